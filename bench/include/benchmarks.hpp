@@ -0,0 +1,72 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#ifndef INCG_PL_BENCH_BENCHMARKS_HPP
+#define INCG_PL_BENCH_BENCHMARKS_HPP
+#include "../../include/pl/annotations.hpp" // PL_INOUT
+#include "../../include/pl/bench.hpp"       // pl::bench
+
+namespace pl {
+namespace benchmarks {
+/*!
+ * \brief Runs the benchmarks of hexify, unhexify, memxor, bswap and hash.
+ * \param b The bench to run them on.
+ **/
+void byte_benchmarks(PL_INOUT bench& b);
+
+/*!
+ * \brief Runs the benchmarks of string_view and strcontains.
+ * \param b The bench to run them on.
+ **/
+void string_benchmarks(PL_INOUT bench& b);
+
+/*!
+ * \brief Runs the benchmarks of timer, tsc_timer and hdr_histogram.
+ * \param b The bench to run them on.
+ **/
+void timer_benchmarks(PL_INOUT bench& b);
+
+/*!
+ * \brief Runs the benchmarks of the synchronization primitives of pl::thd.
+ * \param b The bench to run them on.
+ **/
+void thd_sync_benchmarks(PL_INOUT bench& b);
+
+/*!
+ * \brief Runs the benchmarks of the concurrent containers and the memory
+ *        reclamation of pl::thd.
+ * \param b The bench to run them on.
+ **/
+void thd_container_benchmarks(PL_INOUT bench& b);
+
+/*!
+ * \brief Runs the benchmarks of the executors of pl::thd.
+ * \param b The bench to run them on.
+ **/
+void thd_executor_benchmarks(PL_INOUT bench& b);
+} // namespace benchmarks
+} // namespace pl
+#endif // INCG_PL_BENCH_BENCHMARKS_HPP
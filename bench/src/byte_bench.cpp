@@ -0,0 +1,91 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/bench.hpp"    // pl::bench, pl::do_not_optimize
+#include "../../include/pl/bswap.hpp"    // pl::bswap
+#include "../../include/pl/byte.hpp"     // pl::byte
+#include "../../include/pl/hash.hpp"     // pl::hash
+#include "../../include/pl/hexify.hpp"   // pl::hexify
+#include "../../include/pl/memxor.hpp"   // pl::memxor
+#include "../../include/pl/unhexify.hpp" // pl::unhexify, pl::try_unhexify
+#include "../include/benchmarks.hpp"     // pl::benchmarks::byte_benchmarks
+#include <cstddef>                       // std::size_t
+#include <cstdint>                       // std::uint32_t, std::uint64_t
+#include <string>                        // std::string
+#include <vector>                        // std::vector
+
+namespace pl {
+namespace benchmarks {
+void byte_benchmarks(PL_INOUT bench& b)
+{
+  std::vector<byte> bytes(64U);
+
+  for (std::size_t i{0U}; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<byte>(i * 37U);
+  }
+
+  b.run("hexify/64", [&bytes] {
+    do_not_optimize(hexify(bytes.data(), bytes.size(), " "));
+  });
+
+  const std::string hex{hexify(bytes.data(), bytes.size(), " ")};
+
+  b.run("unhexify/64", [&hex] { do_not_optimize(unhexify(hex, 1U)); });
+  b.run(
+    "try_unhexify/64", [&hex] { do_not_optimize(try_unhexify(hex, 1U)); });
+
+  for (const std::size_t size : {64U, 4096U, 1048576U}) {
+    std::vector<byte>       destination(size);
+    const std::vector<byte> source(size, static_cast<byte>(0x5A));
+
+    b.run("memxor/" + std::to_string(size), [&destination, &source] {
+      do_not_optimize(
+        memxor(destination.data(), source.data(), destination.size()));
+      clobber_memory();
+    });
+  }
+
+  std::uint32_t u32{0x12345678U};
+  b.run("bswap/uint32", [&u32] {
+    u32 = bswap(u32);
+    do_not_optimize(u32);
+  });
+
+  std::uint64_t u64{0x0123456789ABCDEFU};
+  b.run("bswap/uint64", [&u64] {
+    u64 = bswap(u64);
+    do_not_optimize(u64);
+  });
+
+  const std::string text{"some text to hash"};
+  int               number{42};
+  b.run("hash/3", [&text, &number] {
+    do_not_optimize(number);
+    do_not_optimize(hash(text, number, 1.5));
+  });
+}
+} // namespace benchmarks
+} // namespace pl
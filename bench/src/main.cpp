@@ -0,0 +1,79 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/bench.hpp" // pl::bench, pl::write_json, pl::write_csv
+#include "../include/benchmarks.hpp" // pl::benchmarks::byte_benchmarks
+#include <cstdlib>                   // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>                  // std::cout, std::cerr
+#include <string>                    // std::string
+
+/*!
+ * \brief Runs the benchmarks.
+ *
+ * Usage: benchmarks [--json | --csv] [filter]
+ * Only the benchmarks whose names contain filter are run.
+ * The results are written to stdout, as JSON by default.
+ **/
+int main(int argc, char** argv)
+{
+  pl::bench_options options{};
+  bool              is_csv{false};
+
+  for (int i{1}; i < argc; ++i) {
+    const std::string argument{argv[i]};
+
+    if (argument == "--csv") {
+      is_csv = true;
+    }
+    else if (argument == "--json") {
+      is_csv = false;
+    }
+    else if ((argument.size() > 1U) && (argument[0] == '-')) {
+      std::cerr << "Usage: " << argv[0] << " [--json | --csv] [filter]\n";
+      return EXIT_FAILURE;
+    }
+    else {
+      options.filter = argument;
+    }
+  }
+
+  pl::bench b{options};
+  pl::benchmarks::byte_benchmarks(b);
+  pl::benchmarks::string_benchmarks(b);
+  pl::benchmarks::timer_benchmarks(b);
+  pl::benchmarks::thd_sync_benchmarks(b);
+  pl::benchmarks::thd_container_benchmarks(b);
+  pl::benchmarks::thd_executor_benchmarks(b);
+
+  if (is_csv) {
+    pl::write_csv(std::cout, b.results());
+  }
+  else {
+    pl::write_json(std::cout, b.results());
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,58 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/bench.hpp"       // pl::bench, pl::do_not_optimize
+#include "../../include/pl/strcontains.hpp" // pl::strcontains
+#include "../../include/pl/string_view.hpp" // pl::string_view
+#include "../include/benchmarks.hpp"        // pl::benchmarks::string_benchmarks
+#include <string>                           // std::string
+
+namespace pl {
+namespace benchmarks {
+void string_benchmarks(PL_INOUT bench& b)
+{
+  const std::string haystack(4096U, 'a');
+  const std::string needle{"aab"};
+
+  b.run("string_view/contains/4096", [&haystack, &needle] {
+    do_not_optimize(string_view{haystack}.contains(string_view{needle}));
+  });
+
+  b.run("string_view/contains_char/4096", [&haystack] {
+    do_not_optimize(string_view{haystack}.contains('b'));
+  });
+
+  b.run("string_view/compare/4096", [&haystack] {
+    const string_view view{haystack};
+    do_not_optimize(view.compare(view));
+  });
+
+  b.run("strcontains/4096", [&haystack, &needle] {
+    do_not_optimize(strcontains(haystack, needle));
+  });
+}
+} // namespace benchmarks
+} // namespace pl
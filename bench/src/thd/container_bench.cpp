@@ -0,0 +1,157 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/bench.hpp" // pl::bench, pl::do_not_optimize
+#include "../../../include/pl/thd/bounded_queue.hpp" // pl::thd::bounded_queue
+#include "../../../include/pl/thd/combinable.hpp"    // pl::thd::combinable
+#include "../../../include/pl/thd/concurrent_hash_map.hpp" // pl::thd::concurrent_hash_map
+#include "../../../include/pl/thd/reclamation.hpp" // pl::thd::epoch_guard, pl::thd::hazard_pointer
+#include "../../../include/pl/thd/sharded_counter.hpp" // pl::thd::sharded_counter
+#include "../../../include/pl/thd/spsc_queue.hpp"    // pl::thd::spsc_queue
+#include "../../../include/pl/thd/thread_safe_queue.hpp" // pl::thd::thread_safe_queue
+#include "../../../include/pl/thd/treiber_stack.hpp" // pl::thd::treiber_stack, pl::thd::intrusive_treiber_stack
+#include "../../include/benchmarks.hpp" // pl::benchmarks::thd_container_benchmarks
+#include <atomic>                                    // std::atomic
+#include <cstddef>                                   // std::size_t
+#include <cstdint>                                   // std::uint64_t
+#include <thread>                                    // std::thread
+
+namespace pl {
+namespace benchmarks {
+void thd_container_benchmarks(PL_INOUT bench& b)
+{
+  thd::bounded_queue<int> bounded{64U};
+  b.run("thd/bounded_queue/push_pop", [&bounded] {
+    int value{0};
+    bounded.push(1);
+    bounded.pop(value);
+    do_not_optimize(value);
+  });
+
+  thd::spsc_queue<int> spsc{64U};
+  b.run("thd/spsc_queue/push_pop", [&spsc] {
+    int value{0};
+    spsc.try_push(1);
+    spsc.try_pop(value);
+    do_not_optimize(value);
+  });
+
+  // a consumer thread drains the queue, measures the transfer between cores.
+  thd::spsc_queue<std::uint64_t, true> blocking_spsc{1024U};
+  std::thread                          consumer{[&blocking_spsc] {
+    while (blocking_spsc.pop() != 0U) {
+    }
+  }};
+
+  std::uint64_t next{1U};
+  b.run("thd/spsc_queue/push_to_other_thread", [&blocking_spsc, &next] {
+    blocking_spsc.push(next++);
+  });
+
+  blocking_spsc.push(0U);
+  consumer.join();
+
+  thd::thread_safe_queue<int> safe_queue{};
+  b.run("thd/thread_safe_queue/push_pop", [&safe_queue] {
+    safe_queue.push(1);
+    do_not_optimize(safe_queue.pop());
+  });
+
+  thd::treiber_stack<int> stack{};
+  b.run("thd/treiber_stack/push_pop", [&stack] {
+    int value{0};
+    stack.push(1);
+    stack.try_pop(value);
+    do_not_optimize(value);
+  });
+
+  struct pooled_buffer {
+    std::atomic<pooled_buffer*> next;
+    int                         value;
+  };
+
+  pooled_buffer buffer{{nullptr}, 0};
+  thd::intrusive_treiber_stack<pooled_buffer, &pooled_buffer::next> pool{};
+  b.run("thd/intrusive_treiber_stack/push_pop", [&pool, &buffer] {
+    pool.push(buffer);
+    do_not_optimize(pool.try_pop());
+  });
+
+  thd::concurrent_hash_map<int, int> map{};
+
+  for (int i{0}; i < 1024; ++i) {
+    map.insert_or_assign(i, i);
+  }
+
+  int key{0};
+  b.run("thd/concurrent_hash_map/find", [&map, &key] {
+    int value{0};
+    map.find(key, [&value](const int& v) { value = v; });
+    key = (key + 1) & 1023;
+    do_not_optimize(value);
+  });
+
+  b.run("thd/concurrent_hash_map/insert_or_assign", [&map, &key] {
+    do_not_optimize(map.insert_or_assign(key, key));
+    key = (key + 1) & 1023;
+  });
+
+  thd::combinable<std::uint64_t> combinable{};
+  b.run("thd/combinable/local", [&combinable] { ++combinable.local(); });
+
+  thd::sharded_counter counter{};
+  b.run("thd/sharded_counter/increment", [&counter] { counter.increment(); });
+
+  std::atomic<std::uint64_t> atomic_counter{0U};
+  b.run("std::atomic/fetch_add", [&atomic_counter] {
+    atomic_counter.fetch_add(1U, std::memory_order_relaxed);
+  });
+
+  b.run("thd/epoch_guard/pin_unpin", [] {
+    const thd::epoch_guard guard{};
+    clobber_memory();
+  });
+
+  b.run("thd/epoch_retire/new_delete", [] {
+    thd::epoch_retire(new int{1});
+  });
+  thd::epoch_collect();
+
+  int               object{0};
+  std::atomic<int*> source{&object};
+  thd::hazard_pointer hazard{};
+  b.run("thd/hazard_pointer/protect", [&hazard, &source] {
+    do_not_optimize(hazard.protect(source));
+  });
+  hazard.reset();
+
+  b.run("thd/hazard_retire/new_delete", [] {
+    thd::hazard_retire(new int{1});
+  });
+  thd::hazard_collect();
+}
+} // namespace benchmarks
+} // namespace pl
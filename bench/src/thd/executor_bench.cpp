@@ -0,0 +1,133 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/bench.hpp" // pl::bench, pl::do_not_optimize
+#include "../../../include/pl/thd/concurrent.hpp"     // pl::thd::concurrent
+#include "../../../include/pl/thd/fiber.hpp" // pl::thd::fiber_scheduler
+#include "../../../include/pl/thd/keyed_executor.hpp" // pl::thd::keyed_executor
+#include "../../../include/pl/thd/pipeline.hpp"       // pl::thd::make_pipeline
+#include "../../../include/pl/thd/strand.hpp"         // pl::thd::strand
+#include "../../../include/pl/thd/then.hpp"           // pl::thd::then
+#include "../../../include/pl/thd/thread_pool.hpp"    // pl::thd::thread_pool
+#include "../../../include/pl/thd/timer_wheel.hpp"    // pl::thd::timer_wheel
+#include "../../include/benchmarks.hpp" // pl::benchmarks::thd_executor_benchmarks
+#include <chrono>                                     // std::chrono::seconds
+#include <future> // std::future, std::promise
+#include <vector>                                     // std::vector
+
+namespace pl {
+namespace benchmarks {
+void thd_executor_benchmarks(PL_INOUT bench& b)
+{
+  thd::thread_pool pool{4U};
+
+  b.run("thd/thread_pool/add_task_get", [&pool] {
+    do_not_optimize(pool.add_task([] { return 1; }).get());
+  });
+
+  std::vector<std::future<int>> futures{};
+  futures.reserve(100U);
+  b.run("thd/thread_pool/add_task_x100", [&pool, &futures] {
+    for (int i{0}; i < 100; ++i) {
+      futures.push_back(pool.add_task([i] { return i; }));
+    }
+
+    for (std::future<int>& future : futures) {
+      do_not_optimize(future.get());
+    }
+
+    futures.clear();
+  });
+
+  thd::thread_pool metrics_pool{4U};
+  metrics_pool.enable_metrics();
+  b.run("thd/thread_pool/add_task_get_metrics", [&metrics_pool] {
+    do_not_optimize(metrics_pool.add_task([] { return 1; }).get());
+  });
+
+  thd::strand strand{pool};
+  b.run("thd/strand/post_wait", [&strand] {
+    std::promise<void> promise{};
+    strand.post([&promise] { promise.set_value(); });
+    promise.get_future().wait();
+  });
+
+  thd::keyed_executor<int> keyed{pool};
+  int                      key{0};
+  b.run("thd/keyed_executor/add_task_get", [&keyed, &key] {
+    do_not_optimize(keyed.add_task(key, [] { return 1; }).get());
+    key = (key + 1) & 15;
+  });
+
+  thd::concurrent<int> concurrent{pool, 0};
+  b.run("thd/concurrent/call_get", [&concurrent] {
+    do_not_optimize(concurrent([](int& i) { return ++i; }).get());
+  });
+
+  b.run("thd/then/ready_future", [] {
+    std::promise<int> promise{};
+    promise.set_value(1);
+    do_not_optimize(
+      thd::then(promise.get_future(), [](int i) { return i + 1; }).get());
+  });
+
+  b.run("thd/pipeline/100_items", [&pool] {
+    int next{0};
+    int sum{0};
+    thd::make_pipeline([&next](thd::flow_control& fc) {
+      if (next == 100) {
+        fc.stop();
+      }
+
+      return next++;
+    })
+      .add_stage(thd::filter_mode::parallel, [](int i) { return i * 2; })
+      .add_stage(
+        thd::filter_mode::serial_in_order, [&sum](int i) { sum += i; })
+      .run(pool, 8U);
+    do_not_optimize(sum);
+  });
+
+  thd::timer_wheel wheel{pool};
+  b.run("thd/timer_wheel/schedule_cancel", [&wheel] {
+    do_not_optimize(
+      wheel.cancel(wheel.schedule_after(std::chrono::seconds{60}, [] {})));
+  });
+
+  thd::fiber_scheduler scheduler{2U};
+  b.run("thd/fiber_scheduler/spawn_get", [&scheduler] {
+    do_not_optimize(scheduler.spawn([] { return 1; }).get());
+  });
+
+  // a fiber yielding to itself measures the cost of a context switch.
+  scheduler
+    .spawn([&b] {
+      b.run("thd/this_fiber/yield", [] { thd::this_fiber::yield(); });
+    })
+    .get();
+}
+} // namespace benchmarks
+} // namespace pl
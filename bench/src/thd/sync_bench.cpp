@@ -0,0 +1,139 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/bench.hpp" // pl::bench, pl::do_not_optimize
+#include "../../../include/pl/thd/atomic_wait.hpp" // pl::thd::atomic_notify_one
+#include "../../../include/pl/thd/barrier.hpp"        // pl::thd::barrier
+#include "../../../include/pl/thd/counting_semaphore.hpp" // pl::thd::counting_semaphore
+#include "../../../include/pl/thd/event.hpp" // pl::thd::manual_reset_event
+#include "../../../include/pl/thd/latch.hpp"          // pl::thd::latch
+#include "../../../include/pl/thd/monitor.hpp"        // pl::thd::monitor
+#include "../../../include/pl/thd/profiled_mutex.hpp" // pl::thd::profiled_mutex
+#include "../../include/benchmarks.hpp" // pl::benchmarks::thd_sync_benchmarks
+#include <atomic>                                     // std::atomic
+#include <cstdint>                                    // std::uint32_t
+#include <mutex>                                      // std::mutex
+#include <thread>                                     // std::thread
+
+namespace pl {
+namespace benchmarks {
+void thd_sync_benchmarks(PL_INOUT bench& b)
+{
+  std::mutex mutex{};
+  b.run("std::mutex/lock_unlock", [&mutex] {
+    mutex.lock();
+    clobber_memory();
+    mutex.unlock();
+  });
+
+  thd::profiled_mutex profiled{"bench"};
+  b.run("thd/profiled_mutex/lock_unlock/disabled", [&profiled] {
+    profiled.lock();
+    clobber_memory();
+    profiled.unlock();
+  });
+
+  thd::enable_lock_profiling(true);
+  b.run("thd/profiled_mutex/lock_unlock/enabled", [&profiled] {
+    profiled.lock();
+    clobber_memory();
+    profiled.unlock();
+  });
+  thd::enable_lock_profiling(false);
+
+  thd::monitor<int> monitor{0};
+  b.run("thd/monitor/call", [&monitor] {
+    monitor([](int& i) { ++i; });
+  });
+
+  thd::counting_semaphore semaphore{0U};
+  b.run("thd/counting_semaphore/release_acquire", [&semaphore] {
+    semaphore.release();
+    semaphore.acquire();
+  });
+
+  thd::manual_reset_event manual_event{};
+  b.run("thd/manual_reset_event/set_wait_reset", [&manual_event] {
+    manual_event.set();
+    manual_event.wait();
+    manual_event.reset();
+  });
+
+  thd::auto_reset_event auto_event{};
+  b.run("thd/auto_reset_event/set_try_wait", [&auto_event] {
+    auto_event.set();
+    do_not_optimize(auto_event.try_wait());
+  });
+
+  b.run("thd/latch/count_down_wait", [] {
+    thd::latch latch{1U};
+    latch.count_down();
+    latch.wait();
+  });
+
+  thd::barrier<> barrier{1U};
+  b.run("thd/barrier/arrive_and_wait", [&barrier] {
+    barrier.arrive_and_wait();
+  });
+
+  std::atomic<std::uint32_t> word{0U};
+  b.run("thd/atomic_notify_one/no_waiters", [&word] {
+    word.fetch_add(1U, std::memory_order_release);
+    thd::atomic_notify_one(word);
+  });
+
+  // two threads handing a token back and forth, measures the wake up latency.
+  std::atomic<std::uint32_t> ping{0U};
+  std::atomic<bool>          is_done{false};
+  std::thread                ponger{[&ping, &is_done] {
+    std::uint32_t expected{1U};
+
+    while (!is_done.load(std::memory_order_acquire)) {
+      thd::atomic_wait(ping, expected - 1U);
+
+      if (ping.load(std::memory_order_acquire) == expected) {
+        ping.store(expected + 1U, std::memory_order_release);
+        thd::atomic_notify_one(ping);
+        expected += 2U;
+      }
+    }
+  }};
+
+  std::uint32_t next{0U};
+  b.run("thd/atomic_wait/ping_pong", [&ping, &next] {
+    ping.store(next + 1U, std::memory_order_release);
+    thd::atomic_notify_one(ping);
+    thd::atomic_wait(ping, next + 1U);
+    next += 2U;
+  });
+
+  is_done.store(true, std::memory_order_release);
+  ping.fetch_add(1U, std::memory_order_release);
+  thd::atomic_notify_one(ping);
+  ponger.join();
+}
+} // namespace benchmarks
+} // namespace pl
@@ -0,0 +1,73 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/bench.hpp"         // pl::bench, pl::do_not_optimize
+#include "../../include/pl/hdr_histogram.hpp" // pl::hdr_histogram
+#include "../../include/pl/timer.hpp"         // pl::timer
+#include "../../include/pl/tsc_timer.hpp"     // pl::tsc_timer
+#include "../include/benchmarks.hpp" // pl::benchmarks::timer_benchmarks
+#include <chrono>                             // std::chrono::steady_clock
+#include <cstdint>                            // std::uint64_t
+
+namespace pl {
+namespace benchmarks {
+void timer_benchmarks(PL_INOUT bench& b)
+{
+  b.run("std::chrono::steady_clock/now", [] {
+    do_not_optimize(std::chrono::steady_clock::now());
+  });
+
+  const timer t{};
+  b.run("timer/elapsed_time", [&t] { do_not_optimize(t.elapsed_time()); });
+
+  tsc_timer::calibrate();
+  const tsc_timer tsc{};
+  b.run(
+    "tsc_timer/elapsed_time", [&tsc] { do_not_optimize(tsc.elapsed_time()); });
+  b.run("tsc_timer/elapsed_ticks", [&tsc] {
+    do_not_optimize(tsc.elapsed_ticks());
+  });
+
+  hdr_histogram histogram{3600000000000U, 3U};
+  std::uint64_t value{0U};
+  b.run("hdr_histogram/record", [&histogram, &value] {
+    do_not_optimize(histogram.record(value));
+    value = (value * 31U + 17U) & 0xFFFFFFU;
+  });
+  b.run("hdr_histogram/value_at_percentile", [&histogram] {
+    do_not_optimize(histogram.value_at_percentile(99.9));
+  });
+
+  hdr_histogram other{histogram};
+  b.run("hdr_histogram/merge", [&histogram, &other] {
+    do_not_optimize(other.merge(histogram));
+  });
+  b.run("hdr_histogram/serialize", [&histogram] {
+    do_not_optimize(histogram.serialize());
+  });
+}
+} // namespace benchmarks
+} // namespace pl
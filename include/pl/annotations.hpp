@@ -30,8 +30,9 @@
  **/
 #ifndef INCG_PL_ANNOTATIONS_HPP
 #define INCG_PL_ANNOTATIONS_HPP
+#include "begin_end_macro.hpp" // PL_BEGIN_MACRO, PL_END_MACRO
 #include "compiler.hpp" // PL_COMPILER, PL_COMPILER_GCC, PL_COMPILER_CLANG, PL_COMPILER_ICC, PL_COMPILER_MSVC, PL_COMPILER_UNKNOWN
-#include <cstddef>      // std::nullptr_t
+#include <cstddef>             // std::nullptr_t
 
 /*!
  * \def PL_FALLTHROUGH
@@ -61,6 +62,61 @@
  * will be considered to be the first argument!
  **/
 
+/*!
+ * \def PL_LIKELY(expr)
+ * \brief Evaluates to expr converted to bool and tells the compiler that
+ *        expr is expected to be true.
+ * \example if (PL_LIKELY(size < capacity)) { ... }
+ **/
+
+/*!
+ * \def PL_UNLIKELY(expr)
+ * \brief Evaluates to expr converted to bool and tells the compiler that
+ *        expr is expected to be false, so that the branch it guards is laid
+ *        out away from the hot path.
+ **/
+
+/*!
+ * \def PL_ASSUME(expr)
+ * \brief Tells the compiler that expr is true, which it may optimize on.
+ * \warning The behavior is undefined if expr is false.
+ *          expr must not have side effects, it may or may not be evaluated.
+ **/
+
+/*!
+ * \def PL_PREFETCH(address, rw, locality)
+ * \brief Hints the CPU to fetch the cache line that contains address.
+ * \note rw must be 0 if the memory is to be read or 1 if it is to be
+ *       written to. locality must be within [0..3], 0 meaning that the data
+ *       will not be reused soon and 3 that it should stay in all levels of
+ *       cache. Both must be constant expressions.
+ **/
+
+/*!
+ * \def PL_HOT
+ * \brief Annotates a function as frequently called, to be optimized more
+ *        aggressively and to be placed next to other hot functions.
+ **/
+
+/*!
+ * \def PL_COLD
+ * \brief Annotates a function as rarely called, to be optimized for size
+ *        and to be placed away from the hot code. Branches leading to calls
+ *        to cold functions are considered to be unlikely.
+ **/
+
+/*!
+ * \def PL_NOINLINE
+ * \brief Prevents the function annotated from being inlined.
+ **/
+
+/*!
+ * \def PL_FLATTEN
+ * \brief Requests every call inside of the function annotated to be inlined
+ *        if possible.
+ * \note Expands to nothing for MSVC.
+ **/
+
 /*!
  * \def PL_IN
  * \brief Annotates a pointer or reference parameter as an input parameter.
@@ -162,6 +218,54 @@
 #define PL_PRINTF_FUNCTION(format_str_pos, var_args_pos) /* nothing */
 #endif
 
+#if (PL_COMPILER == PL_COMPILER_GCC) || (PL_COMPILER == PL_COMPILER_CLANG) \
+  || (PL_COMPILER == PL_COMPILER_ICC)
+#define PL_LIKELY(expr) (__builtin_expect(!!(expr), 1))
+#define PL_UNLIKELY(expr) (__builtin_expect(!!(expr), 0))
+#define PL_PREFETCH(address, rw, locality) \
+  __builtin_prefetch((address), (rw), (locality))
+#define PL_HOT __attribute__((hot))
+#define PL_COLD __attribute__((cold))
+#define PL_NOINLINE __attribute__((noinline))
+#define PL_FLATTEN __attribute__((flatten))
+#if PL_COMPILER == PL_COMPILER_CLANG
+#define PL_ASSUME(expr) __builtin_assume(expr)
+#else
+#define PL_ASSUME(expr)    \
+  PL_BEGIN_MACRO             \
+  if (!(expr)) {             \
+    __builtin_unreachable(); \
+  }                          \
+  PL_END_MACRO
+#endif
+#elif PL_COMPILER == PL_COMPILER_MSVC
+#define PL_LIKELY(expr) (!!(expr))
+#define PL_UNLIKELY(expr) (!!(expr))
+#define PL_ASSUME(expr) __assume(expr)
+#if defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h> // _mm_prefetch
+#define PL_PREFETCH(address, rw, locality)                     \
+  _mm_prefetch(                                                \
+    static_cast<const char*>(static_cast<const void*>(address)), \
+    ((locality) == 0) ? _MM_HINT_NTA : (4 - (locality)))
+#else
+#define PL_PREFETCH(address, rw, locality) static_cast<void>(address)
+#endif
+#define PL_HOT      /* nothing */
+#define PL_COLD     /* nothing */
+#define PL_NOINLINE __declspec(noinline)
+#define PL_FLATTEN  /* nothing */
+#else
+#define PL_LIKELY(expr) (!!(expr))
+#define PL_UNLIKELY(expr) (!!(expr))
+#define PL_ASSUME(expr) static_cast<void>(0)
+#define PL_PREFETCH(address, rw, locality) static_cast<void>(address)
+#define PL_HOT      /* nothing */
+#define PL_COLD     /* nothing */
+#define PL_NOINLINE /* nothing */
+#define PL_FLATTEN  /* nothing */
+#endif
+
 /*!
  * \def PL_PARENT(parent)
  * \brief Macro that can be used to mark something as a parent.
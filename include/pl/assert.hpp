@@ -31,10 +31,11 @@
  **/
 #ifndef INCG_PL_ASSERT_HPP
 #define INCG_PL_ASSERT_HPP
+#include "annotations.hpp"     // PL_UNLIKELY
 #include "begin_end_macro.hpp" // PL_BEGIN_MACRO, PL_END_MACRO
 #include "except.hpp" // pl::assertion_violation_exception, pl::precondition_violation_exception, pl::postcondition_violation_exception
-#include <cassert>    // NDEBUG
-#include <string>     // std::string
+#include <cassert>             // NDEBUG
+#include <string>              // std::string
 
 /*!
  * \def PL_DBG_CHECK_PRE(precondition)
@@ -101,7 +102,7 @@
 #define PL_DETAIL_ASSERTION_IMPLEMENTATION(                             \
   condition, exception_type, violation_type_string)                     \
   PL_BEGIN_MACRO                                                        \
-  if (!(condition)) {                                                   \
+  if (PL_UNLIKELY(!(condition))) {                                      \
     PL_THROW_WITH_SOURCE_INFO(                                          \
       exception_type,                                                   \
       violation_type_string                                             \
@@ -119,7 +120,7 @@
 #define PL_DETAIL_ASSERTION_IMPLEMENTATION_MSG(                  \
   condition, exception_type, violation_type_string, message)     \
   PL_BEGIN_MACRO                                                 \
-  if (!(condition)) {                                            \
+  if (PL_UNLIKELY(!(condition))) {                               \
     PL_THROW_WITH_SOURCE_INFO(                                   \
       exception_type,                                            \
       violation_type_string                                      \
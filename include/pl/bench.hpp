@@ -0,0 +1,394 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file bench.hpp
+ * \brief Exports a micro-benchmark harness built on pl::timer.
+ **/
+#ifndef INCG_PL_BENCH_HPP
+#define INCG_PL_BENCH_HPP
+#include "annotations.hpp"   // PL_IN, PL_INOUT, PL_NODISCARD, PL_NOINLINE
+#include "compiler.hpp"      // PL_COMPILER, PL_COMPILER_MSVC
+#include "hdr_histogram.hpp" // pl::hdr_histogram
+#include "json_quote.hpp"    // pl::json_quote
+#include "timer.hpp"         // pl::timer
+#include <algorithm>         // std::min, std::max
+#include <chrono>            // std::chrono::nanoseconds, std::chrono::duration
+#include <cstddef>           // std::size_t
+#include <cstdint>           // std::uint64_t
+#include <ios>               // std::fixed
+#include <iomanip>           // std::setprecision
+#include <ostream>           // std::ostream
+#include <sstream>           // std::ostringstream
+#include <string>            // std::string
+#include <type_traits>       // std::enable_if_t, std::is_trivially_copyable
+#include <utility>           // std::move
+#include <vector>            // std::vector
+#if PL_COMPILER == PL_COMPILER_MSVC
+#include <intrin.h> // _ReadWriteBarrier
+#endif              // PL_COMPILER == PL_COMPILER_MSVC
+
+namespace pl {
+#if PL_COMPILER == PL_COMPILER_MSVC
+namespace detail {
+PL_NOINLINE inline void use_char_pointer(const volatile char*) noexcept
+{
+}
+} // namespace detail
+
+/*!
+ * \brief Prevents the compiler from optimizing away the computation of value.
+ * \param value The value that is to be treated as if it were observed.
+ **/
+template<typename Ty>
+inline void do_not_optimize(PL_IN const Ty& value) noexcept
+{
+  detail::use_char_pointer(&reinterpret_cast<const volatile char&>(value));
+  _ReadWriteBarrier();
+}
+
+/*!
+ * \brief Forces the compiler to assume that all of memory may have been read
+ *        and written, so that stores are not optimized away.
+ **/
+inline void clobber_memory() noexcept
+{
+  _ReadWriteBarrier();
+}
+#else
+/*!
+ * \brief Prevents the compiler from optimizing away the computation of value.
+ * \param value The value that is to be treated as if it were observed.
+ **/
+template<typename Ty>
+inline std::enable_if_t<
+  std::is_trivially_copyable<Ty>::value && (sizeof(Ty) <= sizeof(Ty*))>
+do_not_optimize(PL_IN const Ty& value) noexcept
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/*!
+ * \brief Prevents the compiler from optimizing away the computation of value.
+ * \param value The value that is to be treated as if it were observed.
+ * \note Objects that don't fit into a register are observed in memory,
+ *       so that they aren't copied.
+ **/
+template<typename Ty>
+inline std::enable_if_t<
+  !std::is_trivially_copyable<Ty>::value || (sizeof(Ty) > sizeof(Ty*))>
+do_not_optimize(PL_IN const Ty& value) noexcept
+{
+  asm volatile("" : : "m"(value) : "memory");
+}
+
+/*!
+ * \brief Forces the compiler to assume that all of memory may have been read
+ *        and written, so that stores are not optimized away.
+ **/
+inline void clobber_memory() noexcept
+{
+  asm volatile("" : : : "memory");
+}
+#endif // PL_COMPILER == PL_COMPILER_MSVC
+
+/*!
+ * \brief The settings of a bench.
+ **/
+struct bench_options {
+  std::chrono::nanoseconds warmup_time{
+    std::chrono::milliseconds{10}}; //!< minimum time spent warming up.
+  std::chrono::nanoseconds sample_time{
+    std::chrono::milliseconds{1}}; //!< minimum duration of a sample.
+  std::size_t sample_count{31U};   //!< the amount of samples to take.
+  std::string filter{}; //!< only names containing filter are run.
+};
+
+/*!
+ * \brief The statistics measured for a benchmark.
+ *        All of the times are in nanoseconds per iteration.
+ **/
+struct bench_result {
+  std::string   name;       //!< the name of the benchmark.
+  std::size_t   samples;    //!< the amount of samples taken.
+  std::uint64_t iterations; //!< the amount of iterations per sample.
+  double        min_ns;     //!< the fastest sample.
+  double        median_ns;  //!< the median sample.
+  double        p99_ns;     //!< the 99th percentile.
+  double        mean_ns;    //!< the arithmetic mean of the samples.
+  double        max_ns;     //!< the slowest sample.
+};
+
+namespace detail {
+/*!
+ * \brief The highest sample in picoseconds per iteration that the
+ *        histogram of a benchmark tracks: one hour.
+ **/
+constexpr std::uint64_t bench_max_sample_ps{3600000000000000U};
+
+/*!
+ * \brief Formats a number of nanoseconds for output.
+ * \param ns The nanoseconds.
+ * \return ns with three decimal places.
+ **/
+inline std::string bench_format(double ns)
+{
+  std::ostringstream oss{};
+  oss << std::fixed << std::setprecision(3) << ns;
+  return oss.str();
+}
+
+/*!
+ * \brief Escapes a string for use as a CSV field.
+ * \param string The string to escape.
+ * \return string in double quotes if it contains a comma, a quote or a
+ *         line break; string unchanged otherwise.
+ **/
+inline std::string bench_csv_string(PL_IN const std::string& string)
+{
+  if (string.find_first_of(",\"\r\n") == std::string::npos) {
+    return string;
+  }
+
+  std::string result{"\""};
+
+  for (const char c : string) {
+    if (c == '"') {
+      result += '"';
+    }
+
+    result += c;
+  }
+
+  result += '"';
+  return result;
+}
+} // namespace detail
+
+/*!
+ * \brief A micro-benchmark harness.
+ * \example pl::bench b{};
+ *          b.run("hexify", [&bytes] {
+ *            pl::do_not_optimize(pl::hexify(bytes));
+ *          });
+ *          pl::write_json(std::cout, b.results());
+ *
+ * Each benchmark is warmed up first, while the amount of iterations per
+ * sample is scaled up until a sample takes at least sample_time, so that
+ * the overhead of reading the clock is amortized. Afterwards sample_count
+ * samples are timed with pl::timer and aggregated in a pl::hdr_histogram,
+ * which keeps three significant digits.
+ **/
+class bench {
+public:
+  using this_type = bench;
+
+  /*!
+   * \brief Creates a bench.
+   * \param options The settings to use.
+   **/
+  explicit bench(bench_options options = bench_options{})
+    : m_options{std::move(options)}, m_results{}
+  {
+  }
+
+  /*!
+   * \brief Benchmarks callable and stores the result.
+   * \param name The name of the benchmark.
+   * \param callable The code to benchmark, invoked once per iteration.
+   * \return true if the benchmark was run; false if its name doesn't
+   *         contain the filter.
+   * \note Use do_not_optimize and clobber_memory within callable, so that
+   *       the compiler can't optimize away the code being measured.
+   **/
+  template<typename Callable>
+  bool run(std::string name, Callable&& callable)
+  {
+    if (name.find(m_options.filter) == std::string::npos) {
+      return false;
+    }
+
+    const std::uint64_t iterations{warm_up(callable)};
+
+    // Picoseconds keep three decimal places for the fastest benchmarks.
+    constexpr double ps_per_ns{1000.0};
+    hdr_histogram    samples{detail::bench_max_sample_ps, 3U};
+    std::uint64_t sum_ps{0U};
+
+    for (std::size_t i{0U}; i < m_options.sample_count; ++i) {
+      const std::uint64_t sample_ps{static_cast<std::uint64_t>(
+        static_cast<double>(run_batch(callable, iterations).count()) * ps_per_ns
+          / static_cast<double>(iterations)
+        + 0.5)};
+
+      if (samples.record(sample_ps)) {
+        sum_ps += sample_ps;
+      }
+    }
+
+    m_results.push_back(bench_result{
+      std::move(name),
+      static_cast<std::size_t>(samples.total_count()),
+      iterations,
+      static_cast<double>(samples.min()) / ps_per_ns,
+      static_cast<double>(samples.value_at_percentile(50.0)) / ps_per_ns,
+      static_cast<double>(samples.value_at_percentile(99.0)) / ps_per_ns,
+      static_cast<double>(sum_ps)
+        / static_cast<double>(
+          (std::max)(samples.total_count(), std::uint64_t{1U}))
+        / ps_per_ns,
+      static_cast<double>(samples.max()) / ps_per_ns});
+    return true;
+  }
+
+  /*!
+   * \brief Returns the settings.
+   * \return The settings.
+   **/
+  PL_NODISCARD const bench_options& options() const noexcept
+  {
+    return m_options;
+  }
+
+  /*!
+   * \brief Returns the results of the benchmarks run so far.
+   * \return The results in the order in which the benchmarks were run.
+   **/
+  PL_NODISCARD const std::vector<bench_result>& results() const noexcept
+  {
+    return m_results;
+  }
+
+private:
+  /*!
+   * \brief Invokes callable iterations times.
+   * \return The time taken.
+   **/
+  template<typename Callable>
+  static std::chrono::nanoseconds
+  run_batch(PL_INOUT Callable& callable, std::uint64_t iterations)
+  {
+    const timer t{};
+
+    for (std::uint64_t i{0U}; i < iterations; ++i) {
+      callable();
+    }
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      t.elapsed_time());
+  }
+
+  /*!
+   * \brief Runs callable for at least warmup_time.
+   * \return The amount of iterations that take at least sample_time.
+   **/
+  template<typename Callable>
+  std::uint64_t warm_up(PL_INOUT Callable& callable) const
+  {
+    const timer   warmup_timer{};
+    std::uint64_t iterations{1U};
+
+    for (;;) {
+      const std::chrono::nanoseconds elapsed{run_batch(callable, iterations)};
+
+      if (elapsed >= m_options.sample_time) {
+        if (warmup_timer.elapsed_time() >= m_options.warmup_time) {
+          return iterations;
+        }
+
+        continue;
+      }
+
+      // Aim slightly above sample_time, but grow by at most 10x per step
+      // as the first batches are distorted by cold caches.
+      const double wanted{
+        elapsed.count() <= 0
+          ? static_cast<double>(iterations) * 10.0
+          : static_cast<double>(iterations) * 1.2
+              * static_cast<double>(m_options.sample_time.count())
+              / static_cast<double>(elapsed.count())};
+      iterations = std::max(
+        iterations + 1U,
+        std::min(iterations * 10U, static_cast<std::uint64_t>(wanted)));
+    }
+  }
+
+  bench_options             m_options; //!< the settings.
+  std::vector<bench_result> m_results; //!< the results so far.
+};
+
+/*!
+ * \brief Writes benchmark results as JSON.
+ * \param os The ostream to write to.
+ * \param results The results to write.
+ * \return os.
+ **/
+inline std::ostream& write_json(
+  PL_INOUT std::ostream& os,
+  PL_IN const std::vector<bench_result>& results)
+{
+  os << "{\n  \"benchmarks\": [";
+
+  for (std::size_t i{0U}; i < results.size(); ++i) {
+    const bench_result& r{results[i]};
+    os << (i == 0U ? "\n" : ",\n") << "    {\"name\": "
+       << json_quote(r.name) << ", \"samples\": " << r.samples
+       << ", \"iterations\": " << r.iterations
+       << ", \"min_ns\": " << detail::bench_format(r.min_ns)
+       << ", \"median_ns\": " << detail::bench_format(r.median_ns)
+       << ", \"p99_ns\": " << detail::bench_format(r.p99_ns)
+       << ", \"mean_ns\": " << detail::bench_format(r.mean_ns)
+       << ", \"max_ns\": " << detail::bench_format(r.max_ns) << '}';
+  }
+
+  return os << "\n  ]\n}\n";
+}
+
+/*!
+ * \brief Writes benchmark results as CSV, including a header line.
+ * \param os The ostream to write to.
+ * \param results The results to write.
+ * \return os.
+ **/
+inline std::ostream& write_csv(
+  PL_INOUT std::ostream& os,
+  PL_IN const std::vector<bench_result>& results)
+{
+  os << "name,samples,iterations,min_ns,median_ns,p99_ns,mean_ns,max_ns\n";
+
+  for (const bench_result& r : results) {
+    os << detail::bench_csv_string(r.name) << ',' << r.samples << ','
+       << r.iterations << ',' << detail::bench_format(r.min_ns) << ','
+       << detail::bench_format(r.median_ns) << ','
+       << detail::bench_format(r.p99_ns) << ','
+       << detail::bench_format(r.mean_ns) << ','
+       << detail::bench_format(r.max_ns) << '\n';
+  }
+
+  return os;
+}
+} // namespace pl
+#endif // INCG_PL_BENCH_HPP
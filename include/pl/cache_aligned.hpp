@@ -0,0 +1,263 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file cache_aligned.hpp
+ * \brief Exports the hardware interference size constants, the
+ *        cache_aligned class template and the cache_aligned_allocator to
+ *        avoid false sharing.
+ **/
+#ifndef INCG_PL_CACHE_ALIGNED_HPP
+#define INCG_PL_CACHE_ALIGNED_HPP
+#include "annotations.hpp" // PL_NODISCARD
+#include "compiler.hpp"    // PL_COMPILER, PL_COMPILER_MSVC
+#include "type_traits.hpp" // pl::enable_if_t, pl::decay_t
+#include <cstddef>         // std::size_t
+#include <cstdint>         // std::uintptr_t
+#include <limits>          // std::numeric_limits
+#include <new>             // operator new, operator delete, std::bad_alloc
+#include <type_traits>     // std::is_same
+#include <utility>         // std::forward
+
+namespace pl {
+/*!
+ * \brief The minimum offset between two objects to avoid false sharing.
+ * \note Fallback for std::hardware_destructive_interference_size, which is
+ *       only available as of C++17 and whose value GCC warns may differ
+ *       between compiler versions, making it unsuitable for headers.
+ *
+ * 128 on architectures whose processors prefetch pairs of cache lines or
+ * have 128 byte cache lines, 64 otherwise.
+ **/
+constexpr std::size_t hardware_destructive_interference_size{
+#if defined(__aarch64__) || defined(_M_ARM64) || defined(__powerpc64__) \
+  || defined(__s390x__)
+  128U
+#else
+  64U
+#endif
+};
+
+/*!
+ * \brief The maximum size of contiguous memory to promote true sharing.
+ * \note Fallback for std::hardware_constructive_interference_size.
+ **/
+constexpr std::size_t hardware_constructive_interference_size{64U};
+
+#if PL_COMPILER == PL_COMPILER_MSVC
+#pragma warning(push)
+#pragma warning(disable : 4324) // structure was padded due to alignment
+#endif                          // PL_COMPILER == PL_COMPILER_MSVC
+
+/*!
+ * \brief Wraps an object of type Ty so that it occupies cache lines of its
+ *        own, no other object can falsely share them.
+ * \note Objects of this type are over-aligned, std::allocator only honors
+ *       the alignment as of C++17. Use cache_aligned_allocator to store
+ *       them in standard containers.
+ *
+ * Both the alignment and the size are multiples of
+ * hardware_destructive_interference_size.
+ **/
+template<typename Ty>
+class alignas(hardware_destructive_interference_size) cache_aligned {
+public:
+  using this_type    = cache_aligned;
+  using element_type = Ty;
+
+  /*!
+   * \brief Value initializes the object wrapped.
+   **/
+  constexpr cache_aligned() : m_value{}
+  {
+  }
+
+  /*!
+   * \brief Creates the object wrapped from args.
+   * \param args The arguments to forward to the constructor of Ty.
+   * \note Does not participate in overload resolution if the only argument
+   *       is a cache_aligned.
+   **/
+  template<
+    typename Arg,
+    typename... Args,
+    typename = enable_if_t<!std::is_same<decay_t<Arg>, this_type>::value>>
+  constexpr explicit cache_aligned(Arg&& arg, Args&&... args)
+    : m_value(std::forward<Arg>(arg), std::forward<Args>(args)...)
+  {
+  }
+
+  /*!
+   * \brief Returns the object wrapped.
+   * \return A reference to the object wrapped.
+   **/
+  PL_NODISCARD element_type& get() noexcept
+  {
+    return m_value;
+  }
+
+  /*!
+   * \brief Returns the object wrapped.
+   * \return A reference to the object wrapped.
+   **/
+  PL_NODISCARD constexpr const element_type& get() const noexcept
+  {
+    return m_value;
+  }
+
+  /*!
+   * \brief Returns the object wrapped.
+   * \return A reference to the object wrapped.
+   **/
+  PL_NODISCARD element_type& operator*() noexcept
+  {
+    return m_value;
+  }
+
+  /*!
+   * \brief Returns the object wrapped.
+   * \return A reference to the object wrapped.
+   **/
+  PL_NODISCARD constexpr const element_type& operator*() const noexcept
+  {
+    return m_value;
+  }
+
+  /*!
+   * \brief Accesses the members of the object wrapped.
+   * \return A pointer to the object wrapped.
+   **/
+  PL_NODISCARD element_type* operator->() noexcept
+  {
+    return &m_value;
+  }
+
+  /*!
+   * \brief Accesses the members of the object wrapped.
+   * \return A pointer to the object wrapped.
+   **/
+  PL_NODISCARD constexpr const element_type* operator->() const noexcept
+  {
+    return &m_value;
+  }
+
+private:
+  element_type m_value; //!< the object wrapped.
+};
+
+#if PL_COMPILER == PL_COMPILER_MSVC
+#pragma warning(pop)
+#endif // PL_COMPILER == PL_COMPILER_MSVC
+
+/*!
+ * \brief Allocator whose allocations begin on a cache line of their own.
+ * \tparam Ty The type of the objects to allocate.
+ *
+ * Honors the alignment of over-aligned types such as cache_aligned even
+ * before C++17, where std::allocator ignores any alignment beyond that of
+ * std::max_align_t. The storage is aligned to the greater of alignof(Ty)
+ * and hardware_destructive_interference_size.
+ **/
+template<typename Ty>
+class cache_aligned_allocator {
+public:
+  using this_type  = cache_aligned_allocator;
+  using value_type = Ty;
+
+  cache_aligned_allocator() noexcept = default;
+
+  /*!
+   * \brief Rebinding converting constructor, the allocator is stateless.
+   **/
+  template<typename Other>
+  cache_aligned_allocator(const cache_aligned_allocator<Other>&) noexcept
+  {
+  }
+
+  /*!
+   * \brief Allocates storage for count objects of type Ty.
+   * \param count The amount of objects.
+   * \return A pointer to the aligned storage.
+   * \throws std::bad_alloc if the allocation fails.
+   **/
+  PL_NODISCARD value_type* allocate(std::size_t count)
+  {
+    static constexpr std::size_t overhead{alignment - 1U + sizeof(void*)};
+
+    if (count > (std::numeric_limits<std::size_t>::max() - overhead)
+                  / sizeof(value_type)) {
+      throw std::bad_alloc{};
+    }
+
+    // the pointer operator new returned is stored right before the storage.
+    void* const          raw{::operator new(count * sizeof(value_type)
+                                   + overhead)};
+    const std::uintptr_t address{
+      (reinterpret_cast<std::uintptr_t>(raw) + overhead)
+      & ~std::uintptr_t{alignment - 1U}};
+    reinterpret_cast<void**>(address)[-1] = raw;
+    return reinterpret_cast<value_type*>(address);
+  }
+
+  /*!
+   * \brief Frees storage allocated by allocate.
+   * \param p The pointer allocate returned.
+   **/
+  void deallocate(value_type* p, std::size_t) noexcept
+  {
+    ::operator delete(reinterpret_cast<void**>(p)[-1]);
+  }
+
+private:
+  static constexpr std::size_t alignment{
+    alignof(value_type) > hardware_destructive_interference_size
+      ? alignof(value_type)
+      : hardware_destructive_interference_size};
+};
+
+/*!
+ * \brief All cache_aligned_allocators are equal, they are stateless.
+ **/
+template<typename Ty, typename Other>
+constexpr bool operator==(
+  const cache_aligned_allocator<Ty>&,
+  const cache_aligned_allocator<Other>&) noexcept
+{
+  return true;
+}
+
+/*!
+ * \brief All cache_aligned_allocators are equal, they are stateless.
+ **/
+template<typename Ty, typename Other>
+constexpr bool operator!=(
+  const cache_aligned_allocator<Ty>&,
+  const cache_aligned_allocator<Other>&) noexcept
+{
+  return false;
+}
+} // namespace pl
+#endif // INCG_PL_CACHE_ALIGNED_HPP
@@ -31,10 +31,14 @@
  **/
 #ifndef INCG_PL_CONT_AT_HPP
 #define INCG_PL_CONT_AT_HPP
-#include "../annotations.hpp" // PL_IN
+#include "../annotations.hpp" // PL_IN, PL_UNLIKELY
+#include "../expected.hpp"    // pl::expected, pl::make_unexpected
 #include <cstddef>            // std::size_t
+#include <functional>         // std::reference_wrapper
 #include <initializer_list>   // std::initializer_list
 #include <stdexcept>          // std::out_of_range
+#include <system_error>       // std::errc
+#include <type_traits>        // std::remove_reference_t
 
 namespace pl {
 namespace cont {
@@ -49,7 +53,7 @@ namespace cont {
 template<typename Ty, std::size_t Size>
 constexpr Ty& at(PL_IN Ty (&arr)[Size], std::size_t index)
 {
-  if (!(index < Size)) {
+  if (PL_UNLIKELY(!(index < Size))) {
     throw std::out_of_range{
       "index was out of bounds in pl::cont::at (C-Array)"};
   }
@@ -69,7 +73,7 @@ template<typename Container>
 constexpr auto at(PL_IN Container& container, std::size_t index)
   -> decltype(container[container.size()])
 {
-  if (!(index < container.size())) {
+  if (PL_UNLIKELY(!(index < container.size()))) {
     throw std::out_of_range{
       "index was out of bounds in pl::cont::at (container)"};
   }
@@ -88,13 +92,70 @@ constexpr auto at(PL_IN Container& container, std::size_t index)
 template<typename Ty>
 constexpr Ty at(std::initializer_list<Ty> il, std::size_t index)
 {
-  if (!(index < il.size())) {
+  if (PL_UNLIKELY(!(index < il.size()))) {
     throw std::out_of_range{
       "index was out of bounds in pl::cont::at (initializer_list)"};
   }
 
   return *(il.begin() + index);
 }
+/*!
+ * \brief Retrieves a reference to the element at position 'index' in the
+ *        C-Array 'arr' without throwing.
+ * \param arr The C-Array to access.
+ * \param index The index of the element in 'arr' to get a reference to.
+ * \return A reference to the element at position 'index' in 'arr' or
+ *         std::errc::result_out_of_range if 'index' is out of bounds.
+ **/
+template<typename Ty, std::size_t Size>
+expected<std::reference_wrapper<Ty>, std::errc>
+try_at(PL_IN Ty (&arr)[Size], std::size_t index) noexcept
+{
+  if (PL_UNLIKELY(!(index < Size))) {
+    return make_unexpected(std::errc::result_out_of_range);
+  }
+
+  return std::reference_wrapper<Ty>{arr[index]};
+}
+
+/*!
+ * \brief Retrieves a reference to the element at position 'index' in the
+ *        container 'container' without throwing.
+ * \param container The container to access.
+ * \param index The index of the element in 'container' to get a reference to.
+ * \return A reference to the element at position 'index' in 'container' or
+ *         std::errc::result_out_of_range if 'index' is out of bounds.
+ **/
+template<typename Container>
+auto try_at(PL_IN Container& container, std::size_t index) -> expected<
+  std::reference_wrapper<
+    std::remove_reference_t<decltype(container[container.size()])>>,
+  std::errc>
+{
+  if (PL_UNLIKELY(!(index < container.size()))) {
+    return make_unexpected(std::errc::result_out_of_range);
+  }
+
+  return std::ref(container[index]);
+}
+
+/*!
+ * \brief Retrieves a copy of the element at position 'index' in the
+ *        std::initializer_list 'il' without throwing.
+ * \param il The initializer_list to access.
+ * \param index The index of the element to get a copy of.
+ * \return A copy of the element at position 'index' or
+ *         std::errc::result_out_of_range if 'index' is out of bounds.
+ **/
+template<typename Ty>
+expected<Ty, std::errc> try_at(std::initializer_list<Ty> il, std::size_t index)
+{
+  if (PL_UNLIKELY(!(index < il.size()))) {
+    return make_unexpected(std::errc::result_out_of_range);
+  }
+
+  return *(il.begin() + index);
+}
 } // namespace cont
 } // namespace pl
 #endif // INCG_PL_CONT_AT_HPP
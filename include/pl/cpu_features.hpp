@@ -0,0 +1,347 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file cpu_features.hpp
+ * \brief Exports facilities to detect the instruction set extensions
+ *        supported by the CPU at runtime and to dispatch to the best
+ *        implementation of a kernel accordingly.
+ **/
+#ifndef INCG_PL_CPU_FEATURES_HPP
+#define INCG_PL_CPU_FEATURES_HPP
+#include "annotations.hpp" // PL_IN, PL_NODISCARD
+#include "bitmask.hpp"     // PL_ENABLE_BITMASK_OPERATORS
+#include "compiler.hpp"    // PL_COMPILER, PL_COMPILER_MSVC
+#include <cstddef>         // std::size_t
+#include <cstdint>         // std::uint32_t, std::uint64_t
+
+/*!
+ * \def PL_CPU_X86
+ * \brief Defined as 1 if compiling for x86 or x86-64; otherwise 0.
+ **/
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) \
+  || defined(_M_IX86)
+#define PL_CPU_X86 1
+#else
+#define PL_CPU_X86 0
+#endif
+
+#if PL_CPU_X86
+#if PL_COMPILER == PL_COMPILER_MSVC
+#include <intrin.h> // __cpuidex, _xgetbv
+#else
+#include <cpuid.h> // __cpuid_count
+#endif             // PL_COMPILER == PL_COMPILER_MSVC
+#endif             // PL_CPU_X86
+
+/*!
+ * \def PL_TARGET(isa)
+ * \brief Allows the function it is applied to to use the instruction set
+ *        extensions given as a string literal, like "avx2" or "sse4.2",
+ *        regardless of the compiler flags used.
+ * \note Such a function may only be called if the CPU supports those
+ *       instruction set extensions, which is what pl::select_kernel is for.
+ *       Expands to nothing for MSVC, which allows intrinsics for all
+ *       instruction set extensions anyway.
+ * \example PL_TARGET("avx2")
+ *          void add_avx2(float* a, const float* b, std::size_t size);
+ **/
+#if PL_CPU_X86 && (PL_COMPILER != PL_COMPILER_MSVC)
+#define PL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PL_TARGET(isa) /* nothing */
+#endif
+
+namespace pl {
+/*!
+ * \brief Instruction set extensions that may be supported by the CPU.
+ *        The bitmask operators are enabled.
+ * \note Extensions that require support by the operating system (AVX and
+ *       AVX-512) are only reported if the operating system saves the
+ *       corresponding registers on context switches.
+ *       invariant_tsc means that the time stamp counter runs at a constant
+ *       rate regardless of the power state of the CPU.
+ **/
+enum class cpu_feature : std::uint32_t {
+  none          = 0U,
+  sse2          = 1U << 0U,
+  sse3          = 1U << 1U,
+  ssse3         = 1U << 2U,
+  sse4_1        = 1U << 3U,
+  sse4_2        = 1U << 4U,
+  popcnt        = 1U << 5U,
+  pclmul        = 1U << 6U,
+  avx           = 1U << 7U,
+  fma           = 1U << 8U,
+  avx2          = 1U << 9U,
+  bmi1          = 1U << 10U,
+  bmi2          = 1U << 11U,
+  avx512f       = 1U << 12U,
+  avx512dq      = 1U << 13U,
+  avx512cd      = 1U << 14U,
+  avx512bw      = 1U << 15U,
+  avx512vl      = 1U << 16U,
+  sha           = 1U << 17U,
+  rdtscp        = 1U << 18U,
+  invariant_tsc = 1U << 19U
+};
+
+PL_ENABLE_BITMASK_OPERATORS(cpu_feature)
+
+namespace detail {
+/*!
+ * \brief The registers eax, ebx, ecx and edx as returned by CPUID.
+ **/
+struct cpuid_registers {
+  std::uint32_t eax;
+  std::uint32_t ebx;
+  std::uint32_t ecx;
+  std::uint32_t edx;
+};
+
+#if PL_CPU_X86
+inline cpuid_registers cpuid(std::uint32_t leaf, std::uint32_t subleaf) noexcept
+{
+  cpuid_registers r{0U, 0U, 0U, 0U};
+#if PL_COMPILER == PL_COMPILER_MSVC
+  int regs[4]{};
+  __cpuidex(regs, static_cast<int>(leaf), static_cast<int>(subleaf));
+  r.eax = static_cast<std::uint32_t>(regs[0]);
+  r.ebx = static_cast<std::uint32_t>(regs[1]);
+  r.ecx = static_cast<std::uint32_t>(regs[2]);
+  r.edx = static_cast<std::uint32_t>(regs[3]);
+#else
+  unsigned int a{0U};
+  unsigned int b{0U};
+  unsigned int c{0U};
+  unsigned int d{0U};
+  __cpuid_count(leaf, subleaf, a, b, c, d);
+  r.eax = a;
+  r.ebx = b;
+  r.ecx = c;
+  r.edx = d;
+#endif // PL_COMPILER == PL_COMPILER_MSVC
+  return r;
+}
+
+/*!
+ * \brief Reads the extended control register 0, which tells which register
+ *        states the operating system saves.
+ * \warning May only be called if CPUID reports OSXSAVE.
+ **/
+inline std::uint64_t xgetbv0() noexcept
+{
+#if PL_COMPILER == PL_COMPILER_MSVC
+  return static_cast<std::uint64_t>(_xgetbv(0));
+#else
+  std::uint32_t eax{0U};
+  std::uint32_t edx{0U};
+  // the mnemonic would require -mxsave.
+  __asm__ volatile(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<std::uint64_t>(edx) << 32U) | eax;
+#endif // PL_COMPILER == PL_COMPILER_MSVC
+}
+
+inline cpu_feature
+cpu_feature_if(std::uint32_t reg, unsigned bit, cpu_feature feature) noexcept
+{
+  return ((reg >> bit) & 1U) != 0U ? feature : cpu_feature::none;
+}
+
+inline cpu_feature detect_cpu_features() noexcept
+{
+  const std::uint32_t max_leaf{cpuid(0U, 0U).eax};
+
+  if (max_leaf < 1U) {
+    return cpu_feature::none;
+  }
+
+  const cpuid_registers leaf1{cpuid(1U, 0U)};
+  cpu_feature           result{
+    cpu_feature_if(leaf1.edx, 26U, cpu_feature::sse2)
+    | cpu_feature_if(leaf1.ecx, 0U, cpu_feature::sse3)
+    | cpu_feature_if(leaf1.ecx, 1U, cpu_feature::pclmul)
+    | cpu_feature_if(leaf1.ecx, 9U, cpu_feature::ssse3)
+    | cpu_feature_if(leaf1.ecx, 19U, cpu_feature::sse4_1)
+    | cpu_feature_if(leaf1.ecx, 20U, cpu_feature::sse4_2)
+    | cpu_feature_if(leaf1.ecx, 23U, cpu_feature::popcnt)};
+
+  // XCR0 bits: 1 SSE, 2 AVX, 5 opmask, 6 upper ZMM0-15, 7 ZMM16-31.
+  const bool          has_osxsave{((leaf1.ecx >> 27U) & 1U) != 0U};
+  const std::uint64_t xcr0{has_osxsave ? xgetbv0() : 0U};
+  const bool          os_saves_avx{(xcr0 & 0x6U) == 0x6U};
+  const bool          os_saves_avx512{(xcr0 & 0xE6U) == 0xE6U};
+
+  if (os_saves_avx) {
+    result |= cpu_feature_if(leaf1.ecx, 28U, cpu_feature::avx)
+              | cpu_feature_if(leaf1.ecx, 12U, cpu_feature::fma);
+  }
+
+  // leaf 0x80000001 EDX bit 27 and leaf 0x80000007 EDX bit 8.
+  const std::uint32_t max_extended_leaf{cpuid(0x80000000U, 0U).eax};
+
+  if (max_extended_leaf >= 0x80000001U) {
+    result
+      |= cpu_feature_if(cpuid(0x80000001U, 0U).edx, 27U, cpu_feature::rdtscp);
+  }
+
+  if (max_extended_leaf >= 0x80000007U) {
+    result |= cpu_feature_if(
+      cpuid(0x80000007U, 0U).edx, 8U, cpu_feature::invariant_tsc);
+  }
+
+  if (max_leaf < 7U) {
+    return result;
+  }
+
+  const cpuid_registers leaf7{cpuid(7U, 0U)};
+  result |= cpu_feature_if(leaf7.ebx, 3U, cpu_feature::bmi1)
+            | cpu_feature_if(leaf7.ebx, 8U, cpu_feature::bmi2)
+            | cpu_feature_if(leaf7.ebx, 29U, cpu_feature::sha);
+
+  if (os_saves_avx) {
+    result |= cpu_feature_if(leaf7.ebx, 5U, cpu_feature::avx2);
+  }
+
+  if (os_saves_avx512) {
+    result |= cpu_feature_if(leaf7.ebx, 16U, cpu_feature::avx512f)
+              | cpu_feature_if(leaf7.ebx, 17U, cpu_feature::avx512dq)
+              | cpu_feature_if(leaf7.ebx, 28U, cpu_feature::avx512cd)
+              | cpu_feature_if(leaf7.ebx, 30U, cpu_feature::avx512bw)
+              | cpu_feature_if(leaf7.ebx, 31U, cpu_feature::avx512vl);
+  }
+
+  return result;
+}
+#else
+inline cpu_feature detect_cpu_features() noexcept
+{
+  return cpu_feature::none;
+}
+#endif // PL_CPU_X86
+} // namespace detail
+
+/*!
+ * \brief The set of instruction set extensions supported.
+ **/
+class cpu_features {
+public:
+  using this_type = cpu_features;
+
+  /*!
+   * \brief Creates a cpu_features object that reports the features passed.
+   * \param features The features to report.
+   * \note Use current() to get the features of the CPU running the program.
+   **/
+  explicit constexpr cpu_features(cpu_feature features) noexcept
+    : m_features{features}
+  {
+  }
+
+  /*!
+   * \brief Returns the features supported by the CPU and operating system
+   *        the program runs on.
+   * \return The features supported.
+   * \note Runs CPUID only the first time it is called.
+   **/
+  static const this_type& current() noexcept
+  {
+    static const this_type features{detail::detect_cpu_features()};
+    return features;
+  }
+
+  /*!
+   * \brief Queries whether all of the features passed are supported.
+   * \param features The features to query.
+   * \return true if all of them are supported; otherwise false.
+   **/
+  PL_NODISCARD constexpr bool has(cpu_feature features) const noexcept
+  {
+    return (m_features & features) == features;
+  }
+
+  /*!
+   * \brief Returns all of the features supported.
+   * \return The features supported.
+   **/
+  PL_NODISCARD constexpr cpu_feature features() const noexcept
+  {
+    return m_features;
+  }
+
+private:
+  cpu_feature m_features; //!< the features supported.
+};
+
+/*!
+ * \brief An implementation of a kernel together with the instruction set
+ *        extensions it requires.
+ * \tparam Function The type of the function pointer.
+ **/
+template<typename Function>
+struct kernel {
+  cpu_feature requirements; //!< the extensions used by function.
+  Function    function;     //!< the implementation.
+};
+
+/*!
+ * \brief Selects the first of the kernels passed whose requirements are
+ *        met by features.
+ * \param kernels The implementations, best one first. The last one should
+ *                be a portable implementation that requires
+ *                cpu_feature::none.
+ * \param features The features to select by.
+ * \return The function of the first kernel whose requirements are met or
+ *         the function of the last kernel if there is no such kernel.
+ * \example Initialize a function pointer with static storage duration
+ *          once, every later call is an indirect call:
+ *
+ *          inline int sum(const int* p, std::size_t size)
+ *          {
+ *            using fn = int (*)(const int*, std::size_t);
+ *            static const fn impl{pl::select_kernel<fn>(
+ *              {{pl::cpu_feature::avx2, &sum_avx2},
+ *               {pl::cpu_feature::none, &sum_generic}})};
+ *            return impl(p, size);
+ *          }
+ **/
+template<typename Function, std::size_t Size>
+PL_NODISCARD Function select_kernel(
+  PL_IN const kernel<Function> (&kernels)[Size],
+  PL_IN const cpu_features& features = cpu_features::current()) noexcept
+{
+  static_assert(Size > 0U, "At least one kernel is required.");
+
+  for (std::size_t i{0U}; i < Size; ++i) {
+    if (features.has(kernels[i].requirements)) {
+      return kernels[i].function;
+    }
+  }
+
+  return kernels[Size - 1U].function;
+}
+} // namespace pl
+#endif // INCG_PL_CPU_FEATURES_HPP
@@ -30,6 +30,7 @@
  **/
 #ifndef INCG_PL_EXCEPT_HPP
 #define INCG_PL_EXCEPT_HPP
+#include "annotations.hpp"      // PL_UNLIKELY, PL_COLD, PL_NOINLINE
 #include "begin_end_macro.hpp"  // PL_BEGIN_MACRO, PL_END_MACRO
 #include "compiler.hpp"         // PL_COMPILER, PL_COMPILER_MSVC
 #include "current_function.hpp" // PL_CURRENT_FUNCTION
@@ -81,18 +82,14 @@
  * thrown by the macro. The second parameter of the macro is the message
  * of the user to include in the exception object's message, std::string must
  * be constructible from message.
+ * The macro is a throw-expression, it may be used as an operand of the
+ * conditional operator. The exception object is created by an out of line
+ * cold function that is passed pointers to string literals only, so that
+ * the message is not formatted at the throw site.
  **/
-#define PL_THROW_WITH_SOURCE_INFO(exception_type, message) \
-  throw exception_type                                     \
-  {                                                        \
-    "Message: " + std::string{message}                     \
-      + "\nexception was thrown at:\nfile: " __FILE__      \
-        "\nline: " PL_SOURCE_LINE "\nfunction: "           \
-      + std::string                                        \
-    {                                                      \
-      PL_CURRENT_FUNCTION                                  \
-    }                                                      \
-  }
+#define PL_THROW_WITH_SOURCE_INFO(exception_type, message)      \
+  throw ::pl::detail::make_source_info_exception<exception_type>( \
+    message, __FILE__, PL_SOURCE_LINE, PL_CURRENT_FUNCTION)
 
 /*!
  * \def PL_THROW_IF_NULL(pointer)
@@ -102,7 +99,7 @@
  **/
 #define PL_THROW_IF_NULL(pointer)                                      \
   PL_BEGIN_MACRO                                                       \
-  if ((pointer) == nullptr) {                                          \
+  if (PL_UNLIKELY((pointer) == nullptr)) {                             \
     PL_THROW_WITH_SOURCE_INFO(                                         \
       pl::null_pointer_exception, PL_STRINGIFY(pointer) " was null!"); \
   }                                                                    \
@@ -208,6 +205,55 @@ public:
   using std::runtime_error::runtime_error;
 };
 
+namespace detail {
+/*!
+ * \brief Creates an Exception whose message includes the source information.
+ * \note Used by PL_THROW_WITH_SOURCE_INFO.
+ **/
+template<typename Exception>
+PL_COLD PL_NOINLINE Exception make_source_info_exception(
+  const std::string& message,
+  const char*        file,
+  const char*        line,
+  const char*        function)
+{
+  return Exception{
+    "Message: " + message + "\nexception was thrown at:\nfile: " + file
+    + "\nline: " + line + "\nfunction: " + function};
+}
+
+/*!
+ * \brief Creates an Exception whose message includes the source information.
+ * \note Used by PL_THROW_WITH_SOURCE_INFO.
+ **/
+template<typename Exception>
+PL_COLD PL_NOINLINE Exception make_source_info_exception(
+  const char* message,
+  const char* file,
+  const char* line,
+  const char* function)
+{
+  return make_source_info_exception<Exception>(
+    std::string{message}, file, line, function);
+}
+
+/*!
+ * \brief Converts message to std::string and creates an Exception whose
+ *        message includes the source information.
+ * \note Used by PL_THROW_WITH_SOURCE_INFO.
+ **/
+template<typename Exception, typename Message>
+PL_COLD PL_NOINLINE Exception make_source_info_exception(
+  const Message& message,
+  const char*    file,
+  const char*    line,
+  const char*    function)
+{
+  return make_source_info_exception<Exception>(
+    std::string{message}, file, line, function);
+}
+} // namespace detail
+
 #if PL_COMPILER == PL_COMPILER_MSVC
 #pragma warning(push)
 #pragma warning(disable : 4505) // unreferenced local function has been removed
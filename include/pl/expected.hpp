@@ -0,0 +1,537 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file expected.hpp
+ * \brief Exports the expected class template, which holds either a value or
+ *        an error, as a means to report errors without exceptions.
+ **/
+#ifndef INCG_PL_EXPECTED_HPP
+#define INCG_PL_EXPECTED_HPP
+#include "annotations.hpp" // PL_IN, PL_INOUT, PL_NODISCARD, PL_UNLIKELY
+#include <exception>       // std::exception
+#include <new>             // ::operator new
+#include <type_traits> // std::is_trivially_copyable, std::is_nothrow_move_constructible
+#include <utility>         // std::move, std::forward
+
+namespace pl {
+/*!
+ * \brief Wraps an error to construct an expected holding that error from.
+ * \tparam Error The type of the error.
+ **/
+template<typename Error>
+class unexpected {
+public:
+  using this_type  = unexpected;
+  using error_type = Error;
+
+  /*!
+   * \brief Creates an unexpected holding error.
+   * \param error The error.
+   **/
+  constexpr explicit unexpected(PL_IN const error_type& error) : m_error{error}
+  {
+  }
+
+  /*!
+   * \brief Creates an unexpected holding error.
+   * \param error The error.
+   **/
+  constexpr explicit unexpected(error_type&& error)
+    : m_error{std::move(error)}
+  {
+  }
+
+  /*!
+   * \brief Returns the error.
+   * \return The error.
+   **/
+  constexpr const error_type& error() const& noexcept
+  {
+    return m_error;
+  }
+
+  /*!
+   * \brief Returns the error.
+   * \return The error.
+   **/
+  error_type& error() & noexcept
+  {
+    return m_error;
+  }
+
+  /*!
+   * \brief Returns the error.
+   * \return The error.
+   **/
+  error_type&& error() && noexcept
+  {
+    return std::move(m_error);
+  }
+
+private:
+  error_type m_error; //!< the error.
+};
+
+/*!
+ * \brief Creates an unexpected from an error.
+ * \param error The error.
+ * \return The unexpected created.
+ **/
+template<typename Error>
+constexpr unexpected<typename std::decay<Error>::type>
+make_unexpected(Error&& error)
+{
+  return unexpected<typename std::decay<Error>::type>{
+    std::forward<Error>(error)};
+}
+
+/*!
+ * \brief Thrown by expected::value if the expected holds an error.
+ * \tparam Error The type of the error.
+ **/
+template<typename Error>
+class bad_expected_access : public std::exception {
+public:
+  using this_type  = bad_expected_access;
+  using error_type = Error;
+
+  /*!
+   * \brief Creates a bad_expected_access holding error.
+   * \param error The error.
+   **/
+  explicit bad_expected_access(error_type error)
+    : std::exception{}, m_error{std::move(error)}
+  {
+  }
+
+  /*!
+   * \brief Returns the error.
+   * \return The error held by the expected that was accessed.
+   **/
+  const error_type& error() const noexcept
+  {
+    return m_error;
+  }
+
+  const char* what() const noexcept override
+  {
+    return "pl::bad_expected_access: the expected held an error";
+  }
+
+private:
+  error_type m_error; //!< the error.
+};
+
+namespace detail {
+struct expected_value_tag {
+};
+
+struct expected_error_tag {
+};
+
+/*!
+ * \brief Storage of expected if both types are trivially copyable.
+ *        All special member functions are trivial.
+ **/
+template<
+  typename Ty,
+  typename Error,
+  bool IsTrivial = std::is_trivially_copyable<Ty>::value
+                   && std::is_trivially_copyable<Error>::value>
+class expected_storage {
+public:
+  template<typename... Args>
+  constexpr explicit expected_storage(expected_value_tag, Args&&... args)
+    : m_value(std::forward<Args>(args)...), m_has_value{true}
+  {
+  }
+
+  template<typename... Args>
+  constexpr explicit expected_storage(expected_error_tag, Args&&... args)
+    : m_error(std::forward<Args>(args)...), m_has_value{false}
+  {
+  }
+
+protected:
+  union {
+    Ty    m_value;
+    Error m_error;
+  };
+  bool m_has_value;
+};
+
+/*!
+ * \brief Storage of expected if Ty or Error is not trivially copyable.
+ **/
+template<typename Ty, typename Error>
+class expected_storage<Ty, Error, false> {
+public:
+  using this_type = expected_storage;
+
+  template<typename... Args>
+  explicit expected_storage(expected_value_tag, Args&&... args)
+    : m_value(std::forward<Args>(args)...), m_has_value{true}
+  {
+  }
+
+  template<typename... Args>
+  explicit expected_storage(expected_error_tag, Args&&... args)
+    : m_error(std::forward<Args>(args)...), m_has_value{false}
+  {
+  }
+
+  expected_storage(const this_type& other) : m_has_value{other.m_has_value}
+  {
+    if (m_has_value) {
+      ::new (static_cast<void*>(&m_value)) Ty(other.m_value);
+    }
+    else {
+      ::new (static_cast<void*>(&m_error)) Error(other.m_error);
+    }
+  }
+
+  expected_storage(this_type&& other) noexcept(
+    std::is_nothrow_move_constructible<Ty>::value
+    && std::is_nothrow_move_constructible<Error>::value)
+    : m_has_value{other.m_has_value}
+  {
+    if (m_has_value) {
+      ::new (static_cast<void*>(&m_value)) Ty(std::move(other.m_value));
+    }
+    else {
+      ::new (static_cast<void*>(&m_error)) Error(std::move(other.m_error));
+    }
+  }
+
+  /*!
+   * \note Only provides the basic exception guarantee if the move
+   *       constructor of Ty or Error may throw.
+   **/
+  this_type& operator=(const this_type& other)
+  {
+    if (this != &other) {
+      this_type copy{other};
+      *this = std::move(copy);
+    }
+
+    return *this;
+  }
+
+  this_type& operator=(this_type&& other) noexcept(
+    std::is_nothrow_move_constructible<Ty>::value
+    && std::is_nothrow_move_constructible<Error>::value)
+  {
+    if (this == &other) {
+      return *this;
+    }
+
+    if (m_has_value && other.m_has_value) {
+      m_value = std::move(other.m_value);
+    }
+    else if (!m_has_value && !other.m_has_value) {
+      m_error = std::move(other.m_error);
+    }
+    else {
+      destroy();
+      m_has_value = other.m_has_value;
+
+      if (m_has_value) {
+        ::new (static_cast<void*>(&m_value)) Ty(std::move(other.m_value));
+      }
+      else {
+        ::new (static_cast<void*>(&m_error)) Error(std::move(other.m_error));
+      }
+    }
+
+    return *this;
+  }
+
+  ~expected_storage()
+  {
+    destroy();
+  }
+
+protected:
+  void destroy() noexcept
+  {
+    if (m_has_value) {
+      m_value.~Ty();
+    }
+    else {
+      m_error.~Error();
+    }
+  }
+
+  union {
+    Ty    m_value;
+    Error m_error;
+  };
+  bool m_has_value;
+};
+} // namespace detail
+
+/*!
+ * \brief Holds either a value or an error.
+ * \tparam Ty The type of the value.
+ * \tparam Error The type of the error.
+ * \note Is trivially copyable if both Ty and Error are.
+ * \example pl::expected<int, std::errc> parse(pl::string_view s);
+ *
+ *          auto result = parse(text);
+ *          if (result) {
+ *            use(*result);
+ *          }
+ *          else {
+ *            report(result.error());
+ *          }
+ *
+ * Allows functions to report errors that are expected to occur frequently
+ * without the cost of throwing an exception.
+ **/
+template<typename Ty, typename Error>
+class expected : private detail::expected_storage<Ty, Error> {
+public:
+  using this_type  = expected;
+  using value_type = Ty;
+  using error_type = Error;
+
+private:
+  using base_type = detail::expected_storage<Ty, Error>;
+
+public:
+  /*!
+   * \brief Creates an expected holding a value initialized value.
+   **/
+  constexpr expected() : base_type{detail::expected_value_tag{}}
+  {
+  }
+
+  /*!
+   * \brief Creates an expected holding value.
+   * \param value The value.
+   **/
+  constexpr expected(PL_IN const value_type& value)
+    : base_type{detail::expected_value_tag{}, value}
+  {
+  }
+
+  /*!
+   * \brief Creates an expected holding value.
+   * \param value The value.
+   **/
+  constexpr expected(value_type&& value)
+    : base_type{detail::expected_value_tag{}, std::move(value)}
+  {
+  }
+
+  /*!
+   * \brief Creates an expected holding the error of unexpected.
+   * \param unexpected The error.
+   **/
+  template<typename OtherError>
+  constexpr expected(PL_IN const unexpected<OtherError>& unexpected)
+    : base_type{detail::expected_error_tag{}, unexpected.error()}
+  {
+  }
+
+  /*!
+   * \brief Creates an expected holding the error of unexpected.
+   * \param unexpected The error.
+   **/
+  template<typename OtherError>
+  constexpr expected(unexpected<OtherError>&& unexpected)
+    : base_type{detail::expected_error_tag{}, std::move(unexpected).error()}
+  {
+  }
+
+  /*!
+   * \brief Queries whether a value is held.
+   * \return true if a value is held; false if an error is held.
+   **/
+  PL_NODISCARD constexpr bool has_value() const noexcept
+  {
+    return this->m_has_value;
+  }
+
+  /*!
+   * \brief Queries whether a value is held.
+   * \return true if a value is held; false if an error is held.
+   **/
+  constexpr explicit operator bool() const noexcept
+  {
+    return this->m_has_value;
+  }
+
+  /*!
+   * \brief Returns the value.
+   * \return The value.
+   * \throws bad_expected_access<Error> if an error is held.
+   **/
+  value_type& value() &
+  {
+    check();
+    return this->m_value;
+  }
+
+  /*!
+   * \brief Returns the value.
+   * \return The value.
+   * \throws bad_expected_access<Error> if an error is held.
+   **/
+  const value_type& value() const&
+  {
+    check();
+    return this->m_value;
+  }
+
+  /*!
+   * \brief Returns the value.
+   * \return The value.
+   * \throws bad_expected_access<Error> if an error is held.
+   **/
+  value_type&& value() &&
+  {
+    check();
+    return std::move(this->m_value);
+  }
+
+  /*!
+   * \brief Returns the value.
+   * \return The value.
+   * \warning Undefined behavior if an error is held.
+   **/
+  value_type& operator*() & noexcept
+  {
+    return this->m_value;
+  }
+
+  /*!
+   * \brief Returns the value.
+   * \return The value.
+   * \warning Undefined behavior if an error is held.
+   **/
+  constexpr const value_type& operator*() const& noexcept
+  {
+    return this->m_value;
+  }
+
+  /*!
+   * \brief Returns the value.
+   * \return The value.
+   * \warning Undefined behavior if an error is held.
+   **/
+  value_type&& operator*() && noexcept
+  {
+    return std::move(this->m_value);
+  }
+
+  /*!
+   * \brief Accesses a member of the value.
+   * \return A pointer to the value.
+   * \warning Undefined behavior if an error is held.
+   **/
+  value_type* operator->() noexcept
+  {
+    return &this->m_value;
+  }
+
+  /*!
+   * \brief Accesses a member of the value.
+   * \return A pointer to the value.
+   * \warning Undefined behavior if an error is held.
+   **/
+  const value_type* operator->() const noexcept
+  {
+    return &this->m_value;
+  }
+
+  /*!
+   * \brief Returns the error.
+   * \return The error.
+   * \warning Undefined behavior if a value is held.
+   **/
+  error_type& error() & noexcept
+  {
+    return this->m_error;
+  }
+
+  /*!
+   * \brief Returns the error.
+   * \return The error.
+   * \warning Undefined behavior if a value is held.
+   **/
+  constexpr const error_type& error() const& noexcept
+  {
+    return this->m_error;
+  }
+
+  /*!
+   * \brief Returns the error.
+   * \return The error.
+   * \warning Undefined behavior if a value is held.
+   **/
+  error_type&& error() && noexcept
+  {
+    return std::move(this->m_error);
+  }
+
+  /*!
+   * \brief Returns the value if one is held or default_value otherwise.
+   * \param default_value The value to return if an error is held.
+   * \return The value or default_value.
+   **/
+  template<typename Other>
+  constexpr value_type value_or(Other&& default_value) const&
+  {
+    return this->m_has_value
+             ? this->m_value
+             : static_cast<value_type>(std::forward<Other>(default_value));
+  }
+
+  /*!
+   * \brief Returns the value if one is held or default_value otherwise.
+   * \param default_value The value to return if an error is held.
+   * \return The value or default_value.
+   **/
+  template<typename Other>
+  value_type value_or(Other&& default_value) &&
+  {
+    return this->m_has_value
+             ? std::move(this->m_value)
+             : static_cast<value_type>(std::forward<Other>(default_value));
+  }
+
+private:
+  void check() const
+  {
+    if (PL_UNLIKELY(!this->m_has_value)) {
+      throw bad_expected_access<error_type>{this->m_error};
+    }
+  }
+};
+} // namespace pl
+#endif // INCG_PL_EXPECTED_HPP
@@ -0,0 +1,715 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file hdr_histogram.hpp
+ * \brief Exports the hdr_histogram type, a high dynamic range histogram
+ *        to aggregate large amounts of recorded values such as latencies.
+ **/
+#ifndef INCG_PL_HDR_HISTOGRAM_HPP
+#define INCG_PL_HDR_HISTOGRAM_HPP
+#include "annotations.hpp" // PL_IN, PL_INOUT, PL_OUT, PL_NODISCARD, PL_UNLIKELY
+#include "assert.hpp"      // PL_CHECK_PRE
+#include "byte.hpp"        // pl::byte
+#include "compiler.hpp"    // PL_COMPILER, PL_COMPILER_GCC, PL_COMPILER_CLANG
+#include "expected.hpp"    // pl::expected, pl::make_unexpected
+#include <algorithm>       // std::min, std::max
+#include <cstddef>         // std::size_t
+#include <cstdint>         // std::uint32_t, std::uint64_t
+#include <limits>          // std::numeric_limits
+#include <system_error>    // std::errc
+#include <vector>          // std::vector
+
+namespace pl {
+namespace detail {
+/*!
+ * \brief The version written by hdr_histogram::serialize.
+ **/
+constexpr byte hdr_serialization_version{1U};
+
+/*!
+ * \brief Returns the number of bits needed to represent value.
+ * \param value The value.
+ * \return The index of the highest set bit plus one; 0 if value is 0.
+ **/
+inline std::uint32_t hdr_bit_width(std::uint64_t value) noexcept
+{
+#if (PL_COMPILER == PL_COMPILER_GCC) || (PL_COMPILER == PL_COMPILER_CLANG)
+  return value == 0U
+           ? 0U
+           : 64U - static_cast<std::uint32_t>(__builtin_clzll(value));
+#else
+  std::uint32_t width{0U};
+
+  while (value != 0U) {
+    ++width;
+    value >>= 1U;
+  }
+
+  return width;
+#endif
+}
+
+/*!
+ * \brief Appends value to buffer as an unsigned LEB128 varint.
+ **/
+inline void hdr_write_varint(
+  PL_INOUT std::vector<byte>& buffer,
+  std::uint64_t               value)
+{
+  while (value >= 0x80U) {
+    buffer.push_back(static_cast<byte>((value & 0x7FU) | 0x80U));
+    value >>= 7U;
+  }
+
+  buffer.push_back(static_cast<byte>(value));
+}
+
+/*!
+ * \brief Reads an unsigned LEB128 varint.
+ * \param it The position to read from, advanced past the varint.
+ * \param end The end of the buffer.
+ * \param value The value read.
+ * \return false if the varint is truncated or doesn't fit 64 bits.
+ **/
+inline bool hdr_read_varint(
+  PL_INOUT const byte*& it,
+  const byte*           end,
+  PL_OUT std::uint64_t& value) noexcept
+{
+  value = 0U;
+
+  for (std::uint32_t shift{0U}; (shift < 64U) && (it != end); shift += 7U) {
+    const byte current{*it};
+    ++it;
+
+    if ((shift == 63U) && ((current & 0x7EU) != 0U)) {
+      return false;
+    }
+
+    value |= static_cast<std::uint64_t>(current & 0x7FU) << shift;
+
+    if ((current & 0x80U) == 0U) {
+      return true;
+    }
+  }
+
+  return false;
+}
+} // namespace detail
+
+/*!
+ * \brief A high dynamic range histogram.
+ *
+ * Values are tracked with a fixed relative precision of
+ * significant_digits decimal digits across the whole range between the
+ * lowest discernible and the highest trackable value: the range is split
+ * into buckets covering powers of two, which are split linearly into sub
+ * buckets. Recording a value is therefore O(1) and the memory used only
+ * depends on the range and the precision, not on the amount of values
+ * recorded.
+ *
+ * The type is not thread-safe. Use one histogram per thread and merge them
+ * to query the combined results.
+ **/
+class hdr_histogram {
+public:
+  using this_type  = hdr_histogram;
+  using value_type = std::uint64_t;
+  using count_type = std::uint64_t;
+
+  /*!
+   * \brief Creates an empty histogram with a lowest discernible value of 1.
+   * \param highest_trackable_value The highest value to be tracked,
+   *                                must be at least 2.
+   * \param significant_digits The amount of significant decimal digits to
+   *                           maintain, must be in the range [1,5].
+   * \throws pl::precondition_violation_exception if the parameters are
+   *         invalid.
+   **/
+  hdr_histogram(
+    value_type    highest_trackable_value,
+    std::uint32_t significant_digits)
+    : hdr_histogram{1U, highest_trackable_value, significant_digits}
+  {
+  }
+
+  /*!
+   * \brief Creates an empty histogram.
+   * \param lowest_discernible_value The smallest value that can be told
+   *                                 apart from 0, must be at least 1.
+   * \param highest_trackable_value The highest value to be tracked,
+   *                                must be at least twice
+   *                                lowest_discernible_value.
+   * \param significant_digits The amount of significant decimal digits to
+   *                           maintain, must be in the range [1,5].
+   * \throws pl::precondition_violation_exception if the parameters are
+   *         invalid.
+   **/
+  hdr_histogram(
+    value_type    lowest_discernible_value,
+    value_type    highest_trackable_value,
+    std::uint32_t significant_digits)
+    : m_lowest_discernible_value{lowest_discernible_value}
+    , m_highest_trackable_value{highest_trackable_value}
+    , m_significant_digits{significant_digits}
+    , m_unit_magnitude{0U}
+    , m_sub_bucket_half_count_magnitude{0U}
+    , m_sub_bucket_half_count{0U}
+    , m_sub_bucket_mask{0U}
+    , m_counts{}
+    , m_total_count{0U}
+    , m_min{(std::numeric_limits<value_type>::max)()}
+    , m_max{0U}
+  {
+    PL_CHECK_PRE(is_valid_configuration(
+      lowest_discernible_value, highest_trackable_value, significant_digits));
+
+    m_unit_magnitude = detail::hdr_bit_width(lowest_discernible_value) - 1U;
+    m_sub_bucket_half_count_magnitude
+      = sub_bucket_count_magnitude_for(significant_digits) - 1U;
+    m_sub_bucket_half_count = value_type{1U}
+                              << m_sub_bucket_half_count_magnitude;
+    m_sub_bucket_mask = (m_sub_bucket_half_count * 2U - 1U)
+                        << m_unit_magnitude;
+
+    // The first bucket covers all the values below sub_bucket_count units,
+    // every further bucket doubles the range covered.
+    value_type smallest_untrackable_value{
+      (m_sub_bucket_half_count * 2U) << m_unit_magnitude};
+    std::size_t bucket_count{1U};
+
+    while (smallest_untrackable_value <= highest_trackable_value) {
+      ++bucket_count;
+
+      if (
+        smallest_untrackable_value
+        > (std::numeric_limits<value_type>::max)() / 2U) {
+        break;
+      }
+
+      smallest_untrackable_value <<= 1U;
+    }
+
+    m_counts.resize(
+      (bucket_count + 1U) * static_cast<std::size_t>(m_sub_bucket_half_count));
+  }
+
+  /*!
+   * \brief Checks whether the parameters given can be used to create a
+   *        histogram.
+   * \param lowest_discernible_value The smallest value that can be told
+   *                                 apart from 0.
+   * \param highest_trackable_value The highest value to be tracked.
+   * \param significant_digits The amount of significant decimal digits.
+   * \return true if the parameters are valid; otherwise false.
+   **/
+  PL_NODISCARD static bool is_valid_configuration(
+    value_type    lowest_discernible_value,
+    value_type    highest_trackable_value,
+    std::uint32_t significant_digits) noexcept
+  {
+    if (
+      (lowest_discernible_value < 1U) || (significant_digits < 1U)
+      || (significant_digits > 5U)
+      || ((highest_trackable_value / 2U) < lowest_discernible_value)) {
+      return false;
+    }
+
+    // Keeps the shifts done when indexing within 64 bits.
+    return (detail::hdr_bit_width(lowest_discernible_value) - 1U)
+             + sub_bucket_count_magnitude_for(significant_digits)
+           <= 62U;
+  }
+
+  /*!
+   * \brief Records a value.
+   * \param value The value to record.
+   * \param count The amount of times to record value.
+   * \return true if value was recorded; false if it is beyond the highest
+   *         trackable value.
+   **/
+  bool record(value_type value, count_type count = 1U) noexcept
+  {
+    const std::size_t index{counts_index_for(value)};
+
+    if (PL_UNLIKELY(index >= m_counts.size())) {
+      return false;
+    }
+
+    m_counts[index] += count;
+    m_total_count += count;
+    m_min = (std::min)(m_min, value);
+    m_max = (std::max)(m_max, value);
+    return true;
+  }
+
+  /*!
+   * \brief Adds all the values recorded in other to this histogram.
+   * \param other The histogram to merge into this one, may use a different
+   *              range or precision.
+   * \return false if some values recorded in other are beyond the highest
+   *         trackable value of this histogram; those are not merged.
+   * \note Merging histograms that were created with the same parameters
+   *       adds up the counts and is lossless.
+   **/
+  bool merge(PL_IN const hdr_histogram& other) noexcept
+  {
+    if (other.m_total_count == 0U) {
+      return true;
+    }
+
+    if (
+      (m_lowest_discernible_value == other.m_lowest_discernible_value)
+      && (m_highest_trackable_value == other.m_highest_trackable_value)
+      && (m_significant_digits == other.m_significant_digits)) {
+      for (std::size_t i{0U}; i < m_counts.size(); ++i) {
+        m_counts[i] += other.m_counts[i];
+      }
+
+      m_total_count += other.m_total_count;
+      m_min = (std::min)(m_min, other.m_min);
+      m_max = (std::max)(m_max, other.m_max);
+      return true;
+    }
+
+    bool all_recorded{true};
+
+    for (std::size_t i{0U}; i < other.m_counts.size(); ++i) {
+      if (other.m_counts[i] == 0U) {
+        continue;
+      }
+
+      // Clamping keeps the smallest value recorded in other exact.
+      const value_type value{(std::max)(
+        other.m_min, (std::min)(other.value_at_index(i), other.m_max))};
+
+      if (!record(value, other.m_counts[i])) {
+        all_recorded = false;
+      }
+    }
+
+    if (counts_index_for(other.m_max) < m_counts.size()) {
+      m_max = (std::max)(m_max, other.m_max);
+    }
+
+    return all_recorded;
+  }
+
+  /*!
+   * \brief Removes all the values recorded.
+   **/
+  void reset() noexcept
+  {
+    for (count_type& count : m_counts) {
+      count = 0U;
+    }
+
+    m_total_count = 0U;
+    m_min         = (std::numeric_limits<value_type>::max)();
+    m_max         = 0U;
+  }
+
+  /*!
+   * \brief Returns the value at the given percentile.
+   * \param percentile The percentile, clamped to [0,100].
+   *                   For instance 99.9 for the p999.
+   * \return The highest value equivalent to the value at percentile, but no
+   *         larger than max(); 0 if the histogram is empty.
+   **/
+  PL_NODISCARD value_type value_at_percentile(double percentile) const noexcept
+  {
+    if (m_total_count == 0U) {
+      return 0U;
+    }
+
+    const double     requested{(std::min)((std::max)(percentile, 0.0), 100.0)};
+    const count_type wanted_count{(std::max)(
+      static_cast<count_type>(
+        (requested / 100.0) * static_cast<double>(m_total_count) + 0.5),
+      count_type{1U})};
+    count_type running_count{0U};
+
+    for (std::size_t i{0U}; i < m_counts.size(); ++i) {
+      running_count += m_counts[i];
+
+      if (running_count >= wanted_count) {
+        return (std::min)(highest_equivalent_value(value_at_index(i)), m_max);
+      }
+    }
+
+    return m_max;
+  }
+
+  /*!
+   * \brief Returns the smallest value recorded.
+   * \return The smallest value recorded; 0 if the histogram is empty.
+   **/
+  PL_NODISCARD value_type min() const noexcept
+  {
+    return m_total_count == 0U ? 0U : m_min;
+  }
+
+  /*!
+   * \brief Returns the largest value recorded.
+   * \return The largest value recorded; 0 if the histogram is empty.
+   **/
+  PL_NODISCARD value_type max() const noexcept
+  {
+    return m_max;
+  }
+
+  /*!
+   * \brief Returns the arithmetic mean of the values recorded.
+   * \return The mean, using the median equivalent value of each sub bucket;
+   *         0 if the histogram is empty.
+   **/
+  PL_NODISCARD double mean() const noexcept
+  {
+    if (m_total_count == 0U) {
+      return 0.0;
+    }
+
+    double sum{0.0};
+
+    for (std::size_t i{0U}; i < m_counts.size(); ++i) {
+      if (m_counts[i] != 0U) {
+        sum += static_cast<double>(median_equivalent_value(value_at_index(i)))
+               * static_cast<double>(m_counts[i]);
+      }
+    }
+
+    return sum / static_cast<double>(m_total_count);
+  }
+
+  /*!
+   * \brief Returns the amount of values recorded.
+   * \return The amount of values recorded.
+   **/
+  PL_NODISCARD count_type total_count() const noexcept
+  {
+    return m_total_count;
+  }
+
+  /*!
+   * \brief Returns how often values equivalent to value were recorded.
+   * \param value The value to look up.
+   * \return The count of the sub bucket of value; 0 if value is beyond the
+   *         highest trackable value.
+   **/
+  PL_NODISCARD count_type count_at_value(value_type value) const noexcept
+  {
+    const std::size_t index{counts_index_for(value)};
+    return index < m_counts.size() ? m_counts[index] : 0U;
+  }
+
+  /*!
+   * \brief Returns the size of the range of values equivalent to value.
+   * \param value The value.
+   * \return The amount of values sharing a sub bucket with value.
+   **/
+  PL_NODISCARD value_type
+  size_of_equivalent_value_range(value_type value) const noexcept
+  {
+    const std::uint32_t bucket{bucket_index(value)};
+    const value_type    sub_bucket{sub_bucket_index(value, bucket)};
+    const std::uint32_t adjusted_bucket{
+      sub_bucket >= m_sub_bucket_half_count * 2U ? bucket + 1U : bucket};
+    return value_type{1U} << (m_unit_magnitude + adjusted_bucket);
+  }
+
+  /*!
+   * \brief Returns the smallest value equivalent to value.
+   * \param value The value.
+   * \return The lowest value sharing a sub bucket with value.
+   **/
+  PL_NODISCARD value_type
+  lowest_equivalent_value(value_type value) const noexcept
+  {
+    const std::uint32_t bucket{bucket_index(value)};
+    return value_from_index(bucket, sub_bucket_index(value, bucket));
+  }
+
+  /*!
+   * \brief Returns the largest value equivalent to value.
+   * \param value The value.
+   * \return The highest value sharing a sub bucket with value.
+   **/
+  PL_NODISCARD value_type
+  highest_equivalent_value(value_type value) const noexcept
+  {
+    return lowest_equivalent_value(value)
+           + size_of_equivalent_value_range(value) - 1U;
+  }
+
+  /*!
+   * \brief Returns the value in the middle of the values equivalent to
+   *        value.
+   * \param value The value.
+   * \return The median of the values sharing a sub bucket with value.
+   **/
+  PL_NODISCARD value_type
+  median_equivalent_value(value_type value) const noexcept
+  {
+    return lowest_equivalent_value(value)
+           + size_of_equivalent_value_range(value) / 2U;
+  }
+
+  /*!
+   * \brief Returns the lowest discernible value.
+   * \return The lowest discernible value.
+   **/
+  PL_NODISCARD value_type lowest_discernible_value() const noexcept
+  {
+    return m_lowest_discernible_value;
+  }
+
+  /*!
+   * \brief Returns the highest trackable value.
+   * \return The highest trackable value.
+   **/
+  PL_NODISCARD value_type highest_trackable_value() const noexcept
+  {
+    return m_highest_trackable_value;
+  }
+
+  /*!
+   * \brief Returns the amount of significant decimal digits.
+   * \return The amount of significant decimal digits.
+   **/
+  PL_NODISCARD std::uint32_t significant_digits() const noexcept
+  {
+    return m_significant_digits;
+  }
+
+  /*!
+   * \brief Encodes the histogram in a compact binary form.
+   * \return The encoded histogram.
+   * \throws std::bad_alloc if the buffer couldn't be allocated.
+   *
+   * The encoding starts with a version byte, followed by the parameters,
+   * min() and max() as LEB128 varints. The counts follow as varints, where
+   * a count c is stored as c << 1 and a run of n empty sub buckets as
+   * (n << 1) | 1, so that sparse histograms stay small. Trailing empty sub
+   * buckets are omitted.
+   **/
+  PL_NODISCARD std::vector<byte> serialize() const
+  {
+    std::vector<byte> buffer{};
+    buffer.push_back(detail::hdr_serialization_version);
+    detail::hdr_write_varint(buffer, m_lowest_discernible_value);
+    detail::hdr_write_varint(buffer, m_highest_trackable_value);
+    detail::hdr_write_varint(buffer, m_significant_digits);
+    detail::hdr_write_varint(buffer, min());
+    detail::hdr_write_varint(buffer, m_max);
+
+    std::uint64_t empty_run{0U};
+
+    for (const count_type count : m_counts) {
+      if (count == 0U) {
+        ++empty_run;
+        continue;
+      }
+
+      if (empty_run != 0U) {
+        detail::hdr_write_varint(buffer, (empty_run << 1U) | 1U);
+        empty_run = 0U;
+      }
+
+      detail::hdr_write_varint(buffer, count << 1U);
+    }
+
+    return buffer;
+  }
+
+  /*!
+   * \brief Decodes a histogram encoded with serialize.
+   * \param data The encoded histogram.
+   * \param size The size of data in bytes.
+   * \return The histogram or std::errc::invalid_argument if data is
+   *         malformed.
+   * \throws std::bad_alloc if the histogram couldn't be allocated.
+   **/
+  PL_NODISCARD static expected<hdr_histogram, std::errc>
+  deserialize(PL_IN const void* data, std::size_t size)
+  {
+    const byte*       it{static_cast<const byte*>(data)};
+    const byte* const end{it + size};
+    std::uint64_t     lowest_discernible_value{0U};
+    std::uint64_t     highest_trackable_value{0U};
+    std::uint64_t     significant_digits{0U};
+    std::uint64_t     min_value{0U};
+    std::uint64_t     max_value{0U};
+
+    if (PL_UNLIKELY(
+          (size == 0U) || (*it++ != detail::hdr_serialization_version)
+          || !detail::hdr_read_varint(it, end, lowest_discernible_value)
+          || !detail::hdr_read_varint(it, end, highest_trackable_value)
+          || !detail::hdr_read_varint(it, end, significant_digits)
+          || !detail::hdr_read_varint(it, end, min_value)
+          || !detail::hdr_read_varint(it, end, max_value)
+          || (significant_digits > 5U)
+          || !is_valid_configuration(
+            lowest_discernible_value,
+            highest_trackable_value,
+            static_cast<std::uint32_t>(significant_digits)))) {
+      return make_unexpected(std::errc::invalid_argument);
+    }
+
+    hdr_histogram histogram{
+      lowest_discernible_value,
+      highest_trackable_value,
+      static_cast<std::uint32_t>(significant_digits)};
+    std::size_t index{0U};
+
+    while (it != end) {
+      std::uint64_t entry{0U};
+
+      if (PL_UNLIKELY(!detail::hdr_read_varint(it, end, entry))) {
+        return make_unexpected(std::errc::invalid_argument);
+      }
+
+      const std::uint64_t amount{entry >> 1U};
+      const std::size_t   remaining{histogram.m_counts.size() - index};
+
+      if ((entry & 1U) != 0U) {
+        if (PL_UNLIKELY(amount > remaining)) {
+          return make_unexpected(std::errc::invalid_argument);
+        }
+
+        index += static_cast<std::size_t>(amount);
+        continue;
+      }
+
+      if (PL_UNLIKELY(remaining == 0U)) {
+        return make_unexpected(std::errc::invalid_argument);
+      }
+
+      histogram.m_counts[index] = amount;
+      histogram.m_total_count += amount;
+      ++index;
+    }
+
+    if (histogram.m_total_count != 0U) {
+      if (PL_UNLIKELY(
+            (min_value > max_value)
+            || (histogram.counts_index_for(max_value)
+                >= histogram.m_counts.size()))) {
+        return make_unexpected(std::errc::invalid_argument);
+      }
+
+      histogram.m_min = min_value;
+      histogram.m_max = max_value;
+    }
+
+    return histogram;
+  }
+
+private:
+  /*!
+   * \brief Returns log2 of the amount of sub buckets per bucket, which is
+   *        the smallest power of two that tells 2 * 10^significant_digits
+   *        values apart.
+   **/
+  static std::uint32_t sub_bucket_count_magnitude_for(
+    std::uint32_t significant_digits) noexcept
+  {
+    value_type largest_value_with_single_unit_resolution{2U};
+
+    for (std::uint32_t i{0U}; i < significant_digits; ++i) {
+      largest_value_with_single_unit_resolution *= 10U;
+    }
+
+    return detail::hdr_bit_width(
+      largest_value_with_single_unit_resolution - 1U);
+  }
+
+  std::uint32_t bucket_index(value_type value) const noexcept
+  {
+    return detail::hdr_bit_width(value | m_sub_bucket_mask) - m_unit_magnitude
+           - (m_sub_bucket_half_count_magnitude + 1U);
+  }
+
+  value_type sub_bucket_index(value_type value, std::uint32_t bucket) const
+    noexcept
+  {
+    return value >> (bucket + m_unit_magnitude);
+  }
+
+  value_type value_from_index(std::uint32_t bucket, value_type sub_bucket) const
+    noexcept
+  {
+    return sub_bucket << (bucket + m_unit_magnitude);
+  }
+
+  /*!
+   * \brief Returns the index of the sub bucket of value in m_counts.
+   **/
+  std::size_t counts_index_for(value_type value) const noexcept
+  {
+    const std::uint32_t bucket{bucket_index(value)};
+    const value_type    sub_bucket{sub_bucket_index(value, bucket)};
+
+    // Only the first bucket uses the lower half of its sub buckets, as the
+    // lower half of the others would overlap with the previous bucket.
+    return static_cast<std::size_t>(
+      ((value_type{bucket} + 1U) << m_sub_bucket_half_count_magnitude)
+      + sub_bucket - m_sub_bucket_half_count);
+  }
+
+  /*!
+   * \brief Returns the lowest value of the sub bucket at index in m_counts.
+   **/
+  value_type value_at_index(std::size_t index) const noexcept
+  {
+    const value_type bucket_plus_one{
+      static_cast<value_type>(index) >> m_sub_bucket_half_count_magnitude};
+    const value_type sub_bucket{
+      (static_cast<value_type>(index) & (m_sub_bucket_half_count - 1U))
+      + m_sub_bucket_half_count};
+
+    if (bucket_plus_one == 0U) {
+      return value_from_index(0U, sub_bucket - m_sub_bucket_half_count);
+    }
+
+    return value_from_index(
+      static_cast<std::uint32_t>(bucket_plus_one - 1U), sub_bucket);
+  }
+
+  value_type    m_lowest_discernible_value;
+  value_type    m_highest_trackable_value;
+  std::uint32_t m_significant_digits;
+  std::uint32_t m_unit_magnitude; //!< log2 of the lowest discernible value.
+  std::uint32_t m_sub_bucket_half_count_magnitude;
+  value_type    m_sub_bucket_half_count;
+  value_type    m_sub_bucket_mask; //!< the values within the first bucket.
+  std::vector<count_type> m_counts; //!< the counts of the sub buckets.
+  count_type              m_total_count;
+  value_type              m_min;
+  value_type              m_max;
+};
+} // namespace pl
+#endif // INCG_PL_HDR_HISTOGRAM_HPP
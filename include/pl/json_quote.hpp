@@ -0,0 +1,73 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file json_quote.hpp
+ * \brief Exports the json_quote function.
+ **/
+#ifndef INCG_PL_JSON_QUOTE_HPP
+#define INCG_PL_JSON_QUOTE_HPP
+#include "string_view.hpp" // pl::string_view
+#include <string>          // std::string
+
+namespace pl {
+/*!
+ * \brief Turns a string into a JSON string literal.
+ * \param string The string to quote.
+ * \return string in double quotes with quotes, backslashes and control
+ *         characters escaped.
+ * \throws std::bad_alloc if memory could not be allocated.
+ * \note Bytes of 0x80 and above are copied as is, so UTF-8 stays valid.
+ **/
+inline std::string json_quote(string_view string)
+{
+  static constexpr char hexits[]{"0123456789abcdef"};
+  std::string           result{};
+  result.reserve(string.size() + 2U);
+  result += '"';
+
+  for (const char c : string) {
+    const unsigned char uc{static_cast<unsigned char>(c)};
+
+    if ((c == '"') || (c == '\\')) {
+      result += '\\';
+      result += c;
+    }
+    else if (uc < 0x20U) {
+      result += "\\u00";
+      result += hexits[uc >> 4U];
+      result += hexits[uc & 0xFU];
+    }
+    else {
+      result += c;
+    }
+  }
+
+  result += '"';
+  return result;
+}
+} // namespace pl
+#endif // INCG_PL_JSON_QUOTE_HPP
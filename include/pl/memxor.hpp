@@ -30,12 +30,57 @@
  **/
 #ifndef INCG_PL_MEMXOR_HPP
 #define INCG_PL_MEMXOR_HPP
-#include "annotations.hpp" // PL_IN, PL_INOUT
-#include "byte.hpp"        // pl::Byte
-#include "restrict.hpp"    // PL_RESTRICT
-#include <cstddef>         // std::size_t
+#include "annotations.hpp"  // PL_IN, PL_INOUT
+#include "byte.hpp"         // pl::Byte
+#include "cpu_features.hpp" // pl::select_kernel, PL_TARGET, PL_CPU_X86
+#include "restrict.hpp"     // PL_RESTRICT
+#include <cstddef>          // std::size_t
+#if PL_CPU_X86
+#include <immintrin.h> // _mm256_loadu_si256, _mm256_xor_si256
+#endif                 // PL_CPU_X86
 
 namespace pl {
+namespace detail {
+inline void memxor_generic(
+  PL_INOUT byte* PL_RESTRICT dest,
+  PL_IN const byte* PL_RESTRICT src,
+  std::size_t                   byte_count) noexcept
+{
+  while (byte_count > 0) {
+    *dest ^= *src;
+
+    --byte_count;
+    ++dest;
+    ++src;
+  }
+}
+
+#if PL_CPU_X86
+PL_TARGET("avx2")
+inline void memxor_avx2(
+  PL_INOUT byte* PL_RESTRICT dest,
+  PL_IN const byte* PL_RESTRICT src,
+  std::size_t                   byte_count) noexcept
+{
+  static constexpr std::size_t block_size{sizeof(__m256i)};
+
+  while (byte_count >= block_size) {
+    const __m256i d{
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dest))};
+    const __m256i s{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src))};
+    _mm256_storeu_si256(
+      reinterpret_cast<__m256i*>(dest), _mm256_xor_si256(d, s));
+
+    byte_count -= block_size;
+    dest += block_size;
+    src += block_size;
+  }
+
+  memxor_generic(dest, src, byte_count);
+}
+#endif // PL_CPU_X86
+} // namespace detail
+
 /*!
  * \brief Bytewise xor-assigns the memory pointed to by 'destination'
  *        with the memory pointed to by 'source'.
@@ -49,22 +94,25 @@ namespace pl {
  *                  byte size for 'destination' and 'source'.
  * \return 'destination' is returned.
  * \warning Make sure 'byte_count' is correct!
+ * \note Uses AVX2 if the CPU supports it.
  **/
 inline void* memxor(
   PL_INOUT void* PL_RESTRICT    destination,
   PL_IN const void* PL_RESTRICT source,
   std::size_t                   byte_count) noexcept
 {
-  auto dest = static_cast<byte * PL_RESTRICT>(destination);
-  auto src  = static_cast<const byte * PL_RESTRICT>(source);
+  using kernel_type = void (*)(byte*, const byte*, std::size_t);
 
-  while (byte_count > 0) {
-    *dest ^= *src;
+  static const kernel_type impl{select_kernel<kernel_type>({
+#if PL_CPU_X86
+    {cpu_feature::avx2, &detail::memxor_avx2},
+#endif // PL_CPU_X86
+    {cpu_feature::none, &detail::memxor_generic}})};
 
-    --byte_count;
-    ++dest;
-    ++src;
-  }
+  impl(
+    static_cast<byte*>(destination),
+    static_cast<const byte*>(source),
+    byte_count);
 
   return destination;
 }
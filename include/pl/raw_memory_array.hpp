@@ -31,13 +31,16 @@
 #ifndef INCG_PL_RAW_MEMORY_ARRAY_HPP
 #define INCG_PL_RAW_MEMORY_ARRAY_HPP
 #include "algo/destroy.hpp" // pl::algo::destroy
-#include "annotations.hpp"  // PL_NODISCARD, PL_OUT, PL_IN
+#include "annotations.hpp"  // PL_NODISCARD, PL_OUT, PL_IN, PL_UNLIKELY
 #include "assert.hpp"       // PL_DBG_CHECK_PRE
+#include "expected.hpp"     // pl::expected, pl::make_unexpected
 #include <algorithm> // std::fill, std::equal, std::lexicographical_compare
-#include <cstddef>   // std::size_t, std::ptrdiff_t
-#include <iterator>  // std::reverse_iterator
-#include <memory>    // std::uninitialized_fill
-#include <stdexcept> // std::out_of_range
+#include <cstddef>          // std::size_t, std::ptrdiff_t
+#include <functional>       // std::reference_wrapper, std::ref, std::cref
+#include <iterator>         // std::reverse_iterator
+#include <memory>           // std::uninitialized_fill
+#include <stdexcept>        // std::out_of_range
+#include <system_error>     // std::errc
 
 namespace pl {
 /*!
@@ -125,7 +128,7 @@ public:
    **/
   PL_NODISCARD reference at(size_type pos)
   {
-    if (!(pos < size())) {
+    if (PL_UNLIKELY(!(pos < size()))) {
       throw std::out_of_range{
         "pos in pl::raw_memory_array::at was out of bounds!"};
     }
@@ -147,6 +150,44 @@ public:
     return const_cast<this_type*>(this)->at(pos);
   }
 
+  /*!
+   * \brief Returns a reference to the element at specified location
+   *        'pos', with bounds checking, without throwing.
+   * \param pos Position of the element to return.
+   * \return Reference to the requested element or
+   *         std::errc::result_out_of_range if 'pos' is not within the range
+   *         of the raw_memory_array.
+   * \note Constant complexity.
+   **/
+  PL_NODISCARD expected<std::reference_wrapper<value_type>, std::errc>
+  try_at(size_type pos) noexcept
+  {
+    if (PL_UNLIKELY(!(pos < size()))) {
+      return make_unexpected(std::errc::result_out_of_range);
+    }
+
+    return std::ref((*this)[pos]);
+  }
+
+  /*!
+   * \brief Returns a reference to the element at specified location
+   *        'pos', with bounds checking, without throwing.
+   * \param pos Position of the element to return.
+   * \return Reference to the requested element or
+   *         std::errc::result_out_of_range if 'pos' is not within the range
+   *         of the raw_memory_array.
+   * \note Constant complexity.
+   **/
+  PL_NODISCARD expected<std::reference_wrapper<const value_type>, std::errc>
+  try_at(size_type pos) const noexcept
+  {
+    if (PL_UNLIKELY(!(pos < size()))) {
+      return make_unexpected(std::errc::result_out_of_range);
+    }
+
+    return std::cref((*this)[pos]);
+  }
+
   /*!
    * \brief Returns a reference to the element at specified location 'pos'.
    *        No bounds checking is performed!
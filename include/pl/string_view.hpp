@@ -30,7 +30,7 @@
  **/
 #ifndef INCG_PL_STRING_VIEW_HPP
 #define INCG_PL_STRING_VIEW_HPP
-#include "annotations.hpp" // PL_NODISCARD, PL_IN, PL_OUT, PL_INOUT, PL_NULL_TERMINATED, PL_IMPLICIT
+#include "annotations.hpp" // PL_NODISCARD, PL_IN, PL_OUT, PL_INOUT, PL_NULL_TERMINATED, PL_IMPLICIT, PL_UNLIKELY
 #include "compiler.hpp" // PL_COMPILER, PL_COMPILER_MSVC, PL_COMPILER_VERSION, PL_COMPILER_VERSION_CHECK
 #include "hash.hpp"                  // pl::detail::add_hash
 #include "meta/remove_cvref.hpp"     // pl::meta::remove_cvref_t
@@ -354,7 +354,7 @@ public:
    **/
   constexpr const_reference at(size_type position) const
   {
-    if (position > size()) {
+    if (PL_UNLIKELY(position > size())) {
       throw std::out_of_range{
         "basic_string_view::at position was out of bounds."};
     }
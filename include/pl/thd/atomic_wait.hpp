@@ -0,0 +1,244 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file atomic_wait.hpp
+ * \brief Exports functions to block on an atomic 32 bit integer until its
+ *        value changes and to wake threads blocked on it.
+ **/
+#ifndef INCG_PL_THD_ATOMIC_WAIT_HPP
+#define INCG_PL_THD_ATOMIC_WAIT_HPP
+#include "../annotations.hpp" // PL_IN, PL_INOUT
+#include "../compiler.hpp"    // PL_COMPILER, PL_COMPILER_MSVC
+#include "../os.hpp"          // PL_OS, PL_OS_LINUX, PL_OS_ANDROID
+#include <atomic>             // std::atomic
+#include <cstdint>            // std::uint32_t, std::uintptr_t
+#include <thread>             // std::this_thread::yield
+#if (PL_COMPILER == PL_COMPILER_MSVC) \
+  && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h> // _mm_pause
+#endif
+#if (PL_OS == PL_OS_LINUX) || (PL_OS == PL_OS_ANDROID)
+#include <linux/futex.h> // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+#include <sys/syscall.h> // SYS_futex
+#include <unistd.h>      // syscall
+#include <climits>       // INT_MAX
+#define PL_DETAIL_THD_HAS_FUTEX 1
+#elif defined(__cpp_lib_atomic_wait)
+#define PL_DETAIL_THD_HAS_STD_ATOMIC_WAIT 1
+#else
+#include <array>              // std::array
+#include <condition_variable> // std::condition_variable
+#include <cstddef>            // std::size_t
+#include <mutex>              // std::mutex, std::unique_lock
+#endif
+
+namespace pl {
+namespace thd {
+namespace detail {
+#if !defined(PL_DETAIL_THD_HAS_FUTEX) \
+  && !defined(PL_DETAIL_THD_HAS_STD_ATOMIC_WAIT)
+/*!
+ * \brief A mutex and a condition variable, used as the fallback
+ *        implementation on platforms without futexes.
+ **/
+struct wait_bucket {
+  std::mutex              mutex;
+  std::condition_variable cv;
+};
+
+/*!
+ * \brief Maps the address of an atomic object to one of a fixed set of
+ *        wait_buckets. Multiple atomic objects may share a bucket.
+ **/
+inline wait_bucket& get_wait_bucket(PL_IN const void* address) noexcept
+{
+  static constexpr std::size_t                  bucket_count{16U};
+  static std::array<wait_bucket, bucket_count> buckets{};
+
+  // the low bits are mostly zero due to alignment.
+  const std::uintptr_t value{reinterpret_cast<std::uintptr_t>(address) >> 4U};
+  return buckets[value % bucket_count];
+}
+#endif
+
+/*!
+ * \brief Hints to the processor that the calling thread is spinning.
+ **/
+inline void cpu_relax() noexcept
+{
+#if (PL_COMPILER == PL_COMPILER_MSVC) \
+  && (defined(_M_X64) || defined(_M_IX86))
+  _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+/*!
+ * \brief Spins for a short while until predicate returns true.
+ * \param predicate Nullary callable to poll.
+ * \return true if predicate returned true; false if the calling thread
+ *         should block instead.
+ *
+ * Polls with pause instructions first and then yields the processor, so
+ * that short waits don't pay for the system calls to block and wake up.
+ **/
+template<typename Predicate>
+bool spin_until(Predicate predicate)
+{
+  static constexpr int pause_iterations{64};
+  static constexpr int yield_iterations{8};
+
+  for (int i{0}; i < pause_iterations; ++i) {
+    if (predicate()) {
+      return true;
+    }
+
+    cpu_relax();
+  }
+
+  for (int i{0}; i < yield_iterations; ++i) {
+    if (predicate()) {
+      return true;
+    }
+
+    std::this_thread::yield();
+  }
+
+  return predicate();
+}
+
+#if defined(PL_DETAIL_THD_HAS_FUTEX)
+/*!
+ * \brief Issues a futex system call on object.
+ **/
+inline long futex(
+  PL_IN const std::atomic<std::uint32_t>& object,
+  int                                     operation,
+  std::uint32_t                           value) noexcept
+{
+  static_assert(
+    sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+    "std::atomic<std::uint32_t> must be usable as a futex word.");
+
+  return ::syscall(
+    SYS_futex,
+    static_cast<const volatile void*>(&object),
+    operation,
+    value,
+    nullptr,
+    nullptr,
+    0);
+}
+#endif
+} // namespace detail
+
+/*!
+ * \brief Blocks the calling thread while the value of object is equal to
+ *        old.
+ * \param object The atomic object to wait on.
+ * \param old The value to wait to be replaced.
+ * \note Returns immediately if object does not hold old.
+ *       Threads blocked in atomic_wait are only woken up by a call to
+ *       atomic_notify_one or atomic_notify_all, so a thread that modifies
+ *       object must call one of these afterwards.
+ *
+ * Uses the futex system call on Linux, std::atomic::wait if the standard
+ * library offers it and a table of condition variables otherwise.
+ **/
+inline void atomic_wait(
+  PL_IN const std::atomic<std::uint32_t>& object,
+  std::uint32_t                           old) noexcept
+{
+#if defined(PL_DETAIL_THD_HAS_FUTEX)
+  while (object.load(std::memory_order_acquire) == old) {
+    // the kernel rechecks the value, so no wake up can be missed.
+    detail::futex(object, FUTEX_WAIT_PRIVATE, old);
+  }
+#elif defined(PL_DETAIL_THD_HAS_STD_ATOMIC_WAIT)
+  object.wait(old, std::memory_order_acquire);
+#else
+  detail::wait_bucket&         bucket{detail::get_wait_bucket(&object)};
+  std::unique_lock<std::mutex> lock{bucket.mutex};
+
+  while (object.load(std::memory_order_acquire) == old) {
+    bucket.cv.wait(lock);
+  }
+#endif
+}
+
+/*!
+ * \brief Wakes up at least one of the threads blocked in atomic_wait
+ *        on object.
+ * \param object The atomic object whose waiters to wake up.
+ **/
+inline void atomic_notify_one(
+  PL_INOUT std::atomic<std::uint32_t>& object) noexcept
+{
+#if defined(PL_DETAIL_THD_HAS_FUTEX)
+  detail::futex(object, FUTEX_WAKE_PRIVATE, 1U);
+#elif defined(PL_DETAIL_THD_HAS_STD_ATOMIC_WAIT)
+  object.notify_one();
+#else
+  detail::wait_bucket& bucket{detail::get_wait_bucket(&object)};
+  {
+    // makes sure a waiter is either not yet checking the value or
+    // already blocked on the condition variable.
+    std::lock_guard<std::mutex> lock{bucket.mutex};
+    (void)lock;
+  }
+  // the bucket may be shared with other atomic objects.
+  bucket.cv.notify_all();
+#endif
+}
+
+/*!
+ * \brief Wakes up all the threads blocked in atomic_wait on object.
+ * \param object The atomic object whose waiters to wake up.
+ **/
+inline void atomic_notify_all(
+  PL_INOUT std::atomic<std::uint32_t>& object) noexcept
+{
+#if defined(PL_DETAIL_THD_HAS_FUTEX)
+  detail::futex(
+    object, FUTEX_WAKE_PRIVATE, static_cast<std::uint32_t>(INT_MAX));
+#elif defined(PL_DETAIL_THD_HAS_STD_ATOMIC_WAIT)
+  object.notify_all();
+#else
+  detail::wait_bucket& bucket{detail::get_wait_bucket(&object)};
+  {
+    std::lock_guard<std::mutex> lock{bucket.mutex};
+    (void)lock;
+  }
+  bucket.cv.notify_all();
+#endif
+}
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_ATOMIC_WAIT_HPP
@@ -0,0 +1,164 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file barrier.hpp
+ * \brief Defines the pl::thd::barrier class template.
+ **/
+#ifndef INCG_PL_THD_BARRIER_HPP
+#define INCG_PL_THD_BARRIER_HPP
+#include "../assert.hpp"   // PL_CHECK_PRE
+#include "atomic_wait.hpp" // pl::thd::atomic_wait, pl::thd::atomic_notify_all
+#include <atomic>          // std::atomic
+#include <cstdint>         // std::uint32_t
+#include <utility>         // std::move
+
+namespace pl {
+namespace thd {
+namespace detail {
+/*!
+ * \brief The default completion function of a barrier, does nothing.
+ **/
+struct barrier_no_completion {
+  void operator()() const noexcept
+  {
+  }
+};
+} // namespace detail
+
+/*!
+ * \brief A reusable thread coordination mechanism that blocks a group of
+ *        threads until all of them have arrived.
+ *
+ * Modeled after std::barrier. Every phase ends once the expected amount of
+ * threads has arrived. The last thread to arrive runs the completion
+ * function before the waiting threads are woken up and the next phase
+ * begins. Waiting threads spin for a short while before they block, ending
+ * a phase only makes a system call if threads are blocked.
+ **/
+template<typename CompletionFunction = detail::barrier_no_completion>
+class barrier {
+public:
+  using this_type = barrier;
+
+  /*!
+   * \brief Creates a barrier.
+   * \param expected The amount of threads that have to arrive in every
+   *                 phase. Must not be 0.
+   * \param completion Called by the last thread to arrive in every phase.
+   **/
+  explicit barrier(
+    std::uint32_t      expected,
+    CompletionFunction completion = CompletionFunction{})
+    : m_phase{0U}
+    , m_waiters{0U}
+    , m_remaining{expected}
+    , m_expected{expected}
+    , m_completion{std::move(completion)}
+  {
+    PL_CHECK_PRE(expected != 0U);
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  barrier(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Arrives at the barrier and blocks the calling thread until the
+   *        current phase ends.
+   **/
+  void arrive_and_wait()
+  {
+    const std::uint32_t phase{arrive()};
+
+    if (detail::spin_until([this, phase] { return has_ended(phase); })) {
+      return;
+    }
+
+    m_waiters.fetch_add(1U, std::memory_order_seq_cst);
+
+    while (m_phase.load(std::memory_order_seq_cst) == phase) {
+      atomic_wait(m_phase, phase);
+    }
+
+    m_waiters.fetch_sub(1U, std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Arrives at the barrier without waiting and decrements the amount
+   *        of threads expected in the following phases.
+   **/
+  void arrive_and_drop()
+  {
+    m_expected.fetch_sub(1U, std::memory_order_relaxed);
+    (void)arrive();
+  }
+
+private:
+  /*!
+   * \brief Arrives at the barrier, ends the phase if the calling thread is
+   *        the last one to arrive.
+   * \return The phase the calling thread arrived in.
+   **/
+  std::uint32_t arrive()
+  {
+    const std::uint32_t phase{m_phase.load(std::memory_order_acquire)};
+
+    if (m_remaining.fetch_sub(1U, std::memory_order_acq_rel) == 1U) {
+      m_completion();
+      m_remaining.store(
+        m_expected.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      m_phase.store(phase + 1U, std::memory_order_seq_cst);
+
+      // pairs with the increment of m_waiters in arrive_and_wait.
+      if (m_waiters.load(std::memory_order_seq_cst) != 0U) {
+        atomic_notify_all(m_phase);
+      }
+    }
+
+    return phase;
+  }
+
+  bool has_ended(std::uint32_t phase) const noexcept
+  {
+    return m_phase.load(std::memory_order_acquire) != phase;
+  }
+
+  std::atomic<std::uint32_t> m_phase;      //!< counts the phases.
+  std::atomic<std::uint32_t> m_waiters;    //!< the blocked threads.
+  std::atomic<std::uint32_t> m_remaining;  //!< yet to arrive in this phase.
+  std::atomic<std::uint32_t> m_expected;   //!< to arrive in every phase.
+  CompletionFunction         m_completion; //!< run at the end of a phase.
+};
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_BARRIER_HPP
@@ -0,0 +1,398 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file bounded_queue.hpp
+ * \brief This header file defines the pl::thd::bounded_queue class
+ **/
+#ifndef INCG_PL_THD_BOUNDED_QUEUE_HPP
+#define INCG_PL_THD_BOUNDED_QUEUE_HPP
+#include "../annotations.hpp" // PL_IN, PL_OUT, PL_INOUT, PL_NODISCARD
+#include "../assert.hpp"      // PL_CHECK_PRE
+#include <chrono>             // std::chrono::duration
+#include <condition_variable> // std::condition_variable
+#include <cstddef>            // std::size_t
+#include <deque>              // std::deque
+#include <mutex>              // std::mutex, std::unique_lock
+#include <utility>            // std::move, std::forward
+
+namespace pl {
+namespace thd {
+/*!
+ * \brief A thread safe first in first out queue with a fixed capacity.
+ *
+ * Producers that outrun the consumers are slowed down, as pushing to a full
+ * bounded_queue blocks (or fails for the try_ variants) until a consumer
+ * has removed an element. Consumers can remove many elements at once by
+ * using pop_bulk or drain, which only lock the mutex once.
+ * The queue can be closed, which wakes up all the waiting threads. Once
+ * closed no more elements can be pushed, but the elements still in the
+ * queue can still be popped. This lets consumer threads exit without the
+ * need for sentinel values.
+ *
+ * This class can be accessed from multiple threads at the same time.
+ **/
+template<typename ValueType>
+class bounded_queue {
+public:
+  using this_type      = bounded_queue;
+  using value_type     = ValueType;
+  using container_type = std::deque<value_type>;
+  using size_type      = typename container_type::size_type;
+
+  /*!
+   * \brief Creates an empty bounded_queue.
+   * \param capacity The maximum amount of elements that can be in the
+   *                 queue at the same time. Must not be 0.
+   **/
+  explicit bounded_queue(size_type capacity)
+    : m_cont{}
+    , m_capacity{capacity}
+    , m_is_closed{false}
+    , m_mutex{}
+    , m_cv_not_empty{}
+    , m_cv_not_full{}
+  {
+    PL_CHECK_PRE(capacity != 0U);
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  bounded_queue(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Pushes data to the back of the queue. Blocks while the queue is
+   *        full.
+   * \param data The object to push.
+   * \return true if data was pushed; false if the queue has been closed.
+   **/
+  bool push(PL_IN const value_type& data)
+  {
+    return emplace_impl(data);
+  }
+
+  /*!
+   * \brief Pushes data to the back of the queue. Blocks while the queue is
+   *        full.
+   * \param data The rvalue to push.
+   * \return true if data was pushed; false if the queue has been closed.
+   * \note data is left untouched if it could not be pushed.
+   **/
+  bool push(PL_IN value_type&& data)
+  {
+    return emplace_impl(std::move(data));
+  }
+
+  /*!
+   * \brief Pushes data to the back of the queue if the queue is not full.
+   * \param data The object to push.
+   * \return true if data was pushed; false if the queue was full or has
+   *         been closed.
+   **/
+  bool try_push(PL_IN const value_type& data)
+  {
+    return try_emplace_impl(data);
+  }
+
+  /*!
+   * \brief Pushes data to the back of the queue if the queue is not full.
+   * \param data The rvalue to push.
+   * \return true if data was pushed; false if the queue was full or has
+   *         been closed.
+   * \note data is left untouched if it could not be pushed.
+   **/
+  bool try_push(PL_IN value_type&& data)
+  {
+    return try_emplace_impl(std::move(data));
+  }
+
+  /*!
+   * \brief Pushes data to the back of the queue. Blocks for at most
+   *        timeout while the queue is full.
+   * \param data The object to push.
+   * \param timeout The maximum duration to wait for.
+   * \return true if data was pushed; false if the timeout expired or the
+   *         queue has been closed.
+   **/
+  template<typename Rep, typename Period>
+  bool try_push_for(
+    PL_IN const value_type&                   data,
+    const std::chrono::duration<Rep, Period>& timeout)
+  {
+    return try_emplace_for_impl(timeout, data);
+  }
+
+  /*!
+   * \brief Pushes data to the back of the queue. Blocks for at most
+   *        timeout while the queue is full.
+   * \param data The rvalue to push.
+   * \param timeout The maximum duration to wait for.
+   * \return true if data was pushed; false if the timeout expired or the
+   *         queue has been closed.
+   * \note data is left untouched if it could not be pushed.
+   **/
+  template<typename Rep, typename Period>
+  bool try_push_for(
+    PL_IN value_type&&                        data,
+    const std::chrono::duration<Rep, Period>& timeout)
+  {
+    return try_emplace_for_impl(timeout, std::move(data));
+  }
+
+  /*!
+   * \brief Removes the first element and moves it into destination.
+   *        Blocks while the queue is empty and not closed.
+   * \param destination The object to move the element into.
+   * \return true if an element was removed; false if the queue has been
+   *         closed and is empty.
+   **/
+  bool pop(PL_OUT value_type& destination)
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cv_not_empty.wait(
+      lock, [this] { return !m_cont.empty() || m_is_closed; });
+
+    if (m_cont.empty()) {
+      return false;
+    }
+
+    destination = std::move(m_cont.front());
+    m_cont.pop_front();
+    lock.unlock();
+    m_cv_not_full.notify_one();
+    return true;
+  }
+
+  /*!
+   * \brief Removes the first element and moves it into destination if the
+   *        queue is not empty.
+   * \param destination The object to move the element into.
+   * \return true if an element was removed; false if the queue was empty.
+   **/
+  bool try_pop(PL_OUT value_type& destination)
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    if (m_cont.empty()) {
+      return false;
+    }
+
+    destination = std::move(m_cont.front());
+    m_cont.pop_front();
+    lock.unlock();
+    m_cv_not_full.notify_one();
+    return true;
+  }
+
+  /*!
+   * \brief Moves up to max_count elements from the front of the queue to
+   *        out. Blocks while the queue is empty and not closed.
+   * \param out The output iterator to write the elements to.
+   * \param max_count The maximum amount of elements to remove.
+   * \return The amount of elements removed. Only returns 0 if max_count is
+   *         0 or if the queue has been closed and is empty.
+   * \note Locks the mutex only once, regardless of the amount of elements.
+   **/
+  template<typename OutputIterator>
+  size_type pop_bulk(OutputIterator out, size_type max_count)
+  {
+    if (max_count == 0U) {
+      return 0U;
+    }
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cv_not_empty.wait(
+      lock, [this] { return !m_cont.empty() || m_is_closed; });
+    return move_out(lock, out, max_count);
+  }
+
+  /*!
+   * \brief Moves up to max_count elements from the front of the queue to
+   *        out without blocking.
+   * \param out The output iterator to write the elements to.
+   * \param max_count The maximum amount of elements to remove.
+   * \return The amount of elements removed.
+   * \note Locks the mutex only once, regardless of the amount of elements.
+   **/
+  template<typename OutputIterator>
+  size_type drain(OutputIterator out, size_type max_count)
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    return move_out(lock, out, max_count);
+  }
+
+  /*!
+   * \brief Closes the queue. Wakes up all threads waiting on the queue.
+   *
+   * Subsequent pushes fail. Elements still in the queue can be popped,
+   * once the queue is empty the popping functions return without blocking.
+   **/
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      (void)lock;
+      m_is_closed = true;
+    }
+
+    m_cv_not_empty.notify_all();
+    m_cv_not_full.notify_all();
+  }
+
+  /*!
+   * \brief Queries whether the queue has been closed.
+   * \return true if close has been called; false otherwise.
+   **/
+  PL_NODISCARD bool is_closed() const
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    return m_is_closed;
+  }
+
+  /*!
+   * \brief Queries the queue as to whether or not it is empty.
+   * \return true if the queue is empty; false otherwise.
+   **/
+  PL_NODISCARD bool empty() const
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    return m_cont.empty();
+  }
+
+  /*!
+   * \brief Queries the queue's size.
+   * \return The size of the queue.
+   **/
+  PL_NODISCARD size_type size() const
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    return m_cont.size();
+  }
+
+  /*!
+   * \brief Queries the queue's capacity.
+   * \return The maximum amount of elements the queue can hold.
+   **/
+  PL_NODISCARD size_type capacity() const noexcept
+  {
+    return m_capacity;
+  }
+
+private:
+  template<typename Ty>
+  bool emplace_impl(Ty&& data)
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cv_not_full.wait(
+      lock, [this] { return (m_cont.size() < m_capacity) || m_is_closed; });
+    return push_back(lock, std::forward<Ty>(data));
+  }
+
+  template<typename Ty>
+  bool try_emplace_impl(Ty&& data)
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    return push_back(lock, std::forward<Ty>(data));
+  }
+
+  template<typename Rep, typename Period, typename Ty>
+  bool try_emplace_for_impl(
+    const std::chrono::duration<Rep, Period>& timeout,
+    Ty&&                                      data)
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cv_not_full.wait_for(lock, timeout, [this] {
+      return (m_cont.size() < m_capacity) || m_is_closed;
+    });
+    return push_back(lock, std::forward<Ty>(data));
+  }
+
+  /*!
+   * \brief Pushes data if there's space and the queue isn't closed.
+   *        Unlocks lock.
+   **/
+  template<typename Ty>
+  bool push_back(PL_INOUT std::unique_lock<std::mutex>& lock, Ty&& data)
+  {
+    if (m_is_closed || (m_cont.size() >= m_capacity)) {
+      return false;
+    }
+
+    m_cont.push_back(std::forward<Ty>(data));
+    lock.unlock();
+    m_cv_not_empty.notify_one();
+    return true;
+  }
+
+  /*!
+   * \brief Moves up to max_count elements to out. Unlocks lock.
+   **/
+  template<typename OutputIterator>
+  size_type move_out(
+    PL_INOUT std::unique_lock<std::mutex>& lock,
+    OutputIterator                         out,
+    size_type                              max_count)
+  {
+    const size_type count{
+      m_cont.size() < max_count ? m_cont.size() : max_count};
+
+    for (size_type i{0U}; i < count; ++i) {
+      *out = std::move(m_cont.front());
+      ++out;
+      m_cont.pop_front();
+    }
+
+    lock.unlock();
+
+    if (count == 1U) {
+      m_cv_not_full.notify_one();
+    }
+    else if (count > 1U) {
+      m_cv_not_full.notify_all();
+    }
+
+    return count;
+  }
+
+  container_type          m_cont;         //!< the elements.
+  const size_type         m_capacity;     //!< the maximum size.
+  bool                    m_is_closed;    //!< whether close was called.
+  mutable std::mutex      m_mutex;        //!< guards the shared data.
+  std::condition_variable m_cv_not_empty; //!< signalled on push and close.
+  std::condition_variable m_cv_not_full;  //!< signalled on pop and close.
+};
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_BOUNDED_QUEUE_HPP
@@ -0,0 +1,274 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file combinable.hpp
+ * \brief Defines the pl::thd::combinable class template.
+ **/
+#ifndef INCG_PL_THD_COMBINABLE_HPP
+#define INCG_PL_THD_COMBINABLE_HPP
+#include "../annotations.hpp"   // PL_NODISCARD, PL_INOUT
+#include "../cache_aligned.hpp" // pl::cache_aligned, pl::cache_aligned_allocator
+#include <atomic>               // std::atomic
+#include <cstddef>              // std::size_t
+#include <cstdint>              // std::uint64_t
+#include <deque>                // std::deque
+#include <functional>           // std::function
+#include <mutex>                // std::mutex, std::lock_guard
+#include <thread>               // std::thread, std::this_thread::get_id
+#include <unordered_map>        // std::unordered_map
+#include <utility>              // std::move
+
+namespace pl {
+namespace thd {
+namespace detail {
+/*!
+ * \brief An entry of the per-thread cache of combinable objects.
+ **/
+struct combinable_cache_entry {
+  std::uint64_t id;   //!< The id of the combinable, 0 if unused.
+  void*         slot; //!< The calling thread's slot in that combinable.
+};
+
+/*!
+ * \brief The amount of entries in the per-thread cache, must be a power
+ *        of 2.
+ **/
+enum : std::size_t { combinable_cache_size = 8U };
+
+/*!
+ * \brief Returns the calling thread's cache of combinable objects.
+ * \return The cache.
+ **/
+inline combinable_cache_entry* combinable_cache() noexcept
+{
+  static thread_local combinable_cache_entry cache[combinable_cache_size]{};
+  return cache;
+}
+
+/*!
+ * \brief Returns an id that has never been returned before.
+ * \return The new id, never 0.
+ **/
+inline std::uint64_t next_combinable_id() noexcept
+{
+  static std::atomic<std::uint64_t> next_id{1U};
+  return next_id.fetch_add(1U, std::memory_order_relaxed);
+}
+} // namespace detail
+
+/*!
+ * \brief Holds one object of type Ty for every thread that uses it.
+ * \tparam Ty The type of the objects.
+ *
+ * Every thread lazily gets an object of its own through local(), which it
+ * can modify without synchronization. Once the threads are done the objects
+ * are folded into a single result through combine or visited through
+ * combine_each. This allows parallel reductions without any atomic
+ * operations or locks in the loops that compute the partial results.
+ * Unlike thread_local combinable can be used for non-static data members.
+ *
+ * local() looks the calling thread's object up in a small per-thread cache
+ * first and only takes a lock when the object isn't cached, which is the
+ * case the first time a thread uses a combinable.
+ * \note The objects are kept until clear() is called or the combinable is
+ *       destroyed, even if the threads that created them have exited. A
+ *       thread that reuses the id of an exited thread continues to use its
+ *       object.
+ **/
+template<typename Ty>
+class combinable {
+public:
+  using this_type  = combinable;
+  using value_type = Ty;
+
+  /*!
+   * \brief Creates a combinable whose objects are value initialized.
+   **/
+  combinable() : combinable{[] { return value_type{}; }}
+  {
+  }
+
+  /*!
+   * \brief Creates a combinable whose objects are created by calling
+   *        factory.
+   * \param factory The function to create the objects of the threads with.
+   **/
+  explicit combinable(std::function<value_type()> factory)
+    : m_id{detail::next_combinable_id()}
+    , m_factory{std::move(factory)}
+    , m_mutex{}
+    , m_slots{}
+    , m_index{}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  combinable(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Returns the calling thread's object, creating it if it
+   *        doesn't exist yet.
+   * \return The calling thread's object.
+   **/
+  PL_NODISCARD value_type& local()
+  {
+    bool exists{};
+    return local(exists);
+  }
+
+  /*!
+   * \brief Returns the calling thread's object, creating it if it
+   *        doesn't exist yet.
+   * \param exists Will be set to true if the object already existed,
+   *               otherwise it will be set to false.
+   * \return The calling thread's object.
+   **/
+  PL_NODISCARD value_type& local(PL_INOUT bool& exists)
+  {
+    const std::uint64_t cached_id{m_id.load(std::memory_order_relaxed)};
+    const detail::combinable_cache_entry& entry{
+      detail::combinable_cache()[cache_index(cached_id)]};
+
+    if (entry.id == cached_id) {
+      exists = true;
+      return *static_cast<value_type*>(entry.slot);
+    }
+
+    const std::thread::id       thread_id{std::this_thread::get_id()};
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    const std::uint64_t id{m_id.load(std::memory_order_relaxed)};
+
+    auto it = m_index.find(thread_id);
+    exists  = it != m_index.end();
+
+    if (!exists) {
+      m_slots.emplace_back(m_factory());
+      it = m_index.emplace(thread_id, &m_slots.back().get()).first;
+    }
+
+    detail::combinable_cache()[cache_index(id)]
+      = detail::combinable_cache_entry{id, it->second};
+    return *it->second;
+  }
+
+  /*!
+   * \brief Folds the objects of all the threads using op.
+   * \param op The binary operation to fold the objects with, must be
+   *           callable as op(const Ty&, const Ty&) and return a Ty.
+   * \return The result of folding, or an object created by the factory if
+   *         no thread has created an object.
+   * \warning Must not be called while other threads modify their objects.
+   **/
+  template<typename BinaryOperation>
+  PL_NODISCARD value_type combine(BinaryOperation op) const
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+
+    if (m_slots.empty()) {
+      return m_factory();
+    }
+
+    auto       it{m_slots.begin()};
+    value_type result{it->get()};
+
+    for (++it; it != m_slots.end(); ++it) {
+      result = op(result, it->get());
+    }
+
+    return result;
+  }
+
+  /*!
+   * \brief Calls function with the object of every thread.
+   * \param function The function to call, must be callable as
+   *                 function(const Ty&).
+   * \warning Must not be called while other threads modify their objects.
+   **/
+  template<typename UnaryFunction>
+  void combine_each(UnaryFunction function) const
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+
+    for (const cache_aligned<value_type>& slot : m_slots) {
+      function(slot.get());
+    }
+  }
+
+  /*!
+   * \brief Destroys the objects of all the threads.
+   * \warning Must not be called while other threads use their objects.
+   **/
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    // A new id invalidates the entries that the threads have cached.
+    m_id.store(detail::next_combinable_id(), std::memory_order_relaxed);
+    m_index.clear();
+    m_slots.clear();
+  }
+
+  /*!
+   * \brief Queries the amount of threads that have created an object.
+   * \return The amount of objects.
+   **/
+  PL_NODISCARD std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    return m_slots.size();
+  }
+
+private:
+  static std::size_t cache_index(std::uint64_t id) noexcept
+  {
+    return static_cast<std::size_t>(id & (detail::combinable_cache_size - 1U));
+  }
+
+  std::atomic<std::uint64_t>  m_id;      //!< Unique id, changed by clear.
+  std::function<value_type()> m_factory; //!< Creates the objects.
+  mutable std::mutex          m_mutex;   //!< Guards m_slots and m_index.
+  std::deque<
+    cache_aligned<value_type>,
+    cache_aligned_allocator<cache_aligned<value_type>>>
+    m_slots; //!< The objects.
+  std::unordered_map<std::thread::id, value_type*>
+    m_index; //!< Maps the threads to their objects.
+};
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_COMBINABLE_HPP
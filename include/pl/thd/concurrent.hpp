@@ -28,25 +28,34 @@
  * \file concurrent.hpp
  * \brief Defines the concurrent type which wraps an instance of any type
  *        and manages a thread that runs callables on the instance wrapped.
- *        Those callables are passed in by users.
+ *        Those callables are passed in by users. Alternatively the
+ *        callables can be run on a shared thread_pool.
  **/
 #ifndef INCG_PL_THD_CONCURRENT_HPP
 #define INCG_PL_THD_CONCURRENT_HPP
-#include "../annotations.hpp"    // PL_IN, PL_OUT, PL_INOUT
-#include "../compiler.hpp"       // PL_COMPILER, PL_COMPILER_MSVC
-#include "../invoke.hpp"         // pl::invoke
-#include "thread_safe_queue.hpp" // pl::thread_safe_queue
-#include <exception>             // std::current_exception
-#include <functional>            // std::function
-#include <future>                // std::future, std::promise
-#include <memory>                // std::make_shared
-#include <thread>                // std::thread
-#include <utility>               // std::move
+#include "../annotations.hpp"     // PL_IN, PL_OUT, PL_INOUT
+#include "../compiler.hpp"        // PL_COMPILER, PL_COMPILER_MSVC
+#include "../invoke.hpp"          // pl::invoke
+#include "../unique_function.hpp" // pl::unique_function
+#include "strand.hpp"             // pl::thd::strand
+#include "thread_pool.hpp"        // pl::thd::thread_pool
+#include "thread_safe_queue.hpp"  // pl::thread_safe_queue
+#include <exception>              // std::current_exception
+#include <future>                 // std::future, std::promise
+#include <memory>                 // std::unique_ptr
+#include <thread>                 // std::thread
+#include <utility>                // std::move, std::forward
 
 namespace pl {
 namespace thd {
 /*!
  * \brief Allows callables to be run on an object managed by a thread.
+ *
+ * By default every concurrent owns a thread of its own. A concurrent
+ * created with a thread_pool instead runs the callables as a strand on that
+ * thread_pool, which allows for a large number of concurrent objects to
+ * share a few threads. In both cases the callables passed to a concurrent
+ * are run one after another in the order they were passed in.
  **/
 template<typename Type>
 class concurrent {
@@ -67,7 +76,11 @@ public:
    *        will operate on.
    **/
   explicit concurrent(Type value)
-    : m_value{std::move(value)}, m_q{}, m_is_done{false}, m_thd{[this] {
+    : m_value{std::move(value)}
+    , m_q{}
+    , m_is_done{false}
+    , m_strand{}
+    , m_thd{[this] {
       while (!m_is_done) {
         m_q.pop()();
       }
@@ -75,6 +88,27 @@ public:
   {
   }
 
+  /*!
+   * \brief Creates a concurrent that runs the callables passed in on pool
+   *        rather than on a thread of its own.
+   * \param pool The thread_pool to run the callables on. Must outlive this
+   *             object.
+   * \param value The object that the callables passed in the call operator
+   *        will operate on.
+   *
+   * At most one callable of this object is run on pool at any time. The
+   * thread running the callables is given back to pool as soon as there are
+   * no more callables to be run.
+   **/
+  concurrent(PL_INOUT thread_pool& pool, Type value)
+    : m_value{std::move(value)}
+    , m_q{}
+    , m_is_done{false}
+    , m_strand{std::make_unique<strand>(pool)}
+    , m_thd{}
+  {
+  }
+
   /*!
    * \brief This type is non-copyable.
    **/
@@ -94,9 +128,16 @@ public:
    * thread_safe_queue. As soon as the callable that sets is done to true is
    * run the thread will exit its loop. Then the thread calling this
    * destructor joins this instances's underlying thread.
+   * If this object runs on a thread_pool the destructor blocks until all
+   * of the callables passed in have been run.
    **/
   ~concurrent()
   {
+    if (m_strand != nullptr) {
+      m_strand.reset();
+      return;
+    }
+
     m_q.push([this] { m_is_done = true; });
     m_thd.join();
   }
@@ -112,28 +153,36 @@ public:
    *         The returned future can be joined on using .get() for instance.
    **/
   template<typename Callable>
-  auto operator()(PL_IN Callable&& callable)
+  auto operator()(Callable&& callable)
   {
-    auto p = std::make_shared<
-      std::promise<decltype(::pl::invoke(callable, m_value))>>();
+    std::promise<decltype(::pl::invoke(callable, m_value))> p{};
 
-    auto ret = p->get_future();
+    auto ret = p.get_future();
 
-    m_q.push([p, callable, this] {
+    function f{[p = std::move(p),
+                c = std::forward<Callable>(callable),
+                this]() mutable {
       try {
-        set_value(*p, callable, m_value);
+        set_value(p, c, m_value);
       }
       catch (...) {
-        p->set_exception(std::current_exception());
+        p.set_exception(std::current_exception());
       }
-    });
+    }};
+
+    if (m_strand != nullptr) {
+      m_strand->post(std::move(f));
+    }
+    else {
+      m_q.push(std::move(f));
+    }
 
     return ret;
   }
 
 private:
   // these type aliases are just for gcc
-  using function         = std::function<void()>;
+  using function         = ::pl::unique_function<void()>;
   using concurrent_queue = thread_safe_queue<function>;
 
   /*!
@@ -172,10 +221,11 @@ private:
 #pragma warning(pop)
 #endif // PL_COMPILER == PL_COMPILER_MSVC
 
-  Type             m_value;
-  concurrent_queue m_q;
-  bool             m_is_done; //!< only accessed from m_thd
-  std::thread      m_thd;
+  Type                    m_value;
+  concurrent_queue        m_q;
+  bool                    m_is_done; //!< only accessed from m_thd
+  std::unique_ptr<strand> m_strand;  //!< null unless run on a thread_pool
+  std::thread             m_thd;     //!< not a thread if run on a thread_pool
 };
 } // namespace thd
 } // namespace pl
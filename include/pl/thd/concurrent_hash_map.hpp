@@ -0,0 +1,408 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file concurrent_hash_map.hpp
+ * \brief This header file defines the pl::thd::concurrent_hash_map class.
+ **/
+#ifndef INCG_PL_THD_CONCURRENT_HASH_MAP_HPP
+#define INCG_PL_THD_CONCURRENT_HASH_MAP_HPP
+#include "../annotations.hpp"   // PL_IN, PL_NODISCARD
+#include "../as_const.hpp"      // pl::as_const
+#include "../assert.hpp"        // PL_CHECK_PRE
+#include "../cache_aligned.hpp" // pl::hardware_destructive_interference_size, pl::cache_aligned_allocator
+#include "../compiler.hpp"      // PL_COMPILER, PL_COMPILER_MSVC
+#include "../invoke.hpp"        // pl::invoke
+#include "../type_traits.hpp"   // pl::decay_t
+#include <cstddef>              // std::size_t
+#include <functional>           // std::hash, std::equal_to
+#include <mutex>                // std::unique_lock
+#include <shared_mutex>         // std::shared_timed_mutex, std::shared_lock
+#include <unordered_map>        // std::unordered_map
+#include <utility>              // std::move, std::forward, std::declval
+#include <vector>               // std::vector
+
+namespace pl {
+namespace thd {
+#if PL_COMPILER == PL_COMPILER_MSVC
+#pragma warning(push)
+#pragma warning(disable : 4324) // structure was padded due to alignment
+#endif                          // PL_COMPILER == PL_COMPILER_MSVC
+
+/*!
+ * \brief A hash map that can be accessed by multiple threads concurrently.
+ * \note The elements are only ever accessed through callables that are
+ *       invoked while the element is protected by a lock, so that no
+ *       references to elements that might be erased by another thread
+ *       concurrently can escape.
+ * \warning The callables passed must not access the concurrent_hash_map
+ *          themselves, as that may deadlock.
+ *
+ * The elements are partitioned into stripes by their hash values. Every
+ * stripe is a std::unordered_map of its own that is guarded by a
+ * reader-writer lock on its own cache line. Lookups only acquire the lock
+ * of their stripe in shared mode, so that readers never block each other
+ * and writers only block the accesses to their stripe.
+ **/
+template<
+  typename Key,
+  typename Value,
+  typename Hash     = std::hash<Key>,
+  typename KeyEqual = std::equal_to<Key>>
+class concurrent_hash_map {
+public:
+  using this_type   = concurrent_hash_map;
+  using key_type    = Key;
+  using mapped_type = Value;
+  using hasher      = Hash;
+  using key_equal   = KeyEqual;
+  using size_type   = std::size_t;
+
+  /*!
+   * \brief Creates an empty concurrent_hash_map.
+   * \param stripe_count The amount of independently locked partitions.
+   *                     Will be rounded up to the next power of 2.
+   *                     Must not be 0.
+   * \param hash The hash function to use.
+   * \param equal The key equality predicate to use.
+   **/
+  explicit concurrent_hash_map(
+    size_type              stripe_count = 64U,
+    PL_IN const hasher&    hash         = hasher{},
+    PL_IN const key_equal& equal        = key_equal{})
+    : m_hash{hash}
+    , m_mask{round_up_to_power_of_2(stripe_count) - 1U}
+    , m_stripes{}
+  {
+    m_stripes.reserve(m_mask + 1U);
+
+    for (size_type i{0U}; i <= m_mask; ++i) {
+      m_stripes.emplace_back(hash, equal);
+    }
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  concurrent_hash_map(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Invokes callable with the value mapped to key if there is one.
+   * \param key The key to look up.
+   * \param callable Will be called with a const lvalue reference to the
+   *                 value while other threads may read it concurrently.
+   * \return true if key was found and callable was invoked; false otherwise.
+   **/
+  template<typename Callable>
+  bool find(PL_IN const key_type& key, PL_IN Callable&& callable) const
+  {
+    const stripe&                             s{stripe_of(key)};
+    std::shared_lock<std::shared_timed_mutex> lock{s.mutex};
+    const auto                                it = s.map.find(key);
+
+    if (it == s.map.end()) {
+      return false;
+    }
+
+    ::pl::invoke(std::forward<Callable>(callable), it->second);
+    return true;
+  }
+
+  /*!
+   * \brief Checks whether key is contained.
+   * \param key The key to look up.
+   * \return true if key is contained; false otherwise.
+   **/
+  PL_NODISCARD bool contains(PL_IN const key_type& key) const
+  {
+    const stripe&                             s{stripe_of(key)};
+    std::shared_lock<std::shared_timed_mutex> lock{s.mutex};
+    return s.map.find(key) != s.map.end();
+  }
+
+  /*!
+   * \brief Maps key to value, replacing the value previously mapped to
+   *        key if there is one.
+   * \param key The key.
+   * \param value The value.
+   * \return true if key was inserted; false if the value was assigned.
+   **/
+  bool insert_or_assign(key_type key, mapped_type value)
+  {
+    stripe&                                   s{stripe_of(key)};
+    std::unique_lock<std::shared_timed_mutex> lock{s.mutex};
+    const auto                                it = s.map.find(key);
+
+    if (it != s.map.end()) {
+      it->second = std::move(value);
+      return false;
+    }
+
+    s.map.emplace(std::move(key), std::move(value));
+    return true;
+  }
+
+  /*!
+   * \brief Invokes callable with the value mapped to key if there is one,
+   *        so that it may be modified.
+   * \param key The key to look up.
+   * \param callable Will be called with a non-const lvalue reference to the
+   *                 value while no other thread may access its stripe.
+   * \return true if key was found and callable was invoked; false otherwise.
+   **/
+  template<typename Callable>
+  bool update(PL_IN const key_type& key, PL_IN Callable&& callable)
+  {
+    stripe&                                   s{stripe_of(key)};
+    std::unique_lock<std::shared_timed_mutex> lock{s.mutex};
+    const auto                                it = s.map.find(key);
+
+    if (it == s.map.end()) {
+      return false;
+    }
+
+    ::pl::invoke(std::forward<Callable>(callable), it->second);
+    return true;
+  }
+
+  /*!
+   * \brief Maps key to the result of invoking factory if key is not
+   *        contained and then invokes callable with the value mapped to key.
+   * \param key The key.
+   * \param factory Nullary callable that creates the value. It is invoked
+   *                at most once per insertion of key, even if multiple
+   *                threads call this function with key concurrently.
+   * \param callable Will be called with a const lvalue reference to the
+   *                 value mapped to key.
+   * \return The result of invoking callable, decayed and returned by
+   *         value, so that no reference into the stripe escapes its lock.
+   **/
+  template<typename Factory, typename Callable>
+  auto compute_if_absent(
+    PL_IN const key_type& key,
+    PL_IN Factory&& factory,
+    PL_IN Callable&& callable)
+    -> decay_t<decltype(::pl::invoke(
+      std::forward<Callable>(callable),
+      std::declval<const mapped_type&>()))>
+  {
+    stripe& s{stripe_of(key)};
+
+    {
+      // fast path, most lookups find the key in read heavy workloads.
+      std::shared_lock<std::shared_timed_mutex> lock{s.mutex};
+      const auto                                it = s.map.find(key);
+
+      if (it != s.map.end()) {
+        return ::pl::invoke(
+          std::forward<Callable>(callable), ::pl::as_const(it->second));
+      }
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lock{s.mutex};
+    auto                                      it = s.map.find(key);
+
+    if (it == s.map.end()) {
+      // another thread may have inserted the key in the meantime.
+      it = s.map.emplace(key, ::pl::invoke(std::forward<Factory>(factory)))
+             .first;
+    }
+
+    return ::pl::invoke(
+      std::forward<Callable>(callable), ::pl::as_const(it->second));
+  }
+
+  /*!
+   * \brief Maps key to the result of invoking factory if key is not
+   *        contained.
+   * \param key The key.
+   * \param factory Nullary callable that creates the value. It is invoked
+   *                at most once per insertion of key, even if multiple
+   *                threads call this function with key concurrently.
+   * \return A copy of the value mapped to key.
+   **/
+  template<typename Factory>
+  mapped_type compute_if_absent(
+    PL_IN const key_type& key,
+    PL_IN Factory&& factory)
+  {
+    return compute_if_absent(
+      key, std::forward<Factory>(factory), [](PL_IN const mapped_type& v) {
+        return v;
+      });
+  }
+
+  /*!
+   * \brief Removes key and the value mapped to it.
+   * \param key The key to remove.
+   * \return true if key was removed; false if it wasn't contained.
+   **/
+  bool erase(PL_IN const key_type& key)
+  {
+    stripe&                                   s{stripe_of(key)};
+    std::unique_lock<std::shared_timed_mutex> lock{s.mutex};
+    return s.map.erase(key) != 0U;
+  }
+
+  /*!
+   * \brief Invokes callable with every key and the value mapped to it.
+   * \param callable Will be called with a const lvalue reference to the key
+   *                 and a const lvalue reference to the value.
+   * \note Only one stripe is locked at a time, so that modifications made
+   *       concurrently may or may not be observed.
+   **/
+  template<typename Callable>
+  void for_each(PL_IN Callable&& callable) const
+  {
+    for (const stripe& s : m_stripes) {
+      std::shared_lock<std::shared_timed_mutex> lock{s.mutex};
+
+      for (const auto& pair : s.map) {
+        ::pl::invoke(callable, pair.first, pair.second);
+      }
+    }
+  }
+
+  /*!
+   * \brief Removes all the elements.
+   **/
+  void clear()
+  {
+    for (stripe& s : m_stripes) {
+      std::unique_lock<std::shared_timed_mutex> lock{s.mutex};
+      s.map.clear();
+    }
+  }
+
+  /*!
+   * \brief Queries the amount of elements.
+   * \return The amount of elements.
+   * \note The result is only a snapshot if other threads modify the
+   *       concurrent_hash_map concurrently.
+   **/
+  PL_NODISCARD size_type size() const
+  {
+    size_type result{0U};
+
+    for (const stripe& s : m_stripes) {
+      std::shared_lock<std::shared_timed_mutex> lock{s.mutex};
+      result += s.map.size();
+    }
+
+    return result;
+  }
+
+  /*!
+   * \brief Checks whether there are no elements.
+   * \return true if there are no elements; false otherwise.
+   **/
+  PL_NODISCARD bool empty() const
+  {
+    return size() == 0U;
+  }
+
+  /*!
+   * \brief Queries the amount of stripes.
+   * \return The amount of independently locked partitions.
+   **/
+  PL_NODISCARD size_type stripe_count() const noexcept
+  {
+    return m_mask + 1U;
+  }
+
+private:
+  using map_type = std::unordered_map<key_type, mapped_type, hasher, key_equal>;
+
+  /*!
+   * \brief The alignment that keeps the stripes from sharing cache lines.
+   **/
+  static constexpr std::size_t cache_line_size{
+    hardware_destructive_interference_size};
+
+  /*!
+   * \brief A partition of the elements, begins on a cache line of its own.
+   **/
+  struct alignas(cache_line_size) stripe {
+    stripe(PL_IN const hasher& hash, PL_IN const key_equal& equal)
+      : mutex{}, map{0U, hash, equal}
+    {
+    }
+
+    stripe(stripe&& other) : mutex{}, map{std::move(other.map)}
+    {
+    }
+
+    mutable std::shared_timed_mutex mutex;
+    map_type                        map;
+  };
+
+  static size_type round_up_to_power_of_2(size_type stripe_count)
+  {
+    PL_CHECK_PRE(stripe_count != 0U);
+    size_type result{1U};
+
+    while (result < stripe_count) {
+      result <<= 1U;
+    }
+
+    return result;
+  }
+
+  const stripe& stripe_of(PL_IN const key_type& key) const
+  {
+    return m_stripes[index_of(key)];
+  }
+
+  stripe& stripe_of(PL_IN const key_type& key)
+  {
+    return m_stripes[index_of(key)];
+  }
+
+  size_type index_of(PL_IN const key_type& key) const
+  {
+    // fold the upper bits in, the lower bits are used by the stripes' maps.
+    size_type bits{m_hash(key)};
+    bits ^= bits >> (sizeof(size_type) * 4U);
+    return bits & m_mask;
+  }
+
+  hasher              m_hash;    //!< the hash function.
+  const size_type     m_mask;    //!< stripe_count() - 1.
+  std::vector<stripe, cache_aligned_allocator<stripe>>
+    m_stripes; //!< the partitions.
+};
+
+#if PL_COMPILER == PL_COMPILER_MSVC
+#pragma warning(pop)
+#endif // PL_COMPILER == PL_COMPILER_MSVC
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_CONCURRENT_HASH_MAP_HPP
@@ -0,0 +1,136 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file counting_semaphore.hpp
+ * \brief Defines the pl::thd::counting_semaphore class.
+ **/
+#ifndef INCG_PL_THD_COUNTING_SEMAPHORE_HPP
+#define INCG_PL_THD_COUNTING_SEMAPHORE_HPP
+#include "../annotations.hpp" // PL_NODISCARD
+#include "atomic_wait.hpp" // pl::thd::atomic_wait, pl::thd::atomic_notify_one
+#include <atomic>          // std::atomic
+#include <cstdint>         // std::uint32_t
+
+namespace pl {
+namespace thd {
+/*!
+ * \brief A semaphore with a non-negative counter of available resources.
+ *
+ * Modeled after std::counting_semaphore. Acquiring a resource while there
+ * are some available and releasing resources while no thread is blocked
+ * don't make any system calls. Threads that have to wait spin for a short
+ * while before they block.
+ **/
+class counting_semaphore {
+public:
+  using this_type = counting_semaphore;
+
+  /*!
+   * \brief Creates a counting_semaphore.
+   * \param desired The initial amount of available resources.
+   **/
+  explicit counting_semaphore(std::uint32_t desired)
+    : m_counter{desired}, m_waiters{0U}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  counting_semaphore(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Makes resources available, waking up blocked threads.
+   * \param update The amount of resources to make available.
+   **/
+  void release(std::uint32_t update = 1U) noexcept
+  {
+    m_counter.fetch_add(update, std::memory_order_seq_cst);
+
+    // pairs with the increment of m_waiters in acquire.
+    if (m_waiters.load(std::memory_order_seq_cst) != 0U) {
+      if (update == 1U) {
+        atomic_notify_one(m_counter);
+      }
+      else {
+        atomic_notify_all(m_counter);
+      }
+    }
+  }
+
+  /*!
+   * \brief Acquires a resource if there is one available.
+   * \return true if a resource was acquired; false otherwise.
+   **/
+  PL_NODISCARD bool try_acquire() noexcept
+  {
+    std::uint32_t value{m_counter.load(std::memory_order_relaxed)};
+
+    while (value != 0U) {
+      if (m_counter.compare_exchange_weak(
+            value,
+            value - 1U,
+            std::memory_order_acquire,
+            std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /*!
+   * \brief Acquires a resource, blocks the calling thread until there is
+   *        one available.
+   **/
+  void acquire() noexcept
+  {
+    if (detail::spin_until([this] { return try_acquire(); })) {
+      return;
+    }
+
+    m_waiters.fetch_add(1U, std::memory_order_seq_cst);
+
+    while (!try_acquire()) {
+      atomic_wait(m_counter, 0U);
+    }
+
+    m_waiters.fetch_sub(1U, std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::uint32_t> m_counter; //!< the resources available.
+  std::atomic<std::uint32_t> m_waiters; //!< the amount of blocked threads.
+};
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_COUNTING_SEMAPHORE_HPP
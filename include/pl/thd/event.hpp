@@ -0,0 +1,229 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file event.hpp
+ * \brief Defines the pl::thd::manual_reset_event and
+ *        pl::thd::auto_reset_event classes.
+ **/
+#ifndef INCG_PL_THD_EVENT_HPP
+#define INCG_PL_THD_EVENT_HPP
+#include "../annotations.hpp" // PL_NODISCARD
+#include "atomic_wait.hpp" // pl::thd::atomic_wait, pl::thd::atomic_notify_all
+#include <atomic>          // std::atomic
+#include <cstdint>         // std::uint32_t
+
+namespace pl {
+namespace thd {
+/*!
+ * \brief An event that remains set until it is reset. Releases all the
+ *        waiting threads when it is set.
+ *
+ * Setting the event only makes a system call if threads are blocked on it.
+ * Waiting threads spin for a short while before they block.
+ **/
+class manual_reset_event {
+public:
+  using this_type = manual_reset_event;
+
+  /*!
+   * \brief Creates a manual_reset_event.
+   * \param initially_set Whether the event starts out set.
+   **/
+  explicit manual_reset_event(bool initially_set = false)
+    : m_state{initially_set ? is_set_state : not_set_state}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  manual_reset_event(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Sets the event, wakes up all the waiting threads.
+   **/
+  void set() noexcept
+  {
+    if (
+      m_state.exchange(is_set_state, std::memory_order_acq_rel)
+      == has_waiters_state) {
+      atomic_notify_all(m_state);
+    }
+  }
+
+  /*!
+   * \brief Resets the event if it is set.
+   **/
+  void reset() noexcept
+  {
+    std::uint32_t expected{is_set_state};
+    (void)m_state.compare_exchange_strong(
+      expected, not_set_state, std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Checks whether the event is set.
+   * \return true if the event is set; false otherwise.
+   **/
+  PL_NODISCARD bool is_set() const noexcept
+  {
+    return m_state.load(std::memory_order_acquire) == is_set_state;
+  }
+
+  /*!
+   * \brief Blocks the calling thread until the event is set.
+   **/
+  void wait() noexcept
+  {
+    if (detail::spin_until([this] { return is_set(); })) {
+      return;
+    }
+
+    for (;;) {
+      std::uint32_t state{m_state.load(std::memory_order_acquire)};
+
+      if (state == is_set_state) {
+        return;
+      }
+
+      // announce that there's a thread that has to be woken up.
+      if (
+        (state == not_set_state)
+        && !m_state.compare_exchange_weak(
+          state, has_waiters_state, std::memory_order_acquire)) {
+        continue;
+      }
+
+      atomic_wait(m_state, has_waiters_state);
+    }
+  }
+
+private:
+  /*!
+   * \brief The values of m_state.
+   **/
+  enum : std::uint32_t {
+    not_set_state     = 0U,
+    is_set_state      = 1U,
+    has_waiters_state = 2U
+  };
+
+  std::atomic<std::uint32_t> m_state; //!< one of the states above.
+};
+
+/*!
+ * \brief An event that is reset automatically when it releases a waiting
+ *        thread. Setting it releases at most one waiting thread.
+ *
+ * Setting the event only makes a system call if threads are blocked on it.
+ * Waiting threads spin for a short while before they block.
+ **/
+class auto_reset_event {
+public:
+  using this_type = auto_reset_event;
+
+  /*!
+   * \brief Creates an auto_reset_event.
+   * \param initially_set Whether the event starts out set.
+   **/
+  explicit auto_reset_event(bool initially_set = false)
+    : m_state{initially_set ? 1U : 0U}, m_waiters{0U}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  auto_reset_event(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Sets the event, wakes up one waiting thread.
+   **/
+  void set() noexcept
+  {
+    m_state.store(1U, std::memory_order_seq_cst);
+
+    // pairs with the increment of m_waiters in wait.
+    if (m_waiters.load(std::memory_order_seq_cst) != 0U) {
+      atomic_notify_one(m_state);
+    }
+  }
+
+  /*!
+   * \brief Resets the event if it is set.
+   **/
+  void reset() noexcept
+  {
+    m_state.store(0U, std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Resets the event if it is set.
+   * \return true if the event was set; false otherwise.
+   **/
+  PL_NODISCARD bool try_wait() noexcept
+  {
+    std::uint32_t expected{1U};
+    return m_state.compare_exchange_strong(
+      expected, 0U, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Blocks the calling thread until the event is set and resets it.
+   **/
+  void wait() noexcept
+  {
+    if (detail::spin_until([this] { return try_wait(); })) {
+      return;
+    }
+
+    m_waiters.fetch_add(1U, std::memory_order_seq_cst);
+
+    while (!try_wait()) {
+      atomic_wait(m_state, 0U);
+    }
+
+    m_waiters.fetch_sub(1U, std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::uint32_t> m_state;   //!< 1 if set; 0 otherwise.
+  std::atomic<std::uint32_t> m_waiters; //!< the amount of blocked threads.
+};
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_EVENT_HPP
@@ -0,0 +1,1579 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file fiber.hpp
+ * \brief Defines stackful user-space fibers that are run by a work-stealing
+ *        fiber_scheduler along with a mutex, a condition variable and a
+ *        future that suspend the calling fiber instead of its thread.
+ **/
+#ifndef INCG_PL_THD_FIBER_HPP
+#define INCG_PL_THD_FIBER_HPP
+#include "../os.hpp" // PL_OS, PL_OS_LINUX
+
+/*!
+ * \def PL_THD_HAS_FIBERS
+ * \brief Defined as 1 if pl::thd::fiber is supported on the target, that is
+ *        on x86-64 GNU/Linux. Defined as 0 otherwise.
+ **/
+#if (PL_OS == PL_OS_LINUX) && defined(__x86_64__)
+#define PL_THD_HAS_FIBERS 1
+#else
+#define PL_THD_HAS_FIBERS 0
+#endif
+
+#if PL_THD_HAS_FIBERS
+#include "../annotations.hpp"     // PL_IN, PL_INOUT, PL_NODISCARD
+#include "../apply.hpp"           // pl::apply
+#include "../assert.hpp"          // PL_CHECK_PRE
+#include "../unique_function.hpp" // pl::unique_function
+#include <atomic>                 // std::atomic
+#include <condition_variable>     // std::condition_variable
+#include <cstddef>                // std::size_t
+#include <cstdint>                // std::uintptr_t, std::uint8_t
+#include <deque>                  // std::deque
+#include <exception>              // std::exception_ptr, std::terminate
+#include <future>                 // std::future_error, std::future_errc
+#include <memory>                 // std::shared_ptr, std::unique_ptr
+#include <mutex>                  // std::mutex, std::unique_lock
+#include <new>                    // std::bad_alloc
+#include <sys/mman.h>             // mmap, mprotect, munmap, madvise
+#include <thread>                 // std::thread
+#include <tuple>                  // std::make_tuple
+#include <type_traits>            // std::is_void, std::true_type
+#include <unistd.h>               // sysconf
+#include <utility>                // std::move, std::forward
+#include <vector>                 // std::vector
+
+extern "C" {
+/*!
+ * \brief Saves the callee-saved registers of the calling context on its
+ *        stack, stores its stack pointer in *from and resumes the context
+ *        whose stack pointer is to.
+ **/
+void pl_thd_detail_switch_context(void** from, void* to);
+
+/*!
+ * \brief The first code a new fiber runs, calls r12(r13).
+ **/
+void pl_thd_detail_fiber_trampoline();
+}
+
+// The symbols are weak, so that every translation unit including this header
+// may define them.
+asm(R"(
+  .pushsection .text
+  .weak pl_thd_detail_switch_context
+  .type pl_thd_detail_switch_context, @function
+  .p2align 4
+pl_thd_detail_switch_context:
+  pushq %rbp
+  pushq %rbx
+  pushq %r12
+  pushq %r13
+  pushq %r14
+  pushq %r15
+  subq $8, %rsp
+  stmxcsr (%rsp)
+  fnstcw 4(%rsp)
+  movq %rsp, (%rdi)
+  movq %rsi, %rsp
+  ldmxcsr (%rsp)
+  fldcw 4(%rsp)
+  addq $8, %rsp
+  popq %r15
+  popq %r14
+  popq %r13
+  popq %r12
+  popq %rbx
+  popq %rbp
+  ret
+  .size pl_thd_detail_switch_context, .-pl_thd_detail_switch_context
+
+  .weak pl_thd_detail_fiber_trampoline
+  .type pl_thd_detail_fiber_trampoline, @function
+  .p2align 4
+pl_thd_detail_fiber_trampoline:
+  movq %r13, %rdi
+  callq *%r12
+  ud2
+  .size pl_thd_detail_fiber_trampoline, .-pl_thd_detail_fiber_trampoline
+  .popsection
+)");
+
+namespace pl {
+namespace thd {
+class fiber_scheduler;
+
+namespace detail {
+/*!
+ * \brief The memory of a fiber's stack. The lowest page is the guard page
+ *        if the stack has one.
+ **/
+struct fiber_stack {
+  void*       memory; //!< the beginning of the stack incl. guard page.
+  std::size_t size;   //!< the size of the stack including the guard page.
+};
+
+/*!
+ * \brief Maps the stacks of fibers and keeps the stacks of fibers that
+ *        have finished for reuse.
+ *
+ * A stack with a guard page is a mapping of its own, the guard page splits
+ * it into two memory mappings of the kernel. Stacks without a guard page
+ * are carved out of larger mappings of stacks_per_mapping stacks, so that
+ * vm.max_map_count doesn't limit the amount of fibers.
+ **/
+class fiber_stack_pool {
+public:
+  using this_type = fiber_stack_pool;
+
+  static constexpr std::size_t stacks_per_mapping{64U};
+
+  fiber_stack_pool(
+    std::size_t stack_size,
+    std::size_t max_cached,
+    bool        guard_pages)
+    : m_page_size{static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))}
+    , m_size{
+        ((stack_size + m_page_size - 1U) / m_page_size
+         + (guard_pages ? 1U : 0U))
+        * m_page_size}
+    , m_max_cached{max_cached}
+    , m_guard_pages{guard_pages}
+    , m_mutex{}
+    , m_cached{}
+    , m_mappings{}
+  {
+  }
+
+  fiber_stack_pool(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  ~fiber_stack_pool()
+  {
+    if (m_guard_pages) {
+      for (const fiber_stack& stack : m_cached) {
+        ::munmap(stack.memory, stack.size);
+      }
+    }
+
+    for (const fiber_stack& mapping : m_mappings) {
+      ::munmap(mapping.memory, mapping.size);
+    }
+  }
+
+  /*!
+   * \throws std::bad_alloc if no stack could be mapped.
+   **/
+  fiber_stack allocate()
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    if (!m_cached.empty()) {
+      const fiber_stack stack{m_cached.back()};
+      m_cached.pop_back();
+      return stack;
+    }
+
+    if (!m_guard_pages) {
+      return allocate_from_new_mapping();
+    }
+
+    lock.unlock();
+    void* const memory{map(m_size)};
+
+    // overflowing the stack faults instead of overwriting other memory.
+    if (::mprotect(memory, m_page_size, PROT_NONE) != 0) {
+      ::munmap(memory, m_size);
+      throw std::bad_alloc{};
+    }
+
+    return fiber_stack{memory, m_size};
+  }
+
+  void deallocate(fiber_stack stack) noexcept
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+
+    if (!m_guard_pages) {
+      // can't be unmapped on its own, but its memory can be released.
+      if (m_cached.size() >= m_max_cached) {
+        ::madvise(stack.memory, stack.size, MADV_DONTNEED);
+      }
+
+      // never reallocates, room for all the stacks has been reserved.
+      m_cached.push_back(stack);
+      return;
+    }
+
+    if (m_cached.size() < m_max_cached) {
+      try {
+        m_cached.push_back(stack);
+        return;
+      }
+      catch (const std::bad_alloc&) {
+        // unmap it instead.
+      }
+    }
+
+    ::munmap(stack.memory, stack.size);
+  }
+
+private:
+  /*!
+   * \throws std::bad_alloc if the memory could not be mapped.
+   **/
+  static void* map(std::size_t size)
+  {
+    void* const memory{::mmap(
+      nullptr,
+      size,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK,
+      -1,
+      0)};
+
+    if (memory == MAP_FAILED) {
+      throw std::bad_alloc{};
+    }
+
+    return memory;
+  }
+
+  /*!
+   * \brief Maps stacks_per_mapping stacks without guard pages, caches all
+   *        but the first one and returns that one.
+   * \warning m_mutex must be locked by the calling thread.
+   * \throws std::bad_alloc if the memory could not be mapped.
+   **/
+  fiber_stack allocate_from_new_mapping()
+  {
+    const std::size_t stack_count{
+      (m_mappings.size() + 1U) * stacks_per_mapping};
+    m_mappings.reserve(m_mappings.size() + 1U);
+    m_cached.reserve(stack_count);
+    const fiber_stack mapping{
+      map(m_size * stacks_per_mapping), m_size * stacks_per_mapping};
+    m_mappings.push_back(mapping);
+    char* const memory{static_cast<char*>(mapping.memory)};
+
+    for (std::size_t i{stacks_per_mapping - 1U}; i > 0U; --i) {
+      m_cached.push_back(fiber_stack{memory + i * m_size, m_size});
+    }
+
+    return fiber_stack{memory, m_size};
+  }
+
+  const std::size_t        m_page_size;   //!< the size of a page.
+  const std::size_t        m_size;        //!< size of a stack incl. guard.
+  const std::size_t        m_max_cached;  //!< stacks kept for reuse.
+  const bool               m_guard_pages; //!< whether stacks have a guard.
+  std::mutex               m_mutex;       //!< guards the vectors below.
+  std::vector<fiber_stack> m_cached;      //!< stacks to reuse.
+  std::vector<fiber_stack> m_mappings;    //!< the mappings of stacks.
+};
+
+/*!
+ * \brief What a worker does with a fiber that has switched back to it.
+ **/
+enum class fiber_action : std::uint8_t {
+  yield,   //!< schedule the fiber again.
+  suspend, //!< unlock fiber_context::unlock_after, the fiber is woken later.
+  finish   //!< destroy the fiber.
+};
+
+/*!
+ * \brief The state of a fiber.
+ **/
+class fiber_context {
+public:
+  using this_type = fiber_context;
+
+  fiber_context(
+    PL_INOUT fiber_scheduler& sched,
+    fiber_stack               stack,
+    unique_function<void()>   function)
+    : stack_pointer{nullptr}
+    , scheduler{&sched}
+    , stack_memory{stack}
+    , task{std::move(function)}
+    , action{fiber_action::yield}
+    , unlock_after{nullptr}
+  {
+  }
+
+  fiber_context(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  void*                   stack_pointer; //!< saved while not running.
+  fiber_scheduler*        scheduler;     //!< the scheduler running it.
+  fiber_stack             stack_memory;  //!< the stack of the fiber.
+  unique_function<void()> task;          //!< what the fiber runs.
+  fiber_action            action;        //!< set before switching away.
+  std::unique_lock<std::mutex>*
+    unlock_after; //!< unlocked once the fiber has been suspended.
+};
+
+/*!
+ * \brief A thread of a fiber_scheduler with its queue of ready fibers.
+ **/
+class fiber_worker {
+public:
+  using this_type = fiber_worker;
+
+  fiber_worker(PL_INOUT fiber_scheduler& sched, std::size_t idx)
+    : scheduler{&sched}
+    , index{idx}
+    , mutex{}
+    , ready{}
+    , stack_pointer{nullptr}
+    , current{nullptr}
+    , thread{}
+  {
+  }
+
+  fiber_worker(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  fiber_scheduler* const     scheduler;     //!< the scheduler owning it.
+  const std::size_t          index;         //!< index in the scheduler.
+  std::mutex                 mutex;         //!< guards ready.
+  std::deque<fiber_context*> ready;         //!< fibers ready to run.
+  void*                      stack_pointer; //!< saved while running a fiber.
+  fiber_context*             current;       //!< the fiber being run.
+  std::thread                thread;        //!< the thread of the worker.
+};
+
+/*!
+ * \brief Returns the worker of the calling thread, nullptr if it isn't a
+ *        worker.
+ * \note Neither inlined nor free of side effects, so that the compiler
+ *       can't reuse the address of the thread_local computed before a fiber
+ *       was suspended after it resumed on another thread.
+ **/
+__attribute__((noinline)) inline fiber_worker*& current_fiber_worker() noexcept
+{
+  static thread_local fiber_worker* worker{nullptr};
+  asm volatile("" ::: "memory");
+  return worker;
+}
+
+/*!
+ * \brief Returns the fiber being run by the calling thread, nullptr if the
+ *        calling thread isn't running a fiber.
+ **/
+inline fiber_context* current_fiber() noexcept
+{
+  fiber_worker* const worker{current_fiber_worker()};
+  return worker == nullptr ? nullptr : worker->current;
+}
+
+/*!
+ * \brief Accesses the internals of fiber_scheduler.
+ **/
+class fiber_runtime {
+public:
+  static void yield(PL_INOUT fiber_context& fiber);
+
+  static void suspend(
+    PL_INOUT fiber_context& fiber,
+    PL_INOUT std::unique_lock<std::mutex>& lock);
+
+  static void wake(PL_INOUT fiber_context& fiber);
+};
+
+/*!
+ * \brief A fiber or thread waiting in a fiber_wait_queue. Lives on the
+ *        stack of the waiting fiber or thread.
+ **/
+class fiber_waiter {
+public:
+  using this_type = fiber_waiter;
+
+  fiber_waiter()
+    : m_fiber{current_fiber()}, m_mutex{}, m_cv{}, m_is_woken{false}
+  {
+  }
+
+  fiber_waiter(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Suspends the calling fiber, or blocks the calling thread if it
+   *        isn't running a fiber, until wake is called.
+   * \param lock The locked lock guarding the queue this waiter is in.
+   *             Unlocked while waiting and locked again before returning.
+   **/
+  void wait(PL_INOUT std::unique_lock<std::mutex>& lock)
+  {
+    if (m_fiber != nullptr) {
+      fiber_runtime::suspend(*m_fiber, lock);
+    }
+    else {
+      lock.unlock();
+      std::unique_lock<std::mutex> own_lock{m_mutex};
+      m_cv.wait(own_lock, [this] { return m_is_woken; });
+    }
+
+    lock.lock();
+  }
+
+  /*!
+   * \brief Resumes the waiting fiber or thread.
+   * \warning The lock passed to wait must be held by the calling thread.
+   **/
+  void wake()
+  {
+    if (m_fiber != nullptr) {
+      fiber_runtime::wake(*m_fiber);
+      return;
+    }
+
+    std::lock_guard<std::mutex> own_lock{m_mutex};
+    (void)own_lock;
+    m_is_woken = true;
+    m_cv.notify_one();
+  }
+
+private:
+  fiber_context* const    m_fiber;    //!< the fiber, nullptr if a thread.
+  std::mutex              m_mutex;    //!< to block a thread.
+  std::condition_variable m_cv;       //!< to block a thread.
+  bool                    m_is_woken; //!< whether a thread was woken.
+};
+
+/*!
+ * \brief Fibers and threads waiting for something guarded by a std::mutex.
+ **/
+class fiber_wait_queue {
+public:
+  using this_type = fiber_wait_queue;
+
+  fiber_wait_queue() : m_waiters{}
+  {
+  }
+
+  fiber_wait_queue(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Waits until notified.
+   * \param lock The locked lock guarding this queue.
+   **/
+  void wait(PL_INOUT std::unique_lock<std::mutex>& lock)
+  {
+    fiber_waiter waiter{};
+    m_waiters.push_back(&waiter);
+    waiter.wait(lock);
+  }
+
+  /*!
+   * \brief Wakes the waiter that has been waiting the longest.
+   * \warning The lock guarding this queue must be held.
+   **/
+  void notify_one()
+  {
+    if (!m_waiters.empty()) {
+      fiber_waiter* const waiter{m_waiters.front()};
+      m_waiters.pop_front();
+      waiter->wake();
+    }
+  }
+
+  /*!
+   * \brief Wakes all the waiters.
+   * \warning The lock guarding this queue must be held.
+   **/
+  void notify_all()
+  {
+    while (!m_waiters.empty()) {
+      notify_one();
+    }
+  }
+
+private:
+  std::deque<fiber_waiter*> m_waiters; //!< in the order they began waiting.
+};
+
+/*!
+ * \brief The value stored for a fiber_future<void>.
+ **/
+struct fiber_unit {
+};
+
+/*!
+ * \brief The state shared by a fiber_promise and its fiber_future.
+ **/
+template<typename Ty>
+class fiber_shared_state {
+public:
+  using this_type    = fiber_shared_state;
+  using storage_type
+    = std::conditional_t<std::is_void<Ty>::value, fiber_unit, Ty>;
+
+  fiber_shared_state()
+    : m_mutex{}, m_is_ready{false}, m_value{}, m_exception{}, m_waiters{}
+  {
+  }
+
+  fiber_shared_state(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  void set_value(std::unique_ptr<storage_type> value)
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    throw_if_ready();
+    m_value    = std::move(value);
+    m_is_ready = true;
+    m_waiters.notify_all();
+  }
+
+  void set_exception(std::exception_ptr exception)
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    throw_if_ready();
+    m_exception = std::move(exception);
+    m_is_ready  = true;
+    m_waiters.notify_all();
+  }
+
+  void abandon()
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+
+    if (!m_is_ready) {
+      m_exception = std::make_exception_ptr(
+        std::future_error{std::future_errc::broken_promise});
+      m_is_ready = true;
+      m_waiters.notify_all();
+    }
+  }
+
+  PL_NODISCARD bool is_ready() const
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    return m_is_ready;
+  }
+
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    while (!m_is_ready) {
+      m_waiters.wait(lock);
+    }
+  }
+
+  /*!
+   * \warning Must be ready.
+   **/
+  storage_type& value()
+  {
+    if (m_exception != nullptr) {
+      std::rethrow_exception(m_exception);
+    }
+
+    return *m_value;
+  }
+
+private:
+  void throw_if_ready() const
+  {
+    if (m_is_ready) {
+      throw std::future_error{std::future_errc::promise_already_satisfied};
+    }
+  }
+
+  mutable std::mutex            m_mutex;     //!< guards the other members.
+  bool                          m_is_ready;  //!< whether a result is set.
+  std::unique_ptr<storage_type> m_value;     //!< the value, if any.
+  std::exception_ptr            m_exception; //!< the exception, if any.
+  fiber_wait_queue              m_waiters;   //!< waiting for the result.
+};
+} // namespace detail
+
+/*!
+ * \brief The result of a fiber, can be waited for by fibers without blocking
+ *        their thread as well as by threads.
+ * \tparam Ty The type of the result.
+ **/
+template<typename Ty>
+class fiber_future {
+public:
+  using this_type  = fiber_future;
+  using value_type = Ty;
+
+  /*!
+   * \brief Creates an invalid fiber_future.
+   **/
+  fiber_future() noexcept : m_state{}
+  {
+  }
+
+  /*!
+   * \brief Creates a fiber_future referring to a shared state.
+   * \param state The shared state.
+   **/
+  explicit fiber_future(
+    std::shared_ptr<detail::fiber_shared_state<Ty>> state) noexcept
+    : m_state{std::move(state)}
+  {
+  }
+
+  /*!
+   * \brief Queries whether this fiber_future refers to a shared state.
+   * \return true if get may be called; otherwise false.
+   **/
+  PL_NODISCARD bool valid() const noexcept
+  {
+    return m_state != nullptr;
+  }
+
+  /*!
+   * \brief Queries whether the result is available.
+   * \return true if get won't wait; otherwise false.
+   * \warning Must be valid.
+   **/
+  PL_NODISCARD bool is_ready() const
+  {
+    PL_CHECK_PRE(valid());
+    return m_state->is_ready();
+  }
+
+  /*!
+   * \brief Waits until the result is available. Suspends the calling fiber
+   *        if called by a fiber; otherwise blocks the calling thread.
+   * \warning Must be valid.
+   **/
+  void wait() const
+  {
+    PL_CHECK_PRE(valid());
+    m_state->wait();
+  }
+
+  /*!
+   * \brief Waits for the result and returns it. Suspends the calling fiber
+   *        if called by a fiber; otherwise blocks the calling thread.
+   * \return The result.
+   * \throws The exception stored instead of a result.
+   * \warning Must be valid, will be invalid afterwards.
+   **/
+  value_type get()
+  {
+    PL_CHECK_PRE(valid());
+    const std::shared_ptr<detail::fiber_shared_state<Ty>> state{
+      std::move(m_state)};
+    state->wait();
+    return take(*state, std::is_void<Ty>{});
+  }
+
+private:
+  static value_type take(
+    PL_INOUT detail::fiber_shared_state<Ty>& state,
+    std::false_type)
+  {
+    return std::move(state.value());
+  }
+
+  static void take(
+    PL_INOUT detail::fiber_shared_state<Ty>& state,
+    std::true_type)
+  {
+    (void)state.value();
+  }
+
+  std::shared_ptr<detail::fiber_shared_state<Ty>> m_state; //!< the state.
+};
+
+/*!
+ * \brief Stores a result to be retrieved through a fiber_future.
+ * \tparam Ty The type of the result.
+ * \note Destroying a fiber_promise without setting a result stores a
+ *       std::future_error with std::future_errc::broken_promise.
+ **/
+template<typename Ty>
+class fiber_promise {
+public:
+  using this_type  = fiber_promise;
+  using value_type = Ty;
+
+  /*!
+   * \brief Creates a fiber_promise with a new shared state.
+   **/
+  fiber_promise()
+    : m_state{std::make_shared<detail::fiber_shared_state<Ty>>()}
+    , m_is_future_retrieved{false}
+  {
+  }
+
+  /*!
+   * \brief Takes over the shared state of other.
+   * \param other The fiber_promise to move from.
+   **/
+  fiber_promise(this_type&& other) noexcept
+    : m_state{std::move(other.m_state)}
+    , m_is_future_retrieved{other.m_is_future_retrieved}
+  {
+  }
+
+  /*!
+   * \brief Abandons the shared state and takes over the one of other.
+   * \param other The fiber_promise to move from.
+   * \return *this
+   **/
+  this_type& operator=(this_type&& other) noexcept
+  {
+    this_type{std::move(other)}.swap(*this);
+    return *this;
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  fiber_promise(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Stores a broken_promise error if no result has been set.
+   **/
+  ~fiber_promise()
+  {
+    if (m_state != nullptr) {
+      m_state->abandon();
+    }
+  }
+
+  /*!
+   * \brief Swaps this fiber_promise with other.
+   * \param other The fiber_promise to swap with.
+   **/
+  void swap(PL_INOUT this_type& other) noexcept
+  {
+    m_state.swap(other.m_state);
+    std::swap(m_is_future_retrieved, other.m_is_future_retrieved);
+  }
+
+  /*!
+   * \brief Returns the fiber_future to retrieve the result with.
+   * \return The fiber_future.
+   * \throws std::future_error if it has already been retrieved.
+   **/
+  PL_NODISCARD fiber_future<Ty> get_future()
+  {
+    if (m_is_future_retrieved) {
+      throw std::future_error{std::future_errc::future_already_retrieved};
+    }
+
+    m_is_future_retrieved = true;
+    return fiber_future<Ty>{m_state};
+  }
+
+  /*!
+   * \brief Stores the result and wakes the fibers and threads waiting for
+   *        it.
+   * \param args The arguments to construct the result from, none for
+   *             fiber_promise<void>.
+   * \throws std::future_error if a result has already been set.
+   **/
+  template<typename... Args>
+  void set_value(Args&&... args)
+  {
+    m_state->set_value(
+      std::make_unique<typename detail::fiber_shared_state<Ty>::storage_type>(
+        std::forward<Args>(args)...));
+  }
+
+  /*!
+   * \brief Stores an exception instead of a result.
+   * \param exception The exception.
+   * \throws std::future_error if a result has already been set.
+   **/
+  void set_exception(std::exception_ptr exception)
+  {
+    m_state->set_exception(std::move(exception));
+  }
+
+private:
+  std::shared_ptr<detail::fiber_shared_state<Ty>> m_state; //!< the state.
+  bool m_is_future_retrieved; //!< whether get_future has been called.
+};
+
+/*!
+ * \brief Runs fibers on a fixed set of threads.
+ *
+ * Every thread has a double ended queue of fibers that are ready to run.
+ * A thread runs the fibers it made ready itself most recently first and
+ * steals the oldest fiber of another thread when its own queue is empty.
+ * Threads that find no fiber to run sleep until a fiber is made ready.
+ *
+ * A fiber runs on a stack of its own that is mapped with a guard page below
+ * it by default, so that a stack overflow faults. The stacks of finished
+ * fibers are kept for reuse.
+ *
+ * \note Every stack with a guard page takes two of the memory mappings of
+ *       the process, which Linux limits to vm.max_map_count (65530 by
+ *       default), so at most about 32000 fibers with guard pages can exist
+ *       at the same time. Raise the limit with
+ *       sysctl -w vm.max_map_count=<count> or construct the
+ *       fiber_scheduler without guard pages for more fibers.
+ *
+ * A fiber that waits for a fiber_mutex, a fiber_condition_variable or a
+ * fiber_future is suspended and its thread runs other fibers, so that many
+ * more fibers than threads can wait at the same time.
+ * \warning A fiber may resume on a different thread after it has been
+ *          suspended, so it must not hold a std::mutex or other thread
+ *          affine state, such as the exception being handled in a catch
+ *          block, across calls that may suspend it.
+ **/
+class fiber_scheduler {
+public:
+  using this_type = fiber_scheduler;
+
+  /*!
+   * \brief The default size of the stack of a fiber in bytes.
+   **/
+  static constexpr std::size_t default_stack_size{64U * 1024U};
+
+  /*!
+   * \brief Creates a fiber_scheduler and its threads.
+   * \param thread_count The amount of threads running fibers. Must not be
+   *                     0.
+   * \param stack_size The size of the stack of every fiber in bytes,
+   *                   rounded up to whole pages.
+   * \param guard_pages Whether every stack gets a guard page below it,
+   *                    which makes a stack overflow fault rather than
+   *                    overwrite other memory, but limits the amount of
+   *                    fibers by vm.max_map_count.
+   **/
+  explicit fiber_scheduler(
+    std::size_t thread_count = std::thread::hardware_concurrency(),
+    std::size_t stack_size   = default_stack_size,
+    bool        guard_pages  = true);
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  fiber_scheduler(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Waits for all the fibers to finish and joins the threads.
+   * \warning Blocks forever if a fiber never finishes.
+   **/
+  ~fiber_scheduler();
+
+  /*!
+   * \brief Runs task with args in a new fiber.
+   * \param task The callable to run.
+   * \param args The arguments to call task with.
+   * \return A fiber_future to the result of calling task, holds the
+   *         exception if task throws.
+   * \throws std::bad_alloc if no stack could be allocated.
+   **/
+  template<typename Callable, typename... Args>
+  PL_NODISCARD auto spawn(Callable&& task, Args&&... args)
+  {
+    auto invoker
+      = [t   = std::forward<Callable>(task),
+         tup = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+          return ::pl::apply(std::move(t), std::move(tup));
+        };
+
+    using ret = decltype(invoker());
+
+    fiber_promise<ret> promise{};
+    fiber_future<ret>  future{promise.get_future()};
+    launch([p = std::move(promise), inv = std::move(invoker)]() mutable {
+      try {
+        fulfil(p, inv, std::is_void<ret>{});
+      }
+      catch (...) {
+        p.set_exception(std::current_exception());
+      }
+    });
+    return future;
+  }
+
+  /*!
+   * \brief Queries the amount of threads.
+   * \return The amount of threads running fibers.
+   **/
+  PL_NODISCARD std::size_t thread_count() const noexcept
+  {
+    return m_workers.size();
+  }
+
+  /*!
+   * \brief Queries the amount of fibers that haven't finished yet.
+   * \return The amount of fibers.
+   **/
+  PL_NODISCARD std::size_t fiber_count() const
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    return m_fiber_count;
+  }
+
+private:
+  friend class detail::fiber_runtime;
+
+  template<typename Ret, typename Invoker>
+  static void fulfil(
+    PL_INOUT fiber_promise<Ret>& promise,
+    PL_INOUT Invoker&            invoker,
+    std::false_type)
+  {
+    promise.set_value(invoker());
+  }
+
+  template<typename Ret, typename Invoker>
+  static void fulfil(
+    PL_INOUT fiber_promise<Ret>& promise,
+    PL_INOUT Invoker&            invoker,
+    std::true_type)
+  {
+    invoker();
+    promise.set_value();
+  }
+
+  /*!
+   * \brief Creates a fiber running task and makes it ready.
+   **/
+  void launch(unique_function<void()> task);
+
+  /*!
+   * \brief Adds fiber to the queue of the calling thread if it is one of
+   *        the threads of this scheduler, otherwise to the queue of one of
+   *        the threads, and wakes a sleeping thread.
+   **/
+  void schedule(PL_INOUT detail::fiber_context& fiber);
+
+  /*!
+   * \brief Takes a fiber from the queue of worker or steals one.
+   * \return The fiber taken, nullptr if all the queues are empty.
+   **/
+  detail::fiber_context* take(PL_INOUT detail::fiber_worker& worker);
+
+  /*!
+   * \brief Runs fiber until it switches back and handles its action.
+   **/
+  void run(
+    PL_INOUT detail::fiber_worker& worker,
+    PL_INOUT detail::fiber_context& fiber);
+
+  /*!
+   * \brief The function the threads run.
+   **/
+  void worker_function(PL_INOUT detail::fiber_worker& worker);
+
+  /*!
+   * \brief Switches from the running fiber back to its thread.
+   **/
+  static void switch_to_worker(PL_INOUT detail::fiber_context& fiber);
+
+  /*!
+   * \brief The function a new fiber starts running.
+   **/
+  static void fiber_entry(void* fiber) noexcept;
+
+  detail::fiber_stack_pool m_stacks; //!< the stacks of the fibers.
+  std::vector<std::unique_ptr<detail::fiber_worker>>
+                           m_workers;     //!< the threads.
+  std::atomic<std::size_t> m_ready_count; //!< fibers in the queues.
+  std::atomic<std::size_t> m_sleeping;    //!< threads waiting in m_cv_work.
+  std::atomic<std::size_t> m_next_worker; //!< for scheduling from outside.
+  mutable std::mutex       m_mutex;       //!< guards the members below.
+  std::condition_variable  m_cv_work;     //!< wakes sleeping threads.
+  std::condition_variable  m_cv_done;     //!< notified when no fibers are left.
+  std::size_t              m_fiber_count; //!< the fibers not yet finished.
+  bool                     m_is_stopping; //!< set by the destructor.
+};
+
+namespace detail {
+inline void fiber_runtime::yield(PL_INOUT fiber_context& fiber)
+{
+  fiber.action = fiber_action::yield;
+  fiber_scheduler::switch_to_worker(fiber);
+}
+
+inline void fiber_runtime::suspend(
+  PL_INOUT fiber_context& fiber,
+  PL_INOUT std::unique_lock<std::mutex>& lock)
+{
+  fiber.action       = fiber_action::suspend;
+  fiber.unlock_after = &lock;
+  fiber_scheduler::switch_to_worker(fiber);
+}
+
+inline void fiber_runtime::wake(PL_INOUT fiber_context& fiber)
+{
+  fiber.scheduler->schedule(fiber);
+}
+} // namespace detail
+
+inline fiber_scheduler::fiber_scheduler(
+  std::size_t thread_count,
+  std::size_t stack_size,
+  bool        guard_pages)
+  : m_stacks{stack_size, 1024U, guard_pages}
+  , m_workers{}
+  , m_ready_count{0U}
+  , m_sleeping{0U}
+  , m_next_worker{0U}
+  , m_mutex{}
+  , m_cv_work{}
+  , m_cv_done{}
+  , m_fiber_count{0U}
+  , m_is_stopping{false}
+{
+  PL_CHECK_PRE(thread_count != 0U);
+
+  for (std::size_t i{0U}; i < thread_count; ++i) {
+    m_workers.push_back(std::make_unique<detail::fiber_worker>(*this, i));
+  }
+
+  try {
+    for (const std::unique_ptr<detail::fiber_worker>& worker : m_workers) {
+      worker->thread = std::thread{
+        &fiber_scheduler::worker_function, this, std::ref(*worker)};
+    }
+  }
+  catch (...) {
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      (void)lock;
+      m_is_stopping = true;
+    }
+
+    m_cv_work.notify_all();
+
+    for (const std::unique_ptr<detail::fiber_worker>& worker : m_workers) {
+      if (worker->thread.joinable()) {
+        worker->thread.join();
+      }
+    }
+
+    throw;
+  }
+}
+
+inline fiber_scheduler::~fiber_scheduler()
+{
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cv_done.wait(lock, [this] { return m_fiber_count == 0U; });
+    m_is_stopping = true;
+  }
+
+  m_cv_work.notify_all();
+
+  for (const std::unique_ptr<detail::fiber_worker>& worker : m_workers) {
+    worker->thread.join();
+  }
+}
+
+inline void fiber_scheduler::launch(unique_function<void()> task)
+{
+  const detail::fiber_stack stack{m_stacks.allocate()};
+  detail::fiber_context*    fiber{nullptr};
+
+  try {
+    fiber = new detail::fiber_context{*this, stack, std::move(task)};
+  }
+  catch (...) {
+    m_stacks.deallocate(stack);
+    throw;
+  }
+
+  // the initial frame, as if pl_thd_detail_switch_context had been called
+  // by pl_thd_detail_fiber_trampoline, which then calls fiber_entry(fiber).
+  std::uintptr_t* top{reinterpret_cast<std::uintptr_t*>(
+    static_cast<char*>(stack.memory) + stack.size)};
+  *--top = reinterpret_cast<std::uintptr_t>(&pl_thd_detail_fiber_trampoline);
+  *--top = 0U; // rbp
+  *--top = 0U; // rbx
+  // r12, called with r13 by the trampoline.
+  *--top = reinterpret_cast<std::uintptr_t>(&fiber_scheduler::fiber_entry);
+  *--top = reinterpret_cast<std::uintptr_t>(fiber); // r13
+  *--top = 0U;                                      // r14
+  *--top = 0U;                                      // r15
+  // the default MXCSR and x87 control word.
+  *--top = std::uintptr_t{0x1F80U} | (std::uintptr_t{0x037FU} << 32U);
+  fiber->stack_pointer = top;
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    ++m_fiber_count;
+  }
+
+  schedule(*fiber);
+}
+
+inline void fiber_scheduler::schedule(PL_INOUT detail::fiber_context& fiber)
+{
+  detail::fiber_worker* worker{detail::current_fiber_worker()};
+
+  if ((worker == nullptr) || (worker->scheduler != this)) {
+    worker = m_workers[m_next_worker.fetch_add(1U, std::memory_order_relaxed)
+                       % m_workers.size()]
+               .get();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{worker->mutex};
+    (void)lock;
+    worker->ready.push_back(&fiber);
+  }
+
+  // pairs with the sleeping thread incrementing m_sleeping before checking
+  // m_ready_count, so that either this thread notifies it or it sees the
+  // fiber.
+  m_ready_count.fetch_add(1U, std::memory_order_seq_cst);
+
+  if (m_sleeping.load(std::memory_order_seq_cst) != 0U) {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    m_cv_work.notify_one();
+  }
+}
+
+inline detail::fiber_context* fiber_scheduler::take(
+  PL_INOUT detail::fiber_worker& worker)
+{
+  {
+    std::lock_guard<std::mutex> lock{worker.mutex};
+    (void)lock;
+
+    if (!worker.ready.empty()) {
+      detail::fiber_context* const fiber{worker.ready.back()};
+      worker.ready.pop_back();
+      m_ready_count.fetch_sub(1U, std::memory_order_relaxed);
+      return fiber;
+    }
+  }
+
+  for (std::size_t i{1U}; i < m_workers.size(); ++i) {
+    detail::fiber_worker& victim{
+      *m_workers[(worker.index + i) % m_workers.size()]};
+    std::lock_guard<std::mutex> lock{victim.mutex};
+    (void)lock;
+
+    if (!victim.ready.empty()) {
+      detail::fiber_context* const fiber{victim.ready.front()};
+      victim.ready.pop_front();
+      m_ready_count.fetch_sub(1U, std::memory_order_relaxed);
+      return fiber;
+    }
+  }
+
+  return nullptr;
+}
+
+inline void fiber_scheduler::run(
+  PL_INOUT detail::fiber_worker& worker,
+  PL_INOUT detail::fiber_context& fiber)
+{
+  worker.current = &fiber;
+  pl_thd_detail_switch_context(&worker.stack_pointer, fiber.stack_pointer);
+  worker.current = nullptr;
+
+  switch (fiber.action) {
+  case detail::fiber_action::yield:
+    schedule(fiber);
+    break;
+  case detail::fiber_action::suspend: {
+    // the context of the fiber is saved, it may be woken from now on.
+    std::unique_lock<std::mutex>* const lock{fiber.unlock_after};
+    fiber.unlock_after = nullptr;
+    lock->unlock();
+    break;
+  }
+  case detail::fiber_action::finish:
+    m_stacks.deallocate(fiber.stack_memory);
+    delete &fiber;
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      (void)lock;
+
+      if (--m_fiber_count == 0U) {
+        m_cv_done.notify_all();
+      }
+    }
+
+    break;
+  }
+}
+
+inline void fiber_scheduler::worker_function(
+  PL_INOUT detail::fiber_worker& worker)
+{
+  detail::current_fiber_worker() = &worker;
+
+  for (;;) {
+    detail::fiber_context* const fiber{take(worker)};
+
+    if (fiber != nullptr) {
+      run(worker, *fiber);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_sleeping.fetch_add(1U, std::memory_order_seq_cst);
+    m_cv_work.wait(lock, [this] {
+      return m_is_stopping
+             || (m_ready_count.load(std::memory_order_seq_cst) != 0U);
+    });
+    m_sleeping.fetch_sub(1U, std::memory_order_relaxed);
+
+    if (m_is_stopping) {
+      return;
+    }
+  }
+}
+
+inline void fiber_scheduler::switch_to_worker(
+  PL_INOUT detail::fiber_context& fiber)
+{
+  pl_thd_detail_switch_context(
+    &fiber.stack_pointer, detail::current_fiber_worker()->stack_pointer);
+}
+
+inline void fiber_scheduler::fiber_entry(void* fiber) noexcept
+{
+  detail::fiber_context& context{*static_cast<detail::fiber_context*>(fiber)};
+  context.task();
+  context.task = nullptr; // destroy the task on the stack of the fiber.
+  context.action = detail::fiber_action::finish;
+  switch_to_worker(context);
+}
+
+/*!
+ * \brief A mutex that suspends the calling fiber instead of blocking its
+ *        thread while waiting. Can also be used by threads that aren't
+ *        running a fiber.
+ **/
+class fiber_mutex {
+public:
+  using this_type = fiber_mutex;
+
+  /*!
+   * \brief Creates an unlocked fiber_mutex.
+   **/
+  fiber_mutex() : m_mutex{}, m_is_locked{false}, m_waiters{}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  fiber_mutex(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Locks the mutex, waiting until it is unlocked if necessary.
+   **/
+  void lock()
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    while (m_is_locked) {
+      m_waiters.wait(lock);
+    }
+
+    m_is_locked = true;
+  }
+
+  /*!
+   * \brief Locks the mutex if it is unlocked.
+   * \return true if the mutex was locked; otherwise false.
+   **/
+  bool try_lock()
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+
+    if (m_is_locked) {
+      return false;
+    }
+
+    m_is_locked = true;
+    return true;
+  }
+
+  /*!
+   * \brief Unlocks the mutex and wakes a waiting fiber or thread.
+   * \note Unlike std::mutex a fiber_mutex may be unlocked by another fiber
+   *       or thread than the one that locked it.
+   **/
+  void unlock()
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    m_is_locked = false;
+    m_waiters.notify_one();
+  }
+
+private:
+  std::mutex               m_mutex;     //!< guards the other members.
+  bool                     m_is_locked; //!< whether it is locked.
+  detail::fiber_wait_queue m_waiters;   //!< waiting to lock it.
+};
+
+/*!
+ * \brief A condition variable for fiber_mutex that suspends the calling
+ *        fiber instead of blocking its thread. Can also be used by threads
+ *        that aren't running a fiber.
+ **/
+class fiber_condition_variable {
+public:
+  using this_type = fiber_condition_variable;
+
+  /*!
+   * \brief Creates a fiber_condition_variable.
+   **/
+  fiber_condition_variable() : m_mutex{}, m_waiters{}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  fiber_condition_variable(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Unlocks lock, waits until notified and locks lock again.
+   * \param lock The locked lock.
+   **/
+  void wait(PL_INOUT std::unique_lock<fiber_mutex>& lock)
+  {
+    std::unique_lock<std::mutex> own_lock{m_mutex};
+    lock.unlock();
+    m_waiters.wait(own_lock);
+    own_lock.unlock();
+    lock.lock();
+  }
+
+  /*!
+   * \brief Waits until predicate returns true.
+   * \param lock The locked lock.
+   * \param predicate Called with lock locked.
+   **/
+  template<typename Predicate>
+  void wait(PL_INOUT std::unique_lock<fiber_mutex>& lock, Predicate predicate)
+  {
+    while (!predicate()) {
+      wait(lock);
+    }
+  }
+
+  /*!
+   * \brief Wakes one waiting fiber or thread.
+   **/
+  void notify_one()
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    m_waiters.notify_one();
+  }
+
+  /*!
+   * \brief Wakes all the waiting fibers and threads.
+   **/
+  void notify_all()
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    m_waiters.notify_all();
+  }
+
+private:
+  std::mutex               m_mutex;   //!< guards m_waiters.
+  detail::fiber_wait_queue m_waiters; //!< the waiting fibers and threads.
+};
+
+/*!
+ * \brief A handle to a fiber, similar to std::thread.
+ **/
+class fiber {
+public:
+  using this_type = fiber;
+
+  /*!
+   * \brief Creates a fiber object that doesn't refer to a fiber.
+   **/
+  fiber() noexcept : m_done{}
+  {
+  }
+
+  /*!
+   * \brief Runs task with args in a new fiber on scheduler.
+   * \param scheduler The fiber_scheduler to run the fiber on.
+   * \param task The callable to run.
+   * \param args The arguments to call task with.
+   **/
+  template<typename Callable, typename... Args>
+  fiber(PL_INOUT fiber_scheduler& scheduler, Callable&& task, Args&&... args)
+    : m_done{scheduler.spawn(
+      [t   = std::forward<Callable>(task),
+       tup = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+        ::pl::apply(std::move(t), std::move(tup));
+      })}
+  {
+  }
+
+  /*!
+   * \brief This type is move-only.
+   **/
+  fiber(this_type&&) noexcept = default;
+
+  /*!
+   * \brief This type is move-only.
+   **/
+  this_type& operator=(this_type&& other) noexcept
+  {
+    if (joinable()) {
+      m_done.wait();
+    }
+
+    m_done = std::move(other.m_done);
+    return *this;
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  fiber(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Waits for the fiber to finish if it is joinable.
+   **/
+  ~fiber()
+  {
+    if (joinable()) {
+      m_done.wait();
+    }
+  }
+
+  /*!
+   * \brief Queries whether this object refers to a fiber.
+   * \return true if join may be called; otherwise false.
+   **/
+  PL_NODISCARD bool joinable() const noexcept
+  {
+    return m_done.valid();
+  }
+
+  /*!
+   * \brief Waits for the fiber to finish. Suspends the calling fiber if
+   *        called by a fiber; otherwise blocks the calling thread.
+   * \throws The exception that escaped the function run by the fiber.
+   * \warning Must be joinable.
+   **/
+  void join()
+  {
+    m_done.get();
+  }
+
+  /*!
+   * \brief Lets the fiber run on its own.
+   * \warning Must be joinable.
+   **/
+  void detach()
+  {
+    PL_CHECK_PRE(joinable());
+    m_done = fiber_future<void>{};
+  }
+
+private:
+  fiber_future<void> m_done; //!< ready once the fiber has finished.
+};
+
+namespace this_fiber {
+/*!
+ * \brief Queries whether the calling code is run by a fiber.
+ * \return true if called by a fiber; otherwise false.
+ **/
+PL_NODISCARD inline bool is_fiber() noexcept
+{
+  return detail::current_fiber() != nullptr;
+}
+
+/*!
+ * \brief Lets the thread of the calling fiber run other fibers. Calls
+ *        std::this_thread::yield if not called by a fiber.
+ **/
+inline void yield()
+{
+  detail::fiber_context* const fiber{detail::current_fiber()};
+
+  if (fiber == nullptr) {
+    std::this_thread::yield();
+    return;
+  }
+
+  detail::fiber_runtime::yield(*fiber);
+}
+} // namespace this_fiber
+} // namespace thd
+} // namespace pl
+#endif // PL_THD_HAS_FIBERS
+#endif // INCG_PL_THD_FIBER_HPP
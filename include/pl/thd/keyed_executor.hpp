@@ -0,0 +1,277 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file keyed_executor.hpp
+ * \brief Defines the keyed_executor class template that runs tasks with the
+ *        same key one after another and tasks with different keys
+ *        concurrently on a thread_pool.
+ **/
+#ifndef INCG_PL_THD_KEYED_EXECUTOR_HPP
+#define INCG_PL_THD_KEYED_EXECUTOR_HPP
+#include "../annotations.hpp"     // PL_IN, PL_INOUT, PL_NODISCARD
+#include "../apply.hpp"           // pl::apply
+#include "../assert.hpp"          // PL_CHECK_PRE
+#include "../hash.hpp"            // pl::hash
+#include "../unique_function.hpp" // pl::unique_function
+#include "thread_pool.hpp"        // pl::thd::thread_pool
+#include <condition_variable>     // std::condition_variable
+#include <cstddef>                // std::size_t
+#include <cstdint>                // std::uint8_t
+#include <deque>                  // std::deque
+#include <future>                 // std::future, std::packaged_task
+#include <memory>                 // std::unique_ptr, std::make_unique
+#include <mutex> // std::mutex, std::unique_lock, std::lock_guard
+#include <tuple>                  // std::make_tuple
+#include <unordered_map>          // std::unordered_map
+#include <utility>                // std::move, std::forward
+
+namespace pl {
+namespace thd {
+/*!
+ * \brief Runs tasks on a thread_pool. Tasks added with the same key are run
+ *        one after another in the order they were added, tasks added with
+ *        different keys may run concurrently.
+ * \tparam Key The type of the keys. Must be equality comparable and
+ *             std::hash must be specialized for it.
+ *
+ * Every key that has tasks waiting or running has a mailbox. A single
+ * task of the thread_pool works through the mailbox of a key and the
+ * mailbox is removed as soon as it becomes empty, so only the keys that
+ * currently have work occupy memory. The mailboxes are spread across
+ * independently locked stripes by the keys' pl::hash values, and no lock is
+ * held while a task runs.
+ **/
+template<typename Key>
+class keyed_executor {
+public:
+  using this_type = keyed_executor;
+  using key_type  = Key;
+
+  /*!
+   * \brief Creates a keyed_executor.
+   * \param pool The thread_pool to run the tasks on. Must outlive the
+   *             keyed_executor.
+   * \param stripe_count The amount of independently locked partitions
+   *                     of the keys. Must not be 0.
+   **/
+  explicit keyed_executor(
+    PL_INOUT thread_pool& pool,
+    std::size_t           stripe_count = 16U)
+    : m_pool{pool}
+    , m_stripe_count{stripe_count}
+    , m_stripes{std::make_unique<stripe[]>(stripe_count)}
+    , m_mutex{}
+    , m_cv_idle{}
+    , m_active_keys{0U}
+  {
+    PL_CHECK_PRE(stripe_count != 0U);
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  keyed_executor(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Destroys the keyed_executor.
+   * \warning Blocks until all of the tasks added have been run.
+   **/
+  ~keyed_executor()
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cv_idle.wait(lock, [this] { return m_active_keys == 0U; });
+  }
+
+  /*!
+   * \brief Adds a task to be called with the arguments passed to the
+   *        mailbox of key.
+   * \param key The key. Tasks with the same key are run one after another.
+   * \param task The task to run.
+   * \param args The arguments that task will be called with.
+   * \return A std::future to the result of invoking task with args.
+   *         The std::future returned may hold an exception if an exception
+   *         occurred while running the task.
+   **/
+  template<typename Callable, typename... Args>
+  PL_NODISCARD auto
+  add_task(PL_IN const key_type& key, Callable&& task, Args&&... args)
+  {
+    auto invoker
+      = [t   = std::forward<Callable>(task),
+         tup = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+          return ::pl::apply(std::move(t), std::move(tup));
+        };
+
+    using ret = decltype(invoker());
+
+    std::packaged_task<ret()> packaged{std::move(invoker)};
+    auto                      fut = packaged.get_future();
+    enqueue(key, [p = std::move(packaged)]() mutable { p(); });
+    return fut;
+  }
+
+  /*!
+   * \brief Queries the amount of keys that have tasks waiting or running.
+   * \return The count of active keys.
+   **/
+  PL_NODISCARD std::size_t active_keys() const
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    return m_active_keys;
+  }
+
+private:
+  using task_type = ::pl::unique_function<void()>;
+
+  /*!
+   * \brief Upper bound for the amount of tasks of a key run before the
+   *        thread is given back to the thread_pool.
+   **/
+  static constexpr std::size_t max_batch_size{64U};
+
+  /*!
+   * \brief Hashes keys using pl::hash.
+   **/
+  struct key_hash {
+    std::size_t operator()(PL_IN const key_type& key) const noexcept
+    {
+      return ::pl::hash(key);
+    }
+  };
+
+  /*!
+   * \brief A partition of the keys.
+   **/
+  struct stripe {
+    stripe() : mutex{}, mailboxes{}
+    {
+    }
+
+    std::mutex mutex;
+    std::unordered_map<key_type, std::deque<task_type>, key_hash> mailboxes;
+  };
+
+  stripe& stripe_of(PL_IN const key_type& key) const noexcept
+  {
+    return m_stripes[::pl::hash(key) % m_stripe_count];
+  }
+
+  void enqueue(PL_IN const key_type& key, task_type task)
+  {
+    stripe&                      s{stripe_of(key)};
+    std::unique_lock<std::mutex> lock{s.mutex};
+    auto                         it = s.mailboxes.find(key);
+
+    if (it != s.mailboxes.end()) {
+      // the key is already being worked on.
+      it->second.push_back(std::move(task));
+      return;
+    }
+
+    s.mailboxes[key].push_back(std::move(task));
+    lock.unlock();
+
+    {
+      std::lock_guard<std::mutex> guard{m_mutex};
+      (void)guard;
+      ++m_active_keys;
+    }
+
+    schedule(key);
+  }
+
+  void schedule(PL_IN const key_type& key)
+  {
+    // bypasses the overflow_policy, as the key stays active until this task
+    // has emptied its mailbox.
+    (void)m_pool.force_add_task(
+      static_cast<std::uint8_t>(0U), [this, key] { run_batch(key); });
+  }
+
+  void run_batch(PL_IN const key_type& key)
+  {
+    stripe& s{stripe_of(key)};
+
+    for (std::size_t i{0U}; i < max_batch_size; ++i) {
+      task_type task{};
+
+      {
+        std::lock_guard<std::mutex> lock{s.mutex};
+        (void)lock;
+        auto                        it = s.mailboxes.find(key);
+
+        // the mailbox of a scheduled key is only erased by this function,
+        // should it be missing anyway the key is treated as done.
+        if (it != s.mailboxes.end()) {
+          if (it->second.empty()) {
+            s.mailboxes.erase(it);
+          }
+          else {
+            task = std::move(it->second.front());
+            it->second.pop_front();
+          }
+        }
+      }
+
+      if (!task) {
+        // the stripe may no longer be touched after this.
+        deactivate();
+        return;
+      }
+
+      task(); // packaged_task, doesn't throw.
+    }
+
+    schedule(key);
+  }
+
+  void deactivate()
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    --m_active_keys;
+    // notify while holding the lock, as the keyed_executor may be destroyed
+    // as soon as the lock is released.
+    m_cv_idle.notify_all();
+  }
+
+  thread_pool&              m_pool;         //!< the pool to run on.
+  const std::size_t         m_stripe_count; //!< the amount of stripes.
+  std::unique_ptr<stripe[]> m_stripes;      //!< the mailboxes.
+  mutable std::mutex        m_mutex;        //!< guards m_active_keys.
+  std::condition_variable   m_cv_idle;      //!< signalled when idle.
+  std::size_t m_active_keys; //!< the amount of keys with a mailbox.
+};
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_KEYED_EXECUTOR_HPP
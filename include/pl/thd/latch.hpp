@@ -0,0 +1,135 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file latch.hpp
+ * \brief Defines the pl::thd::latch class.
+ **/
+#ifndef INCG_PL_THD_LATCH_HPP
+#define INCG_PL_THD_LATCH_HPP
+#include "../annotations.hpp" // PL_NODISCARD
+#include "../assert.hpp"      // PL_CHECK_PRE
+#include "atomic_wait.hpp" // pl::thd::atomic_wait, pl::thd::atomic_notify_all
+#include <atomic>          // std::atomic
+#include <cstdint>         // std::uint32_t
+
+namespace pl {
+namespace thd {
+/*!
+ * \brief A single use downward counter that threads can block on until it
+ *        reaches zero.
+ *
+ * Modeled after std::latch. Counting down doesn't make a system call unless
+ * the counter reaches zero while threads are blocked and waiting threads
+ * spin for a short while before they block.
+ **/
+class latch {
+public:
+  using this_type = latch;
+
+  /*!
+   * \brief Creates a latch.
+   * \param expected The initial value of the counter.
+   **/
+  explicit latch(std::uint32_t expected) : m_counter{expected}, m_waiters{0U}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  latch(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Decrements the counter, wakes the waiting threads if it reaches
+   *        zero.
+   * \param update The amount to decrement the counter by. Must not be
+   *               greater than the counter.
+   **/
+  void count_down(std::uint32_t update = 1U)
+  {
+    const std::uint32_t old{
+      m_counter.fetch_sub(update, std::memory_order_seq_cst)};
+    PL_CHECK_PRE(update <= old);
+
+    // pairs with the increment of m_waiters in wait.
+    if ((old == update) && (m_waiters.load(std::memory_order_seq_cst) != 0U)) {
+      atomic_notify_all(m_counter);
+    }
+  }
+
+  /*!
+   * \brief Checks whether the counter has reached zero.
+   * \return true if the counter is zero; false otherwise.
+   **/
+  PL_NODISCARD bool try_wait() const noexcept
+  {
+    return m_counter.load(std::memory_order_acquire) == 0U;
+  }
+
+  /*!
+   * \brief Blocks the calling thread until the counter reaches zero.
+   **/
+  void wait() const noexcept
+  {
+    if (detail::spin_until([this] { return try_wait(); })) {
+      return;
+    }
+
+    m_waiters.fetch_add(1U, std::memory_order_seq_cst);
+
+    for (std::uint32_t value{m_counter.load(std::memory_order_seq_cst)};
+         value != 0U;
+         value = m_counter.load(std::memory_order_seq_cst)) {
+      atomic_wait(m_counter, value);
+    }
+
+    m_waiters.fetch_sub(1U, std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Decrements the counter and blocks the calling thread until the
+   *        counter reaches zero.
+   * \param update The amount to decrement the counter by.
+   **/
+  void arrive_and_wait(std::uint32_t update = 1U)
+  {
+    count_down(update);
+    wait();
+  }
+
+private:
+  std::atomic<std::uint32_t>         m_counter; //!< the counter.
+  mutable std::atomic<std::uint32_t> m_waiters; //!< the blocked threads.
+};
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_LATCH_HPP
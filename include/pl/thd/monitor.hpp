@@ -33,6 +33,7 @@
 #define INCG_PL_THD_MONITOR_HPP
 #include "../annotations.hpp" // PL_IN
 #include "../invoke.hpp"      // pl::invoke
+#include "profiled_mutex.hpp" // pl::thd::set_mutex_name
 #include <mutex>              // std::mutex, std::lock_guard
 #include <utility>            // std::move, std::forward
 
@@ -42,12 +43,15 @@ namespace thd {
  * \brief Stores shared data in its private section.
  *        Allows different threads to operate on the shared data
  *        by passing in callables that operate on the shared data.
+ *
+ * The Mutex can be replaced, e.g. by a profiled_mutex.
  **/
-template<typename SharedData>
+template<typename SharedData, typename Mutex = std::mutex>
 class monitor {
 public:
   using this_type    = monitor;
   using element_type = SharedData;
+  using mutex_type   = Mutex;
 
   /*!
    * \brief Creates a monitor.
@@ -56,6 +60,7 @@ public:
   explicit monitor(element_type shared_data)
     : m_shared_data{std::move(shared_data)}, m_mutex{}
   {
+    set_mutex_name(m_mutex, "pl::thd::monitor");
   }
 
   /*!
@@ -78,14 +83,24 @@ public:
   template<typename Callable>
   auto operator()(PL_IN Callable&& callable) -> decltype(auto)
   {
-    std::lock_guard<std::mutex> lock_guard{m_mutex};
+    std::lock_guard<mutex_type> lock_guard{m_mutex};
     (void)lock_guard;
     return ::pl::invoke(std::forward<Callable>(callable), m_shared_data);
   }
 
+  /*!
+   * \brief Names the mutex of this monitor for the lock_profiles, only has
+   *        an effect if Mutex is a profiled_mutex.
+   * \param name The name, must outlive this object.
+   **/
+  void name_mutex(const char* name) noexcept
+  {
+    set_mutex_name(m_mutex, name);
+  }
+
 private:
   element_type m_shared_data; //!< the shared data
-  std::mutex   m_mutex;       /*!< the mutex to guard access
+  mutex_type   m_mutex;       /*!< the mutex to guard access
                                *   to the shared data
                                **/
 };
@@ -0,0 +1,611 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file pipeline.hpp
+ * \brief Defines the pipeline class template that runs a chain of stages on
+ *        a thread_pool.
+ **/
+#ifndef INCG_PL_THD_PIPELINE_HPP
+#define INCG_PL_THD_PIPELINE_HPP
+#include "../annotations.hpp"          // PL_IN, PL_INOUT, PL_NODISCARD
+#include "../assert.hpp"               // PL_CHECK_PRE
+#include "../invoke.hpp"               // pl::invoke
+#include "../meta/detection_idiom.hpp" // pl::meta::is_detected
+#include "../meta/remove_cvref.hpp"    // pl::meta::remove_cvref_t
+#include "thread_pool.hpp"             // pl::thd::thread_pool
+#include <condition_variable>          // std::condition_variable
+#include <cstddef>                     // std::size_t
+#include <cstdint>                     // std::uint8_t
+#include <deque>                       // std::deque
+#include <exception> // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <functional>                  // std::function
+#include <map>                         // std::map
+#include <memory> // std::shared_ptr, std::make_shared, std::make_unique
+#include <mutex> // std::mutex, std::unique_lock, std::lock_guard
+#include <type_traits> // std::is_void, std::is_const, std::is_member_pointer
+#include <utility>                     // std::move, std::forward, std::declval
+#include <vector>                      // std::vector
+
+namespace pl {
+namespace thd {
+/*!
+ * \brief The modes a stage of a pipeline can run in.
+ **/
+enum class filter_mode {
+  serial_in_order,     //!< one item at a time, in the order of the source.
+  serial_out_of_order, //!< one item at a time, in any order.
+  parallel             //!< any amount of items at the same time.
+};
+
+/*!
+ * \brief Passed to the source stage of a pipeline. The source stage calls
+ *        stop on it to signal that there are no more items.
+ **/
+class flow_control {
+public:
+  using this_type = flow_control;
+
+  /*!
+   * \brief Creates a flow_control that is not stopped.
+   **/
+  flow_control() noexcept : m_is_stopped{false}
+  {
+  }
+
+  /*!
+   * \brief Signals that the source is exhausted.
+   * \note The value returned by the source from the invocation that called
+   *       stop is discarded.
+   **/
+  void stop() noexcept
+  {
+    m_is_stopped = true;
+  }
+
+  /*!
+   * \brief Queries whether stop has been called.
+   * \return true if stop has been called; false otherwise.
+   **/
+  PL_NODISCARD bool is_stopped() const noexcept
+  {
+    return m_is_stopped;
+  }
+
+private:
+  bool m_is_stopped;
+};
+
+namespace detail {
+/*!
+ * \brief Type erased source stage. Returns the item created.
+ **/
+using pipeline_source = std::function<std::shared_ptr<void>(flow_control&)>;
+
+/*!
+ * \brief Type erased stage. Takes an item and returns the item created.
+ **/
+using pipeline_function
+  = std::function<std::shared_ptr<void>(const std::shared_ptr<void>&)>;
+
+/*!
+ * \brief A stage of a pipeline.
+ **/
+struct pipeline_stage {
+  filter_mode       mode;
+  pipeline_function function;
+};
+
+/*!
+ * \brief The result of calling a const Callable with an Input lvalue.
+ *        Not to be used directly.
+ **/
+template<typename Callable, typename Input>
+using const_call_result_t
+  = decltype(std::declval<const Callable&>()(std::declval<Input&>()));
+
+/*!
+ * \brief The reference through which the callable of a stage is invoked:
+ *        a const reference if Callable can be invoked as const, otherwise
+ *        a non-const reference. Not to be used directly.
+ **/
+template<typename Callable, typename Input>
+using stage_callable_t = std::conditional_t<
+  std::is_member_pointer<Callable>::value
+    || meta::is_detected<const_call_result_t, Callable, Input>::value,
+  const Callable&,
+  Callable&>;
+
+/*!
+ * \brief Invokes callable with args and stores the result on the heap.
+ *        Not to be used directly.
+ **/
+template<typename Callable, typename... Args>
+inline auto invoke_to_shared(
+  std::false_type,
+  PL_INOUT Callable& callable,
+  Args&&... args) -> std::shared_ptr<void>
+{
+  return std::make_shared<meta::remove_cvref_t<decltype(
+    ::pl::invoke(callable, std::forward<Args>(args)...))>>(
+    ::pl::invoke(callable, std::forward<Args>(args)...));
+}
+
+/*!
+ * \brief Invokes callable with args. Handles the void case.
+ *        Not to be used directly.
+ **/
+template<typename Callable, typename... Args>
+inline auto invoke_to_shared(
+  std::true_type,
+  PL_INOUT Callable& callable,
+  Args&&... args) -> std::shared_ptr<void>
+{
+  ::pl::invoke(callable, std::forward<Args>(args)...);
+  return nullptr;
+}
+
+/*!
+ * \brief Runs the stages of a pipeline on a thread_pool.
+ *        Not to be used directly.
+ *
+ * Every item created by the source is a token. At most max_tokens tokens
+ * are in flight at any time. A token runs through the stages in a task on
+ * the thread_pool. Parallel stages are run directly. Serial stages run one
+ * token at a time, a token arriving at a busy serial stage (or arriving
+ * early at a serial_in_order stage) is buffered by the stage and resumed
+ * in a new task when the stage becomes available. Thus no thread ever
+ * blocks waiting for a stage.
+ **/
+class pipeline_executor
+  : public std::enable_shared_from_this<pipeline_executor> {
+public:
+  pipeline_executor(
+    PL_INOUT thread_pool&                    pool,
+    std::size_t                              max_tokens,
+    pipeline_source                          source,
+    PL_IN const std::vector<pipeline_stage>& stages)
+    : m_pool{pool}
+    , m_max_tokens{max_tokens}
+    , m_source{std::move(source)}
+    , m_stages{}
+    , m_mutex{}
+    , m_cv{}
+    , m_tokens_in_flight{0U}
+    , m_next_sequence{0U}
+    , m_is_source_busy{false}
+    , m_is_stopped{false}
+    , m_is_done{false}
+    , m_exception{}
+  {
+    m_stages.reserve(stages.size());
+
+    for (const pipeline_stage& stage : stages) {
+      m_stages.push_back(std::make_unique<stage_state>(stage));
+    }
+  }
+
+  pipeline_executor(const pipeline_executor&) = delete;
+  pipeline_executor& operator=(const pipeline_executor&) = delete;
+
+  /*!
+   * \brief Starts the pipeline, blocks until it finished and rethrows the
+   *        first exception thrown by a stage, if any.
+   **/
+  void run()
+  {
+    pump();
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cv.wait(lock, [this] { return m_is_done; });
+
+    if (m_exception != nullptr) {
+      std::rethrow_exception(m_exception);
+    }
+  }
+
+private:
+  /*!
+   * \brief An item on its way through the pipeline.
+   **/
+  struct token {
+    std::size_t           sequence;
+    std::shared_ptr<void> value;
+    bool                  is_cancelled; //!< a stage threw for this token.
+  };
+
+  /*!
+   * \brief The state of a stage while the pipeline runs.
+   **/
+  struct stage_state {
+    explicit stage_state(PL_IN const pipeline_stage& s)
+      : stage{s}
+      , mutex{}
+      , is_busy{false}
+      , next_sequence{0U}
+      , in_order_tokens{}
+      , out_of_order_tokens{}
+    {
+    }
+
+    pipeline_stage               stage;
+    std::mutex                   mutex;
+    bool                         is_busy;
+    std::size_t                  next_sequence;
+    std::map<std::size_t, token> in_order_tokens;
+    std::deque<token>            out_of_order_tokens;
+  };
+
+  /*!
+   * \brief Starts a run of the source if the source is idle, not exhausted
+   *        and the token limit has not been reached.
+   **/
+  void pump()
+  {
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      (void)lock;
+
+      if (
+        m_is_source_busy || m_is_stopped
+        || (m_tokens_in_flight >= m_max_tokens)) {
+        return;
+      }
+
+      m_is_source_busy = true;
+      ++m_tokens_in_flight;
+    }
+
+    // the tasks of the pipeline bypass the overflow_policy, as the tokens
+    // they carry have to be finished for run to return.
+    auto self = shared_from_this();
+    (void)m_pool.force_add_task(
+      static_cast<std::uint8_t>(0U), [self] { self->run_source(); });
+  }
+
+  void run_source()
+  {
+    flow_control          fc{};
+    std::shared_ptr<void> value{};
+
+    try {
+      value = m_source(fc);
+    }
+    catch (...) {
+      set_exception(std::current_exception());
+      fc.stop();
+    }
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_is_source_busy = false;
+
+    if (fc.is_stopped()) {
+      m_is_stopped = true;
+      lock.unlock();
+      finish_token();
+      return;
+    }
+
+    token t{m_next_sequence, std::move(value), false};
+    ++m_next_sequence;
+    lock.unlock();
+
+    pump();
+    process(std::move(t), 0U, false);
+  }
+
+  /*!
+   * \brief Runs t through the stages starting at stage_index.
+   * \param is_acquired Whether the serial stage at stage_index has
+   *                    already been acquired for t.
+   **/
+  void process(token t, std::size_t stage_index, bool is_acquired)
+  {
+    for (; stage_index < m_stages.size(); ++stage_index) {
+      stage_state& s{*m_stages[stage_index]};
+
+      if ((s.stage.mode != filter_mode::parallel) && !is_acquired) {
+        std::lock_guard<std::mutex> lock{s.mutex};
+        (void)lock;
+
+        if (s.stage.mode == filter_mode::serial_in_order) {
+          if (s.is_busy || (t.sequence != s.next_sequence)) {
+            const std::size_t sequence{t.sequence};
+            s.in_order_tokens.emplace(sequence, std::move(t));
+            return;
+          }
+        }
+        else if (s.is_busy) {
+          s.out_of_order_tokens.push_back(std::move(t));
+          return;
+        }
+
+        s.is_busy = true;
+      }
+
+      is_acquired = false;
+      run_stage(t, s);
+
+      if (s.stage.mode != filter_mode::parallel) {
+        release(stage_index);
+      }
+    }
+
+    finish_token();
+  }
+
+  void run_stage(PL_INOUT token& t, PL_INOUT stage_state& s)
+  {
+    if (t.is_cancelled) {
+      return;
+    }
+
+    try {
+      t.value = s.stage.function(t.value);
+    }
+    catch (...) {
+      set_exception(std::current_exception());
+      // cancelled tokens still pass through the remaining stages without
+      // invoking them, so that the serial_in_order stages don't wait for
+      // them forever.
+      t.value.reset();
+      t.is_cancelled = true;
+    }
+  }
+
+  /*!
+   * \brief Releases the serial stage at stage_index and resumes the next
+   *        token waiting for it, if any.
+   **/
+  void release(std::size_t stage_index)
+  {
+    stage_state& s{*m_stages[stage_index]};
+    token        next{0U, nullptr, false};
+    bool         has_next{false};
+
+    {
+      std::lock_guard<std::mutex> lock{s.mutex};
+      (void)lock;
+      s.is_busy = false;
+
+      if (s.stage.mode == filter_mode::serial_in_order) {
+        ++s.next_sequence;
+        auto it = s.in_order_tokens.begin();
+
+        if (
+          (it != s.in_order_tokens.end())
+          && (it->first == s.next_sequence)) {
+          next = std::move(it->second);
+          s.in_order_tokens.erase(it);
+          has_next = true;
+        }
+      }
+      else if (!s.out_of_order_tokens.empty()) {
+        next = std::move(s.out_of_order_tokens.front());
+        s.out_of_order_tokens.pop_front();
+        has_next = true;
+      }
+
+      s.is_busy = has_next;
+    }
+
+    if (has_next) {
+      auto self = shared_from_this();
+      (void)m_pool.force_add_task(
+        static_cast<std::uint8_t>(0U), [self, next, stage_index] {
+          self->process(next, stage_index, true);
+        });
+    }
+  }
+
+  /*!
+   * \brief Called whenever a token leaves the pipeline.
+   **/
+  void finish_token()
+  {
+    bool is_done{false};
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      (void)lock;
+      --m_tokens_in_flight;
+      is_done = m_is_stopped && (m_tokens_in_flight == 0U);
+      m_is_done = is_done;
+    }
+
+    if (is_done) {
+      m_cv.notify_all();
+    }
+    else {
+      pump();
+    }
+  }
+
+  void set_exception(std::exception_ptr exception)
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+
+    if (m_exception == nullptr) {
+      m_exception = std::move(exception);
+    }
+
+    m_is_stopped = true; // stop feeding new tokens.
+  }
+
+  thread_pool&                              m_pool;
+  const std::size_t                         m_max_tokens;
+  pipeline_source                           m_source;
+  std::vector<std::unique_ptr<stage_state>> m_stages;
+  std::mutex                                m_mutex;
+  std::condition_variable                   m_cv;
+  std::size_t                               m_tokens_in_flight;
+  std::size_t                               m_next_sequence;
+  bool                                      m_is_source_busy;
+  bool                                      m_is_stopped;
+  bool                                      m_is_done;
+  std::exception_ptr                        m_exception;
+};
+} // namespace detail
+
+/*!
+ * \brief A chain of stages that items flow through. Similar to TBB's
+ *        parallel_pipeline.
+ * \note Use make_pipeline to create a pipeline.
+ * \example auto total = 0;
+ *          pl::thd::make_pipeline([&file](pl::thd::flow_control& fc) {
+ *              auto line = read_line(file);
+ *              if (!line) { fc.stop(); }
+ *              return line;
+ *            })
+ *            .add_stage(pl::thd::filter_mode::parallel, &parse)
+ *            .add_stage(
+ *              pl::thd::filter_mode::serial_in_order,
+ *              [&total](const record& r) { total += r.value; })
+ *            .run(pool, 16U);
+ *
+ * The first stage is the source that creates the items, the source is
+ * always run serially. Every further stage takes the item returned by the
+ * previous stage. Each stage can be run serially in the order the source
+ * created the items, serially in any order or in parallel.
+ * \tparam Output The type of the items returned by the last stage.
+ *         No further stages can be added after a stage returning void.
+ **/
+template<typename Output>
+class pipeline {
+public:
+  using this_type   = pipeline;
+  using output_type = Output;
+
+  /*!
+   * \brief Creates a pipeline from type erased stages.
+   * \note Not to be used directly, use make_pipeline instead.
+   **/
+  pipeline(
+    detail::pipeline_source             source,
+    std::vector<detail::pipeline_stage> stages)
+    : m_source{std::move(source)}, m_stages{std::move(stages)}
+  {
+  }
+
+  /*!
+   * \brief Appends a stage to the pipeline.
+   * \param mode The mode to run the stage in.
+   * \param callable The callable to invoke with the output of the previous
+   *                 stage. A single copy of it is shared by all of the
+   *                 items. If it can be invoked as const it is always
+   *                 invoked through a const reference, otherwise through a
+   *                 non-const reference.
+   * \return The resulting pipeline.
+   * \throws pl::precondition_violation_exception if mode is
+   *         filter_mode::parallel and callable can't be invoked as const.
+   * \warning A parallel stage is invoked by several threads at the same
+   *          time, the const invocation of callable must be safe to call
+   *          concurrently. Serial stages may keep state in callable.
+   **/
+  template<typename Callable, typename Input = Output>
+  PL_NODISCARD auto add_stage(filter_mode mode, Callable callable) const
+    -> pipeline<meta::remove_cvref_t<decltype(::pl::invoke(
+      std::declval<detail::stage_callable_t<Callable, Input>>(),
+      std::declval<Input&>()))>>
+  {
+    using callable_type = detail::stage_callable_t<Callable, Input>;
+    using result_type   = decltype(::pl::invoke(
+      std::declval<callable_type>(), std::declval<Input&>()));
+
+    PL_CHECK_PRE(
+      (mode != filter_mode::parallel)
+      || std::is_const<std::remove_reference_t<callable_type>>::value);
+
+    std::vector<detail::pipeline_stage> stages{m_stages};
+    stages.push_back(detail::pipeline_stage{
+      mode,
+      [c = std::move(callable)](const std::shared_ptr<void>& input) mutable {
+        callable_type f{c};
+        return detail::invoke_to_shared(
+          typename std::is_void<result_type>::type{},
+          f,
+          std::move(*static_cast<Input*>(input.get())));
+      }});
+
+    return pipeline<meta::remove_cvref_t<result_type>>{
+      m_source, std::move(stages)};
+  }
+
+  /*!
+   * \brief Runs the pipeline on pool until the source signals that it is
+   *        exhausted and all of the items have passed all of the stages.
+   * \param pool The thread_pool to run the stages on.
+   * \param max_tokens The maximum amount of items in flight at the same
+   *                   time. Bounds the memory used. Must not be 0.
+   * \throws The first exception thrown by a stage, if any. A stage
+   *         throwing stops the source, the items already in flight still
+   *         pass the remaining serial stages, but the stages aren't invoked
+   *         for the item that caused the exception.
+   * \warning Blocks the calling thread. Must not be called from a thread
+   *          of pool, as that thread could otherwise be needed to make
+   *          progress.
+   **/
+  void run(PL_INOUT thread_pool& pool, std::size_t max_tokens) const
+  {
+    PL_CHECK_PRE(max_tokens != 0U);
+    PL_CHECK_PRE(pool.max_thread_count() != 0U);
+
+    std::make_shared<detail::pipeline_executor>(
+      pool, max_tokens, m_source, m_stages)
+      ->run();
+  }
+
+private:
+  detail::pipeline_source             m_source;
+  std::vector<detail::pipeline_stage> m_stages;
+};
+
+/*!
+ * \brief Creates a pipeline from its source stage.
+ * \param source The callable that creates the items. Is invoked with a
+ *               flow_control and has to call stop on it once there are
+ *               no more items. Is always run serially.
+ * \return The pipeline created.
+ **/
+template<typename Callable>
+auto make_pipeline(Callable source)
+  -> pipeline<meta::remove_cvref_t<decltype(
+    ::pl::invoke(std::declval<Callable&>(), std::declval<flow_control&>()))>>
+{
+  using result_type = decltype(
+    ::pl::invoke(std::declval<Callable&>(), std::declval<flow_control&>()));
+
+  return pipeline<meta::remove_cvref_t<result_type>>{
+    [s = std::move(source)](flow_control& fc) mutable {
+      return detail::invoke_to_shared(
+        typename std::is_void<result_type>::type{}, s, fc);
+    },
+    std::vector<detail::pipeline_stage>{}};
+}
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_PIPELINE_HPP
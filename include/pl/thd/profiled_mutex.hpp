@@ -0,0 +1,556 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file profiled_mutex.hpp
+ * \brief Defines the pl::thd::profiled_mutex class that records how
+ *        contended it is.
+ **/
+#ifndef INCG_PL_THD_PROFILED_MUTEX_HPP
+#define INCG_PL_THD_PROFILED_MUTEX_HPP
+#include "../annotations.hpp" // PL_IN, PL_INOUT, PL_NODISCARD
+#include <algorithm>          // std::sort, std::find, std::find_if
+#include <array>              // std::array
+#include <atomic>             // std::atomic
+#include <chrono>             // std::chrono::steady_clock
+#include <condition_variable> // std::condition_variable_any
+#include <cstddef>            // std::size_t
+#include <cstdint>            // std::uint64_t, std::int64_t
+#include <mutex>              // std::mutex, std::lock_guard
+#include <ostream>            // std::ostream
+#include <string>             // std::string
+#include <type_traits>        // std::conditional_t, std::is_same
+#include <utility>            // std::move
+#include <vector>             // std::vector
+
+namespace pl {
+namespace thd {
+/*!
+ * \brief The condition variable type to use together with a Mutex.
+ *        std::condition_variable for std::mutex, otherwise
+ *        std::condition_variable_any.
+ **/
+template<typename Mutex>
+using condition_variable_for_t = std::conditional_t<
+  std::is_same<Mutex, std::mutex>::value,
+  std::condition_variable,
+  std::condition_variable_any>;
+
+/*!
+ * \brief The amount of buckets of the histograms in a lock_profile.
+ **/
+enum : std::size_t { lock_histogram_buckets = 40U };
+
+/*!
+ * \brief Snapshot of the statistics recorded by a profiled_mutex.
+ *
+ * Bucket 0 of a histogram counts the durations of 0 nanoseconds, bucket i
+ * counts the durations within [2^(i-1), 2^i) nanoseconds. The last bucket
+ * also counts all of the longer durations.
+ **/
+struct lock_profile {
+  std::string   name;                   //!< the name of the mutex.
+  std::uint64_t acquisitions;           //!< times the mutex was locked.
+  std::uint64_t contended_acquisitions; //!< times a thread had to wait.
+  std::chrono::nanoseconds total_wait; //!< time spent waiting to lock it.
+  std::chrono::nanoseconds total_hold; //!< time it was held locked.
+  std::array<std::uint64_t, lock_histogram_buckets>
+    wait_histogram; //!< histogram of the waiting times.
+  std::array<std::uint64_t, lock_histogram_buckets>
+    hold_histogram; //!< histogram of the times held.
+};
+
+namespace detail {
+/*!
+ * \brief Returns the flag that turns the profiling of all the
+ *        profiled_mutexes on and off.
+ **/
+inline std::atomic<bool>& lock_profiling_flag() noexcept
+{
+  static std::atomic<bool> flag{false};
+  return flag;
+}
+
+/*!
+ * \brief The counters of a profiled_mutex, updated concurrently.
+ **/
+class lock_statistics {
+public:
+  using this_type = lock_statistics;
+
+  lock_statistics() noexcept
+    : m_acquisitions{0U}
+    , m_contended_acquisitions{0U}
+    , m_total_wait{0U}
+    , m_total_hold{0U}
+    , m_wait_histogram{}
+    , m_hold_histogram{}
+  {
+    for (std::size_t i{0U}; i < lock_histogram_buckets; ++i) {
+      m_wait_histogram[i].store(0U, std::memory_order_relaxed);
+      m_hold_histogram[i].store(0U, std::memory_order_relaxed);
+    }
+  }
+
+  lock_statistics(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  void record_acquisition(bool contended, std::uint64_t wait_ns) noexcept
+  {
+    m_acquisitions.fetch_add(1U, std::memory_order_relaxed);
+
+    if (contended) {
+      m_contended_acquisitions.fetch_add(1U, std::memory_order_relaxed);
+    }
+
+    m_total_wait.fetch_add(wait_ns, std::memory_order_relaxed);
+    m_wait_histogram[bucket(wait_ns)].fetch_add(1U, std::memory_order_relaxed);
+  }
+
+  void record_hold(std::uint64_t hold_ns) noexcept
+  {
+    m_total_hold.fetch_add(hold_ns, std::memory_order_relaxed);
+    m_hold_histogram[bucket(hold_ns)].fetch_add(1U, std::memory_order_relaxed);
+  }
+
+  PL_NODISCARD lock_profile snapshot(std::string name) const
+  {
+    lock_profile profile{
+      std::move(name),
+      m_acquisitions.load(std::memory_order_relaxed),
+      m_contended_acquisitions.load(std::memory_order_relaxed),
+      std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(
+        m_total_wait.load(std::memory_order_relaxed))},
+      std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(
+        m_total_hold.load(std::memory_order_relaxed))},
+      {},
+      {}};
+
+    for (std::size_t i{0U}; i < lock_histogram_buckets; ++i) {
+      profile.wait_histogram[i]
+        = m_wait_histogram[i].load(std::memory_order_relaxed);
+      profile.hold_histogram[i]
+        = m_hold_histogram[i].load(std::memory_order_relaxed);
+    }
+
+    return profile;
+  }
+
+private:
+  static std::size_t bucket(std::uint64_t ns) noexcept
+  {
+    std::size_t result{0U};
+
+    while ((ns != 0U) && (result < (lock_histogram_buckets - 1U))) {
+      ns >>= 1U;
+      ++result;
+    }
+
+    return result;
+  }
+
+  std::atomic<std::uint64_t> m_acquisitions;
+  std::atomic<std::uint64_t> m_contended_acquisitions;
+  std::atomic<std::uint64_t> m_total_wait; //!< in nanoseconds.
+  std::atomic<std::uint64_t> m_total_hold; //!< in nanoseconds.
+  std::array<std::atomic<std::uint64_t>, lock_histogram_buckets>
+    m_wait_histogram;
+  std::array<std::atomic<std::uint64_t>, lock_histogram_buckets>
+    m_hold_histogram;
+};
+
+class lock_registry;
+} // namespace detail
+
+/*!
+ * \brief A mutex that records how often it is locked, how often threads
+ *        had to wait to lock it as well as histograms of the time spent
+ *        waiting and the time it was held.
+ *
+ * Can be used in place of std::mutex, for instance as the Mutex template
+ * argument of thread_pool, thread_safe_queue and monitor. Profiling is
+ * turned on for all profiled_mutexes with enable_lock_profiling. While it
+ * is turned off locking and unlocking only cost an additional load of an
+ * atomic flag and a branch each.
+ *
+ * Every profiled_mutex has a name and lock_profiles returns the statistics
+ * of all of them, including the ones that have already been destroyed,
+ * sorted by the total time threads spent waiting to lock them.
+ **/
+class profiled_mutex {
+public:
+  using this_type = profiled_mutex;
+  using clock     = std::chrono::steady_clock;
+
+  /*!
+   * \brief Creates an unlocked profiled_mutex.
+   * \param name The name of the mutex used in the reports. Must point to a
+   *             null-terminated string that outlives this object, e.g. a
+   *             string literal.
+   **/
+  explicit profiled_mutex(const char* name = "pl::thd::profiled_mutex");
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  profiled_mutex(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Keeps the statistics of this mutex for lock_profiles.
+   * \warning Must not be locked.
+   **/
+  ~profiled_mutex();
+
+  /*!
+   * \brief Locks the mutex, blocks the calling thread until the mutex could
+   *        be locked.
+   **/
+  void lock()
+  {
+    if (!is_enabled()) {
+      m_mutex.lock();
+      return;
+    }
+
+    if (m_mutex.try_lock()) {
+      m_statistics.record_acquisition(false, 0U);
+    }
+    else {
+      const std::int64_t begin{now()};
+      m_mutex.lock();
+      const std::int64_t end{now()};
+      m_statistics.record_acquisition(
+        true, static_cast<std::uint64_t>(end - begin));
+      m_locked_at = end;
+      return;
+    }
+
+    m_locked_at = now();
+  }
+
+  /*!
+   * \brief Tries to lock the mutex without blocking.
+   * \return true if the mutex was locked; otherwise false.
+   **/
+  bool try_lock()
+  {
+    if (!m_mutex.try_lock()) {
+      return false;
+    }
+
+    if (is_enabled()) {
+      m_statistics.record_acquisition(false, 0U);
+      m_locked_at = now();
+    }
+
+    return true;
+  }
+
+  /*!
+   * \brief Unlocks the mutex.
+   * \warning Must be locked by the calling thread.
+   **/
+  void unlock()
+  {
+    const std::int64_t locked_at{m_locked_at};
+
+    if (locked_at == 0) {
+      m_mutex.unlock();
+      return;
+    }
+
+    m_locked_at = 0;
+    const std::int64_t unlocked_at{now()};
+    m_mutex.unlock();
+    m_statistics.record_hold(
+      static_cast<std::uint64_t>(unlocked_at - locked_at));
+  }
+
+  /*!
+   * \brief Returns the name of this mutex.
+   * \return The name.
+   **/
+  PL_NODISCARD const char* name() const noexcept
+  {
+    return m_name.load(std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Replaces the name of this mutex.
+   * \param name The new name. Must point to a null-terminated string that
+   *             outlives this object, e.g. a string literal.
+   **/
+  void set_name(const char* name) noexcept
+  {
+    m_name.store(name, std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Returns the statistics recorded so far.
+   * \return A snapshot of the statistics.
+   **/
+  PL_NODISCARD lock_profile profile() const
+  {
+    return m_statistics.snapshot(name());
+  }
+
+private:
+  static bool is_enabled() noexcept
+  {
+    return detail::lock_profiling_flag().load(std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Returns the current time in nanoseconds, never 0.
+   **/
+  static std::int64_t now() noexcept
+  {
+    const std::int64_t result{static_cast<std::int64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock::now().time_since_epoch())
+        .count())};
+    return result == 0 ? 1 : result;
+  }
+
+  std::mutex               m_mutex;      //!< the actual mutex.
+  std::int64_t             m_locked_at;  /*!< when the mutex was locked, 0 if
+                                          *   the locking wasn't profiled.
+                                          *   Only accessed by the thread
+                                          *   holding the mutex.
+                                          **/
+  std::atomic<const char*> m_name;       //!< the name used in reports.
+  detail::lock_statistics  m_statistics; //!< the statistics recorded.
+};
+
+namespace detail {
+/*!
+ * \brief Adds the statistics of from to into, leaving the name of into.
+ **/
+inline void merge_lock_profile(
+  PL_INOUT lock_profile& into,
+  PL_IN const lock_profile& from) noexcept
+{
+  into.acquisitions += from.acquisitions;
+  into.contended_acquisitions += from.contended_acquisitions;
+  into.total_wait += from.total_wait;
+  into.total_hold += from.total_hold;
+
+  for (std::size_t i{0U}; i < lock_histogram_buckets; ++i) {
+    into.wait_histogram[i] += from.wait_histogram[i];
+    into.hold_histogram[i] += from.hold_histogram[i];
+  }
+}
+
+/*!
+ * \brief Keeps track of all the profiled_mutexes and the statistics of the
+ *        ones that have been destroyed, merged into one entry per name.
+ **/
+class lock_registry {
+public:
+  using this_type = lock_registry;
+
+  lock_registry() : m_mutex{}, m_live{}, m_destroyed{}
+  {
+  }
+
+  lock_registry(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  void add(PL_IN const profiled_mutex& mutex)
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    m_live.push_back(&mutex);
+  }
+
+  void remove(PL_IN const profiled_mutex& mutex)
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    m_live.erase(std::find(m_live.begin(), m_live.end(), &mutex));
+    lock_profile profile{mutex.profile()};
+
+    if (profile.acquisitions == 0U) {
+      return;
+    }
+
+    // mutexes created and destroyed repeatedly share a name, merging them
+    // keeps the memory used bounded by the amount of names.
+    const auto it = std::find_if(
+      m_destroyed.begin(),
+      m_destroyed.end(),
+      [&profile](PL_IN const lock_profile& destroyed) {
+        return destroyed.name == profile.name;
+      });
+
+    if (it != m_destroyed.end()) {
+      merge_lock_profile(*it, profile);
+    }
+    else {
+      m_destroyed.push_back(std::move(profile));
+    }
+  }
+
+  PL_NODISCARD std::vector<lock_profile> profiles() const
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    std::vector<lock_profile> result{m_destroyed};
+
+    for (const profiled_mutex* mutex : m_live) {
+      result.push_back(mutex->profile());
+    }
+
+    return result;
+  }
+
+  void clear_destroyed()
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    m_destroyed.clear();
+  }
+
+private:
+  mutable std::mutex                 m_mutex;
+  std::vector<const profiled_mutex*> m_live;      //!< existing mutexes.
+  std::vector<lock_profile>          m_destroyed; //!< one per name.
+};
+
+inline lock_registry& get_lock_registry()
+{
+  static lock_registry registry{};
+  return registry;
+}
+} // namespace detail
+
+inline profiled_mutex::profiled_mutex(const char* name)
+  : m_mutex{}, m_locked_at{0}, m_name{name}, m_statistics{}
+{
+  detail::get_lock_registry().add(*this);
+}
+
+inline profiled_mutex::~profiled_mutex()
+{
+  detail::get_lock_registry().remove(*this);
+}
+
+/*!
+ * \brief Turns the profiling of all the profiled_mutexes on or off.
+ * \param enabled true to turn profiling on; false to turn it off.
+ **/
+inline void enable_lock_profiling(bool enabled = true) noexcept
+{
+  detail::lock_profiling_flag().store(enabled, std::memory_order_relaxed);
+}
+
+/*!
+ * \brief Queries whether the profiled_mutexes are being profiled.
+ * \return true if profiling is turned on; otherwise false.
+ **/
+PL_NODISCARD inline bool is_lock_profiling_enabled() noexcept
+{
+  return detail::lock_profiling_flag().load(std::memory_order_relaxed);
+}
+
+/*!
+ * \brief Returns the statistics of all the profiled_mutexes, including the
+ *        destroyed ones that have been locked at least once. The destroyed
+ *        mutexes sharing a name are merged into a single entry.
+ * \return The statistics sorted by the total time spent waiting for the
+ *         mutexes in descending order, the most contended mutex first.
+ **/
+PL_NODISCARD inline std::vector<lock_profile> lock_profiles()
+{
+  std::vector<lock_profile> result{detail::get_lock_registry().profiles()};
+  std::sort(
+    result.begin(),
+    result.end(),
+    [](PL_IN const lock_profile& a, PL_IN const lock_profile& b) {
+      return a.total_wait > b.total_wait;
+    });
+  return result;
+}
+
+/*!
+ * \brief Discards the statistics of the profiled_mutexes that have been
+ *        destroyed.
+ **/
+inline void clear_destroyed_lock_profiles()
+{
+  detail::get_lock_registry().clear_destroyed();
+}
+
+/*!
+ * \brief Writes a report of lock_profiles to an ostream, one line per
+ *        mutex with the most contended mutex first.
+ * \param os The ostream to write to.
+ * \return os.
+ **/
+inline std::ostream& write_lock_report(PL_INOUT std::ostream& os)
+{
+  os << "name,acquisitions,contended_acquisitions,total_wait_ns,"
+        "total_hold_ns\n";
+
+  for (const lock_profile& profile : lock_profiles()) {
+    os << profile.name << ',' << profile.acquisitions << ','
+       << profile.contended_acquisitions << ','
+       << profile.total_wait.count() << ',' << profile.total_hold.count()
+       << '\n';
+  }
+
+  return os;
+}
+
+/*!
+ * \brief Names a mutex used by a component, does nothing unless the mutex
+ *        is a profiled_mutex.
+ **/
+template<typename Mutex>
+void set_mutex_name(PL_INOUT Mutex&, const char*) noexcept
+{
+}
+
+/*!
+ * \brief Names a profiled_mutex used by a component.
+ * \param mutex The mutex to name.
+ * \param name The name, must outlive the mutex.
+ **/
+inline void set_mutex_name(PL_INOUT profiled_mutex& mutex, const char* name)
+  noexcept
+{
+  mutex.set_name(name);
+}
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_PROFILED_MUTEX_HPP
@@ -0,0 +1,752 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file reclamation.hpp
+ * \brief Defines facilities to safely reclaim the memory of objects that
+ *        were removed from lock-free data structures while other threads
+ *        may still be reading them: epoch based reclamation and hazard
+ *        pointers.
+ **/
+#ifndef INCG_PL_THD_RECLAMATION_HPP
+#define INCG_PL_THD_RECLAMATION_HPP
+#include "../annotations.hpp" // PL_IN, PL_INOUT, PL_NODISCARD
+#include <algorithm>          // std::sort, std::binary_search, std::for_each
+#include <atomic>             // std::atomic, std::atomic_thread_fence
+#include <cstddef>            // std::size_t
+#include <cstdint>            // std::uint64_t
+#include <deque>              // std::deque
+#include <iterator>           // std::make_move_iterator
+#include <mutex>              // std::mutex, std::lock_guard, std::unique_lock
+#include <utility>            // std::move
+#include <vector>             // std::vector
+
+namespace pl {
+namespace thd {
+namespace detail {
+/*!
+ * \brief Deletes the object of type Ty that p points to.
+ * \param p Pointer to the object to delete.
+ **/
+template<typename Ty>
+void delete_retired(void* p)
+{
+  delete static_cast<Ty*>(p);
+}
+
+/*!
+ * \brief An object that was retired and is to be reclaimed once no thread
+ *        may access it any longer.
+ **/
+struct retired_object {
+  void* pointer;          //!< the object.
+  void (*deleter)(void*); //!< reclaims the object.
+
+  void reclaim() const
+  {
+    deleter(pointer);
+  }
+};
+
+/*!
+ * \brief Reclaims all the objects in the range [first, last).
+ **/
+template<typename Iterator>
+void reclaim_all(Iterator first, Iterator last)
+{
+  std::for_each(
+    first, last, [](PL_IN const retired_object& obj) { obj.reclaim(); });
+}
+
+/*!
+ * \brief Objects retired by a thread within the same epoch.
+ **/
+struct retired_batch {
+  std::uint64_t               epoch;   //!< the epoch they were retired in.
+  std::vector<retired_object> objects; //!< the objects.
+};
+
+/*!
+ * \brief The epoch based reclamation state of a thread.
+ **/
+struct epoch_participant {
+  epoch_participant()
+    : state{0U}, in_use{true}, next{nullptr}, nesting{0U}, pending{}, sealed{}
+  {
+  }
+
+  epoch_participant(const epoch_participant&) = delete;
+
+  epoch_participant& operator=(const epoch_participant&) = delete;
+
+  /*!
+   * \brief The epoch observed shifted to the left by one, the lowest bit is
+   *        set while the thread is pinned.
+   **/
+  std::atomic<std::uint64_t> state;
+  std::atomic<bool>          in_use; //!< whether a thread owns this.
+  epoch_participant*         next;   //!< the next participant, immutable.
+  std::size_t                nesting; //!< the amount of epoch_guards alive.
+  std::vector<retired_object> pending; //!< retired, not yet tagged.
+  std::deque<retired_batch>   sealed;  //!< batches tagged with an epoch.
+};
+
+/*!
+ * \brief The process wide state of epoch based reclamation.
+ *
+ * There is a global epoch. Pinned threads publish the epoch they observed.
+ * The global epoch is only advanced once every pinned thread has observed
+ * it, so that once it has been advanced twice after an object was retired
+ * no thread can still hold a reference to it.
+ **/
+class epoch_state {
+public:
+  using this_type = epoch_state;
+
+  /*!
+   * \brief The amount of objects a thread retires before they are tagged
+   *        with an epoch and reclamation is attempted.
+   **/
+  static constexpr std::size_t batch_size{64U};
+
+  epoch_state() : m_epoch{0U}, m_head{nullptr}, m_mutex{}, m_orphans{}
+  {
+  }
+
+  epoch_state(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  ~epoch_state()
+  {
+    // no thread can be pinned any longer.
+    epoch_participant* p{m_head.load(std::memory_order_acquire)};
+
+    while (p != nullptr) {
+      epoch_participant* const next{p->next};
+      reclaim_all(p->pending.begin(), p->pending.end());
+
+      for (const retired_batch& batch : p->sealed) {
+        reclaim_all(batch.objects.begin(), batch.objects.end());
+      }
+
+      delete p;
+      p = next;
+    }
+
+    for (const retired_batch& batch : m_orphans) {
+      reclaim_all(batch.objects.begin(), batch.objects.end());
+    }
+  }
+
+  /*!
+   * \brief Acquires a participant for the calling thread, reusing the
+   *        participants of threads that exited.
+   **/
+  epoch_participant* acquire()
+  {
+    for (epoch_participant* p{m_head.load(std::memory_order_acquire)};
+         p != nullptr;
+         p = p->next) {
+      bool expected{false};
+
+      if (p->in_use.compare_exchange_strong(
+            expected, true, std::memory_order_acquire)) {
+        return p;
+      }
+    }
+
+    epoch_participant* const p{new epoch_participant{}};
+    p->next = m_head.load(std::memory_order_relaxed);
+
+    while (!m_head.compare_exchange_weak(
+      p->next, p, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+
+    return p;
+  }
+
+  /*!
+   * \brief Releases the participant of a thread that exits. The objects it
+   *        retired are handed over to the other threads.
+   **/
+  void release(PL_INOUT epoch_participant& p)
+  {
+    seal(p);
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      (void)lock;
+      std::move(
+        p.sealed.begin(), p.sealed.end(), std::back_inserter(m_orphans));
+    }
+
+    p.sealed.clear();
+    p.in_use.store(false, std::memory_order_release);
+  }
+
+  void pin(PL_INOUT epoch_participant& p)
+  {
+    if (p.nesting++ != 0U) {
+      return;
+    }
+
+    const std::uint64_t epoch{m_epoch.load(std::memory_order_relaxed)};
+    p.state.store((epoch << 1U) | 1U, std::memory_order_relaxed);
+    // the store must be visible before any shared object is read.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  void unpin(PL_INOUT epoch_participant& p)
+  {
+    if (--p.nesting == 0U) {
+      p.state.store(0U, std::memory_order_release);
+    }
+  }
+
+  void retire(PL_INOUT epoch_participant& p, PL_IN const retired_object& obj)
+  {
+    p.pending.push_back(obj);
+
+    if (p.pending.size() >= batch_size) {
+      collect(p);
+    }
+  }
+
+  /*!
+   * \brief Tags the pending objects of p, tries to advance the global
+   *        epoch and reclaims what can be reclaimed.
+   **/
+  void collect(PL_INOUT epoch_participant& p)
+  {
+    seal(p);
+    try_advance();
+    const std::uint64_t epoch{m_epoch.load(std::memory_order_acquire)};
+    reclaim_expired(p.sealed, epoch);
+    std::unique_lock<std::mutex> lock{m_mutex, std::try_to_lock};
+
+    if (lock.owns_lock()) {
+      reclaim_expired(m_orphans, epoch);
+    }
+  }
+
+private:
+  void seal(PL_INOUT epoch_participant& p)
+  {
+    if (p.pending.empty()) {
+      return;
+    }
+
+    // the objects were unlinked before the epoch is read.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::uint64_t epoch{m_epoch.load(std::memory_order_relaxed)};
+    p.sealed.push_back(retired_batch{epoch, std::move(p.pending)});
+    p.pending.clear();
+  }
+
+  void try_advance()
+  {
+    std::uint64_t epoch{m_epoch.load(std::memory_order_relaxed)};
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    for (epoch_participant* p{m_head.load(std::memory_order_acquire)};
+         p != nullptr;
+         p = p->next) {
+      const std::uint64_t state{p->state.load(std::memory_order_relaxed)};
+
+      if (((state & 1U) != 0U) && ((state >> 1U) != epoch)) {
+        return; // a pinned thread hasn't observed the epoch yet.
+      }
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    (void)m_epoch.compare_exchange_strong(
+      epoch, epoch + 1U, std::memory_order_release, std::memory_order_relaxed);
+  }
+
+  static void reclaim_expired(
+    PL_INOUT std::deque<retired_batch>& batches,
+    std::uint64_t                       epoch)
+  {
+    // the batches are ordered by their epochs.
+    while (!batches.empty() && ((epoch - batches.front().epoch) >= 2U)) {
+      const retired_batch batch{std::move(batches.front())};
+      batches.pop_front();
+      reclaim_all(batch.objects.begin(), batch.objects.end());
+    }
+  }
+
+  std::atomic<std::uint64_t>      m_epoch;   //!< the global epoch.
+  std::atomic<epoch_participant*> m_head;    //!< all the participants.
+  std::mutex                      m_mutex;   //!< guards m_orphans.
+  std::deque<retired_batch>       m_orphans; //!< from threads that exited.
+};
+
+inline epoch_state& get_epoch_state()
+{
+  static epoch_state state{};
+  return state;
+}
+
+/*!
+ * \brief Owns the participant of the calling thread until it exits.
+ **/
+class epoch_participant_holder {
+public:
+  using this_type = epoch_participant_holder;
+
+  epoch_participant_holder() : participant{get_epoch_state().acquire()}
+  {
+  }
+
+  epoch_participant_holder(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  ~epoch_participant_holder()
+  {
+    get_epoch_state().release(*participant);
+  }
+
+  epoch_participant* const participant;
+};
+
+inline epoch_participant& local_epoch_participant()
+{
+  // the epoch_state is constructed first, so that it outlives this.
+  (void)get_epoch_state();
+  static thread_local epoch_participant_holder holder{};
+  return *holder.participant;
+}
+
+/*!
+ * \brief A slot that publishes a pointer that is being accessed.
+ **/
+struct hazard_record {
+  hazard_record() : pointer{nullptr}, in_use{true}, next{nullptr}
+  {
+  }
+
+  hazard_record(const hazard_record&) = delete;
+
+  hazard_record& operator=(const hazard_record&) = delete;
+
+  std::atomic<const void*> pointer; //!< the pointer protected.
+  std::atomic<bool>        in_use;  //!< whether a hazard_pointer owns this.
+  hazard_record*           next;    //!< the next record, immutable.
+};
+
+/*!
+ * \brief The process wide state of the hazard pointers.
+ **/
+class hazard_state {
+public:
+  using this_type = hazard_state;
+
+  /*!
+   * \brief The amount of objects a thread may retire in addition to twice
+   *        the amount of hazard pointers before it scans them.
+   **/
+  static constexpr std::size_t scan_threshold{64U};
+
+  hazard_state() : m_head{nullptr}, m_record_count{0U}, m_mutex{}, m_orphans{}
+  {
+  }
+
+  hazard_state(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  ~hazard_state()
+  {
+    hazard_record* r{m_head.load(std::memory_order_acquire)};
+
+    while (r != nullptr) {
+      hazard_record* const next{r->next};
+      delete r;
+      r = next;
+    }
+
+    reclaim_all(m_orphans.begin(), m_orphans.end());
+  }
+
+  hazard_record* acquire()
+  {
+    for (hazard_record* r{m_head.load(std::memory_order_acquire)};
+         r != nullptr;
+         r = r->next) {
+      bool expected{false};
+
+      if (r->in_use.compare_exchange_strong(
+            expected, true, std::memory_order_acquire)) {
+        return r;
+      }
+    }
+
+    hazard_record* const r{new hazard_record{}};
+    r->next = m_head.load(std::memory_order_relaxed);
+
+    while (!m_head.compare_exchange_weak(
+      r->next, r, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+
+    m_record_count.fetch_add(1U, std::memory_order_relaxed);
+    return r;
+  }
+
+  void release(PL_INOUT hazard_record& r)
+  {
+    r.pointer.store(nullptr, std::memory_order_release);
+    r.in_use.store(false, std::memory_order_release);
+  }
+
+  /*!
+   * \brief Whether a thread that retired count objects should scan.
+   **/
+  PL_NODISCARD bool should_scan(std::size_t count) const
+  {
+    return count
+           >= (m_record_count.load(std::memory_order_relaxed) * 2U
+               + scan_threshold);
+  }
+
+  /*!
+   * \brief Reclaims the objects in retired that are not protected by any
+   *        hazard pointer, the others remain in retired.
+   **/
+  void scan(PL_INOUT std::vector<retired_object>& retired)
+  {
+    // the objects were unlinked before the hazard pointers are read.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::vector<const void*> hazards{};
+
+    for (hazard_record* r{m_head.load(std::memory_order_acquire)};
+         r != nullptr;
+         r = r->next) {
+      const void* const p{r->pointer.load(std::memory_order_acquire)};
+
+      if (p != nullptr) {
+        hazards.push_back(p);
+      }
+    }
+
+    std::sort(hazards.begin(), hazards.end());
+    reclaim_unprotected(retired, hazards);
+    std::unique_lock<std::mutex> lock{m_mutex, std::try_to_lock};
+
+    if (lock.owns_lock()) {
+      reclaim_unprotected(m_orphans, hazards);
+    }
+  }
+
+  /*!
+   * \brief Hands over the objects retired by a thread that exits.
+   **/
+  void orphan(PL_INOUT std::vector<retired_object>& retired)
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    m_orphans.insert(
+      m_orphans.end(),
+      std::make_move_iterator(retired.begin()),
+      std::make_move_iterator(retired.end()));
+    retired.clear();
+  }
+
+private:
+  static void reclaim_unprotected(
+    PL_INOUT std::vector<retired_object>& retired,
+    PL_IN const std::vector<const void*>& hazards)
+  {
+    std::vector<retired_object> reclaimable{};
+    auto                        it = retired.begin();
+
+    for (const retired_object& obj : retired) {
+      const void* const pointer{obj.pointer};
+
+      if (std::binary_search(hazards.begin(), hazards.end(), pointer)) {
+        *it++ = obj; // still protected.
+      }
+      else {
+        reclaimable.push_back(obj);
+      }
+    }
+
+    retired.erase(it, retired.end());
+    reclaim_all(reclaimable.begin(), reclaimable.end());
+  }
+
+  std::atomic<hazard_record*> m_head;         //!< all the records.
+  std::atomic<std::size_t>    m_record_count; //!< the amount of records.
+  std::mutex                  m_mutex;        //!< guards m_orphans.
+  std::vector<retired_object> m_orphans; //!< from threads that exited.
+};
+
+inline hazard_state& get_hazard_state()
+{
+  static hazard_state state{};
+  return state;
+}
+
+/*!
+ * \brief The objects retired by the calling thread that are not yet
+ *        reclaimed.
+ **/
+class hazard_retire_list {
+public:
+  using this_type = hazard_retire_list;
+
+  hazard_retire_list() : objects{}
+  {
+  }
+
+  hazard_retire_list(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  ~hazard_retire_list()
+  {
+    get_hazard_state().scan(objects);
+
+    if (!objects.empty()) {
+      get_hazard_state().orphan(objects);
+    }
+  }
+
+  std::vector<retired_object> objects;
+};
+
+inline hazard_retire_list& local_hazard_retire_list()
+{
+  // the hazard_state is constructed first, so that it outlives this.
+  (void)get_hazard_state();
+  static thread_local hazard_retire_list list{};
+  return list;
+}
+} // namespace detail
+
+/*!
+ * \brief Pins the calling thread to the current epoch while it is alive.
+ *        Objects retired using epoch_retire are not reclaimed while a
+ *        thread that could have obtained a pointer to them is pinned.
+ * \note epoch_guards may be nested.
+ * \warning Pointers to shared objects that may be retired must only be
+ *          used while an epoch_guard is alive.
+ *
+ * Pinning and unpinning are cheap and never block, so that readers of
+ * lock-free data structures can pin for every operation. Memory is
+ * reclaimed in batches, but a thread that stays pinned prevents all
+ * reclamation. Use hazard pointers if that is not acceptable.
+ **/
+class epoch_guard {
+public:
+  using this_type = epoch_guard;
+
+  /*!
+   * \brief Pins the calling thread.
+   **/
+  epoch_guard() : m_participant{detail::local_epoch_participant()}
+  {
+    detail::get_epoch_state().pin(m_participant);
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  epoch_guard(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Unpins the calling thread if this is the outermost epoch_guard.
+   **/
+  ~epoch_guard()
+  {
+    detail::get_epoch_state().unpin(m_participant);
+  }
+
+private:
+  detail::epoch_participant& m_participant; //!< of the calling thread.
+};
+
+/*!
+ * \brief Retires an object that has been unlinked from a shared data
+ *        structure. It will be reclaimed once no thread that was pinned
+ *        when it was retired is pinned any longer.
+ * \param pointer The object to reclaim.
+ * \param deleter Will be called with pointer to reclaim the object.
+ * \note The objects are reclaimed in batches by the threads retiring them.
+ **/
+inline void epoch_retire(void* pointer, void (*deleter)(void*))
+{
+  detail::get_epoch_state().retire(
+    detail::local_epoch_participant(),
+    detail::retired_object{pointer, deleter});
+}
+
+/*!
+ * \brief Retires an object that has been unlinked from a shared data
+ *        structure. It will be deleted once no thread that was pinned
+ *        when it was retired is pinned any longer.
+ * \param pointer The object to delete, must have been allocated using new.
+ **/
+template<typename Ty>
+void epoch_retire(Ty* pointer)
+{
+  epoch_retire(pointer, &detail::delete_retired<Ty>);
+}
+
+/*!
+ * \brief Attempts to reclaim the objects retired by the calling thread
+ *        without waiting for a full batch.
+ * \note Every object is only reclaimed once the global epoch has advanced
+ *       twice, which requires at least two calls.
+ **/
+inline void epoch_collect()
+{
+  detail::get_epoch_state().collect(detail::local_epoch_participant());
+}
+
+/*!
+ * \brief A hazard pointer. Protects a single object from being reclaimed
+ *        while other threads retire it using hazard_retire.
+ *
+ * Unlike with epoch based reclamation a thread that doesn't make progress
+ * can only keep the objects it protects from being reclaimed, so that the
+ * amount of objects that are retired but not yet reclaimed is bounded.
+ **/
+class hazard_pointer {
+public:
+  using this_type = hazard_pointer;
+
+  /*!
+   * \brief Acquires a hazard pointer that doesn't protect anything.
+   **/
+  hazard_pointer() : m_record{detail::get_hazard_state().acquire()}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  hazard_pointer(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Releases the hazard pointer, so that the object it protected
+   *        may be reclaimed.
+   **/
+  ~hazard_pointer()
+  {
+    detail::get_hazard_state().release(*m_record);
+  }
+
+  /*!
+   * \brief Loads the pointer stored in source and protects the object it
+   *        points to.
+   * \param source The atomic pointer to load.
+   * \return The pointer loaded. The object it points to can be accessed
+   *         safely until this hazard_pointer protects something else.
+   **/
+  template<typename Ty>
+  Ty* protect(PL_IN const std::atomic<Ty*>& source) noexcept
+  {
+    Ty* pointer{source.load(std::memory_order_relaxed)};
+
+    for (;;) {
+      m_record->pointer.store(pointer, std::memory_order_seq_cst);
+
+      // seq_cst orders the load after the store above, an acquire load
+      // could be satisfied before the hazard is visible to the reclaimer.
+      Ty* const reloaded{source.load(std::memory_order_seq_cst)};
+
+      // the object wasn't retired before it was protected.
+      if (reloaded == pointer) {
+        return pointer;
+      }
+
+      pointer = reloaded;
+    }
+  }
+
+  /*!
+   * \brief Stops protecting the object.
+   **/
+  void reset() noexcept
+  {
+    m_record->pointer.store(nullptr, std::memory_order_release);
+  }
+
+private:
+  detail::hazard_record* const m_record; //!< the published slot.
+};
+
+/*!
+ * \brief Retires an object that has been unlinked from a shared data
+ *        structure. It will be reclaimed once no hazard_pointer protects
+ *        it.
+ * \param pointer The object to reclaim.
+ * \param deleter Will be called with pointer to reclaim the object.
+ **/
+inline void hazard_retire(void* pointer, void (*deleter)(void*))
+{
+  detail::hazard_retire_list& list{detail::local_hazard_retire_list()};
+  list.objects.push_back(detail::retired_object{pointer, deleter});
+
+  if (detail::get_hazard_state().should_scan(list.objects.size())) {
+    detail::get_hazard_state().scan(list.objects);
+  }
+}
+
+/*!
+ * \brief Retires an object that has been unlinked from a shared data
+ *        structure. It will be deleted once no hazard_pointer protects it.
+ * \param pointer The object to delete, must have been allocated using new.
+ **/
+template<typename Ty>
+void hazard_retire(Ty* pointer)
+{
+  hazard_retire(pointer, &detail::delete_retired<Ty>);
+}
+
+/*!
+ * \brief Reclaims the objects retired by the calling thread that are not
+ *        protected by any hazard_pointer.
+ **/
+inline void hazard_collect()
+{
+  detail::get_hazard_state().scan(detail::local_hazard_retire_list().objects);
+}
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_RECLAMATION_HPP
@@ -0,0 +1,176 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file sharded_counter.hpp
+ * \brief Defines the pl::thd::sharded_counter class.
+ **/
+#ifndef INCG_PL_THD_SHARDED_COUNTER_HPP
+#define INCG_PL_THD_SHARDED_COUNTER_HPP
+#include "../annotations.hpp"   // PL_NODISCARD
+#include "../assert.hpp"        // PL_CHECK_PRE
+#include "../cache_aligned.hpp" // pl::cache_aligned, pl::cache_aligned_allocator
+#include <atomic>               // std::atomic
+#include <cstddef>              // std::size_t
+#include <cstdint>              // std::int64_t
+#include <thread>               // std::thread::hardware_concurrency
+#include <vector>               // std::vector
+
+namespace pl {
+namespace thd {
+/*!
+ * \brief A counter that many threads can modify concurrently without
+ *        contending on a single cache line.
+ *
+ * The counter is split into shards that each occupy cache lines of their
+ * own. Every thread is assigned a shard when it first uses a
+ * sharded_counter and only modifies that shard, reading the counter sums up
+ * all the shards. Modifying is therefore cheap and reading is expensive,
+ * which suits statistics that are updated often and read rarely.
+ **/
+class sharded_counter {
+public:
+  using this_type  = sharded_counter;
+  using value_type = std::int64_t;
+
+  /*!
+   * \brief Creates a sharded_counter whose value is 0.
+   * \param shard_count The amount of shards, will be rounded up to a power
+   *                    of 2. Defaults to the amount of hardware threads.
+   **/
+  explicit sharded_counter(
+    std::size_t shard_count = std::thread::hardware_concurrency())
+    : m_mask{round_up_to_power_of_2(shard_count) - 1U}, m_shards(m_mask + 1U)
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  sharded_counter(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Adds delta to the counter.
+   * \param delta The value to add, may be negative.
+   **/
+  void add(value_type delta) noexcept
+  {
+    m_shards[thread_index() & m_mask]->fetch_add(
+      delta, std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Adds 1 to the counter.
+   **/
+  void increment() noexcept
+  {
+    add(1);
+  }
+
+  /*!
+   * \brief Subtracts 1 from the counter.
+   **/
+  void decrement() noexcept
+  {
+    add(-1);
+  }
+
+  /*!
+   * \brief Reads the counter by summing up all the shards.
+   * \return The value of the counter.
+   * \note The result is only a snapshot while other threads modify the
+   *       counter concurrently.
+   **/
+  PL_NODISCARD value_type load() const noexcept
+  {
+    value_type sum{0};
+
+    for (const cache_aligned<std::atomic<value_type>>& shard : m_shards) {
+      sum += shard->load(std::memory_order_relaxed);
+    }
+
+    return sum;
+  }
+
+  /*!
+   * \brief Sets the counter to 0.
+   * \warning Modifications made concurrently may be lost.
+   **/
+  void reset() noexcept
+  {
+    for (cache_aligned<std::atomic<value_type>>& shard : m_shards) {
+      shard->store(0, std::memory_order_relaxed);
+    }
+  }
+
+  /*!
+   * \brief Queries the amount of shards.
+   * \return The amount of shards.
+   **/
+  PL_NODISCARD std::size_t shard_count() const noexcept
+  {
+    return m_shards.size();
+  }
+
+private:
+  static std::size_t round_up_to_power_of_2(std::size_t shard_count) noexcept
+  {
+    std::size_t result{1U};
+
+    while (result < shard_count) {
+      result <<= 1U;
+    }
+
+    return result;
+  }
+
+  /*!
+   * \brief Returns the index assigned to the calling thread. The threads
+   *        are assigned consecutive indices, so that the first threads
+   *        don't share shards.
+   **/
+  static std::size_t thread_index() noexcept
+  {
+    static std::atomic<std::size_t> next_index{0U};
+    static thread_local const std::size_t index{
+      next_index.fetch_add(1U, std::memory_order_relaxed)};
+    return index;
+  }
+
+  const std::size_t m_mask; //!< shard_count() - 1.
+  std::vector<
+    cache_aligned<std::atomic<value_type>>,
+    cache_aligned_allocator<cache_aligned<std::atomic<value_type>>>>
+    m_shards; //!< shards.
+};
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_SHARDED_COUNTER_HPP
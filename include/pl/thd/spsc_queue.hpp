@@ -0,0 +1,486 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file spsc_queue.hpp
+ * \brief This header file defines the pl::thd::spsc_queue class
+ **/
+#ifndef INCG_PL_THD_SPSC_QUEUE_HPP
+#define INCG_PL_THD_SPSC_QUEUE_HPP
+#include "../annotations.hpp"   // PL_IN, PL_OUT, PL_NODISCARD
+#include "../assert.hpp"        // PL_CHECK_PRE
+#include "../cache_aligned.hpp" // pl::hardware_destructive_interference_size
+#include "../compiler.hpp"      // PL_COMPILER, PL_COMPILER_MSVC
+#include "atomic_wait.hpp" // pl::thd::atomic_wait, pl::thd::atomic_notify_one
+#include <atomic>          // std::atomic, std::atomic_thread_fence
+#include <cstddef>         // std::size_t
+#include <cstdint>         // std::uint32_t
+#include <memory>          // std::unique_ptr, std::make_unique
+#include <new>             // new
+#include <type_traits>     // std::aligned_storage
+#include <utility>         // std::move, std::forward
+
+namespace pl {
+namespace thd {
+#if PL_COMPILER == PL_COMPILER_MSVC
+#pragma warning(push)
+#pragma warning(disable : 4324) // structure was padded due to alignment
+#endif                          // PL_COMPILER == PL_COMPILER_MSVC
+
+/*!
+ * \brief A fixed capacity wait-free first in first out queue for exactly one
+ *        producer thread and exactly one consumer thread.
+ * \note If IsBlocking is true the blocking push and pop member functions
+ *       can be used in addition to the try_ member functions. This costs
+ *       a memory fence per operation that the non-blocking queue doesn't
+ *       need.
+ * \warning Only one thread may call the pushing member functions and only
+ *          one thread may call the popping member functions at any time.
+ *
+ * The producer and the consumer each own an index into the ring buffer.
+ * Both indices live on separate cache lines alongside a cached copy of the
+ * other side's index, so that the cache line of the other side only has to
+ * be read when the cached index indicates that the queue is full or empty
+ * respectively.
+ **/
+template<typename ValueType, bool IsBlocking = false>
+class spsc_queue {
+public:
+  using this_type  = spsc_queue;
+  using value_type = ValueType;
+  using size_type  = std::size_t;
+
+  /*!
+   * \brief Creates an empty spsc_queue.
+   * \param capacity The minimum amount of elements that the queue shall be
+   *                 able to hold. Will be rounded up to the next power of 2.
+   *                 Must be within [1..2^31].
+   **/
+  explicit spsc_queue(size_type capacity)
+    : m_mask{round_up_to_power_of_2(capacity) - 1U}
+    , m_storage{std::make_unique<storage_type[]>(size_type{m_mask} + 1U)}
+    , m_tail{0U}
+    , m_cached_head{0U}
+    , m_consumer_waiting{0U}
+    , m_head{0U}
+    , m_cached_tail{0U}
+    , m_producer_waiting{0U}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  spsc_queue(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Destroys the elements still in the queue.
+   **/
+  ~spsc_queue()
+  {
+    const index_type tail{m_tail.load(std::memory_order_acquire)};
+
+    for (index_type i{m_head.load(std::memory_order_acquire)}; i != tail; ++i) {
+      slot(i)->~value_type();
+    }
+  }
+
+  /*!
+   * \brief Constructs an element in place at the back of the queue, if the
+   *        queue is not full. Only to be called by the producer.
+   * \param args The arguments to construct the element from.
+   * \return true if the element was pushed; false if the queue was full.
+   **/
+  template<typename... Args>
+  bool try_emplace(Args&&... args)
+  {
+    const index_type tail{m_tail.load(std::memory_order_relaxed)};
+
+    if (free_slots(tail) == 0U) {
+      return false;
+    }
+
+    ::new (static_cast<void*>(slot(tail)))
+      value_type(std::forward<Args>(args)...);
+    publish_tail(tail + 1U);
+    return true;
+  }
+
+  /*!
+   * \brief Pushes data to the back of the queue, if the queue is not full.
+   *        Only to be called by the producer.
+   * \param data The object to push.
+   * \return true if data was pushed; false if the queue was full.
+   **/
+  bool try_push(PL_IN const value_type& data)
+  {
+    return try_emplace(data);
+  }
+
+  /*!
+   * \brief Pushes data to the back of the queue, if the queue is not full.
+   *        Only to be called by the producer.
+   * \param data The rvalue to push.
+   * \return true if data was pushed; false if the queue was full.
+   * \note data is left untouched if it could not be pushed.
+   **/
+  bool try_push(PL_IN value_type&& data)
+  {
+    return try_emplace(std::move(data));
+  }
+
+  /*!
+   * \brief Pushes as many elements of [first, first + count) as there's
+   *        space for to the back of the queue.
+   *        Only to be called by the producer.
+   * \param first Iterator to the first element of the elements to push.
+   *              Use std::make_move_iterator to move the elements.
+   * \param count The amount of elements to push.
+   * \return The amount of elements that were pushed.
+   * \note The elements pushed are published to the consumer at once.
+   **/
+  template<typename InputIterator>
+  size_type try_push_bulk(InputIterator first, size_type count)
+  {
+    const index_type tail{m_tail.load(std::memory_order_relaxed)};
+    index_type       amount{free_slots(tail, count)};
+
+    if (count < amount) {
+      amount = static_cast<index_type>(count);
+    }
+
+    index_type i{0U};
+
+    try {
+      for (; i < amount; ++i, ++first) {
+        ::new (static_cast<void*>(slot(tail + i))) value_type(*first);
+      }
+    }
+    catch (...) {
+      for (index_type j{0U}; j < i; ++j) {
+        slot(tail + j)->~value_type();
+      }
+
+      throw;
+    }
+
+    if (amount != 0U) {
+      publish_tail(tail + amount);
+    }
+
+    return amount;
+  }
+
+  /*!
+   * \brief Removes the first element and moves it into destination, if the
+   *        queue is not empty. Only to be called by the consumer.
+   * \param destination The object to move the element into.
+   * \return true if an element was removed; false if the queue was empty.
+   **/
+  bool try_pop(PL_OUT value_type& destination)
+  {
+    const index_type head{m_head.load(std::memory_order_relaxed)};
+
+    if (used_slots(head) == 0U) {
+      return false;
+    }
+
+    value_type* const p{slot(head)};
+    destination = std::move(*p);
+    p->~value_type();
+    publish_head(head + 1U);
+    return true;
+  }
+
+  /*!
+   * \brief Moves up to max_count elements from the front of the queue to
+   *        out. Only to be called by the consumer.
+   * \param out The output iterator to write the elements to.
+   * \param max_count The maximum amount of elements to remove.
+   * \return The amount of elements that were removed.
+   * \warning Moving value_type objects must not throw.
+   * \note The slots freed are published to the producer at once.
+   **/
+  template<typename OutputIterator>
+  size_type try_pop_bulk(OutputIterator out, size_type max_count)
+  {
+    const index_type head{m_head.load(std::memory_order_relaxed)};
+    index_type       amount{used_slots(head, max_count)};
+
+    if (max_count < amount) {
+      amount = static_cast<index_type>(max_count);
+    }
+
+    for (index_type i{0U}; i < amount; ++i, ++out) {
+      value_type* const p{slot(head + i)};
+      *out = std::move(*p);
+      p->~value_type();
+    }
+
+    if (amount != 0U) {
+      publish_head(head + amount);
+    }
+
+    return amount;
+  }
+
+  /*!
+   * \brief Pushes data to the back of the queue. Blocks while the queue is
+   *        full. Only to be called by the producer.
+   * \param data The object to push.
+   * \note Only available if IsBlocking is true.
+   **/
+  void push(PL_IN const value_type& data)
+  {
+    emplace_blocking(data);
+  }
+
+  /*!
+   * \brief Pushes data to the back of the queue. Blocks while the queue is
+   *        full. Only to be called by the producer.
+   * \param data The rvalue to push.
+   * \note Only available if IsBlocking is true.
+   **/
+  void push(PL_IN value_type&& data)
+  {
+    emplace_blocking(std::move(data));
+  }
+
+  /*!
+   * \brief Removes the first element and returns it. Blocks while the
+   *        queue is empty. Only to be called by the consumer.
+   * \return The element that used to be at the front of the queue.
+   * \note Only available if IsBlocking is true.
+   **/
+  value_type pop()
+  {
+    static_assert(IsBlocking, "pop requires IsBlocking to be true.");
+    const index_type head{m_head.load(std::memory_order_relaxed)};
+
+    while (used_slots(head) == 0U) {
+      wait_while_equal(m_tail, head, m_consumer_waiting);
+    }
+
+    value_type* const p{slot(head)};
+    value_type        result{std::move(*p)};
+    p->~value_type();
+    publish_head(head + 1U);
+    return result;
+  }
+
+  /*!
+   * \brief Queries the queue as to whether or not it is empty.
+   * \return true if the queue is empty; false otherwise.
+   * \note The result may be outdated as soon as it is returned if the
+   *       other thread modifies the queue concurrently.
+   **/
+  PL_NODISCARD bool empty() const noexcept
+  {
+    return size() == 0U;
+  }
+
+  /*!
+   * \brief Queries the queue's size.
+   * \return The size of the queue.
+   * \note The result may be outdated as soon as it is returned if the
+   *       other thread modifies the queue concurrently.
+   **/
+  PL_NODISCARD size_type size() const noexcept
+  {
+    const index_type head{m_head.load(std::memory_order_acquire)};
+    return static_cast<index_type>(
+      m_tail.load(std::memory_order_acquire) - head);
+  }
+
+  /*!
+   * \brief Queries the queue's capacity.
+   * \return The maximum amount of elements the queue can hold.
+   **/
+  PL_NODISCARD size_type capacity() const noexcept
+  {
+    return size_type{m_mask} + 1U;
+  }
+
+private:
+  /*!
+   * \brief Type of the indices. The indices grow indefinitely and wrap
+   *        around. 32 bits so that they can be waited on.
+   **/
+  using index_type = std::uint32_t;
+
+  using storage_type = typename std::
+    aligned_storage<sizeof(value_type), alignof(value_type)>::type;
+
+  static constexpr std::size_t cache_line_size{
+    hardware_destructive_interference_size};
+  static constexpr int spin_count{64};
+
+  static index_type round_up_to_power_of_2(size_type capacity)
+  {
+    PL_CHECK_PRE((capacity != 0U) && (capacity <= (size_type{1U} << 31U)));
+    index_type result{1U};
+
+    while (result < capacity) {
+      result <<= 1U;
+    }
+
+    return result;
+  }
+
+  value_type* slot(index_type index) const noexcept
+  {
+    return reinterpret_cast<value_type*>(&m_storage[index & m_mask]);
+  }
+
+  /*!
+   * \brief Returns the amount of slots the producer can write to.
+   *        Only reloads the consumer's index if the cached copy indicates
+   *        fewer than wanted free slots.
+   **/
+  index_type free_slots(index_type tail, size_type wanted = 1U) noexcept
+  {
+    index_type amount{
+      static_cast<index_type>(m_mask + 1U - (tail - m_cached_head))};
+
+    if (amount < wanted) {
+      m_cached_head = m_head.load(std::memory_order_acquire);
+      amount = static_cast<index_type>(m_mask + 1U - (tail - m_cached_head));
+    }
+
+    return amount;
+  }
+
+  /*!
+   * \brief Returns the amount of elements the consumer can read.
+   *        Only reloads the producer's index if the cached copy indicates
+   *        fewer than wanted elements.
+   **/
+  index_type used_slots(index_type head, size_type wanted = 1U) noexcept
+  {
+    index_type amount{static_cast<index_type>(m_cached_tail - head)};
+
+    if (amount < wanted) {
+      m_cached_tail = m_tail.load(std::memory_order_acquire);
+      amount        = static_cast<index_type>(m_cached_tail - head);
+    }
+
+    return amount;
+  }
+
+  void publish_tail(index_type tail) noexcept
+  {
+    m_tail.store(tail, std::memory_order_release);
+    notify_if_waiting(m_tail, m_consumer_waiting);
+  }
+
+  void publish_head(index_type head) noexcept
+  {
+    m_head.store(head, std::memory_order_release);
+    notify_if_waiting(m_head, m_producer_waiting);
+  }
+
+  template<typename Ty>
+  void emplace_blocking(Ty&& data)
+  {
+    static_assert(IsBlocking, "push requires IsBlocking to be true.");
+    const index_type tail{m_tail.load(std::memory_order_relaxed)};
+
+    while (free_slots(tail) == 0U) {
+      // the producer waits for the consumer's index to move.
+      wait_while_equal(
+        m_head,
+        static_cast<index_type>(tail - m_mask - 1U),
+        m_producer_waiting);
+    }
+
+    ::new (static_cast<void*>(slot(tail))) value_type(std::forward<Ty>(data));
+    publish_tail(tail + 1U);
+  }
+
+  /*!
+   * \brief Spins for a while and then blocks until index no longer holds
+   *        value.
+   **/
+  static void wait_while_equal(
+    PL_IN const std::atomic<index_type>& index,
+    index_type                           value,
+    PL_INOUT std::atomic<std::uint32_t>& is_waiting) noexcept
+  {
+    for (int i{0}; i < spin_count; ++i) {
+      if (index.load(std::memory_order_acquire) != value) {
+        return;
+      }
+    }
+
+    is_waiting.store(1U, std::memory_order_relaxed);
+    // pairs with the fence in notify_if_waiting: either the other side
+    // sees is_waiting set or this side sees the new index.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    atomic_wait(index, value);
+    is_waiting.store(0U, std::memory_order_relaxed);
+  }
+
+  static void notify_if_waiting(
+    PL_INOUT std::atomic<index_type>&       index,
+    PL_IN const std::atomic<std::uint32_t>& is_waiting) noexcept
+  {
+    if (!IsBlocking) {
+      return;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (is_waiting.load(std::memory_order_relaxed) != 0U) {
+      atomic_notify_one(index);
+    }
+  }
+
+  // read-only after construction.
+  const index_type                m_mask;    //!< capacity - 1
+  std::unique_ptr<storage_type[]> m_storage; //!< the ring buffer.
+
+  // written by the producer.
+  alignas(cache_line_size) std::atomic<index_type> m_tail; //!< write index.
+  index_type m_cached_head; //!< the producer's copy of m_head.
+  std::atomic<std::uint32_t> m_consumer_waiting; //!< set by the consumer.
+
+  // written by the consumer.
+  alignas(cache_line_size) std::atomic<index_type> m_head; //!< read index.
+  index_type m_cached_tail; //!< the consumer's copy of m_tail.
+  std::atomic<std::uint32_t> m_producer_waiting; //!< set by the producer.
+};
+
+#if PL_COMPILER == PL_COMPILER_MSVC
+#pragma warning(pop)
+#endif // PL_COMPILER == PL_COMPILER_MSVC
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_SPSC_QUEUE_HPP
@@ -0,0 +1,196 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file strand.hpp
+ * \brief Defines the strand class that runs tasks one after another on a
+ *        thread_pool.
+ **/
+#ifndef INCG_PL_THD_STRAND_HPP
+#define INCG_PL_THD_STRAND_HPP
+#include "../annotations.hpp"     // PL_INOUT, PL_NODISCARD
+#include "../unique_function.hpp" // pl::unique_function
+#include "thread_pool.hpp"        // pl::thd::thread_pool
+#include <condition_variable>     // std::condition_variable
+#include <cstddef>                // std::size_t
+#include <cstdint>                // std::uint8_t
+#include <deque>                  // std::deque
+#include <mutex> // std::mutex, std::unique_lock, std::lock_guard
+#include <utility>                // std::move
+
+namespace pl {
+namespace thd {
+/*!
+ * \brief Runs the tasks posted to it one after another, in the order they
+ *        were posted, on the threads of a thread_pool.
+ *
+ * A strand does not own a thread. As long as there are tasks in its
+ * mailbox a single task of the thread_pool runs them, once the mailbox is
+ * empty the thread is given back to the thread_pool. Thus any amount of
+ * strands can share a thread_pool, each strand behaving as if it had a
+ * thread of its own.
+ **/
+class strand {
+public:
+  using this_type = strand;
+  using task_type = ::pl::unique_function<void()>;
+
+  /*!
+   * \brief Creates a strand.
+   * \param pool The thread_pool to run the tasks on. Must outlive the
+   *             strand.
+   **/
+  explicit strand(PL_INOUT thread_pool& pool);
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  strand(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Destroys the strand.
+   * \warning Blocks until all the tasks posted have been run.
+   **/
+  ~strand();
+
+  /*!
+   * \brief Adds task to the back of the mailbox.
+   * \param task The task to run. Exceptions thrown by task are discarded.
+   *
+   * Schedules the strand on the thread_pool if it isn't already scheduled.
+   **/
+  void post(task_type task);
+
+  /*!
+   * \brief Queries the amount of tasks in the mailbox that have not yet
+   *        been started.
+   * \return The count of tasks waiting to be run.
+   **/
+  PL_NODISCARD std::size_t tasks_waiting_for_execution() const;
+
+private:
+  /*!
+   * \brief Upper bound for the amount of tasks run before the strand gives
+   *        its thread back to the thread_pool, so that a busy strand can't
+   *        starve the other users of the thread_pool.
+   **/
+  static constexpr std::size_t max_batch_size{64U};
+
+  /*!
+   * \brief Runs tasks from the mailbox until it's empty or max_batch_size
+   *        tasks have been run.
+   **/
+  void run_batch();
+
+  void schedule();
+
+  thread_pool&            m_pool;         //!< the pool to run on.
+  mutable std::mutex      m_mutex;        //!< guards the shared data.
+  std::condition_variable m_cv_idle;      //!< signalled when idle.
+  std::deque<task_type>   m_mailbox;      //!< the tasks to run.
+  bool                    m_is_scheduled; //!< whether a task is on the pool.
+};
+
+inline strand::strand(PL_INOUT thread_pool& pool)
+  : m_pool{pool}, m_mutex{}, m_cv_idle{}, m_mailbox{}, m_is_scheduled{false}
+{
+}
+
+inline strand::~strand()
+{
+  std::unique_lock<std::mutex> lock{m_mutex};
+  m_cv_idle.wait(lock, [this] { return !m_is_scheduled; });
+}
+
+inline void strand::post(task_type task)
+{
+  std::unique_lock<std::mutex> lock{m_mutex};
+  m_mailbox.push_back(std::move(task));
+
+  if (m_is_scheduled) {
+    return; // the task running the strand will pick it up.
+  }
+
+  m_is_scheduled = true;
+  lock.unlock();
+  schedule();
+}
+
+PL_NODISCARD inline std::size_t strand::tasks_waiting_for_execution() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  (void)lock;
+  return m_mailbox.size();
+}
+
+inline void strand::run_batch()
+{
+  for (std::size_t i{0U}; i < max_batch_size; ++i) {
+    task_type task{};
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      (void)lock;
+
+      if (m_mailbox.empty()) {
+        m_is_scheduled = false;
+        // notify while holding the lock, as the strand may be destroyed
+        // as soon as the lock is released.
+        m_cv_idle.notify_all();
+        return;
+      }
+
+      task = std::move(m_mailbox.front());
+      m_mailbox.pop_front();
+    }
+
+    try {
+      task();
+    }
+    catch (...) {
+      // discard the exception, the strand has to keep going.
+    }
+  }
+
+  // there may be more tasks, but let the other users of the pool go first.
+  schedule();
+}
+
+inline void strand::schedule()
+{
+  // bypasses the overflow_policy, as the strand is only scheduled again
+  // once this task has run.
+  (void)m_pool.force_add_task(
+    static_cast<std::uint8_t>(0U), [this] { run_batch(); });
+}
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_STRAND_HPP
@@ -30,49 +30,136 @@
  **/
 #ifndef INCG_PL_THD_THREAD_POOL_HPP
 #define INCG_PL_THD_THREAD_POOL_HPP
-#include "../algo/destroy.hpp" // pl::algo::destroy
-#include "../annotations.hpp"  // PL_IN, PL_NODISCARD
-#include "../apply.hpp"        // pl::apply
-#include "../byte.hpp"         // pl::byte
-#include <algorithm>           // std::for_each
-#include <condition_variable>  // std::condition_variable
-#include <cstddef>             // std::size_t
-#include <cstdint>             // std::uint8_t
-#include <future>              // std::future, std::promise
-#include <memory>              // std::shared_ptr, std::unique_ptr
-#include <mutex>               // std::mutex
-#include <new>                 // new
-#include <queue>               // std::priority_queue
-#include <thread>              // std::thread
-#include <tuple>               // std::make_tuple
-#include <utility>             // std::move
-#include <vector>              // std::vector
+#include "../annotations.hpp"   // PL_IN, PL_NODISCARD
+#include "../apply.hpp"         // pl::apply
+#include "../assert.hpp"        // PL_CHECK_PRE
+#include "../cache_aligned.hpp" // pl::hardware_destructive_interference_size
+#include "../compiler.hpp"      // PL_COMPILER, PL_COMPILER_MSVC
+#include "../hdr_histogram.hpp" // pl::hdr_histogram
+#include "../trace.hpp"         // PL_TRACE_SCOPE, PL_TRACE_THREAD_NAME
+#include "profiled_mutex.hpp"   // pl::thd::condition_variable_for_t
+#include <algorithm> // std::for_each, std::push_heap, std::pop_heap, std::make_heap, std::max
+#include <chrono>               // std::chrono::steady_clock
+#include <cstddef>              // std::size_t
+#include <cstdint>              // std::uint8_t, std::uint64_t
+#include <deque>                // std::deque
+#include <functional>           // std::greater
+#include <future>               // std::future, std::promise
+#include <iterator>             // std::prev
+#include <limits>               // std::numeric_limits
+#include <list>                 // std::list
+#include <memory>               // std::shared_ptr, std::unique_ptr
+#include <mutex>                // std::mutex, std::unique_lock
+#include <stdexcept>            // std::runtime_error
+#include <system_error>         // std::system_error
+#include <thread>               // std::thread
+#include <tuple>                // std::make_tuple
+#include <utility>              // std::move, std::forward, std::pair
+#include <vector>               // std::vector
 
 namespace pl {
 namespace thd {
+#if PL_COMPILER == PL_COMPILER_MSVC
+#pragma warning(push)
+#pragma warning(disable : 4324) // structure was padded due to alignment
+#endif                          // PL_COMPILER == PL_COMPILER_MSVC
+
+/*!
+ * \brief The policies a thread_pool can apply when a task is added while its
+ *        queue of tasks is at its maximum depth.
+ **/
+enum class overflow_policy : std::uint8_t {
+  block,               //!< Blocks the submitting thread until there is room.
+  reject,              //!< Throws pl::thd::task_rejected_exception.
+  caller_runs,         //!< Runs the task on the submitting thread.
+  drop_lowest_priority /*!< Drops the oldest of the tasks with the lowest
+                        *   priority, which may be the task being added.
+                        *   Tasks added with force_add_task are never
+                        *   dropped.
+                        **/
+};
+
+/*!
+ * \brief Exception thrown by thread_pool::add_task if the queue of tasks is
+ *        full and the thread_pool uses overflow_policy::reject.
+ **/
+class task_rejected_exception : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+/*!
+ * \brief The latencies of the tasks run by a thread_pool, recorded once
+ *        enabled with basic_thread_pool::enable_metrics.
+ *
+ * The values are in nanoseconds and are tracked up to an hour with two
+ * significant digits.
+ **/
+struct thread_pool_metrics {
+  hdr_histogram queue_wait{3600000000000U, 2U}; //!< time spent in the queue.
+  hdr_histogram run_time{3600000000000U, 2U};   //!< time taken to run.
+};
+
 /*!
  * \brief A thread pool. Can be created with a count of threads. Will manage
  *        that many threads. Tasks can be added with a priority. The threads
  *        will run the tasks added according to their priority. The count of
  *        threads and the count of tasks still waiting to be executed can be
  *        queried.
+ *
+ * A thread_pool may also be created with a minimum and a maximum count of
+ * threads. It then starts out with the minimum and creates additional threads
+ * while tasks have been waiting for longer than a threshold or while threads
+ * are blocked in a blocking_scope. Threads beyond the minimum that have been
+ * idle for the keepalive period exit.
+ *
+ * The Mutex guarding the queue of tasks can be replaced, e.g. by a
+ * profiled_mutex to find out how contended it is. thread_pool is the
+ * basic_thread_pool that uses std::mutex.
  **/
-class thread_pool {
+template<typename Mutex = std::mutex>
+class basic_thread_pool {
 private:
   class executor_base;
 
 public:
-  using this_type = thread_pool;
+  using this_type  = basic_thread_pool;
+  using mutex_type = Mutex;
+  using clock      = std::chrono::steady_clock;
 
   /*!
-   * \brief Compares two executor_base's priorities.
-   * \param a The first operand.
-   * \param b The second operand.
-   * \return true if a's priority is less than b's priority; false otherwise.
+   * \brief Marks the calling thread as blocked while it is alive, e.g.
+   *        while a task run by the thread_pool waits for I/O. The
+   *        thread_pool may create an additional thread to make up for it.
    **/
-  friend bool operator<(
-    PL_IN const executor_base& a,
-    PL_IN const executor_base& b);
+  class blocking_scope {
+  public:
+    using this_type = blocking_scope;
+
+    /*!
+     * \brief Marks the calling thread as blocked.
+     * \param pool The thread_pool to notify.
+     **/
+    explicit blocking_scope(PL_INOUT basic_thread_pool& pool);
+
+    /*!
+     * \brief This type is non-copyable.
+     **/
+    blocking_scope(const this_type&) = delete;
+
+    /*!
+     * \brief This type is non-copyable.
+     **/
+    this_type& operator=(const this_type&) = delete;
+
+    /*!
+     * \brief Marks the calling thread as no longer being blocked.
+     **/
+    ~blocking_scope();
+
+  private:
+    basic_thread_pool& m_pool; //!< the thread_pool notified.
+  };
 
   /*!
    * \brief Constructs a thread_pool.
@@ -84,13 +171,59 @@ public:
    * You can use std::thread::hardware_concurrency() to get a good amount
    * of threads to be used. However, note that
    * std::thread::hardware_concurrency() may return 0 on error.
+   * The queue of tasks is unbounded.
+   **/
+  explicit basic_thread_pool(std::size_t amt_threads);
+
+  /*!
+   * \brief Constructs a thread_pool whose queue of tasks is bounded.
+   * \param amt_threads The amount of threads that this thread_pool is going
+   *                    to have.
+   * \param max_queue_depth The maximum amount of tasks waiting to be run.
+   *                        Must not be 0.
+   * \param policy What to do when a task is added while max_queue_depth
+   *               tasks are waiting to be run.
+   * \warning When using overflow_policy::block tasks run by this
+   *          thread_pool must not add tasks to it, as that may block all
+   *          of the threads forever.
    **/
-  explicit thread_pool(std::size_t amt_threads);
+  basic_thread_pool(
+    std::size_t     amt_threads,
+    std::size_t     max_queue_depth,
+    overflow_policy policy = overflow_policy::block);
+
+  /*!
+   * \brief Constructs a thread_pool whose count of threads varies.
+   * \param min_threads The amount of threads kept alive at all times.
+   * \param max_threads The maximum amount of threads. Must not be less than
+   *                    min_threads.
+   * \param queue_wait_threshold A thread is added if the oldest task
+   *                             queued has been waiting for at least this
+   *                             long and all the threads are busy. Checked
+   *                             whenever a task is added or taken from the
+   *                             queue and by a supervisor thread once the
+   *                             oldest task reaches the threshold, so that
+   *                             a thread is added even if no tasks are
+   *                             added while all the threads are busy.
+   * \param keepalive How long a thread beyond min_threads may be idle
+   *                  before it exits.
+   * \param max_queue_depth The maximum amount of tasks waiting to be run.
+   *                        Must not be 0.
+   * \param policy What to do when a task is added while max_queue_depth
+   *               tasks are waiting to be run.
+   **/
+  basic_thread_pool(
+    std::size_t     min_threads,
+    std::size_t     max_threads,
+    clock::duration queue_wait_threshold,
+    clock::duration keepalive,
+    std::size_t     max_queue_depth = std::numeric_limits<std::size_t>::max(),
+    overflow_policy policy          = overflow_policy::block);
 
   /*!
    * \brief This type is non-copyable.
    **/
-  thread_pool(const this_type&) = delete;
+  basic_thread_pool(const this_type&) = delete;
 
   /*!
    * \brief This type is non-copyable.
@@ -103,7 +236,7 @@ public:
    * \warning Will block the calling thread until all of the threads in the
    *          thread_pool are shut down.
    **/
-  ~thread_pool();
+  ~basic_thread_pool();
 
   /*!
    * \brief adds the task passed to be called with the arguments passed
@@ -119,6 +252,8 @@ public:
    *         exception occurred while running the task.
    * \note May block the calling thread until the threads in the thread_pool
    *       are done accessing the shared queue of tasks.
+   * \throws pl::thd::task_rejected_exception if the queue of tasks is full
+   *         and overflow_policy::reject is used.
    *
    * Delegates to the add_task overload that also expects a priority to be
    * passed. The priority used will be 0, which is the lowest possible
@@ -126,10 +261,13 @@ public:
    * to the queue of tasks.
    **/
   template<typename Callable, typename... Args>
-  PL_NODISCARD auto add_task(Callable task, Args... args)
+  PL_NODISCARD auto add_task(Callable&& task, Args&&... args)
   {
     // add the task using a priority of 0.
-    return add_task(static_cast<std::uint8_t>(0U), task, args...);
+    return add_task(
+      static_cast<std::uint8_t>(0U),
+      std::forward<Callable>(task),
+      std::forward<Args>(args)...);
   }
 
   /*!
@@ -150,7 +288,14 @@ public:
    *         exception occurred while running the task.
    * \note May block the calling thread until the threads in the thread_pool
    *       are done accessing the shared queue of tasks.
+   * \throws pl::thd::task_rejected_exception if the queue of tasks is full
+   *         and overflow_policy::reject is used.
    *
+   * If the queue of tasks is full the overflow_policy of this thread_pool is
+   * applied: the calling thread may be blocked until there is room, the task
+   * may be run on the calling thread or the oldest of the tasks with the
+   * lowest priority may be dropped, which breaks the promise of its
+   * std::future.
    * The task passed with the arguments it is to be called with will be added
    * to the queue of tasks still to be run using the priority passed into
    * the first parameter of this member function. Will wake up one thread
@@ -159,35 +304,89 @@ public:
    * That std::future can be joined using .get() for instance.
    **/
   template<typename Callable, typename... Args>
-  PL_NODISCARD auto add_task(std::uint8_t prio, Callable task, Args... args)
+  PL_NODISCARD auto add_task(
+    std::uint8_t prio,
+    Callable&&   task,
+    Args&&... args)
   {
-    auto invoker
-      = [t = std::move(task), tup = std::make_tuple(std::move(args)...)] {
-          return ::pl::apply(std::move(t), std::move(tup));
-        };
-
-    // return type for the Executor template
-    using ret = decltype(invoker());
+    return add(
+      submit_mode::apply_policy,
+      prio,
+      std::forward<Callable>(task),
+      std::forward<Args>(args)...);
+  }
 
-    // lock the mutex, shared data is going to be accessed
-    std::unique_lock<std::mutex> lock{m_mutex};
-    auto t = std::make_shared<executor<decltype(invoker), ret>>(
-      std::move(invoker), prio);
+  /*!
+   * \brief Like add_task, but never blocks nor throws if the queue of tasks
+   *        is full.
+   * \param prio The priority to be used.
+   * \param task The task to run.
+   * \param args The arguments to call the task with.
+   * \return A std::future to the result of invoking the task with the
+   *         arguments supplied or an invalid std::future if the queue of
+   *         tasks is full and overflow_policy::block,
+   *         overflow_policy::reject or overflow_policy::caller_runs is
+   *         used.
+   * \note overflow_policy::drop_lowest_priority is applied as in add_task.
+   **/
+  template<typename Callable, typename... Args>
+  PL_NODISCARD auto try_add_task(
+    std::uint8_t prio,
+    Callable&&   task,
+    Args&&... args)
+  {
+    return add(
+      submit_mode::try_policy,
+      prio,
+      std::forward<Callable>(task),
+      std::forward<Args>(args)...);
+  }
 
-    m_tasks_shared.push(t); // add the task to the queue.
-    auto fut = t->result().get_future();
-    lock.unlock();
-    m_cv.notify_one(); // wake one thread
-    return fut;
+  /*!
+   * \brief Like add_task, but always queues the task, regardless of
+   *        max_queue_depth and the overflow_policy.
+   * \param prio The priority to be used.
+   * \param task The task to run.
+   * \param args The arguments to call the task with.
+   * \return A std::future to the result of invoking the task with the
+   *         arguments supplied.
+   * \note Meant for the executors built on top of a thread_pool, such as
+   *       strand, whose bookkeeping relies on every task they add being
+   *       run. Tasks added this way may exceed max_queue_depth and are
+   *       never dropped by overflow_policy::drop_lowest_priority.
+   **/
+  template<typename Callable, typename... Args>
+  PL_NODISCARD auto force_add_task(
+    std::uint8_t prio,
+    Callable&&   task,
+    Args&&... args)
+  {
+    return add(
+      submit_mode::ignore_policy,
+      prio,
+      std::forward<Callable>(task),
+      std::forward<Args>(args)...);
   }
 
   /*!
    * \brief Function to query the amount of threads that this thread_pool
    *        manages.
-   * \return The count of threads that this thread_pool manages.
+   * \return The count of threads that this thread_pool currently manages.
    **/
   PL_NODISCARD std::size_t thread_count() const;
 
+  /*!
+   * \brief Queries the minimum amount of threads.
+   * \return The amount of threads that are kept alive at all times.
+   **/
+  PL_NODISCARD std::size_t min_thread_count() const noexcept;
+
+  /*!
+   * \brief Queries the maximum amount of threads.
+   * \return The maximum amount of threads this thread_pool may manage.
+   **/
+  PL_NODISCARD std::size_t max_thread_count() const noexcept;
+
   /*!
    * \brief Function to query the amount of tasks that are still waiting
    *        to be run.
@@ -197,7 +396,91 @@ public:
    **/
   PL_NODISCARD std::size_t tasks_waiting_for_execution() const;
 
+  /*!
+   * \brief Queries the maximum amount of tasks waiting to be run.
+   * \return The maximum depth of the queue of tasks.
+   *         std::numeric_limits<std::size_t>::max() if it is unbounded.
+   **/
+  PL_NODISCARD std::size_t max_queue_depth() const noexcept;
+
+  /*!
+   * \brief Queries what is done when a task is added to a full queue.
+   * \return The overflow_policy of this thread_pool.
+   **/
+  PL_NODISCARD overflow_policy policy() const noexcept;
+
+  /*!
+   * \brief Names the mutex of this thread_pool for the lock_profiles, only
+   *        has an effect if Mutex is a profiled_mutex.
+   * \param name The name, must outlive this object.
+   **/
+  void name_mutex(const char* name) noexcept
+  {
+    set_mutex_name(m_mutex, name);
+  }
+
+  /*!
+   * \brief Turns recording the metrics of this thread_pool on or off.
+   * \param enabled true to record the metrics of the tasks run from now on.
+   * \throws std::bad_alloc if the metrics couldn't be allocated.
+   * \note Turning the metrics off keeps the ones recorded so far.
+   **/
+  void enable_metrics(bool enabled = true);
+
+  /*!
+   * \brief Returns the metrics recorded so far.
+   * \return A copy of the metrics; empty if they were never enabled.
+   * \throws std::bad_alloc if the copy couldn't be allocated.
+   **/
+  PL_NODISCARD thread_pool_metrics metrics() const;
+
+  /*!
+   * \brief Removes the metrics recorded so far.
+   **/
+  void reset_metrics();
+
 private:
+  /*!
+   * \brief How submit treats a task added while the queue of tasks is full.
+   **/
+  enum class submit_mode : std::uint8_t {
+    apply_policy, //!< the overflow_policy is applied.
+    try_policy,   //!< fails rather than blocking, throwing or running it.
+    ignore_policy //!< the task is queued anyway and can't be dropped.
+  };
+
+  /*!
+   * \brief Wraps task and args into an executor and submits it.
+   * \return The std::future of the executor or an invalid std::future if
+   *         it was not submitted.
+   **/
+  template<typename Callable, typename... Args>
+  auto add(
+    submit_mode  mode,
+    std::uint8_t prio,
+    Callable&&   task,
+    Args&&... args)
+  {
+    auto invoker
+      = [t   = std::forward<Callable>(task),
+         tup = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+          return ::pl::apply(std::move(t), std::move(tup));
+        };
+
+    // return type for the Executor template
+    using ret = decltype(invoker());
+
+    auto t = std::make_shared<executor<decltype(invoker), ret>>(
+      std::move(invoker), prio);
+    auto fut = t->result().get_future();
+
+    if (!submit(t, mode)) {
+      return std::future<ret>{};
+    }
+
+    return fut;
+  }
+
   /*!
    * \brief Base class for the executors. Can run a task and store
    *        the result as a promise. Has a priority associated with it
@@ -227,7 +510,15 @@ private:
      **/
     friend bool operator<(
       PL_IN const executor_base& a,
-      PL_IN const executor_base& b);
+      PL_IN const executor_base& b)
+    {
+      if (a.m_priority != b.m_priority) {
+        return a.m_priority < b.m_priority; // compare the priorities stored.
+      }
+
+      // the task queued later is the lesser one, so that it is run later.
+      return a.m_sequence > b.m_sequence;
+    }
 
     /*!
      * \brief pure virtual member function to be implemented by deriving
@@ -236,9 +527,23 @@ private:
     virtual void operator()() = 0;
 
   protected:
+    friend class basic_thread_pool;
+
     std::uint8_t m_priority; /*!< the priority with which to run the task.
                               *   Can be accessed by derived types.
                               **/
+    std::uint64_t m_sequence; /*!< the order in which the task was queued.
+                               *   Tasks of equal priority are run in that
+                               *   order.
+                               **/
+    bool m_may_be_dropped; /*!< false if added with force_add_task, such
+                            *   tasks are skipped by
+                            *   overflow_policy::drop_lowest_priority.
+                            **/
+    clock::time_point m_enqueued; /*!< when the task was queued, only set
+                                   *   if the count of threads varies or
+                                   *   the metrics are enabled.
+                                   **/
   };
 
   /*!
@@ -255,8 +560,8 @@ private:
      * \param priority The priority with which the task is to be run.
      *        The executors will remain sorted by this criterion.
      **/
-    executor(PL_IN const Task& task, std::uint8_t priority)
-      : executor_base{priority}, m_task{task}, m_result{}
+    executor(Task&& task, std::uint8_t priority)
+      : executor_base{priority}, m_task{std::move(task)}, m_result{}
     {
     }
 
@@ -311,8 +616,8 @@ private:
      * \note The function that is run by the threads will always take the
      *       'greatest' task, that is the one with the highest priority.
      **/
-    executor(PL_IN const Task& task, std::uint8_t priority)
-      : executor_base{priority}, m_task{task}, m_result{}
+    executor(Task&& task, std::uint8_t priority)
+      : executor_base{priority}, m_task{std::move(task)}, m_result{}
     {
     }
 
@@ -395,8 +700,65 @@ private:
    * which will run the actual task and set the promise in the Executor
    * that the future that was returned to the user by add_task is associated
    * with.
+   * If the count of threads varies, a thread waits for at most the keepalive
+   * period and exits if it remained idle while there are more than the
+   * minimum amount of threads. The thread then moves itself from m_threads
+   * to m_retired.
    **/
-  void thread_function();
+  void thread_function(std::list<std::thread>::iterator self);
+
+  /*!
+   * \brief Creates a thread running thread_function.
+   * \warning m_mutex must be locked by the calling thread.
+   * \throws std::system_error if the thread could not be created.
+   **/
+  void spawn_thread();
+
+  /*!
+   * \brief Creates an additional thread if all threads are busy and tasks
+   *        have been waiting for long enough or threads are blocked.
+   * \warning m_mutex must be locked by the calling thread.
+   * \note Failing to create a thread is ignored, the tasks will be run by
+   *       the threads that already exist.
+   **/
+  void grow_if_needed();
+
+  /*!
+   * \brief Function run by the supervisor thread of a thread_pool whose
+   *        count of threads varies. Calls grow_if_needed once the oldest
+   *        task queued has been waiting for m_queue_wait_threshold.
+   **/
+  void supervisor_function();
+
+  /*!
+   * \brief Records that task was added to the queue.
+   * \warning m_mutex must be locked by the calling thread.
+   **/
+  void note_queued(PL_IN const executor_base& task);
+
+  /*!
+   * \brief Records that task was taken out of the queue.
+   * \warning m_mutex must be locked by the calling thread.
+   **/
+  void note_taken(PL_IN const executor_base& task);
+
+  /*!
+   * \brief Returns when the oldest task queued was queued.
+   * \warning m_mutex must be locked by the calling thread.
+   * \warning The count of threads must vary and the queue must not be
+   *          empty.
+   **/
+  PL_NODISCARD clock::time_point oldest_queued() const;
+
+  /*!
+   * \brief Adds an executor to the queue of tasks applying the
+   *        overflow_policy if the queue is full.
+   * \param task The executor to add.
+   * \param mode How to treat task if the queue is full.
+   * \return false if the task was neither queued, run nor dropped;
+   *         true otherwise.
+   **/
+  bool submit(std::shared_ptr<executor_base> task, submit_mode mode);
 
   /*!
    * \brief Will set the is finished flag and wake all threads and then
@@ -407,142 +769,628 @@ private:
    **/
   void join();
 
-  std::priority_queue<
-    std::shared_ptr<executor_base>,
-    std::vector<std::shared_ptr<executor_base>>,
-    deref_less>
-                     m_tasks_shared; //!< the queue of tasks still to be run
-  mutable std::mutex m_mutex;        //!< mutex to protect the shared data
-  std::condition_variable m_cv; /*!< condvar to wake threads waiting for the
-                                 *   queue to no longer be empty. And to
-                                 *   shutdown the threads in the join function
-                                 **/
+  /*!
+   * \brief Records duration in nanoseconds in histogram.
+   * \note Durations beyond the range of histogram are dropped.
+   **/
+  static void record_duration(
+    PL_INOUT hdr_histogram& histogram,
+    clock::duration         duration) noexcept;
+
+  // read-only after construction, kept apart from the contended mutex.
+  const std::size_t     m_max_queue_depth; //!< maximum amount of tasks queued.
+  const overflow_policy m_overflow_policy; //!< applied if the queue is full.
+  const std::size_t     m_min_threads; //!< the amount of threads kept alive.
+  const std::size_t     m_max_threads; //!< the maximum amount of threads.
+  const clock::duration m_queue_wait_threshold; //!< wait that adds a thread.
+  const clock::duration m_keepalive; //!< idle time after which threads exit.
+
+  // guarded by m_mutex, begins on a cache line of its own.
+  alignas(hardware_destructive_interference_size) mutable mutex_type
+    m_mutex; //!< mutex to protect the shared data
+  std::vector<std::shared_ptr<executor_base>>
+    m_tasks_shared; //!< heap of the tasks still to be run
+  condition_variable_for_t<mutex_type>
+    m_cv; /*!< condvar to wake threads waiting for the queue to no longer be
+           *   empty. And to shutdown the threads in the join function
+           **/
+  condition_variable_for_t<mutex_type>
+    m_cv_not_full; //!< condvar to wake threads blocked in add_task.
+  condition_variable_for_t<mutex_type>
+    m_cv_supervisor; //!< condvar to wake the supervisor thread.
+  std::deque<std::pair<std::uint64_t, clock::time_point>>
+    m_queued_order; /*!< sequence and m_enqueued of the tasks queued,
+                     *   oldest first. Only kept if the count of threads
+                     *   varies.
+                     **/
+  std::vector<std::uint64_t>
+    m_taken_out_of_order; /*!< min-heap of the sequences of the tasks
+                           *   taken that are still in m_queued_order.
+                           **/
   bool m_is_finished_shared;    //!< flag that will be set to true on shutdown.
-  const std::size_t           m_thread_count; //!< the amount of threads.
-  std::unique_ptr<pl::byte[]> m_threads;      /*!< raw memory that the threads
-                                               *   live in.
-                                               **/
-  std::thread* m_thread_begin;                //!< iterator to the first thread.
-  std::thread* m_thread_end; //!< end iterator of the range of threads.
+  std::uint64_t         m_next_sequence; //!< the next task's sequence number.
+  std::list<std::thread> m_threads; //!< the threads running.
+  std::list<std::thread> m_retired; //!< threads that exited, to be joined.
+  std::size_t            m_thread_count;    //!< the amount of threads running.
+  std::size_t            m_idle_threads;    //!< threads waiting for tasks.
+  std::size_t            m_blocked_threads; //!< threads in a blocking_scope.
+  std::thread m_supervisor; //!< only runs if the count of threads varies.
+  bool m_metrics_enabled; //!< whether the metrics are recorded.
+  std::unique_ptr<thread_pool_metrics>
+    m_metrics; //!< null until the metrics are first enabled.
 };
 
-inline thread_pool::thread_pool(std::size_t amt_threads)
-    : m_tasks_shared{ },
+#if PL_COMPILER == PL_COMPILER_MSVC
+#pragma warning(pop)
+#endif // PL_COMPILER == PL_COMPILER_MSVC
+
+template<typename Mutex>
+inline basic_thread_pool<Mutex>::basic_thread_pool(std::size_t amt_threads)
+  : basic_thread_pool{
+      amt_threads,
+      std::numeric_limits<std::size_t>::max(),
+      overflow_policy::block}
+{
+}
+
+template<typename Mutex>
+inline basic_thread_pool<Mutex>::basic_thread_pool(
+  std::size_t     amt_threads,
+  std::size_t     max_queue_depth,
+  overflow_policy policy)
+  : basic_thread_pool{
+      amt_threads,
+      amt_threads,
+      clock::duration::max(),
+      clock::duration::max(),
+      max_queue_depth,
+      policy}
+{
+}
+
+template<typename Mutex>
+inline basic_thread_pool<Mutex>::basic_thread_pool(
+  std::size_t     min_threads,
+  std::size_t     max_threads,
+  clock::duration queue_wait_threshold,
+  clock::duration keepalive,
+  std::size_t     max_queue_depth,
+  overflow_policy policy)
+    : m_max_queue_depth{ max_queue_depth },
+      m_overflow_policy{ policy },
+      m_min_threads{ min_threads },
+      m_max_threads{ max_threads },
+      m_queue_wait_threshold{ queue_wait_threshold },
+      m_keepalive{ keepalive },
       m_mutex{ },
+      m_tasks_shared{ },
       m_cv{ },
+      m_cv_not_full{ },
+      m_cv_supervisor{ },
+      m_queued_order{ },
+      m_taken_out_of_order{ },
       m_is_finished_shared{ false }, // start out not finished
-      m_thread_count{ amt_threads },
-      m_threads{ // get the memory needed for the threads.
-                 // the unique_ptr will deallocate the memory automatically.
-          std::make_unique<pl::byte[]>(m_thread_count * sizeof(std::thread))
-      },
-      m_thread_begin{ // begin iterator to the range of threads
-          reinterpret_cast<std::thread *>(m_threads.get())
-      },
-      m_thread_end{ m_thread_begin + m_thread_count } /* end iterator.
-                                                       * is out of bounds.
-                                                       */
+      m_next_sequence{ 0U },
+      m_threads{ },
+      m_retired{ },
+      m_thread_count{ 0U }, // the threads are created below.
+      m_idle_threads{ 0U },
+      m_blocked_threads{ 0U },
+      m_supervisor{ },
+      m_metrics_enabled{ false },
+      m_metrics{ }
 {
-  if (m_thread_count == 0) {
-    return;
-  }
+  PL_CHECK_PRE(m_max_queue_depth != 0U);
+  PL_CHECK_PRE(m_min_threads <= m_max_threads);
+  set_mutex_name(m_mutex, "pl::thd::thread_pool");
 
-  m_thread_begin = ::new (
-    const_cast<void*>(static_cast<const volatile void*>(m_thread_begin)))
-    std::thread{&thread_pool::thread_function, this};
+  try {
+    // the threads block on the mutex until all of them are created.
+    std::lock_guard<mutex_type> lock{m_mutex};
+    (void)lock;
+
+    for (std::size_t i{0U}; i < m_min_threads; ++i) {
+      spawn_thread();
+    }
 
-  for (std::size_t i{1}; i < m_thread_count; ++i) {
-    ::new (
-      const_cast<void*>(static_cast<const volatile void*>(m_thread_begin + i)))
-      std::thread{&thread_pool::thread_function, this};
+    if (m_min_threads != m_max_threads) {
+      m_supervisor
+        = std::thread{&basic_thread_pool::supervisor_function, this};
+    }
+  }
+  catch (...) {
+    join(); // shut down the threads that were created.
+    throw;
   }
 }
 
-inline thread_pool::~thread_pool()
+template<typename Mutex>
+inline basic_thread_pool<Mutex>::~basic_thread_pool()
 {
   // join the threads
   // this will shut all the threads down and then actually join them.
   join();
+}
 
-  /* Call the destructors of the threads.
-   * the unique_ptr will only free the raw memory of pl::bytes.
-   **/
-  algo::destroy(m_thread_begin, m_thread_end);
+template<typename Mutex>
+PL_NODISCARD inline std::size_t basic_thread_pool<Mutex>::thread_count() const
+{
+  std::lock_guard<mutex_type> lock{m_mutex};
+  (void)lock;
+  return m_thread_count;
 }
 
-PL_NODISCARD inline std::size_t thread_pool::thread_count() const
+template<typename Mutex>
+PL_NODISCARD inline std::size_t
+basic_thread_pool<Mutex>::min_thread_count() const noexcept
 {
-  return m_thread_count; // return the requested constant.
+  return m_min_threads;
 }
 
-PL_NODISCARD inline std::size_t thread_pool::tasks_waiting_for_execution() const
+template<typename Mutex>
+PL_NODISCARD inline std::size_t
+basic_thread_pool<Mutex>::max_thread_count() const noexcept
+{
+  return m_max_threads;
+}
+
+template<typename Mutex>
+PL_NODISCARD inline std::size_t
+basic_thread_pool<Mutex>::tasks_waiting_for_execution() const
 {
   // lock the mutex,
   // the queue of tasks is shared data
   // the threads of the thread pool remove tasks from it.
-  std::lock_guard<std::mutex> lock{m_mutex};
+  std::lock_guard<mutex_type> lock{m_mutex};
   (void)lock;
   return m_tasks_shared.size(); // return the number of tasks still to be run.
 }
 
-inline thread_pool::executor_base::executor_base(std::uint8_t p)
-  : m_priority{p} // just set the priority
+template<typename Mutex>
+PL_NODISCARD inline std::size_t
+basic_thread_pool<Mutex>::max_queue_depth() const noexcept
+{
+  return m_max_queue_depth;
+}
+
+template<typename Mutex>
+PL_NODISCARD inline overflow_policy
+basic_thread_pool<Mutex>::policy() const noexcept
+{
+  return m_overflow_policy;
+}
+
+template<typename Mutex>
+inline void basic_thread_pool<Mutex>::enable_metrics(bool enabled)
 {
+  // allocated outside of the lock, discarded if there already are metrics.
+  std::unique_ptr<thread_pool_metrics> allocated{
+    enabled ? std::make_unique<thread_pool_metrics>() : nullptr};
+  std::lock_guard<mutex_type> lock{m_mutex};
+  (void)lock;
+
+  if (m_metrics == nullptr) {
+    m_metrics.swap(allocated);
+  }
+
+  m_metrics_enabled = enabled;
 }
 
-inline thread_pool::executor_base::~executor_base() = default;
-inline bool operator<(
-  PL_IN const thread_pool::executor_base& a,
-  PL_IN const thread_pool::executor_base& b)
+template<typename Mutex>
+PL_NODISCARD inline thread_pool_metrics
+basic_thread_pool<Mutex>::metrics() const
 {
-  return a.m_priority < b.m_priority; // compare the priorities stored.
+  std::lock_guard<mutex_type> lock{m_mutex};
+  (void)lock;
+  return m_metrics == nullptr ? thread_pool_metrics{} : *m_metrics;
 }
 
-inline void thread_pool::thread_function()
+template<typename Mutex>
+inline void basic_thread_pool<Mutex>::reset_metrics()
 {
-  // by default we're running.
-  auto running = true;
+  std::lock_guard<mutex_type> lock{m_mutex};
+  (void)lock;
 
-  while (running) {
-    std::unique_lock<std::mutex> lock{m_mutex};
-    m_cv.wait(
-      lock, // wait until shutdown or got task to run.
-      [this] { return m_is_finished_shared || !m_tasks_shared.empty(); });
+  if (m_metrics != nullptr) {
+    m_metrics->queue_wait.reset();
+    m_metrics->run_time.reset();
+  }
+}
 
-    // if we woke up because there's a task to run.
+template<typename Mutex>
+inline basic_thread_pool<Mutex>::blocking_scope::blocking_scope(
+  PL_INOUT basic_thread_pool& pool)
+  : m_pool{pool}
+{
+  std::lock_guard<mutex_type> lock{m_pool.m_mutex};
+  (void)lock;
+  ++m_pool.m_blocked_threads;
+  m_pool.grow_if_needed();
+}
+
+template<typename Mutex>
+inline basic_thread_pool<Mutex>::blocking_scope::~blocking_scope()
+{
+  std::lock_guard<mutex_type> lock{m_pool.m_mutex};
+  (void)lock;
+  --m_pool.m_blocked_threads;
+}
+
+template<typename Mutex>
+inline basic_thread_pool<Mutex>::executor_base::executor_base(std::uint8_t p)
+  : m_priority{p} // just set the priority
+  , m_sequence{0U}
+  , m_may_be_dropped{true}
+  , m_enqueued{}
+{
+}
+
+template<typename Mutex>
+inline basic_thread_pool<Mutex>::executor_base::~executor_base() = default;
+
+template<typename Mutex>
+inline void basic_thread_pool<Mutex>::thread_function(
+  std::list<std::thread>::iterator self)
+{
+  PL_TRACE_THREAD_NAME("pl::thd::thread_pool");
+  std::unique_lock<mutex_type> lock{m_mutex};
+
+  for (;;) {
+    // if there's a task to run.
     if (!m_tasks_shared.empty()) {
-      auto task = m_tasks_shared.top(); // get the highest priority task.
-      m_tasks_shared.pop();             // remove it from the queue
+      // move the highest priority task to the back.
+      std::pop_heap(m_tasks_shared.begin(), m_tasks_shared.end(), deref_less{});
+      auto task = std::move(m_tasks_shared.back());
+      m_tasks_shared.pop_back(); // remove it from the queue
+      note_taken(*task);
+      grow_if_needed();          // the next task may have waited too long.
+      const bool              record_metrics{m_metrics_enabled};
+      const clock::time_point started{
+        record_metrics ? clock::now() : clock::time_point{}};
+
+      // tasks queued before the metrics were enabled have no m_enqueued.
+      if (record_metrics && (task->m_enqueued != clock::time_point{})) {
+        record_duration(m_metrics->queue_wait, started - task->m_enqueued);
+      }
+
       lock.unlock(); // unlock the mutex, we're not accessing shared data
                      // any more, the task is local to this thread.
-      (*task)();     // run your task.
+
+      // wake a thread waiting for room in the queue.
+      if (m_max_queue_depth != std::numeric_limits<std::size_t>::max()) {
+        m_cv_not_full.notify_one();
+      }
+
+      {
+        PL_TRACE_SCOPE("pl::thd::thread_pool run task");
+        (*task)();    // run your task.
+        task.reset(); // destroy it before locking again.
+      }
+
+      const clock::duration run_time{
+        record_metrics ? clock::now() - started : clock::duration::zero()};
+      lock.lock();
+
+      if (record_metrics) {
+        record_duration(m_metrics->run_time, run_time);
+      }
+
+      continue;
+    }
+
+    // exit the loop if we're shutting down.
+    if (m_is_finished_shared) {
+      return;
+    }
+
+    // wait until shutdown or got task to run.
+    PL_TRACE_SCOPE("pl::thd::thread_pool wait for task");
+    const auto has_work
+      = [this] { return m_is_finished_shared || !m_tasks_shared.empty(); };
+    ++m_idle_threads;
+
+    if (m_thread_count > m_min_threads) {
+      if (
+        !m_cv.wait_for(lock, m_keepalive, has_work)
+        && (m_thread_count > m_min_threads)) {
+        // idle for the keepalive period, there are threads to spare.
+        --m_idle_threads;
+        --m_thread_count;
+
+        // join the thread that retired previously outside of the lock,
+        // it has at least released the mutex by now.
+        std::list<std::thread> retired{};
+        retired.swap(m_retired);
+        m_retired.splice(m_retired.end(), m_threads, self);
+        lock.unlock();
+        m_cv_supervisor.notify_one(); // a thread may be added again.
+        std::for_each(
+          retired.begin(), retired.end(), [](PL_INOUT std::thread& t) {
+            t.join();
+          });
+        return;
+      }
     }
     else {
-      // if there was no task.
-      // set running to false if we're shutting down.
-      running = !m_is_finished_shared;
-      // exit the loop if we're shutting down.
-      // if running is still true it was just a spurious wake.
+      m_cv.wait(lock, has_work);
     }
+
+    --m_idle_threads;
+  }
+}
+
+template<typename Mutex>
+inline void basic_thread_pool<Mutex>::spawn_thread()
+{
+  m_threads.emplace_back();
+  const auto self = std::prev(m_threads.end());
+
+  try {
+    *self = std::thread{&basic_thread_pool::thread_function, this, self};
+  }
+  catch (...) {
+    m_threads.erase(self);
+    throw;
   }
+
+  ++m_thread_count;
 }
 
-inline void thread_pool::join()
+template<typename Mutex>
+inline void basic_thread_pool<Mutex>::grow_if_needed()
+{
+  if (
+    m_is_finished_shared || (m_thread_count >= m_max_threads)
+    || (m_tasks_shared.size() <= m_idle_threads)) {
+    return;
+  }
+
+  if (
+    (m_thread_count == 0U) || (m_blocked_threads != 0U)
+    || ((clock::now() - oldest_queued()) >= m_queue_wait_threshold)) {
+    try {
+      spawn_thread();
+    }
+    catch (const std::system_error&) {
+      // the threads that already exist will run the tasks.
+    }
+  }
+}
+
+template<typename Mutex>
+inline void basic_thread_pool<Mutex>::supervisor_function()
+{
+  PL_TRACE_THREAD_NAME("pl::thd::thread_pool supervisor");
+  std::unique_lock<mutex_type> lock{m_mutex};
+
+  while (!m_is_finished_shared) {
+    if (m_tasks_shared.empty() || (m_thread_count >= m_max_threads)) {
+      // woken once a task is added to the empty queue or a thread exits.
+      m_cv_supervisor.wait(lock);
+      continue;
+    }
+
+    const clock::time_point deadline{
+      oldest_queued() + m_queue_wait_threshold};
+
+    if (clock::now() < deadline) {
+      m_cv_supervisor.wait_until(lock, deadline);
+      continue;
+    }
+
+    const std::size_t thread_count{m_thread_count};
+    grow_if_needed();
+
+    // don't spin if the threshold is zero or no thread could be added.
+    const clock::time_point earliest{
+      clock::now() + std::chrono::milliseconds{1}};
+
+    if (m_thread_count == thread_count) {
+      // the idle threads may only take the oldest tasks and block, submit
+      // doesn't wake the supervisor for the tasks queued behind them.
+      m_cv_supervisor.wait_until(
+        lock, std::max(oldest_queued() + m_queue_wait_threshold, earliest));
+    }
+    else {
+      // give the thread added the time to take a task.
+      m_cv_supervisor.wait_until(
+        lock, std::max(earliest, clock::now() + m_queue_wait_threshold));
+    }
+  }
+}
+
+template<typename Mutex>
+inline void basic_thread_pool<Mutex>::note_queued(
+  PL_IN const executor_base& task)
+{
+  if (m_min_threads != m_max_threads) {
+    m_queued_order.emplace_back(task.m_sequence, task.m_enqueued);
+  }
+}
+
+template<typename Mutex>
+inline void basic_thread_pool<Mutex>::note_taken(
+  PL_IN const executor_base& task)
+{
+  if (m_min_threads == m_max_threads) {
+    return;
+  }
+
+  if (task.m_sequence != m_queued_order.front().first) {
+    // taken ahead of an older task of lower priority.
+    m_taken_out_of_order.push_back(task.m_sequence);
+    std::push_heap(
+      m_taken_out_of_order.begin(),
+      m_taken_out_of_order.end(),
+      std::greater<std::uint64_t>{});
+    return;
+  }
+
+  m_queued_order.pop_front();
+
+  // skip the tasks taken while they were not the oldest.
+  while (!m_taken_out_of_order.empty()
+         && (m_taken_out_of_order.front() == m_queued_order.front().first)) {
+    std::pop_heap(
+      m_taken_out_of_order.begin(),
+      m_taken_out_of_order.end(),
+      std::greater<std::uint64_t>{});
+    m_taken_out_of_order.pop_back();
+    m_queued_order.pop_front();
+  }
+}
+
+template<typename Mutex>
+PL_NODISCARD inline typename basic_thread_pool<Mutex>::clock::time_point
+basic_thread_pool<Mutex>::oldest_queued() const
+{
+  return m_queued_order.front().second;
+}
+
+template<typename Mutex>
+inline bool basic_thread_pool<Mutex>::submit(
+  std::shared_ptr<executor_base> task,
+  submit_mode                    mode)
+{
+  // released after unlocking, so that no task is destroyed under the lock.
+  std::shared_ptr<executor_base> dropped{};
+
+  // lock the mutex, shared data is going to be accessed
+  std::unique_lock<mutex_type> lock{m_mutex};
+
+  if (mode == submit_mode::ignore_policy) {
+    task->m_may_be_dropped = false;
+  }
+  else if (m_tasks_shared.size() >= m_max_queue_depth) {
+    switch (m_overflow_policy) {
+    case overflow_policy::block: {
+      if (mode == submit_mode::try_policy) {
+        return false;
+      }
+
+      PL_TRACE_SCOPE("pl::thd::thread_pool wait for room in queue");
+      m_cv_not_full.wait(lock, [this] {
+        return m_tasks_shared.size() < m_max_queue_depth;
+      });
+      break;
+    }
+    case overflow_policy::reject:
+      if (mode == submit_mode::try_policy) {
+        return false;
+      }
+
+      lock.unlock();
+      throw task_rejected_exception{"the thread_pool's queue is full"};
+    case overflow_policy::caller_runs:
+      if (mode == submit_mode::try_policy) {
+        return false;
+      }
+
+      lock.unlock();
+      (*task)(); // the promise of the task is set by running it.
+      return true;
+    case overflow_policy::drop_lowest_priority: {
+      // find the oldest of the tasks with the lowest priority that may be
+      // dropped.
+      auto victim = m_tasks_shared.end();
+
+      for (auto it = m_tasks_shared.begin(); it != m_tasks_shared.end();
+           ++it) {
+        if (!(*it)->m_may_be_dropped) {
+          continue;
+        }
+
+        if (
+          (victim == m_tasks_shared.end())
+          || ((*it)->m_priority < (*victim)->m_priority)
+          || (((*it)->m_priority == (*victim)->m_priority)
+              && ((*it)->m_sequence < (*victim)->m_sequence))) {
+          victim = it;
+        }
+      }
+
+      if (
+        (victim == m_tasks_shared.end())
+        || (task->m_priority < (*victim)->m_priority)) {
+        // the task added is dropped, its promise is broken once the
+        // caller releases it.
+        return true;
+      }
+
+      // destroying dropped breaks its promise.
+      dropped = std::move(*victim);
+      m_tasks_shared.erase(victim);
+      note_taken(*dropped);
+      std::make_heap(
+        m_tasks_shared.begin(), m_tasks_shared.end(), deref_less{});
+      break;
+    }
+    }
+  }
+
+  task->m_sequence = m_next_sequence++;
+
+  if ((m_min_threads != m_max_threads) || m_metrics_enabled) {
+    task->m_enqueued = clock::now();
+  }
+
+  note_queued(*task);
+  m_tasks_shared.push_back(std::move(task)); // add the task to the queue.
+  std::push_heap(m_tasks_shared.begin(), m_tasks_shared.end(), deref_less{});
+  grow_if_needed();
+  const bool was_empty{m_tasks_shared.size() == 1U};
+  lock.unlock();
+  m_cv.notify_one(); // wake one thread
+
+  // the supervisor waits for the next task added while the queue is empty.
+  if (was_empty && (m_min_threads != m_max_threads)) {
+    m_cv_supervisor.notify_one();
+  }
+
+  return true;
+}
+
+template<typename Mutex>
+inline void basic_thread_pool<Mutex>::record_duration(
+  PL_INOUT hdr_histogram& histogram,
+  clock::duration         duration) noexcept
+{
+  const auto ns
+    = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  histogram.record(ns < 0 ? 0U : static_cast<std::uint64_t>(ns));
+}
+
+template<typename Mutex>
+inline void basic_thread_pool<Mutex>::join()
 {
   {
     // lock the mutex, the boolean flag is shared data.
-    std::lock_guard<std::mutex> lock{m_mutex};
+    std::lock_guard<mutex_type> lock{m_mutex};
     (void)lock;
     m_is_finished_shared = true;
   }
 
   // wake all threads, we're shutting down.
   m_cv.notify_all();
+  m_cv_supervisor.notify_one();
 
-  // join every thread.
-  std::for_each(
-    m_thread_begin, m_thread_end, [](PL_INOUT std::thread& t) { t.join(); });
+  // the supervisor no longer adds threads once it returns.
+  if (m_supervisor.joinable()) {
+    m_supervisor.join();
+  }
+
+  // join every thread, no threads are created or exit early any more.
+  const auto join_thread = [](PL_INOUT std::thread& t) { t.join(); };
+  std::for_each(m_threads.begin(), m_threads.end(), join_thread);
+  std::for_each(m_retired.begin(), m_retired.end(), join_thread);
+  m_threads.clear();
+  m_retired.clear();
 }
+
+/*!
+ * \brief The thread_pool that uses std::mutex.
+ **/
+using thread_pool = basic_thread_pool<>;
 } // namespace thd
 } // namespace pl
 #endif // INCG_PL_THD_THREAD_POOL_HPP
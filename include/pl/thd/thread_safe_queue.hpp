@@ -31,10 +31,11 @@
 #ifndef INCG_PL_THD_THREAD_SAFE_QUEUE_HPP
 #define INCG_PL_THD_THREAD_SAFE_QUEUE_HPP
 #include "../annotations.hpp" // PL_IN, PL_NODISCARD
-#include <condition_variable> // std::condition_variable
+#include "profiled_mutex.hpp" // pl::thd::condition_variable_for_t
 #include <mutex>              // std::mutex, std::unique_lock
 #include <queue>              // std::queue
-#include <utility>            // std::move
+#include <type_traits>        // std::is_nothrow_default_constructible
+#include <utility>            // std::move, std::forward
 
 namespace pl {
 namespace thd {
@@ -43,12 +44,14 @@ namespace thd {
  *        and pop elements from the front.
  *
  * This class can be accessed from multiple threads at the same time.
+ * The Mutex can be replaced, e.g. by a profiled_mutex.
  **/
-template<typename ValueType>
+template<typename ValueType, typename Mutex = std::mutex>
 class thread_safe_queue {
 public:
   using this_type      = thread_safe_queue;
   using value_type     = ValueType;
+  using mutex_type     = Mutex;
   using container_type = std::queue<value_type>;
   using size_type      = typename container_type::size_type;
 
@@ -56,8 +59,11 @@ public:
    * \brief Creates a thread_safe_queue.
    *        The thread_safe_queue will start out empty.
    **/
-  thread_safe_queue() noexcept : m_cont{}, m_mutex{}, m_cv_has_elements{}
+  thread_safe_queue() noexcept(
+    std::is_nothrow_default_constructible<mutex_type>::value)
+    : m_cont{}, m_mutex{}, m_cv_has_elements{}
   {
+    set_mutex_name(m_mutex, "pl::thd::thread_safe_queue");
   }
   /*!
    * \brief This type is non-copyable.
@@ -78,9 +84,9 @@ public:
    **/
   value_type pop()
   {
-    std::unique_lock<std::mutex> lock{m_mutex};
+    std::unique_lock<mutex_type> lock{m_mutex};
     m_cv_has_elements.wait(lock, [this] { return !m_cont.empty(); });
-    auto return_value = m_cont.front();
+    auto return_value = std::move(m_cont.front());
     m_cont.pop();
     return return_value;
   }
@@ -96,7 +102,7 @@ public:
    **/
   this_type& push(PL_IN const value_type& data)
   {
-    std::unique_lock<std::mutex> lock{m_mutex};
+    std::unique_lock<mutex_type> lock{m_mutex};
     m_cont.push(data);
     lock.unlock();
     m_cv_has_elements.notify_all();
@@ -113,20 +119,38 @@ public:
    **/
   this_type& push(PL_IN value_type&& data)
   {
-    std::unique_lock<std::mutex> lock{m_mutex};
+    std::unique_lock<mutex_type> lock{m_mutex};
     m_cont.push(std::move(data));
     lock.unlock();
     m_cv_has_elements.notify_all();
     return *this;
   }
 
+  /*!
+   * \brief Constructs an element in place at the back of the queue.
+   * \param args The arguments to construct the element from.
+   * \return A reference to this object.
+   *
+   * Will notify threads waiting for the queue to no longer be empty that
+   * the queue is no longer empty.
+   **/
+  template<typename... Args>
+  this_type& emplace(Args&&... args)
+  {
+    std::unique_lock<mutex_type> lock{m_mutex};
+    m_cont.emplace(std::forward<Args>(args)...);
+    lock.unlock();
+    m_cv_has_elements.notify_all();
+    return *this;
+  }
+
   /*!
    * \brief Queries the queue as to whether or not it is empty.
    * \return true if the queue is empty; false otherwise.
    **/
   PL_NODISCARD bool empty() const noexcept
   {
-    std::lock_guard<std::mutex> lock{m_mutex};
+    std::lock_guard<mutex_type> lock{m_mutex};
     (void)lock;
     return m_cont.empty();
   }
@@ -137,15 +161,25 @@ public:
    **/
   size_type size() const noexcept
   {
-    std::lock_guard<std::mutex> lock{m_mutex};
+    std::lock_guard<mutex_type> lock{m_mutex};
     (void)lock;
     return m_cont.size();
   }
 
+  /*!
+   * \brief Names the mutex of this queue for the lock_profiles, only has an
+   *        effect if Mutex is a profiled_mutex.
+   * \param name The name, must outlive this object.
+   **/
+  void name_mutex(const char* name) noexcept
+  {
+    set_mutex_name(m_mutex, name);
+  }
+
 private:
-  container_type          m_cont;
-  mutable std::mutex      m_mutex;
-  std::condition_variable m_cv_has_elements;
+  container_type                       m_cont;
+  mutable mutex_type                   m_mutex;
+  condition_variable_for_t<mutex_type> m_cv_has_elements;
 };
 } // namespace thd
 } // namespace pl
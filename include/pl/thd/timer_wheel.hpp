@@ -0,0 +1,675 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file timer_wheel.hpp
+ * \brief Defines the timer_wheel class that runs tasks on a thread_pool
+ *        after a delay or periodically.
+ **/
+#ifndef INCG_PL_THD_TIMER_WHEEL_HPP
+#define INCG_PL_THD_TIMER_WHEEL_HPP
+#include "../annotations.hpp"     // PL_IN, PL_INOUT, PL_NODISCARD
+#include "../assert.hpp"          // PL_CHECK_PRE
+#include "../unique_function.hpp" // pl::unique_function
+#include "thread_pool.hpp"        // pl::thd::thread_pool
+#include <array>                  // std::array
+#include <atomic>                 // std::atomic
+#include <chrono>                 // std::chrono::steady_clock
+#include <condition_variable>     // std::condition_variable
+#include <cstddef>                // std::size_t
+#include <cstdint>                // std::uint8_t, std::uint32_t, std::uint64_t
+#include <memory>                 // std::shared_ptr, std::make_shared
+#include <mutex>                  // std::mutex, std::unique_lock
+#include <thread>                 // std::thread
+#include <utility>                // std::move, std::forward
+#include <vector>                 // std::vector
+
+namespace pl {
+namespace thd {
+/*!
+ * \brief A hierarchical timing wheel. Runs tasks on a thread_pool after a
+ *        delay or periodically.
+ *
+ * Manages a single timer thread that advances the wheel once per tick.
+ * Tasks that become due are handed off to the thread_pool, so the timer
+ * thread itself never runs user code. Scheduling and cancelling a timer
+ * are O(1), which makes it cheap to hold hundreds of thousands of pending
+ * timeouts at the same time.
+ * The wheel consists of 4 levels of 256 slots each. A timer that is due
+ * within the next 256 ticks is placed into the lowest level, timers further
+ * in the future are placed into the higher levels and cascaded downwards
+ * as time progresses.
+ **/
+class timer_wheel {
+public:
+  using this_type = timer_wheel;
+  using clock     = std::chrono::steady_clock;
+  using duration  = clock::duration;
+
+  /*!
+   * \brief Handle to a timer that was scheduled on a timer_wheel.
+   *        Can be passed to timer_wheel::cancel to cancel the timer.
+   **/
+  class timer_id {
+  public:
+    /*!
+     * \brief Creates a timer_id that does not refer to any timer.
+     **/
+    constexpr timer_id() noexcept : m_index{invalid_index}, m_generation{0U}
+    {
+    }
+
+    /*!
+     * \brief Compares two timer_ids for equality.
+     * \param lhs The first operand.
+     * \param rhs The second operand.
+     * \return true if both refer to the same timer; false otherwise.
+     **/
+    friend constexpr bool operator==(timer_id lhs, timer_id rhs) noexcept
+    {
+      return (lhs.m_index == rhs.m_index)
+             && (lhs.m_generation == rhs.m_generation);
+    }
+
+    /*!
+     * \brief Compares two timer_ids for inequality.
+     * \param lhs The first operand.
+     * \param rhs The second operand.
+     * \return true if they refer to different timers; false otherwise.
+     **/
+    friend constexpr bool operator!=(timer_id lhs, timer_id rhs) noexcept
+    {
+      return !(lhs == rhs);
+    }
+
+  private:
+    friend class timer_wheel;
+
+    static constexpr std::uint32_t invalid_index{0xFFFFFFFFU};
+
+    constexpr timer_id(std::uint32_t index, std::uint32_t generation) noexcept
+      : m_index{index}, m_generation{generation}
+    {
+    }
+
+    std::uint32_t m_index;      //!< index of the timer's node.
+    std::uint32_t m_generation; //!< generation of the timer's node.
+  };
+
+  /*!
+   * \brief Creates a timer_wheel and starts its timer thread.
+   * \param pool The thread_pool to run the tasks on. Must outlive the
+   *             timer_wheel.
+   * \param tick_duration The resolution of the timer_wheel. Tasks will be
+   *                      run no earlier than requested, but may be run up
+   *                      to one tick later. Must be positive.
+   **/
+  explicit timer_wheel(
+    PL_INOUT thread_pool& pool,
+    duration              tick_duration = std::chrono::milliseconds{1});
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  timer_wheel(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Stops and joins the timer thread. Timers still pending are
+   *        discarded without being run.
+   * \warning Will block the calling thread until the timer thread has
+   *          shut down.
+   **/
+  ~timer_wheel();
+
+  /*!
+   * \brief Schedules task to be run once on the thread_pool after delay has
+   *        elapsed.
+   * \param delay The time to wait before running task.
+   * \param task The nullary callable to run.
+   * \return A handle to the timer that can be used to cancel it.
+   **/
+  template<typename Callable>
+  timer_id schedule_after(duration delay, Callable&& task)
+  {
+    return schedule(delay, duration::zero(), std::forward<Callable>(task));
+  }
+
+  /*!
+   * \brief Schedules task to be run on the thread_pool every period until
+   *        the timer is cancelled or the timer_wheel is destroyed.
+   * \param period The time between two runs of task. Must be positive.
+   * \param task The nullary callable to run.
+   * \return A handle to the timer that can be used to cancel it.
+   * \note The first run happens after period has elapsed.
+   *       Runs do not drift, they are scheduled relative to the previous
+   *       due time rather than relative to when the previous run happened.
+   * \note Runs never overlap. If the previous run is still queued on the
+   *       thread_pool or still running when the timer becomes due again,
+   *       that firing is skipped.
+   **/
+  template<typename Callable>
+  timer_id schedule_every(duration period, Callable&& task)
+  {
+    PL_CHECK_PRE(period > duration::zero());
+    return schedule(period, period, std::forward<Callable>(task));
+  }
+
+  /*!
+   * \brief Cancels a timer.
+   * \param id The handle of the timer to cancel.
+   * \return true if the timer was still pending and has been cancelled;
+   *         false if it had already run, had already been cancelled or
+   *         if id does not refer to a timer of this timer_wheel.
+   * \note A run of the task that has already been handed to the thread_pool
+   *       is not affected.
+   **/
+  bool cancel(timer_id id);
+
+  /*!
+   * \brief Queries the amount of timers still pending.
+   * \return The count of timers still pending.
+   **/
+  PL_NODISCARD std::size_t timers_pending() const;
+
+  /*!
+   * \brief Queries the resolution of this timer_wheel.
+   * \return The duration of a tick.
+   **/
+  PL_NODISCARD duration tick_duration() const noexcept;
+
+private:
+  using tick_type = std::uint64_t;
+  using task_type = ::pl::unique_function<void()>;
+
+  static constexpr std::size_t   slot_bits{8U};
+  static constexpr std::size_t   slot_count{std::size_t{1U} << slot_bits};
+  static constexpr std::size_t   level_count{4U};
+  static constexpr std::uint32_t npos{0xFFFFFFFFU};
+
+  /*!
+   * \brief The task of a periodic timer, shared by the timer and its runs
+   *        handed to the thread_pool.
+   **/
+  struct periodic_task {
+    explicit periodic_task(task_type&& t) noexcept
+      : function{std::move(t)}, is_running{false}
+    {
+    }
+
+    task_type         function;   //!< the task to run.
+    std::atomic<bool> is_running; //!< set while a run is queued or running.
+  };
+
+  /*!
+   * \brief A timer. Lives in an intrusive doubly linked list of its bucket
+   *        or in the free list if it isn't in use.
+   **/
+  struct node {
+    tick_type     expiry;     //!< the tick at which the timer is due.
+    tick_type     period;     //!< ticks between runs, 0 if one-shot.
+    task_type     task;       //!< the task to run if one-shot.
+    std::shared_ptr<periodic_task>
+      periodic; //!< the task to run if periodic.
+    std::uint32_t prev;       //!< previous node in the bucket.
+    std::uint32_t next;       //!< next node in the bucket or free list.
+    std::uint32_t bucket;     //!< the index of the bucket.
+    std::uint32_t generation; //!< incremented whenever the node is freed.
+    bool          is_in_use;  //!< whether this node is a pending timer.
+  };
+
+  template<typename Callable>
+  timer_id schedule(duration delay, duration period, Callable&& task)
+  {
+    PL_CHECK_PRE(delay >= duration::zero());
+
+    // only periodic timers share their task with the runs in flight.
+    task_type                      t{std::forward<Callable>(task)};
+    std::shared_ptr<periodic_task> periodic{
+      period == duration::zero()
+        ? nullptr
+        : std::make_shared<periodic_task>(std::move(t))};
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    const duration  since_start{clock::now() - m_start};
+    const bool      was_empty{m_size == 0U};
+    const tick_type now_ticks{to_ticks(since_start)};
+
+    // no timers to cascade, so the wheel can simply jump ahead.
+    if (was_empty && (m_elapsed < now_ticks)) {
+      m_elapsed = now_ticks;
+    }
+
+    // saturate, a delay such as duration::max() would overflow the sum.
+    tick_type expiry{to_ticks_ceil(
+      delay < duration::max() - since_start ? since_start + delay
+                                            : duration::max())};
+
+    if (expiry <= m_elapsed) {
+      expiry = m_elapsed + 1U;
+    }
+
+    const tick_type period_ticks{
+      period == duration::zero() ? tick_type{0U} : to_ticks_ceil(period)};
+    const std::uint32_t index{
+      allocate(expiry, period_ticks, std::move(t), std::move(periodic))};
+    link(index);
+    ++m_size;
+    const timer_id id{index, m_nodes[index].generation};
+    lock.unlock();
+
+    if (was_empty) {
+      m_cv.notify_one(); // the timer thread may be waiting indefinitely.
+    }
+
+    return id;
+  }
+
+  /*!
+   * \brief Converts a duration into ticks rounding down.
+   **/
+  tick_type to_ticks(duration d) const noexcept;
+
+  /*!
+   * \brief Converts a duration into ticks rounding up, at least 1 tick.
+   **/
+  tick_type to_ticks_ceil(duration d) const noexcept;
+
+  /*!
+   * \brief Takes a node from the free list or creates a new one.
+   * \return The index of the node.
+   **/
+  std::uint32_t allocate(
+    tick_type                      expiry,
+    tick_type                      period,
+    task_type                      task,
+    std::shared_ptr<periodic_task> periodic);
+
+  /*!
+   * \brief Returns the node at index to the free list.
+   **/
+  void deallocate(std::uint32_t index) noexcept;
+
+  /*!
+   * \brief Inserts the node at index into the bucket that corresponds to
+   *        its expiry relative to the current tick.
+   **/
+  void link(std::uint32_t index) noexcept;
+
+  /*!
+   * \brief Removes the node at index from its bucket.
+   **/
+  void unlink(std::uint32_t index) noexcept;
+
+  /*!
+   * \brief Detaches all the nodes of a bucket and returns the first one.
+   **/
+  std::uint32_t detach(std::size_t bucket) noexcept;
+
+  /*!
+   * \brief Advances the wheel by one tick. Cascades the higher levels if
+   *        needed and collects the tasks that became due into due.
+   **/
+  void advance(PL_INOUT std::vector<task_type>& due);
+
+  /*!
+   * \brief Runs a periodic task on a thread of the thread_pool and allows
+   *        its next run afterwards.
+   **/
+  static void run_periodic(PL_INOUT periodic_task& task);
+
+  /*!
+   * \brief The function run by the timer thread.
+   **/
+  void thread_function();
+
+  thread_pool&             m_pool;  //!< the pool to run the tasks on.
+  const duration           m_tick;  //!< the duration of a tick.
+  const clock::time_point  m_start; //!< tick 0.
+  mutable std::mutex       m_mutex; //!< mutex to protect the shared data
+  std::condition_variable  m_cv;    //!< wakes the timer thread.
+  std::vector<node>        m_nodes; //!< storage of the timers.
+  std::array<std::uint32_t, level_count * slot_count>
+                m_heads;     //!< the first node of every bucket.
+  std::uint32_t m_free_head; //!< the first node of the free list.
+  tick_type     m_elapsed;   //!< the last tick that was processed.
+  std::size_t   m_size;      //!< the amount of pending timers.
+  bool m_is_finished_shared; //!< flag that will be set to true on shutdown.
+  std::thread m_thread;      //!< the timer thread.
+};
+
+inline timer_wheel::timer_wheel(
+  PL_INOUT thread_pool& pool,
+  duration              tick_duration)
+  : m_pool{pool}
+  , m_tick{tick_duration}
+  , m_start{clock::now()}
+  , m_mutex{}
+  , m_cv{}
+  , m_nodes{}
+  , m_heads{}
+  , m_free_head{npos}
+  , m_elapsed{0U}
+  , m_size{0U}
+  , m_is_finished_shared{false}
+  , m_thread{}
+{
+  PL_CHECK_PRE(tick_duration > duration::zero());
+  m_heads.fill(std::uint32_t{npos}); // a copy, so that npos is not odr-used.
+  m_thread = std::thread{&timer_wheel::thread_function, this};
+}
+
+inline timer_wheel::~timer_wheel()
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    m_is_finished_shared = true;
+  }
+
+  m_cv.notify_all();
+  m_thread.join();
+}
+
+inline bool timer_wheel::cancel(timer_id id)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  (void)lock;
+
+  if (id.m_index >= m_nodes.size()) {
+    return false;
+  }
+
+  const node& n{m_nodes[id.m_index]};
+
+  if (!n.is_in_use || (n.generation != id.m_generation)) {
+    return false;
+  }
+
+  unlink(id.m_index);
+  deallocate(id.m_index);
+  --m_size;
+  return true;
+}
+
+PL_NODISCARD inline std::size_t timer_wheel::timers_pending() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  (void)lock;
+  return m_size;
+}
+
+PL_NODISCARD inline timer_wheel::duration timer_wheel::tick_duration() const
+  noexcept
+{
+  return m_tick;
+}
+
+inline timer_wheel::tick_type timer_wheel::to_ticks(duration d) const noexcept
+{
+  return static_cast<tick_type>(d / m_tick);
+}
+
+inline timer_wheel::tick_type timer_wheel::to_ticks_ceil(duration d) const
+  noexcept
+{
+  // rounds up without adding to d, which may be as large as duration::max().
+  const tick_type ticks{
+    to_ticks(d) + ((d % m_tick) == duration::zero() ? 0U : 1U)};
+  return ticks == 0U ? tick_type{1U} : ticks;
+}
+
+inline std::uint32_t timer_wheel::allocate(
+  tick_type                      expiry,
+  tick_type                      period,
+  task_type                      task,
+  std::shared_ptr<periodic_task> periodic)
+{
+  if (m_free_head == npos) {
+    m_nodes.push_back(node{
+      expiry,
+      period,
+      std::move(task),
+      std::move(periodic),
+      npos,
+      npos,
+      0U,
+      0U,
+      true});
+    return static_cast<std::uint32_t>(m_nodes.size() - 1U);
+  }
+
+  const std::uint32_t index{m_free_head};
+  node&               n{m_nodes[index]};
+  m_free_head = n.next;
+  n.expiry    = expiry;
+  n.period    = period;
+  n.task      = std::move(task);
+  n.periodic  = std::move(periodic);
+  n.is_in_use = true;
+  return index;
+}
+
+inline void timer_wheel::deallocate(std::uint32_t index) noexcept
+{
+  node& n{m_nodes[index]};
+  n.task      = nullptr;
+  n.periodic.reset();
+  n.is_in_use = false;
+  ++n.generation; // invalidates all the timer_ids referring to this node.
+  n.next      = m_free_head;
+  m_free_head = index;
+}
+
+inline void timer_wheel::link(std::uint32_t index) noexcept
+{
+  static constexpr tick_type max_delta{
+    (tick_type{1U} << (slot_bits * level_count)) - 1U};
+
+  node&     n{m_nodes[index]};
+  tick_type expiry{n.expiry < m_elapsed ? m_elapsed : n.expiry};
+
+  // timers beyond the range of the wheel are parked in the highest level
+  // and cascaded (and parked again) until they come into range.
+  if (expiry - m_elapsed > max_delta) {
+    expiry = m_elapsed + max_delta;
+  }
+
+  const tick_type delta{expiry - m_elapsed};
+  std::size_t     level{0U};
+
+  while (((level + 1U) < level_count)
+         && (delta >= (tick_type{1U} << (slot_bits * (level + 1U))))) {
+    ++level;
+  }
+
+  const std::size_t slot{static_cast<std::size_t>(
+    (expiry >> (slot_bits * level)) & (slot_count - 1U))};
+  const std::size_t bucket{level * slot_count + slot};
+
+  n.bucket = static_cast<std::uint32_t>(bucket);
+  n.prev   = npos;
+  n.next   = m_heads[bucket];
+
+  if (n.next != npos) {
+    m_nodes[n.next].prev = index;
+  }
+
+  m_heads[bucket] = index;
+}
+
+inline void timer_wheel::unlink(std::uint32_t index) noexcept
+{
+  node& n{m_nodes[index]};
+
+  if (n.prev != npos) {
+    m_nodes[n.prev].next = n.next;
+  }
+  else {
+    m_heads[n.bucket] = n.next;
+  }
+
+  if (n.next != npos) {
+    m_nodes[n.next].prev = n.prev;
+  }
+}
+
+inline std::uint32_t timer_wheel::detach(std::size_t bucket) noexcept
+{
+  const std::uint32_t head{m_heads[bucket]};
+  m_heads[bucket] = npos;
+  return head;
+}
+
+inline void timer_wheel::advance(PL_INOUT std::vector<task_type>& due)
+{
+  const tick_type now{++m_elapsed};
+
+  // find the highest level whose slot has to be cascaded.
+  std::size_t highest_level{0U};
+
+  while ((highest_level + 1U) < level_count) {
+    const tick_type mask{
+      (tick_type{1U} << (slot_bits * (highest_level + 1U))) - 1U};
+
+    if ((now & mask) != 0U) {
+      break;
+    }
+
+    ++highest_level;
+  }
+
+  // cascade from the top down, so that timers that move down multiple
+  // levels end up in the right place.
+  for (std::size_t level{highest_level}; level > 0U; --level) {
+    const std::size_t slot{static_cast<std::size_t>(
+      (now >> (slot_bits * level)) & (slot_count - 1U))};
+    std::uint32_t index{detach(level * slot_count + slot)};
+
+    while (index != npos) {
+      const std::uint32_t next{m_nodes[index].next};
+      link(index);
+      index = next;
+    }
+  }
+
+  std::uint32_t index{
+    detach(static_cast<std::size_t>(now & (slot_count - 1U)))};
+
+  while (index != npos) {
+    node&               n{m_nodes[index]};
+    const std::uint32_t next{n.next};
+
+    if (n.expiry > now) {
+      link(index);
+    }
+    else if (n.period != 0U) {
+      // skip this firing if the previous run hasn't finished yet.
+      if (!n.periodic->is_running.exchange(true, std::memory_order_acq_rel)) {
+        due.push_back([p = n.periodic] { run_periodic(*p); });
+      }
+
+      n.expiry = now + n.period;
+      link(index);
+    }
+    else {
+      due.push_back(std::move(n.task));
+      deallocate(index);
+      --m_size;
+    }
+
+    index = next;
+  }
+}
+
+inline void timer_wheel::run_periodic(PL_INOUT periodic_task& task)
+{
+  try {
+    task.function();
+  }
+  catch (...) {
+    task.is_running.store(false, std::memory_order_release);
+    throw;
+  }
+
+  task.is_running.store(false, std::memory_order_release);
+}
+
+inline void timer_wheel::thread_function()
+{
+  std::vector<task_type>       due{};
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  while (!m_is_finished_shared) {
+    if (m_size == 0U) {
+      m_cv.wait(
+        lock, [this] { return m_is_finished_shared || (m_size != 0U); });
+      continue;
+    }
+
+    const tick_type now_ticks{to_ticks(clock::now() - m_start)};
+
+    if (m_elapsed >= now_ticks) {
+      m_cv.wait_until(
+        lock,
+        m_start + m_tick * static_cast<duration::rep>(m_elapsed + 1U));
+      continue;
+    }
+
+    while (m_elapsed < now_ticks) {
+      if (m_size == 0U) {
+        m_elapsed = now_ticks;
+        break;
+      }
+
+      advance(due);
+    }
+
+    if (due.empty()) {
+      continue;
+    }
+
+    // don't hold the lock while handing the tasks off to the thread_pool.
+    lock.unlock();
+
+    for (task_type& task : due) {
+      // bypasses the overflow_policy, so that the timer thread never blocks
+      // nor throws.
+      (void)m_pool.force_add_task(
+        static_cast<std::uint8_t>(0U), std::move(task));
+    }
+
+    due.clear();
+    lock.lock();
+  }
+}
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_TIMER_WHEEL_HPP
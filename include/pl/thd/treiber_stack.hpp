@@ -0,0 +1,499 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file treiber_stack.hpp
+ * \brief Defines the pl::thd::treiber_stack and
+ *        pl::thd::intrusive_treiber_stack class templates.
+ **/
+#ifndef INCG_PL_THD_TREIBER_STACK_HPP
+#define INCG_PL_THD_TREIBER_STACK_HPP
+#include "../annotations.hpp" // PL_OUT, PL_INOUT, PL_NODISCARD
+#include "reclamation.hpp" // pl::thd::hazard_pointer, pl::thd::hazard_retire
+#include <atomic>          // std::atomic
+#include <cstdint>         // std::uintptr_t
+#include <utility>         // std::move, std::forward
+
+namespace pl {
+namespace thd {
+namespace detail {
+/*!
+ * \brief Returns the hazard pointer that the calling thread uses to pop
+ *        from treiber_stacks.
+ * \return The calling thread's hazard pointer.
+ * \note A pop never protects more than one node at a time and doesn't call
+ *       any user code while it protects a node, so that all the
+ *       treiber_stacks can share a single hazard pointer per thread.
+ **/
+inline hazard_pointer& treiber_stack_hazard_pointer()
+{
+  static thread_local hazard_pointer hazard{};
+  return hazard;
+}
+} // namespace detail
+
+/*!
+ * \brief A lock-free last in first out stack, also known as Treiber stack.
+ * \tparam Ty The type of the elements.
+ *
+ * Any amount of threads may push and pop concurrently. Popping protects
+ * the top node with a hazard pointer before reading its successor and
+ * hands popped nodes to hazard_retire, so a node can't be freed and
+ * pushed again at the same address while another thread is about to
+ * compare against it. This rules out the ABA problem without requiring a
+ * double width compare and swap for tagged pointers.
+ *
+ * push_list and pop_all transfer many elements with a single atomic
+ * operation on the top of the stack, which allows batched handoff
+ * between threads.
+ *
+ * A treiber_stack of std::unique_ptr can be used as a free list that
+ * recycles expensive objects, such as buffers, between threads.
+ * \note Every push allocates a node and every pop retires one, use an
+ *       intrusive_treiber_stack to recycle objects at high rates.
+ **/
+template<typename Ty>
+class treiber_stack {
+public:
+  using this_type  = treiber_stack;
+  using value_type = Ty;
+
+  /*!
+   * \brief Creates an empty treiber_stack.
+   **/
+  treiber_stack() noexcept : m_head{nullptr}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  treiber_stack(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Destroys the elements still in the stack.
+   * \warning No other thread may use the stack anymore.
+   **/
+  ~treiber_stack()
+  {
+    node* n{m_head.load(std::memory_order_acquire)};
+
+    while (n != nullptr) {
+      node* const next{n->next};
+      delete n;
+      n = next;
+    }
+  }
+
+  /*!
+   * \brief Pushes a copy of value onto the stack.
+   * \param value The value to push.
+   **/
+  void push(const value_type& value)
+  {
+    emplace(value);
+  }
+
+  /*!
+   * \brief Pushes value onto the stack by moving it.
+   * \param value The value to push.
+   **/
+  void push(value_type&& value)
+  {
+    emplace(std::move(value));
+  }
+
+  /*!
+   * \brief Constructs an element in place on top of the stack.
+   * \param args The arguments to construct the element from.
+   **/
+  template<typename... Args>
+  void emplace(Args&&... args)
+  {
+    node* const n{new node{std::forward<Args>(args)...}};
+    link(n, n);
+  }
+
+  /*!
+   * \brief Pushes the elements of [first, last) onto the stack using a
+   *        single atomic operation.
+   * \param first Iterator to the first element to push.
+   * \param last Iterator one past the last element to push.
+   *
+   * The result is the same as pushing the elements one after another,
+   * so that *(last - 1) ends up on top, except that other threads can't
+   * observe intermediate states.
+   **/
+  template<typename InputIterator>
+  void push_list(InputIterator first, InputIterator last)
+  {
+    if (first == last) {
+      return;
+    }
+
+    node* const bottom{new node{*first}};
+    node*       top{bottom};
+
+    try {
+      for (++first; first != last; ++first) {
+        node* const n{new node{*first}};
+        n->next = top;
+        top     = n;
+      }
+    }
+    catch (...) {
+      while (top != nullptr) {
+        node* const next{top->next};
+        delete top;
+        top = next;
+      }
+
+      throw;
+    }
+
+    link(top, bottom);
+  }
+
+  /*!
+   * \brief Pops the element on top of the stack, if there is one.
+   * \param destination The element will be move assigned to this object.
+   * \return true if an element was popped; false if the stack was empty.
+   **/
+  bool try_pop(PL_OUT value_type& destination)
+  {
+    hazard_pointer& hazard{detail::treiber_stack_hazard_pointer()};
+    node*           n{nullptr};
+
+    for (;;) {
+      n = hazard.protect(m_head);
+
+      if (n == nullptr) {
+        hazard.reset();
+        return false;
+      }
+
+      if (m_head.compare_exchange_weak(
+            n, n->next, std::memory_order_acquire, std::memory_order_relaxed)) {
+        break;
+      }
+    }
+
+    hazard.reset();
+    take(n, destination);
+    return true;
+  }
+
+  /*!
+   * \brief Pops all the elements of the stack using a single atomic
+   *        operation.
+   * \param destination Output iterator that the elements are moved to,
+   *                    starting with the element that was on top.
+   * \return An iterator one past the last element written.
+   **/
+  template<typename OutputIterator>
+  OutputIterator pop_all(OutputIterator destination)
+  {
+    node* n{m_head.exchange(nullptr, std::memory_order_acquire)};
+
+    while (n != nullptr) {
+      node* const next{n->next};
+      *destination = std::move(n->value);
+      ++destination;
+      // other threads may still read next of the nodes they protected.
+      hazard_retire(n);
+      n = next;
+    }
+
+    return destination;
+  }
+
+  /*!
+   * \brief Checks whether the stack is empty.
+   * \return true if the stack was empty; otherwise false.
+   * \note The result may be outdated as soon as it is returned if other
+   *       threads use the stack concurrently.
+   **/
+  PL_NODISCARD bool empty() const noexcept
+  {
+    return m_head.load(std::memory_order_relaxed) == nullptr;
+  }
+
+private:
+  struct node {
+    template<typename... Args>
+    explicit node(Args&&... args)
+      : value(std::forward<Args>(args)...), next{nullptr}
+    {
+    }
+
+    node(const node&) = delete;
+
+    node& operator=(const node&) = delete;
+
+    value_type value; //!< the element.
+    node*      next;  //!< the node below, never changes once linked.
+  };
+
+  /*!
+   * \brief Links the nodes from top to bottom onto the top of the stack.
+   **/
+  void link(node* top, node* bottom) noexcept
+  {
+    bottom->next = m_head.load(std::memory_order_relaxed);
+
+    while (!m_head.compare_exchange_weak(
+      bottom->next,
+      top,
+      std::memory_order_release,
+      std::memory_order_relaxed)) {
+    }
+  }
+
+  /*!
+   * \brief Moves the element out of a popped node and retires the node.
+   **/
+  static void take(node* n, PL_OUT value_type& destination)
+  {
+    try {
+      destination = std::move(n->value);
+    }
+    catch (...) {
+      hazard_retire(n);
+      throw;
+    }
+
+    hazard_retire(n);
+  }
+
+  std::atomic<node*> m_head; //!< the node on top, nullptr if empty.
+};
+
+/*!
+ * \brief A lock-free last in first out stack of objects that are linked
+ *        through a member of their own, so that neither push nor pop
+ *        allocates.
+ * \tparam Ty The type of the elements.
+ * \tparam Next The member of Ty that links an element to the element below
+ *              it while the element is in the stack.
+ * \example struct buffer {
+ *            std::atomic<buffer*> next{nullptr};
+ *            std::array<char, 4096> data;
+ *          };
+ *          pl::thd::intrusive_treiber_stack<buffer, &buffer::next> pool{};
+ *
+ * The stack doesn't own its elements. The top of the stack is a pointer
+ * tagged with a 16 bit version in its otherwise unused upper bits, every
+ * change of the top increments the version, so that an element popped and
+ * pushed again by another thread in the meantime makes a pop retry
+ * rather than corrupt the stack (ABA problem).
+ * \warning Requires 64 bit pointers whose upper 16 bits are 0, as on
+ *          x86-64 and AArch64 Linux.
+ * \warning An element popped may only be destroyed once no other thread may
+ *          still be popping from the stack, as a pop may read the link of
+ *          an element that another thread popped concurrently.
+ **/
+template<typename Ty, std::atomic<Ty*> Ty::*Next>
+class intrusive_treiber_stack {
+public:
+  using this_type  = intrusive_treiber_stack;
+  using value_type = Ty;
+
+  static_assert(
+    sizeof(std::uintptr_t) == 8U,
+    "intrusive_treiber_stack requires 64 bit pointers");
+
+  /*!
+   * \brief Creates an empty intrusive_treiber_stack.
+   **/
+  intrusive_treiber_stack() noexcept : m_head{0U}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  intrusive_treiber_stack(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Pushes element onto the stack.
+   * \param element The element to push, must not be in the stack already.
+   **/
+  void push(PL_INOUT value_type& element) noexcept
+  {
+    link(element, element);
+  }
+
+  /*!
+   * \brief Pushes the elements pointed to by [first, last) onto the stack
+   *        using a single atomic operation.
+   * \param first Iterator to the pointer to the first element to push.
+   * \param last Iterator one past the pointer to the last element to push.
+   *
+   * The result is the same as pushing the elements one after another,
+   * so that **(last - 1) ends up on top, except that other threads can't
+   * observe intermediate states.
+   **/
+  template<typename InputIterator>
+  void push_list(InputIterator first, InputIterator last) noexcept
+  {
+    if (first == last) {
+      return;
+    }
+
+    value_type& bottom{**first};
+    value_type* top{&bottom};
+
+    for (++first; first != last; ++first) {
+      ((*first)->*Next).store(top, std::memory_order_relaxed);
+      top = *first;
+    }
+
+    link(*top, bottom);
+  }
+
+  /*!
+   * \brief Pops the element on top of the stack, if there is one.
+   * \return The element popped or nullptr if the stack was empty.
+   **/
+  PL_NODISCARD value_type* try_pop() noexcept
+  {
+    std::uintptr_t head{m_head.load(std::memory_order_acquire)};
+
+    for (;;) {
+      value_type* const top{pointer(head)};
+
+      if (top == nullptr) {
+        return nullptr;
+      }
+
+      // may be outdated if another thread popped top, the tag then makes
+      // the compare and swap fail.
+      value_type* const next{(top->*Next).load(std::memory_order_relaxed)};
+
+      if (m_head.compare_exchange_weak(
+            head,
+            tagged(next, head),
+            std::memory_order_acquire,
+            std::memory_order_acquire)) {
+        return top;
+      }
+    }
+  }
+
+  /*!
+   * \brief Pops all the elements of the stack using a single atomic
+   *        operation.
+   * \param destination Output iterator that the pointers to the elements
+   *                    are written to, starting with the element that was
+   *                    on top.
+   * \return An iterator one past the last pointer written.
+   **/
+  template<typename OutputIterator>
+  OutputIterator pop_all(OutputIterator destination)
+  {
+    std::uintptr_t head{m_head.load(std::memory_order_relaxed)};
+
+    while (!m_head.compare_exchange_weak(
+      head,
+      tagged(nullptr, head),
+      std::memory_order_acquire,
+      std::memory_order_relaxed)) {
+    }
+
+    value_type* element{pointer(head)};
+
+    while (element != nullptr) {
+      value_type* const next{(element->*Next).load(std::memory_order_relaxed)};
+      *destination = element;
+      ++destination;
+      element = next;
+    }
+
+    return destination;
+  }
+
+  /*!
+   * \brief Checks whether the stack is empty.
+   * \return true if the stack was empty; otherwise false.
+   * \note The result may be outdated as soon as it is returned if other
+   *       threads use the stack concurrently.
+   **/
+  PL_NODISCARD bool empty() const noexcept
+  {
+    return pointer(m_head.load(std::memory_order_relaxed)) == nullptr;
+  }
+
+private:
+  static constexpr std::uintptr_t pointer_mask{
+    (std::uintptr_t{1U} << 48U) - 1U};
+
+  static value_type* pointer(std::uintptr_t head) noexcept
+  {
+    return reinterpret_cast<value_type*>(head & pointer_mask);
+  }
+
+  /*!
+   * \brief Tags element with the version of head incremented.
+   **/
+  static std::uintptr_t tagged(
+    value_type*    element,
+    std::uintptr_t head) noexcept
+  {
+    return reinterpret_cast<std::uintptr_t>(element)
+           | ((head & ~pointer_mask) + (pointer_mask + 1U));
+  }
+
+  /*!
+   * \brief Links the elements from top to bottom onto the top of the stack.
+   **/
+  void link(PL_INOUT value_type& top, PL_INOUT value_type& bottom) noexcept
+  {
+    std::uintptr_t head{m_head.load(std::memory_order_relaxed)};
+
+    do {
+      (bottom.*Next).store(pointer(head), std::memory_order_relaxed);
+    } while (!m_head.compare_exchange_weak(
+      head,
+      tagged(&top, head),
+      std::memory_order_release,
+      std::memory_order_relaxed));
+  }
+
+  std::atomic<std::uintptr_t> m_head; //!< the tagged element on top.
+};
+} // namespace thd
+} // namespace pl
+#endif // INCG_PL_THD_TREIBER_STACK_HPP
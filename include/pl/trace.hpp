@@ -0,0 +1,572 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file trace.hpp
+ * \brief Exports macros to record scoped trace zones and facilities to
+ *        export them in the Chrome trace event format.
+ **/
+#ifndef INCG_PL_TRACE_HPP
+#define INCG_PL_TRACE_HPP
+#include "annotations.hpp"      // PL_IN, PL_INOUT, PL_NODISCARD, PL_UNLIKELY
+#include "begin_end_macro.hpp"  // PL_BEGIN_MACRO, PL_END_MACRO
+#include "current_function.hpp" // PL_CURRENT_FUNCTION
+#include "glue.hpp"             // PL_GLUE
+#include "json_quote.hpp"       // pl::json_quote
+#include "source_line.hpp"      // PL_SOURCE_LINE
+#include "thd/spsc_queue.hpp"   // pl::thd::spsc_queue
+#include "tsc_timer.hpp"        // pl::tsc_timer
+#include <atomic>               // std::atomic
+#include <chrono>               // std::chrono::milliseconds
+#include <condition_variable>   // std::condition_variable
+#include <cstddef>              // std::size_t
+#include <cstdint>              // std::uint32_t, std::uint64_t
+#include <ios>                  // std::ios_base
+#include <iterator>             // std::back_inserter
+#include <memory>               // std::shared_ptr, std::make_shared
+#include <mutex>                // std::mutex, std::lock_guard
+#include <ostream>              // std::ostream
+#include <string>               // std::string
+#include <thread>               // std::thread
+#include <unordered_map>        // std::unordered_map
+#include <utility>              // std::move
+#include <vector>               // std::vector
+
+/*!
+ * \def PL_TRACE_BUFFER_CAPACITY
+ * \brief The amount of trace events every thread can buffer until they are
+ *        written. Further events are dropped. Can be defined to override
+ *        the default.
+ **/
+#ifndef PL_TRACE_BUFFER_CAPACITY
+#define PL_TRACE_BUFFER_CAPACITY 16384
+#endif // PL_TRACE_BUFFER_CAPACITY
+
+/*!
+ * \def PL_TRACE_SCOPE(name)
+ * \brief Records a trace zone from this point to the end of the enclosing
+ *        scope, if PL_ENABLE_TRACING is defined; otherwise does nothing.
+ * \param name The name of the zone, must have static storage duration,
+ *             like a string literal.
+ * \note Define PL_ENABLE_TRACING for the entire program through the build
+ *       system, rather than in the source directly.
+ *       Can be used at most once per line.
+ * \example void parse(pl::string_view text)
+ *          {
+ *            PL_TRACE_SCOPE("parse");
+ *            ...
+ *          }
+ **/
+
+/*!
+ * \def PL_TRACE_FUNCTION()
+ * \brief Records a trace zone named after the enclosing function from this
+ *        point to the end of the enclosing scope, if PL_ENABLE_TRACING is
+ *        defined; otherwise does nothing.
+ **/
+
+/*!
+ * \def PL_TRACE_THREAD_NAME(name)
+ * \brief Names the calling thread in the traces written, if
+ *        PL_ENABLE_TRACING is defined; otherwise does nothing.
+ * \param name The name to use.
+ **/
+#if defined(PL_ENABLE_TRACING)
+#define PL_TRACE_SCOPE(name)                                \
+  const ::pl::trace_zone PL_GLUE(pl_trace_zone_, __LINE__){ \
+    name, PL_CURRENT_FUNCTION, __FILE__ ":" PL_SOURCE_LINE}
+#define PL_TRACE_FUNCTION() PL_TRACE_SCOPE(PL_CURRENT_FUNCTION)
+#define PL_TRACE_THREAD_NAME(name) ::pl::set_trace_thread_name(name)
+#else
+#define PL_TRACE_SCOPE(name) \
+  PL_BEGIN_MACRO             \
+  PL_END_MACRO
+#define PL_TRACE_FUNCTION() \
+  PL_BEGIN_MACRO            \
+  PL_END_MACRO
+#define PL_TRACE_THREAD_NAME(name) \
+  PL_BEGIN_MACRO                   \
+  PL_END_MACRO
+#endif // defined(PL_ENABLE_TRACING)
+
+namespace pl {
+/*!
+ * \brief A trace zone recorded.
+ *        The timestamps are in the ticks of pl::tsc_timer.
+ **/
+struct trace_event {
+  const char*   name;     //!< the name of the zone.
+  const char*   function; //!< the function containing the zone.
+  const char*   location; //!< "file:line" of the zone.
+  std::uint64_t begin;    //!< when the zone was entered.
+  std::uint64_t end;      //!< when the zone was left.
+};
+
+namespace detail {
+/*!
+ * \brief The events of a thread waiting to be written.
+ *        The thread is the producer, the thread writing the traces the
+ *        consumer.
+ **/
+struct trace_buffer {
+  explicit trace_buffer(std::uint32_t thread_id)
+    : events{PL_TRACE_BUFFER_CAPACITY}, dropped{0U}, id{thread_id}, name{}
+  {
+  }
+
+  trace_buffer(const trace_buffer&) = delete;
+
+  trace_buffer& operator=(const trace_buffer&) = delete;
+
+  thd::spsc_queue<trace_event> events;  //!< the events recorded.
+  std::atomic<std::uint64_t>   dropped; //!< events lost as events was full.
+  const std::uint32_t          id;      //!< identifies the thread.
+  std::string name; //!< the name of the thread, guarded by the registry.
+};
+
+/*!
+ * \brief Keeps track of the trace_buffers of all of the threads.
+ **/
+class trace_registry {
+public:
+  using this_type = trace_registry;
+
+  trace_registry()
+    : m_mutex{}
+    , m_buffers{}
+    , m_next_id{1U}
+    , m_dropped{0U}
+    , m_origin{tsc_begin()}
+  {
+  }
+
+  trace_registry(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  std::shared_ptr<trace_buffer> add()
+  {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    m_buffers.push_back(std::make_shared<trace_buffer>(m_next_id++));
+    return m_buffers.back();
+  }
+
+  void set_name(PL_INOUT trace_buffer& buffer, std::string name)
+  {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    buffer.name = std::move(name);
+  }
+
+  /*!
+   * \brief Takes the events of all of the threads.
+   * \param callable Called with each trace_buffer and the events taken out
+   *                 of it.
+   **/
+  template<typename Callable>
+  void drain(PL_IN Callable&& callable)
+  {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    std::vector<trace_event>          events{};
+
+    for (auto it = m_buffers.begin(); it != m_buffers.end();) {
+      trace_buffer& buffer{**it};
+      events.clear();
+      buffer.events.try_pop_bulk(
+        std::back_inserter(events), buffer.events.capacity());
+      callable(static_cast<const trace_buffer&>(buffer), events);
+
+      // the thread has exited and everything it recorded was taken.
+      if ((it->use_count() == 1) && buffer.events.empty()) {
+        m_dropped += buffer.dropped.load(std::memory_order_relaxed);
+        it = m_buffers.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+  }
+
+  std::uint64_t dropped() const
+  {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    (void)lock;
+    std::uint64_t                     result{m_dropped};
+
+    for (const std::shared_ptr<trace_buffer>& buffer : m_buffers) {
+      result += buffer->dropped.load(std::memory_order_relaxed);
+    }
+
+    return result;
+  }
+
+  std::uint64_t origin() const noexcept
+  {
+    return m_origin;
+  }
+
+private:
+  mutable std::mutex                         m_mutex;   //!< guards the rest.
+  std::vector<std::shared_ptr<trace_buffer>> m_buffers; //!< of the threads.
+  std::uint32_t                              m_next_id; //!< of the next one.
+  std::uint64_t       m_dropped; //!< dropped by the threads that exited.
+  const std::uint64_t m_origin;  //!< timestamp 0 of the traces.
+};
+
+inline trace_registry& get_trace_registry()
+{
+  static trace_registry registry{};
+  return registry;
+}
+
+/*!
+ * \brief Owns the trace_buffer of a thread. The trace_buffer lives on in
+ *        the registry after the thread has exited until its events have
+ *        been written.
+ **/
+struct trace_buffer_holder {
+  trace_buffer_holder() : buffer{get_trace_registry().add()}
+  {
+  }
+
+  std::shared_ptr<trace_buffer> buffer; //!< the buffer of the thread.
+};
+
+inline trace_buffer& local_trace_buffer()
+{
+  static thread_local trace_buffer_holder holder{};
+  return *holder.buffer;
+}
+} // namespace detail
+
+/*!
+ * \brief Records the time from its creation to its destruction into the
+ *        trace buffer of the calling thread.
+ *        Use PL_TRACE_SCOPE rather than using this type directly.
+ **/
+class trace_zone {
+public:
+  using this_type = trace_zone;
+
+  /*!
+   * \brief Enters the zone.
+   * \param name The name of the zone.
+   * \param function The function containing the zone.
+   * \param location "file:line" of the zone.
+   * \warning All of the strings must have static storage duration.
+   **/
+  trace_zone(
+    PL_IN const char* name,
+    PL_IN const char* function,
+    PL_IN const char* location)
+    : m_buffer{detail::local_trace_buffer()}
+    , m_name{name}
+    , m_function{function}
+    , m_location{location}
+    , m_begin{detail::tsc_begin()}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  trace_zone(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Leaves the zone and records it. The event is dropped if the
+   *        buffer of the thread is full.
+   **/
+  ~trace_zone()
+  {
+    const std::uint64_t end{detail::tsc_end()};
+
+    if (PL_UNLIKELY(!m_buffer.events.try_push(
+          trace_event{m_name, m_function, m_location, m_begin, end}))) {
+      m_buffer.dropped.fetch_add(1U, std::memory_order_relaxed);
+    }
+  }
+
+private:
+  detail::trace_buffer& m_buffer;   //!< of the calling thread.
+  const char*           m_name;     //!< the name of the zone.
+  const char*           m_function; //!< the enclosing function.
+  const char*           m_location; //!< the source location.
+  const std::uint64_t   m_begin;    //!< when the zone was entered.
+};
+
+/*!
+ * \brief Names the calling thread in the traces written.
+ * \param name The name.
+ * \note Use PL_TRACE_THREAD_NAME, so that it compiles to nothing if tracing
+ *       is disabled.
+ **/
+inline void set_trace_thread_name(std::string name)
+{
+  detail::get_trace_registry().set_name(
+    detail::local_trace_buffer(), std::move(name));
+}
+
+/*!
+ * \brief Returns the amount of events that were lost because the buffer
+ *        of their thread was full.
+ * \return The amount of events dropped so far.
+ **/
+PL_NODISCARD inline std::uint64_t trace_events_dropped()
+{
+  return detail::get_trace_registry().dropped();
+}
+
+/*!
+ * \brief Writes the events recorded as a Chrome trace event JSON
+ *        document, which can be opened in chrome://tracing or
+ *        https://ui.perfetto.dev.
+ *
+ * The events are written incrementally: each call of write_pending writes
+ * the events recorded since the last call, destruction completes the
+ * JSON document.
+ **/
+class chrome_trace_writer {
+public:
+  using this_type = chrome_trace_writer;
+
+  /*!
+   * \brief Begins the JSON document.
+   * \param os The ostream to write to, must outlive this object.
+   **/
+  explicit chrome_trace_writer(PL_INOUT std::ostream& os)
+    : m_os{os}, m_is_first{true}, m_thread_names{}
+  {
+    m_os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  chrome_trace_writer(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Writes the remaining events and ends the JSON document.
+   **/
+  ~chrome_trace_writer()
+  {
+    try {
+      write_pending();
+    }
+    catch (...) {
+      // the document is still completed.
+    }
+
+    m_os << "\n]}\n";
+    m_os.flush();
+  }
+
+  /*!
+   * \brief Takes the events recorded by all of the threads and writes them.
+   **/
+  void write_pending()
+  {
+    const std::ios_base::fmtflags flags{m_os.flags()};
+    const std::streamsize         precision{m_os.precision()};
+    m_os.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    m_os.precision(3);
+
+    detail::get_trace_registry().drain(
+      [this](
+        PL_IN const detail::trace_buffer& buffer,
+        PL_IN const std::vector<trace_event>& events) {
+        if (events.empty()) {
+          return;
+        }
+
+        std::string& written_name{m_thread_names[buffer.id]};
+
+        if (buffer.name != written_name) {
+          written_name = buffer.name;
+          separate();
+          m_os << R"({"name":"thread_name","ph":"M","pid":1,"tid":)"
+               << buffer.id << R"(,"args":{"name":)"
+               << json_quote(buffer.name) << "}}";
+        }
+
+        for (const trace_event& event : events) {
+          write_event(buffer.id, event);
+        }
+      });
+
+    m_os.flags(flags);
+    m_os.precision(precision);
+    m_os.flush();
+  }
+
+private:
+  void separate()
+  {
+    m_os << (m_is_first ? "\n" : ",\n");
+    m_is_first = false;
+  }
+
+  static double to_microseconds(std::uint64_t ticks)
+  {
+    return static_cast<double>(ticks) * tsc_timer::nanoseconds_per_tick()
+           / 1000.0;
+  }
+
+  void write_event(std::uint32_t thread_id, PL_IN const trace_event& event)
+  {
+    const std::uint64_t origin{detail::get_trace_registry().origin()};
+    const std::uint64_t begin{event.begin > origin ? event.begin - origin
+                                                   : 0U};
+    const std::uint64_t duration{
+      event.end > event.begin ? event.end - event.begin : 0U};
+
+    separate();
+    m_os << "{\"name\":" << json_quote(event.name)
+         << R"(,"cat":"pl","ph":"X","ts":)" << to_microseconds(begin)
+         << ",\"dur\":" << to_microseconds(duration)
+         << ",\"pid\":1,\"tid\":" << thread_id
+         << ",\"args\":{\"function\":" << json_quote(event.function)
+         << ",\"location\":" << json_quote(event.location) << "}}";
+  }
+
+  std::ostream& m_os;       //!< the ostream written to.
+  bool          m_is_first; //!< whether no event was written yet.
+  std::unordered_map<std::uint32_t, std::string>
+    m_thread_names; //!< the names of the threads written so far.
+};
+
+/*!
+ * \brief Writes all of the events recorded so far as a Chrome trace event
+ *        JSON document.
+ * \param os The ostream to write to.
+ * \return os.
+ **/
+inline std::ostream& write_chrome_trace(PL_INOUT std::ostream& os)
+{
+  {
+    const chrome_trace_writer writer{os};
+    (void)writer;
+  }
+
+  return os;
+}
+
+/*!
+ * \brief Writes the events recorded to an ostream periodically on a
+ *        background thread, so that the trace buffers of the threads don't
+ *        overflow.
+ * \example std::ofstream file{"trace.json"};
+ *          pl::trace_flusher flusher{file};
+ *          run_workload();
+ *          // the JSON document is complete once flusher is destroyed.
+ **/
+class trace_flusher {
+public:
+  using this_type = trace_flusher;
+
+  /*!
+   * \brief Begins the JSON document and starts the background thread.
+   * \param os The ostream to write to, must outlive this object.
+   * \param period The time between two writes.
+   **/
+  explicit trace_flusher(
+    PL_INOUT std::ostream&    os,
+    std::chrono::milliseconds period = std::chrono::milliseconds{50})
+    : m_writer{os}
+    , m_period{period}
+    , m_mutex{}
+    , m_cv{}
+    , m_is_finished{false}
+    , m_thread{[this] { thread_function(); }}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  trace_flusher(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Stops the background thread, writes the remaining events and
+   *        completes the JSON document.
+   **/
+  ~trace_flusher()
+  {
+    {
+      const std::lock_guard<std::mutex> lock{m_mutex};
+      (void)lock;
+      m_is_finished = true;
+    }
+
+    m_cv.notify_one();
+    m_thread.join();
+  }
+
+private:
+  void thread_function()
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    while (!m_is_finished) {
+      m_cv.wait_for(lock, m_period, [this] { return m_is_finished; });
+      lock.unlock();
+
+      try {
+        m_writer.write_pending();
+      }
+      catch (...) {
+        // try again in the next period.
+      }
+
+      lock.lock();
+    }
+  }
+
+  chrome_trace_writer       m_writer;      //!< writes the events.
+  std::chrono::milliseconds m_period;      //!< the time between writes.
+  std::mutex                m_mutex;       //!< guards m_is_finished.
+  std::condition_variable   m_cv;          //!< wakes the thread to finish.
+  bool                      m_is_finished; //!< whether to stop.
+  std::thread               m_thread;      //!< writes periodically.
+};
+} // namespace pl
+#endif // INCG_PL_TRACE_HPP
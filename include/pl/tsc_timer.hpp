@@ -0,0 +1,350 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file tsc_timer.hpp
+ * \brief Exports the tsc_timer type, a timer that reads the cycle counter of
+ *        the CPU, as well as the scoped_tsc_timer type.
+ **/
+#ifndef INCG_PL_TSC_TIMER_HPP
+#define INCG_PL_TSC_TIMER_HPP
+#include "annotations.hpp"  // PL_INOUT, PL_NODISCARD
+#include "compiler.hpp"     // PL_COMPILER, PL_COMPILER_MSVC
+#include "cpu_features.hpp" // pl::cpu_features, PL_CPU_X86
+#include <chrono>           // std::chrono::steady_clock
+#include <cstdint>          // std::uint64_t
+
+#if PL_CPU_X86
+#define PL_DETAIL_TSC_X86
+#if PL_COMPILER == PL_COMPILER_MSVC
+#include <intrin.h> // __rdtsc, __rdtscp, _mm_lfence
+#else
+#include <x86intrin.h> // __rdtsc, __rdtscp, _mm_lfence
+#endif                 // PL_COMPILER == PL_COMPILER_MSVC
+#elif defined(__aarch64__) && (PL_COMPILER != PL_COMPILER_MSVC)
+#define PL_DETAIL_TSC_ARM64
+#endif // PL_CPU_X86
+
+namespace pl {
+namespace detail {
+/*!
+ * \brief How the ticks read by a tsc_timer are converted to nanoseconds.
+ **/
+struct tsc_calibration {
+  bool   uses_cycle_counter; //!< false if steady_clock is used instead.
+  double ns_per_tick;        //!< the nanoseconds per tick.
+};
+
+/*!
+ * \brief Reads the steady_clock in its own ticks.
+ **/
+inline std::uint64_t steady_clock_ticks() noexcept
+{
+  return static_cast<std::uint64_t>(
+    std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+#if defined(PL_DETAIL_TSC_X86)
+/*!
+ * \brief Reads the time stamp counter at the beginning of a timed region.
+ *
+ * The first lfence keeps rdtsc from running before the preceding
+ * instructions are done, the second one keeps the timed instructions from
+ * starting before rdtsc.
+ **/
+inline std::uint64_t cycle_counter_begin() noexcept
+{
+  _mm_lfence();
+  const std::uint64_t ticks{__rdtsc()};
+  _mm_lfence();
+  return ticks;
+}
+
+/*!
+ * \brief Reads the time stamp counter at the end of a timed region.
+ *
+ * rdtscp waits for the timed instructions to be done, the lfence keeps
+ * the following instructions from starting before it.
+ **/
+inline std::uint64_t cycle_counter_end() noexcept
+{
+  unsigned int        processor{0U};
+  const std::uint64_t ticks{__rdtscp(&processor)};
+  _mm_lfence();
+  return ticks;
+}
+
+inline tsc_calibration calibrate_tsc() noexcept
+{
+  const cpu_feature required{cpu_feature::rdtscp | cpu_feature::invariant_tsc};
+
+  if (!cpu_features::current().has(required)) {
+    return tsc_calibration{
+      false,
+      1E9 * std::chrono::steady_clock::period::num
+        / std::chrono::steady_clock::period::den};
+  }
+
+  // measure the frequency of the time stamp counter against steady_clock.
+  using clock = std::chrono::steady_clock;
+  const clock::time_point  start{clock::now()};
+  const std::uint64_t      start_ticks{cycle_counter_begin()};
+  std::chrono::nanoseconds elapsed{0};
+  std::uint64_t            end_ticks{start_ticks};
+
+  while (elapsed < std::chrono::milliseconds{5}) {
+    end_ticks = cycle_counter_end();
+    elapsed   = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      clock::now() - start);
+  }
+
+  return tsc_calibration{
+    true,
+    static_cast<double>(elapsed.count())
+      / static_cast<double>(end_ticks - start_ticks)};
+}
+#elif defined(PL_DETAIL_TSC_ARM64)
+/*!
+ * \brief Reads the virtual counter at the beginning of a timed region.
+ *        The isb keeps the read from being executed early.
+ **/
+inline std::uint64_t cycle_counter_begin() noexcept
+{
+  std::uint64_t ticks{0U};
+  __asm__ volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(ticks) : : "memory");
+  return ticks;
+}
+
+/*!
+ * \brief Reads the virtual counter at the end of a timed region.
+ **/
+inline std::uint64_t cycle_counter_end() noexcept
+{
+  return cycle_counter_begin();
+}
+
+inline tsc_calibration calibrate_tsc() noexcept
+{
+  // the frequency of the counter is architecturally fixed and known.
+  std::uint64_t frequency{0U};
+  __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+  return tsc_calibration{true, 1E9 / static_cast<double>(frequency)};
+}
+#else
+inline std::uint64_t cycle_counter_begin() noexcept
+{
+  return steady_clock_ticks();
+}
+
+inline std::uint64_t cycle_counter_end() noexcept
+{
+  return steady_clock_ticks();
+}
+
+inline tsc_calibration calibrate_tsc() noexcept
+{
+  return tsc_calibration{
+    false,
+    1E9 * std::chrono::steady_clock::period::num
+      / std::chrono::steady_clock::period::den};
+}
+#endif
+
+/*!
+ * \brief Returns the calibration, which is determined the first time this
+ *        function is called.
+ **/
+inline const tsc_calibration& get_tsc_calibration() noexcept
+{
+  static const tsc_calibration calibration{calibrate_tsc()};
+  return calibration;
+}
+
+inline std::uint64_t tsc_begin() noexcept
+{
+  return get_tsc_calibration().uses_cycle_counter ? cycle_counter_begin()
+                                                  : steady_clock_ticks();
+}
+
+inline std::uint64_t tsc_end() noexcept
+{
+  return get_tsc_calibration().uses_cycle_counter ? cycle_counter_end()
+                                                  : steady_clock_ticks();
+}
+} // namespace detail
+
+/*!
+ * \brief A timer that can be used to measure short durations of time.
+ *
+ * Reads the time stamp counter using rdtsc and rdtscp on x86 and the
+ * virtual counter on ARM64, which is much cheaper than reading
+ * std::chrono::steady_clock. Falls back to std::chrono::steady_clock if the
+ * CPU lacks an invariant time stamp counter or rdtscp.
+ * The ticks are converted to nanoseconds using a calibration that is
+ * measured once, the first time a tsc_timer is created, which takes
+ * about 5 milliseconds on x86. Call calibrate() at startup to get that
+ * out of the way.
+ * \note Measures wall clock time, not CPU cycles: the invariant time stamp
+ *       counter runs at a constant rate regardless of the clock speed.
+ **/
+class tsc_timer {
+public:
+  using this_type = tsc_timer;
+
+  /*!
+   * \brief Constructs the timer object.
+   *        The ticks stored are initialized with the current ticks.
+   *        Effectively 'starts' the timer.
+   **/
+  tsc_timer() noexcept;
+
+  /*!
+   * \brief Calculates the duration between now and the ticks stored.
+   * \return The duration between the current time (when this function is
+   *         invoked) and the ticks stored.
+   **/
+  std::chrono::nanoseconds elapsed_time() const noexcept;
+
+  /*!
+   * \brief Calculates the amount of ticks between now and the ticks stored.
+   * \return The ticks elapsed. Use nanoseconds_per_tick() to convert.
+   **/
+  std::uint64_t elapsed_ticks() const noexcept;
+
+  /*!
+   * \brief Resets the ticks stored. The ticks stored are discarded and
+   *        replaced with the current ticks (when this function is invoked)
+   * \return A reference to this tsc_timer object.
+   **/
+  this_type& reset() noexcept;
+
+  /*!
+   * \brief Performs the calibration if that hasn't happened yet.
+   **/
+  static void calibrate() noexcept;
+
+  /*!
+   * \brief Queries whether the cycle counter is used.
+   * \return true if the cycle counter is used; false if
+   *         std::chrono::steady_clock is used.
+   **/
+  PL_NODISCARD static bool uses_cycle_counter() noexcept;
+
+  /*!
+   * \brief Returns the nanoseconds that one tick takes.
+   * \return The nanoseconds per tick.
+   **/
+  PL_NODISCARD static double nanoseconds_per_tick() noexcept;
+
+private:
+  std::uint64_t m_ticks_stored; /*!< The ticks stored */
+};
+
+inline tsc_timer::tsc_timer() noexcept : m_ticks_stored{detail::tsc_begin()}
+{
+}
+
+inline std::chrono::nanoseconds tsc_timer::elapsed_time() const noexcept
+{
+  return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(
+    static_cast<double>(elapsed_ticks()) * nanoseconds_per_tick())};
+}
+
+inline std::uint64_t tsc_timer::elapsed_ticks() const noexcept
+{
+  const std::uint64_t now{detail::tsc_end()};
+
+  // the counters of different cores may be off by a few ticks.
+  return now > m_ticks_stored ? now - m_ticks_stored : 0U;
+}
+
+inline tsc_timer& tsc_timer::reset() noexcept
+{
+  m_ticks_stored = detail::tsc_begin();
+  return *this;
+}
+
+inline void tsc_timer::calibrate() noexcept
+{
+  (void)detail::get_tsc_calibration();
+}
+
+inline bool tsc_timer::uses_cycle_counter() noexcept
+{
+  return detail::get_tsc_calibration().uses_cycle_counter;
+}
+
+inline double tsc_timer::nanoseconds_per_tick() noexcept
+{
+  return detail::get_tsc_calibration().ns_per_tick;
+}
+
+/*!
+ * \brief Adds the time from its creation to its destruction to a duration.
+ * \example std::chrono::nanoseconds parse_time{0};
+ *
+ *          for (const std::string& line : lines) {
+ *            pl::scoped_tsc_timer t{parse_time};
+ *            parse(line);
+ *          }
+ **/
+class scoped_tsc_timer {
+public:
+  using this_type = scoped_tsc_timer;
+
+  /*!
+   * \brief Starts the timer.
+   * \param target The duration to add the time measured to.
+   **/
+  explicit scoped_tsc_timer(PL_INOUT std::chrono::nanoseconds& target) noexcept
+    : m_target{target}, m_timer{}
+  {
+  }
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  scoped_tsc_timer(const this_type&) = delete;
+
+  /*!
+   * \brief This type is non-copyable.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Adds the time elapsed to the target.
+   **/
+  ~scoped_tsc_timer()
+  {
+    m_target += m_timer.elapsed_time();
+  }
+
+private:
+  std::chrono::nanoseconds& m_target; //!< the duration to add to.
+  tsc_timer                 m_timer;  //!< measures the time.
+};
+} // namespace pl
+#endif // INCG_PL_TSC_TIMER_HPP
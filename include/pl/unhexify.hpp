@@ -30,11 +30,14 @@
  **/
 #ifndef INCG_PL_UNHEXIFY_HPP
 #define INCG_PL_UNHEXIFY_HPP
-#include "byte.hpp"   // pl::byte
+#include "annotations.hpp" // PL_UNLIKELY
+#include "byte.hpp"        // pl::byte
 #include "except.hpp" // PL_THROW_WITH_SOURCE_INFO, pl::invalid_size_exception
+#include "expected.hpp"    // pl::expected, pl::make_unexpected
 #include "string_view.hpp" // pl::string_view
 #include <array>           // std::array
 #include <cstddef>         // std::size_t
+#include <system_error>    // std::errc
 #include <vector>          // std::vector
 
 namespace pl {
@@ -60,7 +63,7 @@ inline std::vector<byte> unhexify(
   constexpr std::size_t          low_nibble_offset{1U};
   constexpr std::array<byte, 2U> offsets{{0U, 9U}};
 
-  if (hex_string.size() < nibbles_per_byte) {
+  if (PL_UNLIKELY(hex_string.size() < nibbles_per_byte)) {
     PL_THROW_WITH_SOURCE_INFO(
       invalid_size_exception, "hex_string was smaller than 2!");
   }
@@ -85,5 +88,64 @@ inline std::vector<byte> unhexify(
 
   return buffer;
 }
+
+namespace detail {
+/*!
+ * \brief Converts a hexit to its value.
+ * \return The value or -1 if c is not a hexit.
+ **/
+constexpr int hexit_value(char c) noexcept
+{
+  return ((c >= '0') && (c <= '9'))
+           ? (c - '0')
+           : ((c >= 'a') && (c <= 'f'))
+               ? (c - 'a' + 10)
+               : ((c >= 'A') && (c <= 'F')) ? (c - 'A' + 10) : -1;
+}
+} // namespace detail
+
+/*!
+ * \brief Converts a hex encoded string into bytes without throwing on
+ *        malformed input.
+ * \param hex_string The hex encoded string to turn into bytes.
+ * \param delimiter_size The size of the delimiter (in bytes) used to separate
+ *                       the pairs of hexits from each other.
+ *                       Shall be 0 if no delimiter is used.
+ * \return The resulting bytes or std::errc::invalid_argument if
+ *         `hex_string` has fewer than 2 characters, if its size does not
+ *         match delimiter_size or if it contains a character that is not a
+ *         hexit where a hexit is expected.
+ * \throws std::bad_alloc if the resulting bytes couldn't be allocated.
+ * \note Unlike unhexify the input is validated.
+ **/
+inline expected<std::vector<byte>, std::errc> try_unhexify(
+  string_view hex_string,
+  std::size_t delimiter_size)
+{
+  constexpr std::size_t nibbles_per_byte{2U};
+
+  const std::size_t stride{nibbles_per_byte + delimiter_size};
+
+  if (PL_UNLIKELY(
+        (hex_string.size() < nibbles_per_byte)
+        || (((hex_string.size() + delimiter_size) % stride) != 0U))) {
+    return make_unexpected(std::errc::invalid_argument);
+  }
+
+  std::vector<byte> buffer((hex_string.size() + delimiter_size) / stride);
+
+  for (std::size_t i{0U}; i < buffer.size(); ++i) {
+    const int high_nibble{detail::hexit_value(hex_string[i * stride])};
+    const int low_nibble{detail::hexit_value(hex_string[i * stride + 1U])};
+
+    if (PL_UNLIKELY((high_nibble | low_nibble) < 0)) {
+      return make_unexpected(std::errc::invalid_argument);
+    }
+
+    buffer[i] = static_cast<byte>((high_nibble << 4) | low_nibble);
+  }
+
+  return buffer;
+}
 } // namespace pl
 #endif // INCG_PL_UNHEXIFY_HPP
@@ -0,0 +1,352 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+/*!
+ * \file unique_function.hpp
+ * \brief Exports the unique_function class template, a move-only
+ *        counterpart to std::function.
+ **/
+#ifndef INCG_PL_UNIQUE_FUNCTION_HPP
+#define INCG_PL_UNIQUE_FUNCTION_HPP
+#include "annotations.hpp" // PL_INOUT
+#include "invoke.hpp"      // pl::invoke
+#include "type_traits.hpp" // pl::decay_t, pl::enable_if_t
+#include "voidify.hpp"     // PL_VOIDIFY
+#include <cstddef>         // std::size_t, std::nullptr_t, std::max_align_t
+#include <functional>      // std::bad_function_call
+#include <new>             // ::operator new
+#include <type_traits>     // std::is_same, std::is_nothrow_move_constructible
+#include <utility>         // std::move, std::forward
+
+namespace pl {
+template<typename Signature>
+class unique_function;
+
+/*!
+ * \brief A type erased callable wrapper like std::function that only
+ *        requires the callable stored to be move constructible.
+ * \tparam Ret The return type.
+ * \tparam Args The parameter types.
+ *
+ * Can thus store lambdas capturing std::unique_ptrs, std::promises or other
+ * move-only objects. Is move-only itself, moving a unique_function never
+ * copies nor moves the callable stored in dynamically allocated memory.
+ * Callables that are nothrow move constructible and fit into
+ * small_buffer_size bytes are stored inside of the unique_function without
+ * allocating memory.
+ **/
+template<typename Ret, typename... Args>
+class unique_function<Ret(Args...)> {
+public:
+  using this_type   = unique_function;
+  using result_type = Ret;
+
+  /*!
+   * \brief The size of the buffer for small callables in bytes.
+   **/
+  static constexpr std::size_t small_buffer_size{4U * sizeof(void*)};
+
+  /*!
+   * \brief Creates an empty unique_function.
+   **/
+  unique_function() noexcept : m_vtable{nullptr}, m_storage{}
+  {
+  }
+
+  /*!
+   * \brief Creates an empty unique_function.
+   **/
+  unique_function(std::nullptr_t) noexcept : unique_function{}
+  {
+  }
+
+  /*!
+   * \brief Creates a unique_function storing callable.
+   * \param callable The callable to store, is moved or copied into the
+   *                 unique_function.
+   **/
+  template<
+    typename Callable,
+    typename = enable_if_t<!std::is_same<decay_t<Callable>, this_type>::value>>
+  unique_function(Callable&& callable) : m_vtable{nullptr}, m_storage{}
+  {
+    using callable_type = decay_t<Callable>;
+    create<callable_type>(
+      std::forward<Callable>(callable), is_small<callable_type>{});
+    m_vtable = &vtable_for<callable_type>::value;
+  }
+
+  /*!
+   * \brief Takes over the callable of other, leaving other empty.
+   * \param other The unique_function to move from.
+   **/
+  unique_function(this_type&& other) noexcept
+    : m_vtable{other.m_vtable}, m_storage{}
+  {
+    if (m_vtable != nullptr) {
+      m_vtable->move(PL_VOIDIFY(m_storage), PL_VOIDIFY(other.m_storage));
+      other.m_vtable = nullptr;
+    }
+  }
+
+  /*!
+   * \brief Destroys the callable stored and takes over the callable of
+   *        other, leaving other empty.
+   * \param other The unique_function to move from.
+   * \return *this
+   **/
+  this_type& operator=(this_type&& other) noexcept
+  {
+    this_type{std::move(other)}.swap(*this);
+    return *this;
+  }
+
+  /*!
+   * \brief Destroys the callable stored.
+   * \return *this
+   **/
+  this_type& operator=(std::nullptr_t) noexcept
+  {
+    reset();
+    return *this;
+  }
+
+  /*!
+   * \brief This type is move-only.
+   **/
+  unique_function(const this_type&) = delete;
+
+  /*!
+   * \brief This type is move-only.
+   **/
+  this_type& operator=(const this_type&) = delete;
+
+  /*!
+   * \brief Destroys the callable stored.
+   **/
+  ~unique_function()
+  {
+    reset();
+  }
+
+  /*!
+   * \brief Swaps the callables of this and other.
+   * \param other The unique_function to swap with.
+   **/
+  void swap(PL_INOUT this_type& other) noexcept
+  {
+    this_type temporary{};
+    temporary.take(other);
+    other.take(*this);
+    take(temporary);
+  }
+
+  /*!
+   * \brief Queries whether a callable is stored.
+   * \return true if a callable is stored; otherwise false.
+   **/
+  explicit operator bool() const noexcept
+  {
+    return m_vtable != nullptr;
+  }
+
+  /*!
+   * \brief Calls the callable stored with args.
+   * \param args The arguments to call the callable with.
+   * \return The result of calling the callable.
+   * \throws std::bad_function_call if no callable is stored.
+   **/
+  Ret operator()(Args... args)
+  {
+    if (m_vtable == nullptr) {
+      throw std::bad_function_call{};
+    }
+
+    return m_vtable->invoke(PL_VOIDIFY(m_storage), std::forward<Args>(args)...);
+  }
+
+private:
+  /*!
+   * \brief The operations on the type erased callable.
+   **/
+  struct vtable {
+    Ret (*invoke)(void*, Args&&...); //!< calls the callable.
+    void (*move)(void*, void*) noexcept; //!< moves storage to storage.
+    void (*destroy)(void*) noexcept; //!< destroys the callable.
+  };
+
+  /*!
+   * \brief Storage for a small callable or a pointer to a large one.
+   **/
+  struct storage_type {
+    alignas(std::max_align_t) unsigned char data[small_buffer_size];
+  };
+
+  template<typename Callable>
+  using is_small = std::integral_constant<
+    bool,
+    (sizeof(Callable) <= small_buffer_size)
+      && (alignof(Callable) <= alignof(std::max_align_t))
+      && std::is_nothrow_move_constructible<Callable>::value>;
+
+  /*!
+   * \brief Implements the vtable for callables stored in the buffer.
+   **/
+  template<typename Callable, bool IsSmall = is_small<Callable>::value>
+  struct vtable_for {
+    static Callable& get(void* storage) noexcept
+    {
+      return *static_cast<Callable*>(storage);
+    }
+
+    static Ret invoke(void* storage, Args&&... args)
+    {
+      return static_cast<Ret>(
+        ::pl::invoke(get(storage), std::forward<Args>(args)...));
+    }
+
+    static void move(void* destination, void* source) noexcept
+    {
+      ::new (destination) Callable(std::move(get(source)));
+      get(source).~Callable();
+    }
+
+    static void destroy(void* storage) noexcept
+    {
+      get(storage).~Callable();
+    }
+
+    static constexpr vtable value{&invoke, &move, &destroy};
+  };
+
+  /*!
+   * \brief Implements the vtable for callables stored in dynamically
+   *        allocated memory, the buffer holds a pointer to them.
+   **/
+  template<typename Callable>
+  struct vtable_for<Callable, false> {
+    static Callable*& get(void* storage) noexcept
+    {
+      return *static_cast<Callable**>(storage);
+    }
+
+    static Ret invoke(void* storage, Args&&... args)
+    {
+      return static_cast<Ret>(
+        ::pl::invoke(*get(storage), std::forward<Args>(args)...));
+    }
+
+    static void move(void* destination, void* source) noexcept
+    {
+      ::new (destination) Callable*(get(source));
+    }
+
+    static void destroy(void* storage) noexcept
+    {
+      delete get(storage);
+    }
+
+    static constexpr vtable value{&invoke, &move, &destroy};
+  };
+
+  template<typename Callable, typename Arg>
+  void create(Arg&& arg, std::true_type)
+  {
+    ::new (PL_VOIDIFY(m_storage)) Callable(std::forward<Arg>(arg));
+  }
+
+  template<typename Callable, typename Arg>
+  void create(Arg&& arg, std::false_type)
+  {
+    ::new (PL_VOIDIFY(m_storage))
+      Callable*(new Callable(std::forward<Arg>(arg)));
+  }
+
+  /*!
+   * \brief Moves the callable of other into this, which must be empty.
+   **/
+  void take(PL_INOUT this_type& other) noexcept
+  {
+    m_vtable = other.m_vtable;
+
+    if (m_vtable != nullptr) {
+      m_vtable->move(PL_VOIDIFY(m_storage), PL_VOIDIFY(other.m_storage));
+      other.m_vtable = nullptr;
+    }
+  }
+
+  void reset() noexcept
+  {
+    if (m_vtable != nullptr) {
+      m_vtable->destroy(PL_VOIDIFY(m_storage));
+      m_vtable = nullptr;
+    }
+  }
+
+  const vtable* m_vtable;  //!< nullptr if empty.
+  storage_type  m_storage; //!< the callable or a pointer to it.
+};
+
+template<typename Ret, typename... Args>
+constexpr std::size_t unique_function<Ret(Args...)>::small_buffer_size;
+
+template<typename Ret, typename... Args>
+template<typename Callable, bool IsSmall>
+constexpr typename unique_function<Ret(Args...)>::vtable
+  unique_function<Ret(Args...)>::vtable_for<Callable, IsSmall>::value;
+
+template<typename Ret, typename... Args>
+template<typename Callable>
+constexpr typename unique_function<Ret(Args...)>::vtable
+  unique_function<Ret(Args...)>::vtable_for<Callable, false>::value;
+
+/*!
+ * \brief Compares a unique_function with nullptr.
+ * \param function The unique_function.
+ * \return true if function is empty; otherwise false.
+ **/
+template<typename Ret, typename... Args>
+bool operator==(
+  PL_IN const unique_function<Ret(Args...)>& function,
+  std::nullptr_t) noexcept
+{
+  return !function;
+}
+
+/*!
+ * \brief Compares a unique_function with nullptr.
+ * \param function The unique_function.
+ * \return true if function is not empty; otherwise false.
+ **/
+template<typename Ret, typename... Args>
+bool operator!=(
+  PL_IN const unique_function<Ret(Args...)>& function,
+  std::nullptr_t) noexcept
+{
+  return static_cast<bool>(function);
+}
+} // namespace pl
+#endif // INCG_PL_UNIQUE_FUNCTION_HPP
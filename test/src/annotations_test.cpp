@@ -0,0 +1,100 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif                                      // PL_COMPILER == PL_COMPILER_GCC
+#include "../../include/pl/annotations.hpp" // PL_LIKELY, PL_UNLIKELY, ...
+#include <array>                            // std::array
+#include <cstddef>                          // std::size_t
+
+namespace pl {
+namespace test {
+namespace {
+PL_COLD PL_NOINLINE int cold_function(int i)
+{
+  return i + 1;
+}
+
+PL_HOT PL_FLATTEN int hot_function(int i)
+{
+  if (PL_UNLIKELY(i < 0)) {
+    return cold_function(i);
+  }
+
+  return i * 2;
+}
+
+int assume_positive(int i)
+{
+  PL_ASSUME(i > 0);
+  return i / 2;
+}
+} // anonymous namespace
+} // namespace test
+} // namespace pl
+
+TEST_CASE("annotations_test")
+{
+  SUBCASE("likely")
+  {
+    const int* const null{nullptr};
+    const int        value{5};
+
+    CHECK(PL_LIKELY(value == 5));
+    CHECK_FALSE(PL_LIKELY(value == 6));
+    CHECK(PL_UNLIKELY(&value));
+    CHECK_FALSE(PL_UNLIKELY(null));
+  }
+
+  SUBCASE("function_attributes")
+  {
+    CHECK(pl::test::hot_function(2) == 4);
+    CHECK(pl::test::hot_function(-2) == -1);
+    CHECK(pl::test::assume_positive(8) == 4);
+  }
+
+  SUBCASE("prefetch")
+  {
+    std::array<int, 64U> array{};
+    int                  sum{0};
+
+    for (std::size_t i{0U}; i < array.size(); ++i) {
+      PL_PREFETCH(array.data() + (i + 8U) % array.size(), 0, 3);
+      PL_PREFETCH(&array[i], 1, 0);
+      array[i] = static_cast<int>(i);
+      sum += array[i];
+    }
+
+    CHECK(sum == 2016);
+  }
+}
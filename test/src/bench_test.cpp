@@ -0,0 +1,127 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif                                // PL_COMPILER == PL_COMPILER_GCC
+#include "../../include/pl/bench.hpp" // pl::bench, pl::do_not_optimize
+#include <chrono>                     // std::chrono::microseconds
+#include <cstddef>                    // std::size_t
+#include <sstream>                    // std::ostringstream
+#include <string>                     // std::string
+#include <vector>                     // std::vector
+
+TEST_CASE("bench_test")
+{
+  pl::bench_options options{};
+  options.warmup_time  = std::chrono::microseconds{100};
+  options.sample_time  = std::chrono::microseconds{50};
+  options.sample_count = 5U;
+
+  SUBCASE("do_not_optimize")
+  {
+    int                    i{5};
+    const std::string      s{"text"};
+    const std::vector<int> v{1, 2, 3};
+    pl::do_not_optimize(i);
+    pl::do_not_optimize(s);
+    pl::do_not_optimize(v);
+    pl::clobber_memory();
+    CHECK(i == 5);
+    CHECK(s == "text");
+    CHECK(v.size() == 3U);
+  }
+
+  SUBCASE("run")
+  {
+    pl::bench   b{options};
+    std::size_t invocations{0U};
+
+    CHECK_UNARY(b.run("counter", [&invocations] {
+      ++invocations;
+      pl::clobber_memory();
+    }));
+
+    REQUIRE(b.results().size() == 1U);
+    const pl::bench_result& r{b.results().front()};
+    CHECK(r.name == "counter");
+    CHECK(r.samples == 5U);
+    CHECK(r.iterations >= 1U);
+    CHECK(invocations >= r.iterations * r.samples);
+    CHECK(r.min_ns <= r.median_ns);
+    CHECK(r.median_ns <= r.p99_ns);
+    CHECK(r.p99_ns <= r.max_ns);
+    CHECK(r.min_ns <= r.mean_ns);
+    CHECK(r.mean_ns <= r.max_ns);
+  }
+
+  SUBCASE("filter")
+  {
+    options.filter = "hex";
+    pl::bench b{options};
+
+    CHECK_UNARY_FALSE(b.run("memxor", [] {}));
+    CHECK_UNARY(b.run("hexify", [] {}));
+    REQUIRE(b.results().size() == 1U);
+    CHECK(b.results().front().name == "hexify");
+  }
+
+  SUBCASE("output")
+  {
+    const std::vector<pl::bench_result> results{
+      {"plain", 3U, 100U, 1.0, 2.0, 3.0, 2.0, 3.0},
+      {"a,\"b\"", 3U, 10U, 1.5, 2.5, 3.5, 2.5, 3.5}};
+
+    std::ostringstream json{};
+    pl::write_json(json, results);
+    CHECK(
+      json.str()
+      == "{\n"
+         "  \"benchmarks\": [\n"
+         "    {\"name\": \"plain\", \"samples\": 3, \"iterations\": 100, "
+         "\"min_ns\": 1.000, \"median_ns\": 2.000, \"p99_ns\": 3.000, "
+         "\"mean_ns\": 2.000, \"max_ns\": 3.000},\n"
+         "    {\"name\": \"a,\\\"b\\\"\", \"samples\": 3, \"iterations\": 10, "
+         "\"min_ns\": 1.500, \"median_ns\": 2.500, \"p99_ns\": 3.500, "
+         "\"mean_ns\": 2.500, \"max_ns\": 3.500}\n"
+         "  ]\n"
+         "}\n");
+
+    std::ostringstream csv{};
+    pl::write_csv(csv, results);
+    CHECK(
+      csv.str()
+      == "name,samples,iterations,min_ns,median_ns,p99_ns,mean_ns,max_ns\n"
+         "plain,3,100,1.000,2.000,3.000,2.000,3.000\n"
+         "\"a,\"\"b\"\"\",3,10,1.500,2.500,3.500,2.500,3.500\n");
+  }
+}
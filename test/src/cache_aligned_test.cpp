@@ -0,0 +1,125 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif                                        // PL_COMPILER == PL_COMPILER_GCC
+#include "../../include/pl/cache_aligned.hpp" // pl::cache_aligned, pl::cache_aligned_allocator
+#include <array>   // std::array
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uintptr_t
+#include <deque>   // std::deque
+#include <string>  // std::string
+#include <vector>  // std::vector
+
+TEST_CASE("cache_aligned_test")
+{
+  static constexpr std::size_t line{pl::hardware_destructive_interference_size};
+
+  SUBCASE("constants")
+  {
+    CHECK(line >= 64U);
+    CHECK((line & (line - 1U)) == 0U);
+    CHECK(pl::hardware_constructive_interference_size <= line);
+  }
+
+  SUBCASE("layout")
+  {
+    CHECK(alignof(pl::cache_aligned<char>) == line);
+    CHECK(sizeof(pl::cache_aligned<char>) == line);
+    CHECK(sizeof(pl::cache_aligned<char[65]>) % line == 0U);
+    CHECK(sizeof(pl::cache_aligned<char[65]>) >= 65U);
+
+    std::array<pl::cache_aligned<int>, 2U> array{};
+    const std::uintptr_t first{reinterpret_cast<std::uintptr_t>(&*array[0])};
+    const std::uintptr_t second{reinterpret_cast<std::uintptr_t>(&*array[1])};
+    CHECK(first % line == 0U);
+    CHECK(second - first == line);
+  }
+
+  SUBCASE("access")
+  {
+    pl::cache_aligned<std::string>       a{3U, 'a'};
+    const pl::cache_aligned<std::string> b{"text"};
+    const pl::cache_aligned<int>         c{};
+
+    CHECK(a.get() == "aaa");
+    CHECK(*b == "text");
+    CHECK(b->size() == 4U);
+    CHECK(*c == 0);
+
+    a->push_back('b');
+    *a += "c";
+    CHECK(*a == "aaabc");
+
+    pl::cache_aligned<std::string> copy{a};
+    CHECK(*copy == "aaabc");
+  }
+
+  SUBCASE("allocator")
+  {
+    const auto is_aligned = [](const void* p) {
+      return reinterpret_cast<std::uintptr_t>(p) % line == 0U;
+    };
+
+    std::vector<char, pl::cache_aligned_allocator<char>> chars(3U, 'a');
+    CHECK(is_aligned(chars.data()));
+
+    std::vector<
+      pl::cache_aligned<int>,
+      pl::cache_aligned_allocator<pl::cache_aligned<int>>>
+      vector{};
+    std::deque<
+      pl::cache_aligned<std::string>,
+      pl::cache_aligned_allocator<pl::cache_aligned<std::string>>>
+      deque{};
+
+    for (std::size_t i{0U}; i < 100U; ++i) {
+      vector.emplace_back(static_cast<int>(i));
+      deque.emplace_back(i, 'b');
+    }
+
+    for (std::size_t i{0U}; i < 100U; ++i) {
+      CHECK(is_aligned(&vector[i]));
+      CHECK(*vector[i] == static_cast<int>(i));
+      CHECK(is_aligned(&deque[i]));
+      CHECK(deque[i]->size() == i);
+    }
+
+    CHECK(
+      pl::cache_aligned_allocator<int>{}
+      == pl::cache_aligned_allocator<pl::cache_aligned<int>>{});
+    CHECK_FALSE(
+      pl::cache_aligned_allocator<int>{}
+      != pl::cache_aligned_allocator<char>{});
+  }
+}
@@ -37,7 +37,9 @@
 #include "../../include/static_assert.hpp" // PL_TEST_STATIC_ASSERT
 #include <array>                           // std::array
 #include <initializer_list>                // std::intializer_list
+#include <functional>                      // std::reference_wrapper
 #include <string>                          // std::string
+#include <system_error>                    // std::errc
 #include <type_traits>                     // std::is_same
 #include <vector>                          // std::vector
 
@@ -136,6 +138,30 @@ TEST_CASE("at_test")
       pl::cont::at(empty_init_list, static_cast<std::size_t>(-1)),
       std::out_of_range);
   }
+
+  SUBCASE("try_at")
+  {
+    auto r1 = pl::cont::try_at(a1, 1U);
+    REQUIRE(r1.has_value());
+    r1->get() = 20;
+    CHECK(a1[1] == 20);
+    CHECK(pl::cont::try_at(a2, 2U)->get() == 6);
+    CHECK(
+      pl::cont::try_at(a1, 3U).error() == std::errc::result_out_of_range);
+
+    CHECK(pl::cont::try_at(vec1, 3U)->get() == 4);
+    CHECK(pl::cont::try_at(vec2, 0U)->get() == 5);
+    CHECK_UNARY_FALSE(pl::cont::try_at(empty_vector, 0U));
+
+    CHECK(*pl::cont::try_at(il1, 1U) == "text");
+    CHECK(
+      pl::cont::try_at(empty_init_list, 0U).error()
+      == std::errc::result_out_of_range);
+
+    PL_TEST_STATIC_ASSERT(std::is_same<
+                          decltype(pl::cont::try_at(vec2, 0U))::value_type,
+                          std::reference_wrapper<const int>>::value);
+  }
 }
 
 #if (PL_COMPILER != PL_COMPILER_GCC) \
@@ -0,0 +1,118 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif                                       // PL_COMPILER == PL_COMPILER_GCC
+#include "../../include/pl/cpu_features.hpp" // pl::cpu_features
+
+namespace pl {
+namespace test {
+namespace {
+int kernel_generic() noexcept
+{
+  return 0;
+}
+int kernel_sse4_2() noexcept
+{
+  return 1;
+}
+int kernel_avx2() noexcept
+{
+  return 2;
+}
+
+using kernel_type = int (*)();
+
+kernel_type select(cpu_feature features) noexcept
+{
+  return select_kernel<kernel_type>(
+    {{cpu_feature::avx2 | cpu_feature::bmi2, &kernel_avx2},
+     {cpu_feature::sse4_2, &kernel_sse4_2},
+     {cpu_feature::none, &kernel_generic}},
+    cpu_features{features});
+}
+} // anonymous namespace
+} // namespace test
+} // namespace pl
+
+TEST_CASE("cpu_features_test")
+{
+  SUBCASE("has")
+  {
+    const pl::cpu_features features{pl::cpu_feature::sse2
+                                    | pl::cpu_feature::avx};
+
+    CHECK_UNARY(features.has(pl::cpu_feature::none));
+    CHECK_UNARY(features.has(pl::cpu_feature::sse2));
+    CHECK_UNARY(features.has(pl::cpu_feature::sse2 | pl::cpu_feature::avx));
+    CHECK_UNARY_FALSE(features.has(pl::cpu_feature::avx2));
+    CHECK_UNARY_FALSE(
+      features.has(pl::cpu_feature::sse2 | pl::cpu_feature::avx2));
+    CHECK(
+      features.features() == (pl::cpu_feature::sse2 | pl::cpu_feature::avx));
+  }
+
+  SUBCASE("current")
+  {
+    const pl::cpu_features& features{pl::cpu_features::current()};
+    CHECK(&features == &pl::cpu_features::current());
+
+#if defined(__x86_64__) || defined(_M_X64)
+    CHECK_UNARY(features.has(pl::cpu_feature::sse2));
+#endif
+
+    if (features.has(pl::cpu_feature::avx2)) {
+      CHECK_UNARY(features.has(pl::cpu_feature::avx));
+    }
+
+    if (features.has(pl::cpu_feature::avx512bw)) {
+      CHECK_UNARY(features.has(pl::cpu_feature::avx));
+    }
+
+#if !PL_CPU_X86
+    CHECK(features.features() == pl::cpu_feature::none);
+#endif // !PL_CPU_X86
+  }
+
+  SUBCASE("select_kernel")
+  {
+    CHECK(pl::test::select(pl::cpu_feature::none)() == 0);
+    CHECK(pl::test::select(pl::cpu_feature::avx2)() == 0);
+    CHECK(pl::test::select(pl::cpu_feature::sse4_2)() == 1);
+    CHECK(
+      pl::test::select(
+        pl::cpu_feature::sse4_2 | pl::cpu_feature::avx2
+        | pl::cpu_feature::bmi2)()
+      == 2);
+  }
+}
@@ -38,10 +38,12 @@
 #include <cstddef>                      // std::nullptr_t
 #include <cstdint>                      // std::uintptr_t
 #include <cstring>                      // std::strcmp, std::strstr
+#include <exception>                    // std::exception
 #include <memory>                       // std::unique_ptr, std::make_unique
 #include <stdexcept>                    // std::runtime_error
 #include <string> // std::string, std::literals::string_literals::operator""s
 #include <type_traits> // std::is_base_of
+#include <typeinfo>    // typeid
 
 namespace pl {
 namespace test {
@@ -57,6 +59,18 @@ PL_DEFINE_EXCEPTION_TYPE(test_exception, std::runtime_error);
 {
   PL_NOT_YET_IMPLEMENTED();
 }
+
+class final_exception final : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+int checked_value(int value)
+{
+  return value >= 0
+           ? value
+           : PL_THROW_WITH_SOURCE_INFO(final_exception, "negative value");
+}
 } // anonymous namespace
 } // namespace test
 } // namespace pl
@@ -93,8 +107,40 @@ TEST_CASE("throw_with_source_info_test")
 
     CHECK(std::strstr(msg, "test1") != nullptr);
     CHECK(std::strstr(msg, "except_test.cpp") != nullptr);
-    CHECK(std::strstr(msg, "line: 53") != nullptr);
+    CHECK(std::strstr(msg, "line: 55") != nullptr);
     CHECK(std::strstr(msg, "throw_with_source_info") != nullptr);
+    CHECK(ex.what() == msg);
+  }
+
+  try {
+    PL_THROW_WITH_SOURCE_INFO(std::runtime_error, "test" + std::string{"2"});
+  }
+  catch (const std::runtime_error& ex) {
+    const std::string msg{ex.what()};
+
+    CHECK(msg.find("Message: test2\n") == 0U);
+    CHECK(msg.find("\nfunction: ") != std::string::npos);
+    CHECK(msg == ex.what());
+  }
+
+  CHECK(pl::test::checked_value(1) == 1);
+
+  try {
+    (void)pl::test::checked_value(-1);
+  }
+  catch (const std::exception& ex) {
+    // the exact type requested is thrown.
+    CHECK(typeid(ex) == typeid(pl::test::final_exception));
+  }
+
+  try {
+    (void)pl::test::checked_value(-1);
+  }
+  catch (const pl::test::final_exception& ex) {
+    // copies don't lose the source information.
+    const pl::test::final_exception copy{ex};
+    CHECK(std::strstr(copy.what(), "Message: negative value\n") != nullptr);
+    CHECK(std::strstr(copy.what(), "except_test.cpp") != nullptr);
   }
 }
 
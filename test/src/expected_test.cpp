@@ -0,0 +1,126 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif                                   // PL_COMPILER == PL_COMPILER_GCC
+#include "../../include/pl/expected.hpp" // pl::expected
+#include "../include/static_assert.hpp"  // PL_TEST_STATIC_ASSERT
+#include <memory>                        // std::unique_ptr, std::make_unique
+#include <string>                        // std::string
+#include <system_error>                  // std::errc
+#include <type_traits>                   // std::is_trivially_copyable
+#include <utility>                       // std::move
+
+namespace pl {
+namespace test {
+namespace {
+expected<int, std::errc> halve(int i)
+{
+  if (i % 2 != 0) {
+    return make_unexpected(std::errc::invalid_argument);
+  }
+
+  return i / 2;
+}
+} // anonymous namespace
+} // namespace test
+} // namespace pl
+
+TEST_CASE("expected_test")
+{
+  SUBCASE("trivially_copyable")
+  {
+    PL_TEST_STATIC_ASSERT(
+      std::is_trivially_copyable<pl::expected<int, std::errc>>::value);
+    PL_TEST_STATIC_ASSERT(
+      !std::is_trivially_copyable<pl::expected<std::string, int>>::value);
+    CHECK_UNARY(true);
+  }
+
+  SUBCASE("value_and_error")
+  {
+    const pl::expected<int, std::errc> value{pl::test::halve(8)};
+    const pl::expected<int, std::errc> error{pl::test::halve(7)};
+
+    CHECK_UNARY(value.has_value());
+    CHECK_UNARY(value);
+    CHECK(*value == 4);
+    CHECK(value.value() == 4);
+    CHECK(value.value_or(0) == 4);
+
+    CHECK_UNARY_FALSE(error.has_value());
+    CHECK(error.error() == std::errc::invalid_argument);
+    CHECK(error.value_or(-1) == -1);
+    CHECK_THROWS_AS(
+      (void)error.value(), pl::bad_expected_access<std::errc>);
+
+    pl::expected<int, std::errc> copy{error};
+    CHECK(copy.error() == std::errc::invalid_argument);
+    copy = value;
+    CHECK(*copy == 4);
+  }
+
+  SUBCASE("non_trivial")
+  {
+    pl::expected<std::string, std::string> a{std::string{"value"}};
+    pl::expected<std::string, std::string> b{
+      pl::make_unexpected(std::string{"error"})};
+
+    CHECK(a->size() == 5U);
+
+    a = b;
+    CHECK_UNARY_FALSE(a.has_value());
+    CHECK(a.error() == "error");
+
+    b = pl::expected<std::string, std::string>{std::string{"text"}};
+    CHECK(*b == "text");
+
+    try {
+      (void)a.value();
+    }
+    catch (const pl::bad_expected_access<std::string>& ex) {
+      CHECK(ex.error() == "error");
+    }
+  }
+
+  SUBCASE("move_only")
+  {
+    pl::expected<std::unique_ptr<int>, std::errc> a{std::make_unique<int>(1)};
+    pl::expected<std::unique_ptr<int>, std::errc> b{std::move(a)};
+
+    CHECK(**b == 1);
+
+    std::unique_ptr<int> p{std::move(b).value()};
+    CHECK(*p == 1);
+  }
+}
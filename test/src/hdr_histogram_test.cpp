@@ -0,0 +1,234 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../include/pl/assert.hpp" // pl::precondition_violation_exception
+#include "../../include/pl/byte.hpp"          // pl::byte
+#include "../../include/pl/hdr_histogram.hpp" // pl::hdr_histogram
+#include <cstdint>                            // std::uint64_t
+#include <system_error>                       // std::errc
+#include <thread>                             // std::thread
+#include <vector>                             // std::vector
+
+TEST_CASE("hdr_histogram_test")
+{
+  constexpr std::uint64_t one_hour_ns{3600000000000U};
+
+  SUBCASE("empty")
+  {
+    const pl::hdr_histogram histogram{one_hour_ns, 3U};
+
+    CHECK(histogram.total_count() == 0U);
+    CHECK(histogram.min() == 0U);
+    CHECK(histogram.max() == 0U);
+    CHECK(histogram.mean() == doctest::Approx(0.0));
+    CHECK(histogram.value_at_percentile(50.0) == 0U);
+    CHECK(histogram.lowest_discernible_value() == 1U);
+    CHECK(histogram.highest_trackable_value() == one_hour_ns);
+    CHECK(histogram.significant_digits() == 3U);
+  }
+
+  SUBCASE("invalid_configuration")
+  {
+    CHECK_THROWS_AS(
+      pl::hdr_histogram(1U, 3U), pl::precondition_violation_exception);
+    CHECK_THROWS_AS(
+      pl::hdr_histogram(one_hour_ns, 0U), pl::precondition_violation_exception);
+    CHECK_THROWS_AS(
+      pl::hdr_histogram(one_hour_ns, 6U), pl::precondition_violation_exception);
+    CHECK_THROWS_AS(
+      pl::hdr_histogram(0U, one_hour_ns, 3U),
+      pl::precondition_violation_exception);
+    CHECK_FALSE(pl::hdr_histogram::is_valid_configuration(
+      std::uint64_t{1U} << 50U, UINT64_MAX, 5U));
+  }
+
+  SUBCASE("record")
+  {
+    pl::hdr_histogram histogram{one_hour_ns, 3U};
+
+    for (std::uint64_t value{1U}; value <= 10000U; ++value) {
+      histogram.record(value);
+    }
+
+    CHECK_FALSE(histogram.record(UINT64_MAX));
+    CHECK(histogram.record(2000U, 4U));
+    CHECK(histogram.total_count() == 10004U);
+    CHECK(histogram.min() == 1U);
+    CHECK(histogram.max() == 10000U);
+    CHECK(histogram.count_at_value(2000U) == 5U);
+    CHECK(histogram.count_at_value(9999U) == 8U);
+    CHECK(histogram.count_at_value(10008U) == 0U);
+    CHECK(histogram.value_at_percentile(50.0) == 4999U);
+    CHECK(histogram.value_at_percentile(99.0) == 9903U);
+    CHECK(histogram.value_at_percentile(99.9) == 9991U);
+    CHECK(histogram.value_at_percentile(100.0) == 10000U);
+    CHECK(histogram.value_at_percentile(250.0) == 10000U);
+    CHECK(histogram.value_at_percentile(0.0) == 1U);
+    CHECK(histogram.mean() == doctest::Approx(5000.0).epsilon(0.001));
+
+    histogram.reset();
+    CHECK(histogram.total_count() == 0U);
+    CHECK(histogram.count_at_value(2000U) == 0U);
+    CHECK(histogram.max() == 0U);
+  }
+
+  SUBCASE("equivalent_values")
+  {
+    const pl::hdr_histogram histogram{one_hour_ns, 3U};
+
+    CHECK(histogram.size_of_equivalent_value_range(2047U) == 1U);
+    CHECK(histogram.size_of_equivalent_value_range(2048U) == 2U);
+    CHECK(histogram.lowest_equivalent_value(10007U) == 10000U);
+    CHECK(histogram.highest_equivalent_value(10000U) == 10007U);
+    CHECK(histogram.median_equivalent_value(10001U) == 10004U);
+    CHECK(histogram.size_of_equivalent_value_range(10007U) == 8U);
+
+    for (const std::uint64_t value :
+         {std::uint64_t{12345U}, std::uint64_t{987654321U}, one_hour_ns}) {
+      CHECK(
+        histogram.highest_equivalent_value(value)
+          - histogram.lowest_equivalent_value(value)
+        < value / 1000U);
+    }
+
+    const pl::hdr_histogram coarse{1000U, one_hour_ns, 2U};
+    CHECK(coarse.size_of_equivalent_value_range(0U) == 512U);
+    CHECK(coarse.lowest_equivalent_value(1000U) == 512U);
+  }
+
+  SUBCASE("merge")
+  {
+    pl::hdr_histogram              total{one_hour_ns, 3U};
+    std::vector<pl::hdr_histogram> histograms(4U, total);
+    std::vector<std::thread>       threads{};
+
+    for (std::size_t i{0U}; i < histograms.size(); ++i) {
+      threads.emplace_back([&histograms, i] {
+        for (std::uint64_t value{1U}; value <= 1000U; ++value) {
+          histograms[i].record(value * (i + 1U));
+        }
+      });
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    for (const pl::hdr_histogram& histogram : histograms) {
+      CHECK(total.merge(histogram));
+    }
+
+    CHECK(total.total_count() == 4000U);
+    CHECK(total.min() == 1U);
+    CHECK(total.max() == 4000U);
+    CHECK(total.count_at_value(600U) == 4U);
+    CHECK(total.value_at_percentile(100.0) == 4000U);
+
+    pl::hdr_histogram coarse{1U, 1000000U, 2U};
+    CHECK(coarse.merge(total));
+    CHECK(coarse.total_count() == 4000U);
+    CHECK(coarse.min() == 1U);
+    CHECK(coarse.max() == 4000U);
+
+    pl::hdr_histogram small{1U, 100U, 2U};
+    CHECK_FALSE(small.merge(total));
+    CHECK(small.total_count() == 255U + 127U + 85U + 63U);
+    CHECK(small.max() == 255U);
+  }
+
+  SUBCASE("serialize")
+  {
+    pl::hdr_histogram histogram{one_hour_ns, 3U};
+    histogram.record(1U);
+    histogram.record(1000U, 3U);
+    histogram.record(123456789U);
+
+    const std::vector<pl::byte> buffer{histogram.serialize()};
+    CHECK(buffer.size() < 40U);
+
+    const pl::expected<pl::hdr_histogram, std::errc> result{
+      pl::hdr_histogram::deserialize(buffer.data(), buffer.size())};
+    REQUIRE(result.has_value());
+    CHECK(result->total_count() == 5U);
+    CHECK(result->min() == 1U);
+    CHECK(result->max() == 123456789U);
+    CHECK(result->count_at_value(1000U) == 3U);
+    CHECK(result->significant_digits() == 3U);
+    CHECK(result->highest_trackable_value() == one_hour_ns);
+    CHECK(
+      result->value_at_percentile(50.0)
+      == histogram.value_at_percentile(50.0));
+    CHECK(result->serialize() == buffer);
+
+    const std::vector<pl::byte> empty{
+      pl::hdr_histogram{1U, 100U, 1U}.serialize()};
+    const pl::expected<pl::hdr_histogram, std::errc> empty_result{
+      pl::hdr_histogram::deserialize(empty.data(), empty.size())};
+    REQUIRE(empty_result.has_value());
+    CHECK(empty_result->total_count() == 0U);
+    CHECK(empty_result->min() == 0U);
+  }
+
+  SUBCASE("deserialize_malformed")
+  {
+    const auto deserialize = [](const std::vector<pl::byte>& buffer) {
+      return pl::hdr_histogram::deserialize(buffer.data(), buffer.size());
+    };
+    const std::vector<pl::byte> valid{
+      pl::hdr_histogram{1U, 100U, 1U}.serialize()};
+    std::vector<pl::byte> buffer{valid};
+    buffer[0] = 2U;
+
+    CHECK(deserialize({}).error() == std::errc::invalid_argument);
+    CHECK(deserialize(buffer).error() == std::errc::invalid_argument);
+    CHECK(
+      deserialize(std::vector<pl::byte>(valid.begin(), valid.end() - 1))
+        .error()
+      == std::errc::invalid_argument);
+    CHECK(
+      deserialize({1U, 1U, 100U, 9U, 0U, 0U}).error()
+      == std::errc::invalid_argument);
+    CHECK(
+      deserialize({1U, 1U, 100U, 1U, 0U, 0U, 0xFFU}).error()
+      == std::errc::invalid_argument);
+    CHECK(
+      deserialize({1U, 1U, 100U, 1U, 0U, 0U, 0xFFU, 0x7FU}).error()
+      == std::errc::invalid_argument);
+    CHECK(
+      deserialize({1U, 1U, 100U, 1U, 5U, 2U, 2U}).error()
+      == std::errc::invalid_argument);
+    CHECK(deserialize({1U, 1U, 100U, 1U, 2U, 2U, 5U, 2U}).has_value());
+  }
+}
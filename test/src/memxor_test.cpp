@@ -38,6 +38,7 @@
 #include "../../include/pl/memxor.hpp"          // pl::memxor
 #include <cstddef>                              // std::size_t
 #include <cstring>                              // std::memcmp
+#include <vector>                               // std::vector
 
 TEST_CASE("memxor_test")
 {
@@ -91,4 +92,22 @@ TEST_CASE("memxor_test")
   CHECK(ret_val == dest);
 
   CHECK(std::memcmp(dest, expected, size) == 0);
+
+  SUBCASE("large_buffers")
+  {
+    for (std::size_t length{0U}; length < 200U; length += 7U) {
+      std::vector<pl::byte> a(length);
+      std::vector<pl::byte> b(length);
+      std::vector<pl::byte> expected_result(length);
+
+      for (std::size_t i{0U}; i < length; ++i) {
+        a[i]               = static_cast<pl::byte>(i * 3U);
+        b[i]               = static_cast<pl::byte>(i * 7U + 1U);
+        expected_result[i] = static_cast<pl::byte>(a[i] ^ b[i]);
+      }
+
+      pl::memxor(a.data(), b.data(), length);
+      CHECK(a == expected_result);
+    }
+  }
 }
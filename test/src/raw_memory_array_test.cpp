@@ -42,9 +42,10 @@
 #include <algorithm>                                   // std::all_of
 #include <cstddef>                                     // std::size_t
 #include <cstdlib>                                     // std::calloc
-#include <iterator> // std::crbegin, std::crend
-#include <memory>   // std::unique_ptr
-#include <string>   // std::string, std::literals::string_literals::operator""s
+#include <iterator>     // std::crbegin, std::crend
+#include <memory>       // std::unique_ptr
+#include <string> // std::string, std::literals::string_literals::operator""s
+#include <system_error> // std::errc
 
 TEST_CASE("raw_memory_array_test")
 {
@@ -93,6 +94,21 @@ TEST_CASE("raw_memory_array_test")
     CHECK_THROWS_AS((void)empty.at(0U), std::out_of_range);
   }
 
+  SUBCASE("try_at")
+  {
+    const pl::raw_memory_array<std::string>& r{ary2};
+
+    auto result = ary1.try_at(0U);
+    REQUIRE(result.has_value());
+    result->get() = "abc"s;
+    CHECK(ary1.at(0U) == "abc"s);
+    CHECK(r.try_at(amt_of_strings - 1U)->get() == "Text"s);
+
+    CHECK(ary1.try_at(ary1.size()).error() == std::errc::result_out_of_range);
+    CHECK(r.try_at(r.size()).error() == std::errc::result_out_of_range);
+    CHECK_UNARY_FALSE(empty.try_at(0U));
+  }
+
   SUBCASE("front")
   {
     CHECK(pl::as_const(ary1).front() == ""s);
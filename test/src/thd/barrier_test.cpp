@@ -0,0 +1,109 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/barrier.hpp" // pl::thd::barrier
+#include <atomic>                              // std::atomic
+#include <cstdint>                             // std::uint32_t
+#include <thread>                              // std::thread
+#include <vector>                              // std::vector
+
+namespace pl {
+namespace test {
+namespace {
+struct phase_counter {
+  std::atomic<int>* phases;
+
+  void operator()() const noexcept
+  {
+    ++*phases;
+  }
+};
+} // anonymous namespace
+} // namespace test
+} // namespace pl
+
+TEST_CASE("barrier_test")
+{
+  static constexpr std::uint32_t thread_count{4U};
+  static constexpr int           phase_count{1000};
+
+  SUBCASE("phases")
+  {
+    std::atomic<int>                          phases{0};
+    std::atomic<int>                          arrivals{0};
+    std::atomic<int>                          mismatches{0};
+    pl::thd::barrier<pl::test::phase_counter> barrier{
+      thread_count, pl::test::phase_counter{&phases}};
+    std::vector<std::thread> threads{};
+
+    for (std::uint32_t i{0U}; i < thread_count; ++i) {
+      threads.emplace_back([&] {
+        for (int phase{0}; phase < phase_count; ++phase) {
+          ++arrivals;
+          barrier.arrive_and_wait();
+
+          // the completion function ran before anyone was released.
+          if (phases.load() < phase + 1) {
+            ++mismatches;
+          }
+        }
+      });
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    CHECK(mismatches.load() == 0);
+    CHECK(phases.load() == phase_count);
+    CHECK(arrivals.load() == static_cast<int>(thread_count) * phase_count);
+  }
+
+  SUBCASE("arrive_and_drop")
+  {
+    pl::thd::barrier<> barrier{2U};
+    std::thread        thread{[&barrier] {
+      barrier.arrive_and_wait();
+      barrier.arrive_and_drop();
+    }};
+
+    barrier.arrive_and_wait();
+    barrier.arrive_and_wait();
+    thread.join();
+
+    // only this thread is expected from now on.
+    barrier.arrive_and_wait();
+  }
+}
@@ -0,0 +1,154 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/bounded_queue.hpp" // pl::thd::bounded_queue
+#include <chrono>   // std::literals::chrono_literals::operator""ms
+#include <future>   // std::future, std::async, std::launch::async
+#include <iterator> // std::back_inserter
+#include <memory>   // std::unique_ptr, std::make_unique
+#include <vector>   // std::vector
+
+TEST_CASE("bounded_queue_test")
+{
+  using namespace std::literals::chrono_literals;
+
+  pl::thd::bounded_queue<int> q{3U};
+
+  CHECK(q.capacity() == 3U);
+  CHECK_UNARY(q.empty());
+  CHECK(q.size() == 0U);
+  CHECK_UNARY_FALSE(q.is_closed());
+
+  SUBCASE("push_and_pop")
+  {
+    CHECK_UNARY(q.push(1));
+    CHECK_UNARY(q.try_push(2));
+    CHECK_UNARY(q.try_push_for(3, 1ms));
+    CHECK(q.size() == 3U);
+
+    CHECK_UNARY_FALSE(q.try_push(4));
+    CHECK_UNARY_FALSE(q.try_push_for(4, 10ms));
+    CHECK(q.size() == 3U);
+
+    int val{};
+    CHECK_UNARY(q.pop(val));
+    CHECK(val == 1);
+    CHECK_UNARY(q.try_pop(val));
+    CHECK(val == 2);
+    CHECK_UNARY(q.pop(val));
+    CHECK(val == 3);
+    CHECK_UNARY_FALSE(q.try_pop(val));
+    CHECK_UNARY(q.empty());
+  }
+
+  SUBCASE("backpressure")
+  {
+    CHECK_UNARY(q.push(1));
+    CHECK_UNARY(q.push(2));
+    CHECK_UNARY(q.push(3));
+
+    std::future<bool> fut{
+      std::async(std::launch::async, [&q] { return q.push(4); })};
+
+    CHECK(fut.wait_for(50ms) == std::future_status::timeout);
+
+    int val{};
+    CHECK_UNARY(q.pop(val));
+    CHECK(val == 1);
+    CHECK_UNARY(fut.get());
+    CHECK(q.size() == 3U);
+  }
+
+  SUBCASE("pop_bulk_and_drain")
+  {
+    q.push(1);
+    q.push(2);
+    q.push(3);
+
+    std::vector<int> v{};
+    CHECK(q.pop_bulk(std::back_inserter(v), 2U) == 2U);
+    CHECK(v == std::vector<int>{1, 2});
+    CHECK(q.drain(std::back_inserter(v), 5U) == 1U);
+    CHECK(v == std::vector<int>{1, 2, 3});
+    CHECK(q.drain(std::back_inserter(v), 5U) == 0U);
+    CHECK_UNARY(q.empty());
+
+    // doesn't block on the empty queue if nothing is requested.
+    CHECK(q.pop_bulk(std::back_inserter(v), 0U) == 0U);
+    CHECK(v.size() == 3U);
+  }
+
+  SUBCASE("close")
+  {
+    std::future<std::size_t> fut{std::async(std::launch::async, [&q] {
+      std::vector<int> v{};
+      std::size_t      total{0U};
+
+      for (;;) {
+        const std::size_t count{q.pop_bulk(std::back_inserter(v), 2U)};
+
+        if (count == 0U) {
+          return total;
+        }
+
+        total += count;
+      }
+    })};
+
+    for (int i{0}; i < 10; ++i) {
+      CHECK_UNARY(q.push(i));
+    }
+
+    q.close();
+    CHECK_UNARY(q.is_closed());
+    CHECK(fut.get() == 10U);
+    CHECK_UNARY_FALSE(q.push(11));
+    CHECK_UNARY_FALSE(q.try_push(11));
+
+    int val{};
+    CHECK_UNARY_FALSE(q.pop(val));
+  }
+
+  SUBCASE("move_only")
+  {
+    pl::thd::bounded_queue<std::unique_ptr<int>> queue{2U};
+    CHECK_UNARY(queue.push(std::make_unique<int>(5)));
+
+    std::unique_ptr<int> p{};
+    CHECK_UNARY(queue.pop(p));
+    REQUIRE(p != nullptr);
+    CHECK(*p == 5);
+  }
+}
@@ -0,0 +1,152 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/combinable.hpp"  // pl::thd::combinable
+#include "../../../include/pl/thd/thread_pool.hpp" // pl::thd::thread_pool
+#include <cstddef>                                 // std::size_t
+#include <functional>                              // std::plus
+#include <future>                                  // std::future
+#include <memory>                                  // std::unique_ptr
+#include <thread>                                  // std::thread
+#include <vector>                                  // std::vector
+
+TEST_CASE("combinable_test")
+{
+  SUBCASE("empty")
+  {
+    const pl::thd::combinable<int> combinable{[] { return 5; }};
+    CHECK(combinable.size() == 0U);
+    CHECK(combinable.combine(std::plus<int>{}) == 5);
+  }
+
+  SUBCASE("local")
+  {
+    pl::thd::combinable<int> combinable{};
+    bool                     exists{true};
+
+    int& value{combinable.local(exists)};
+    CHECK_UNARY_FALSE(exists);
+    CHECK(value == 0);
+    value = 7;
+
+    CHECK(&combinable.local(exists) == &value);
+    CHECK_UNARY(exists);
+    CHECK(combinable.size() == 1U);
+    CHECK(combinable.combine(std::plus<int>{}) == 7);
+  }
+
+  SUBCASE("multiple_instances")
+  {
+    // more instances than entries in the per-thread cache.
+    std::vector<std::unique_ptr<pl::thd::combinable<int>>> combinables{};
+
+    for (int i{0}; i < 20; ++i) {
+      combinables.push_back(std::make_unique<pl::thd::combinable<int>>());
+    }
+
+    for (int round{0}; round < 3; ++round) {
+      for (std::size_t i{0U}; i < combinables.size(); ++i) {
+        combinables[i]->local() += static_cast<int>(i);
+      }
+    }
+
+    for (std::size_t i{0U}; i < combinables.size(); ++i) {
+      CHECK(combinables[i]->size() == 1U);
+      CHECK(
+        combinables[i]->combine(std::plus<int>{}) == 3 * static_cast<int>(i));
+    }
+  }
+
+  SUBCASE("multiple_threads")
+  {
+    static constexpr int thread_count{8};
+    static constexpr int iterations{10000};
+
+    pl::thd::combinable<long> combinable{};
+    std::vector<std::thread>  threads{};
+
+    for (int i{0}; i < thread_count; ++i) {
+      threads.emplace_back([&combinable] {
+        for (int j{0}; j < iterations; ++j) {
+          ++combinable.local();
+        }
+      });
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    CHECK(combinable.size() <= static_cast<std::size_t>(thread_count));
+    CHECK(
+      combinable.combine(std::plus<long>{})
+      == static_cast<long>(thread_count) * iterations);
+
+    long sum{0};
+    combinable.combine_each([&sum](long value) { sum += value; });
+    CHECK(sum == static_cast<long>(thread_count) * iterations);
+  }
+
+  SUBCASE("thread_pool")
+  {
+    pl::thd::thread_pool           pool{4U};
+    pl::thd::combinable<long>      combinable{};
+    std::vector<std::future<void>> futures{};
+
+    for (long i{1}; i <= 1000; ++i) {
+      futures.push_back(
+        pool.add_task([&combinable, i] { combinable.local() += i; }));
+    }
+
+    for (std::future<void>& future : futures) {
+      future.get();
+    }
+
+    CHECK(combinable.size() <= 4U);
+    CHECK(combinable.combine(std::plus<long>{}) == 500500);
+  }
+
+  SUBCASE("clear")
+  {
+    pl::thd::combinable<int> combinable{};
+    combinable.local() = 3;
+    combinable.clear();
+    CHECK(combinable.size() == 0U);
+
+    bool exists{true};
+    CHECK(combinable.local(exists) == 0);
+    CHECK_UNARY_FALSE(exists);
+  }
+}
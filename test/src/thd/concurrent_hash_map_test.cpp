@@ -0,0 +1,156 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/concurrent_hash_map.hpp" // pl::thd::concurrent_hash_map
+#include <atomic>                                          // std::atomic
+#include <cstddef>                                         // std::size_t
+#include <string>                                          // std::string
+#include <thread>                                          // std::thread
+#include <type_traits>                                     // std::is_same
+#include <vector>                                          // std::vector
+
+TEST_CASE("concurrent_hash_map_test")
+{
+  pl::thd::concurrent_hash_map<int, std::string> map{};
+
+  SUBCASE("stripe_count")
+  {
+    pl::thd::concurrent_hash_map<int, int> m{5U};
+    CHECK(m.stripe_count() == 8U);
+    CHECK(map.stripe_count() == 64U);
+  }
+
+  SUBCASE("basic")
+  {
+    CHECK_UNARY(map.empty());
+    CHECK_UNARY(map.insert_or_assign(1, "one"));
+    CHECK_UNARY(map.insert_or_assign(2, "two"));
+    CHECK_UNARY_FALSE(map.insert_or_assign(1, "uno"));
+    CHECK(map.size() == 2U);
+    CHECK_UNARY(map.contains(1));
+    CHECK_UNARY_FALSE(map.contains(3));
+
+    std::string result{};
+    CHECK_UNARY(map.find(1, [&result](const std::string& s) { result = s; }));
+    CHECK(result == "uno");
+    CHECK_UNARY_FALSE(map.find(3, [](const std::string&) {}));
+
+    CHECK_UNARY(map.update(2, [](std::string& s) { s += "!"; }));
+    CHECK_UNARY_FALSE(map.update(3, [](std::string&) {}));
+    CHECK_UNARY(map.find(2, [&result](const std::string& s) { result = s; }));
+    CHECK(result == "two!");
+
+    CHECK_UNARY(map.erase(1));
+    CHECK_UNARY_FALSE(map.erase(1));
+    CHECK(map.size() == 1U);
+
+    map.clear();
+    CHECK_UNARY(map.empty());
+  }
+
+  SUBCASE("compute_if_absent")
+  {
+    CHECK(map.compute_if_absent(1, [] { return std::string{"one"}; }) == "one");
+    CHECK(map.compute_if_absent(1, [] { return std::string{"x"}; }) == "one");
+    CHECK(
+      map.compute_if_absent(
+        2,
+        [] { return std::string{"two"}; },
+        [](const std::string& s) { return s.size(); })
+      == 3U);
+
+    // a reference returned by callable is copied while the lock is held.
+    const auto factory  = [] { return std::string{"x"}; };
+    const auto identity = [](const std::string& s) -> const std::string& {
+      return s;
+    };
+    static_assert(
+      std::is_same<
+        decltype(map.compute_if_absent(2, factory, identity)),
+        std::string>::value,
+      "compute_if_absent must return by value");
+    const std::string copy{map.compute_if_absent(2, factory, identity)};
+    CHECK(map.erase(2));
+    CHECK(copy == "two");
+  }
+
+  SUBCASE("for_each")
+  {
+    for (int i{0}; i < 100; ++i) {
+      (void)map.insert_or_assign(i, std::to_string(i));
+    }
+
+    int sum{0};
+    map.for_each([&sum](int key, const std::string& value) {
+      CHECK(std::to_string(key) == value);
+      sum += key;
+    });
+    CHECK(sum == 4950);
+  }
+
+  SUBCASE("concurrent")
+  {
+    static constexpr int thread_count{4};
+    static constexpr int key_count{1000};
+
+    pl::thd::concurrent_hash_map<int, int> m{};
+    std::atomic<int>                       factory_calls{0};
+    std::vector<std::thread>               threads{};
+
+    for (int t{0}; t < thread_count; ++t) {
+      threads.emplace_back([&m, &factory_calls] {
+        for (int i{0}; i < key_count; ++i) {
+          CHECK(
+            m.compute_if_absent(
+              i,
+              [&factory_calls, i] {
+                ++factory_calls;
+                return i * 2;
+              })
+            == i * 2);
+          (void)m.update(i, [](int& v) { v += 0; });
+          (void)m.find(i, [i](int v) { CHECK(v == i * 2); });
+        }
+      });
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    CHECK(factory_calls.load() == key_count);
+    CHECK(m.size() == static_cast<std::size_t>(key_count));
+  }
+}
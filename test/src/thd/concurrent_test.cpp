@@ -33,10 +33,13 @@
 #if PL_COMPILER == PL_COMPILER_GCC
 #pragma GCC diagnostic pop
 #endif // PL_COMPILER == PL_COMPILER_GCC
-#include "../../../include/pl/thd/concurrent.hpp" // pl::thd::concurrent
-#include <future>                                 // std::future
-#include <stdexcept>                              // std::logic_error
-#include <vector>                                 // std::vector
+#include "../../../include/pl/thd/concurrent.hpp"  // pl::thd::concurrent
+#include "../../../include/pl/thd/thread_pool.hpp" // pl::thd::thread_pool
+#include <cstddef>                                 // std::size_t
+#include <future>                                  // std::future
+#include <memory>    // std::unique_ptr, std::make_unique
+#include <stdexcept> // std::logic_error
+#include <vector>    // std::vector
 
 TEST_CASE("concurrent_test")
 {
@@ -64,3 +67,45 @@ TEST_CASE("concurrent_test")
   CHECK(fut3.get() == 2U);
   CHECK_THROWS_AS(fut4.get(), std::logic_error);
 }
+
+TEST_CASE("concurrent_on_thread_pool_test")
+{
+  pl::thd::thread_pool pool{2U};
+
+  std::vector<std::unique_ptr<pl::thd::concurrent<std::vector<int>>>>
+    objects{};
+
+  for (int i{0}; i < 100; ++i) {
+    objects.push_back(
+      std::make_unique<pl::thd::concurrent<std::vector<int>>>(
+        pool, std::vector<int>{}));
+  }
+
+  for (int i{0}; i < 50; ++i) {
+    for (auto& object : objects) {
+      (*object)([i](std::vector<int>& v) { v.push_back(i); });
+    }
+  }
+
+  for (auto& object : objects) {
+    std::future<bool> fut{(*object)([](const std::vector<int>& v) {
+      for (std::size_t i{0U}; i < v.size(); ++i) {
+        if (v[i] != static_cast<int>(i)) {
+          return false;
+        }
+      }
+
+      return v.size() == 50U;
+    })};
+
+    CHECK_UNARY(fut.get());
+  }
+
+  std::future<void> fut{(*objects.front())(
+    [](std::vector<int>&) { throw std::logic_error{"test error"}; })};
+  CHECK_THROWS_AS(fut.get(), std::logic_error);
+
+  std::future<int> fut2{(*objects.back())(
+    [p = std::make_unique<int>(7)](std::vector<int>&) { return *p; })};
+  CHECK(fut2.get() == 7);
+}
@@ -0,0 +1,106 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/counting_semaphore.hpp" // pl::thd::counting_semaphore
+#include <atomic>                                         // std::atomic
+#include <chrono> // std::chrono::milliseconds
+#include <thread>                                         // std::thread
+#include <vector>                                         // std::vector
+
+TEST_CASE("counting_semaphore_test")
+{
+  SUBCASE("try_acquire")
+  {
+    pl::thd::counting_semaphore sem{2U};
+    CHECK_UNARY(sem.try_acquire());
+    CHECK_UNARY(sem.try_acquire());
+    CHECK_UNARY_FALSE(sem.try_acquire());
+    sem.release(2U);
+    sem.acquire();
+    CHECK_UNARY(sem.try_acquire());
+    CHECK_UNARY_FALSE(sem.try_acquire());
+  }
+
+  SUBCASE("limits_concurrency")
+  {
+    static constexpr int thread_count{8};
+    static constexpr int iterations{2000};
+
+    pl::thd::counting_semaphore sem{2U};
+    std::atomic<int>            inside{0};
+    std::atomic<int>            violations{0};
+    std::vector<std::thread>    threads{};
+
+    for (int i{0}; i < thread_count; ++i) {
+      threads.emplace_back([&] {
+        for (int j{0}; j < iterations; ++j) {
+          sem.acquire();
+
+          if (++inside > 2) {
+            ++violations;
+          }
+
+          --inside;
+          sem.release();
+        }
+      });
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    CHECK(violations.load() == 0);
+    CHECK_UNARY(sem.try_acquire());
+    CHECK_UNARY(sem.try_acquire());
+    CHECK_UNARY_FALSE(sem.try_acquire());
+  }
+
+  SUBCASE("blocks")
+  {
+    pl::thd::counting_semaphore sem{0U};
+    std::atomic<bool>           acquired{false};
+    std::thread                 thread{[&] {
+      sem.acquire();
+      acquired = true;
+    }};
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    CHECK_UNARY_FALSE(acquired.load());
+    sem.release();
+    thread.join();
+    CHECK_UNARY(acquired.load());
+  }
+}
@@ -0,0 +1,118 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/event.hpp" // pl::thd::manual_reset_event, pl::thd::auto_reset_event
+#include <atomic>                            // std::atomic
+#include <chrono>                            // std::chrono::milliseconds
+#include <thread>                            // std::thread
+#include <vector>                            // std::vector
+
+TEST_CASE("event_test")
+{
+  SUBCASE("manual_reset_event")
+  {
+    pl::thd::manual_reset_event event{};
+    CHECK_UNARY_FALSE(event.is_set());
+    event.set();
+    CHECK_UNARY(event.is_set());
+    event.wait();
+    event.wait(); // remains set.
+    event.reset();
+    CHECK_UNARY_FALSE(event.is_set());
+    CHECK_UNARY(pl::thd::manual_reset_event{true}.is_set());
+  }
+
+  SUBCASE("manual_reset_event_releases_all")
+  {
+    pl::thd::manual_reset_event event{};
+    std::atomic<int>            released{0};
+    std::vector<std::thread>    threads{};
+
+    for (int i{0}; i < 4; ++i) {
+      threads.emplace_back([&] {
+        event.wait();
+        ++released;
+      });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    CHECK(released.load() == 0);
+    event.set();
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    CHECK(released.load() == 4);
+  }
+
+  SUBCASE("auto_reset_event")
+  {
+    pl::thd::auto_reset_event event{true};
+    CHECK_UNARY(event.try_wait());
+    CHECK_UNARY_FALSE(event.try_wait());
+    event.set();
+    event.set(); // doesn't accumulate.
+    event.wait();
+    CHECK_UNARY_FALSE(event.try_wait());
+    event.set();
+    event.reset();
+    CHECK_UNARY_FALSE(event.try_wait());
+  }
+
+  SUBCASE("auto_reset_event_releases_one")
+  {
+    static constexpr int iterations{1000};
+
+    pl::thd::auto_reset_event ping{};
+    pl::thd::auto_reset_event pong{};
+    int                       counter{0};
+    std::thread               thread{[&] {
+      for (int i{0}; i < iterations; ++i) {
+        ping.wait();
+        ++counter;
+        pong.set();
+      }
+    }};
+
+    for (int i{0}; i < iterations; ++i) {
+      ping.set();
+      pong.wait();
+    }
+
+    thread.join();
+    CHECK(counter == iterations);
+  }
+}
@@ -0,0 +1,274 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/fiber.hpp" // pl::thd::fiber
+#if PL_THD_HAS_FIBERS
+#include <atomic>    // std::atomic
+#include <cstddef>   // std::size_t
+#include <future>    // std::future_error
+#include <memory>    // std::unique_ptr, std::make_unique
+#include <mutex>     // std::unique_lock, std::lock_guard
+#include <stdexcept> // std::runtime_error
+#include <string>    // std::string
+#include <thread>    // std::this_thread::yield
+#include <vector>    // std::vector
+
+TEST_CASE("fiber_test")
+{
+  SUBCASE("spawn")
+  {
+    pl::thd::fiber_scheduler scheduler{2U};
+    CHECK(scheduler.thread_count() == 2U);
+
+    pl::thd::fiber_future<int> future{
+      scheduler.spawn([](int a, int b) { return a + b; }, 1, 2)};
+    pl::thd::fiber_future<std::string> string_future{scheduler.spawn([] {
+      CHECK_UNARY(pl::thd::this_fiber::is_fiber());
+      return std::string{"text"};
+    })};
+    pl::thd::fiber_future<void> exception_future{
+      scheduler.spawn([] { throw std::runtime_error{"error"}; })};
+
+    CHECK_UNARY(future.valid());
+    CHECK(future.get() == 3);
+    CHECK_UNARY_FALSE(future.valid());
+    CHECK(string_future.get() == "text");
+    CHECK_THROWS_AS(exception_future.get(), std::runtime_error);
+    CHECK_UNARY_FALSE(pl::thd::this_fiber::is_fiber());
+  }
+
+  SUBCASE("move_only")
+  {
+    pl::thd::fiber_scheduler scheduler{2U};
+
+    pl::thd::fiber_future<std::unique_ptr<int>> future{scheduler.spawn(
+      [p = std::make_unique<int>(1)](std::unique_ptr<int> q) {
+        *q += *p;
+        return q;
+      },
+      std::make_unique<int>(2))};
+
+    CHECK(*future.get() == 3);
+  }
+
+  SUBCASE("yield")
+  {
+    static constexpr int fiber_count{100};
+    static constexpr int iterations{100};
+
+    pl::thd::fiber_scheduler                 scheduler{4U};
+    std::atomic<int>                         counter{0};
+    std::vector<pl::thd::fiber_future<void>> futures{};
+
+    for (int i{0}; i < fiber_count; ++i) {
+      futures.push_back(scheduler.spawn([&counter] {
+        for (int j{0}; j < iterations; ++j) {
+          ++counter;
+          pl::thd::this_fiber::yield();
+        }
+      }));
+    }
+
+    for (pl::thd::fiber_future<void>& future : futures) {
+      future.get();
+    }
+
+    CHECK(counter.load() == fiber_count * iterations);
+  }
+
+  SUBCASE("mutex")
+  {
+    static constexpr int fiber_count{200};
+    static constexpr int iterations{50};
+
+    pl::thd::fiber_scheduler    scheduler{4U};
+    pl::thd::fiber_mutex        mutex{};
+    int                         counter{0};
+    std::vector<pl::thd::fiber> fibers{};
+
+    for (int i{0}; i < fiber_count; ++i) {
+      fibers.emplace_back(scheduler, [&mutex, &counter] {
+        for (int j{0}; j < iterations; ++j) {
+          std::lock_guard<pl::thd::fiber_mutex> lock{mutex};
+          (void)lock;
+          const int value{counter};
+          // other fibers run while the mutex is held.
+          pl::thd::this_fiber::yield();
+          counter = value + 1;
+        }
+      });
+    }
+
+    for (pl::thd::fiber& fiber : fibers) {
+      CHECK_UNARY(fiber.joinable());
+      fiber.join();
+      CHECK_UNARY_FALSE(fiber.joinable());
+    }
+
+    CHECK(counter == fiber_count * iterations);
+  }
+
+  SUBCASE("condition_variable")
+  {
+    static constexpr int item_count{1000};
+
+    pl::thd::fiber_scheduler          scheduler{3U};
+    pl::thd::fiber_mutex              mutex{};
+    pl::thd::fiber_condition_variable cv{};
+    std::vector<int>                  items{};
+    bool                              is_done{false};
+
+    pl::thd::fiber_future<long> consumer{scheduler.spawn([&] {
+      long sum{0};
+
+      for (;;) {
+        std::unique_lock<pl::thd::fiber_mutex> lock{mutex};
+        cv.wait(lock, [&] { return !items.empty() || is_done; });
+
+        if (items.empty()) {
+          return sum;
+        }
+
+        sum += items.back();
+        items.pop_back();
+      }
+    })};
+
+    pl::thd::fiber producer{scheduler, [&] {
+      for (int i{1}; i <= item_count; ++i) {
+        {
+          std::lock_guard<pl::thd::fiber_mutex> lock{mutex};
+          (void)lock;
+          items.push_back(i);
+        }
+
+        cv.notify_one();
+
+        if ((i % 10) == 0) {
+          pl::thd::this_fiber::yield();
+        }
+      }
+
+      {
+        std::lock_guard<pl::thd::fiber_mutex> lock{mutex};
+        (void)lock;
+        is_done = true;
+      }
+
+      cv.notify_all();
+    }};
+
+    producer.join();
+    CHECK(
+      consumer.get() == static_cast<long>(item_count) * (item_count + 1) / 2);
+  }
+
+  SUBCASE("many_waiting_fibers")
+  {
+    // far more fibers than threads wait at the same time, more than
+    // vm.max_map_count would allow with guard pages.
+    static constexpr std::size_t fiber_count{100000U};
+
+    pl::thd::fiber_scheduler                 scheduler{4U, 16U * 1024U, false};
+    pl::thd::fiber_promise<int>              promise{};
+    pl::thd::fiber_future<int>               shared{promise.get_future()};
+    pl::thd::fiber_mutex                     mutex{};
+    pl::thd::fiber_condition_variable        cv{};
+    bool                                     is_released{false};
+    std::vector<int>                         results{};
+    std::atomic<std::size_t>                 started{0U};
+    std::vector<pl::thd::fiber_future<void>> futures{};
+
+    for (std::size_t i{0U}; i < fiber_count; ++i) {
+      futures.push_back(scheduler.spawn([&] {
+        ++started;
+        std::unique_lock<pl::thd::fiber_mutex> lock{mutex};
+        cv.wait(lock, [&] { return is_released; });
+        results.push_back(1);
+      }));
+    }
+
+    while (started.load() != fiber_count) {
+      std::this_thread::yield();
+    }
+
+    CHECK(scheduler.fiber_count() == fiber_count);
+
+    {
+      std::lock_guard<pl::thd::fiber_mutex> lock{mutex};
+      (void)lock;
+      is_released = true;
+    }
+
+    cv.notify_all();
+
+    for (pl::thd::fiber_future<void>& future : futures) {
+      future.get();
+    }
+
+    CHECK(results.size() == fiber_count);
+    promise.set_value(5);
+    CHECK(shared.get() == 5);
+  }
+
+  SUBCASE("future_between_fibers")
+  {
+    pl::thd::fiber_scheduler    scheduler{1U};
+    pl::thd::fiber_promise<int> promise{};
+    pl::thd::fiber_future<int>  future{promise.get_future()};
+
+    // the only thread runs the setter while the getter is suspended.
+    pl::thd::fiber_future<int> getter{
+      scheduler.spawn([&future] { return future.get() * 2; })};
+    pl::thd::fiber setter{scheduler, [&promise] { promise.set_value(21); }};
+
+    CHECK(getter.get() == 42);
+  }
+
+  SUBCASE("broken_promise")
+  {
+    pl::thd::fiber_future<int> future{};
+
+    {
+      pl::thd::fiber_promise<int> promise{};
+      future = promise.get_future();
+      CHECK_UNARY_FALSE(future.is_ready());
+    }
+
+    CHECK_UNARY(future.is_ready());
+    CHECK_THROWS_AS(future.get(), std::future_error);
+  }
+}
+#endif // PL_THD_HAS_FIBERS
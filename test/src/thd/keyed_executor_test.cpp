@@ -0,0 +1,173 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/keyed_executor.hpp" // pl::thd::keyed_executor
+#include "../../../include/pl/thd/thread_pool.hpp"    // pl::thd::thread_pool
+#include <atomic>                                     // std::atomic
+#include <cstddef>                                    // std::size_t
+#include <future> // std::future, std::promise
+#include <memory> // std::unique_ptr, std::make_unique
+#include <stdexcept>                                  // std::runtime_error
+#include <string>                                     // std::string
+#include <thread>                                     // std::this_thread::yield
+#include <vector>                                     // std::vector
+
+TEST_CASE("keyed_executor_test")
+{
+  pl::thd::thread_pool pool{4U};
+
+  SUBCASE("results")
+  {
+    pl::thd::keyed_executor<std::string> executor{pool};
+
+    std::future<int> fut1{
+      executor.add_task("a", [](int a, int b) { return a + b; }, 1, 2)};
+    std::future<void> fut2{executor.add_task(
+      "b", [] { throw std::runtime_error{"error"}; })};
+
+    CHECK(fut1.get() == 3);
+    CHECK_THROWS_AS(fut2.get(), std::runtime_error);
+  }
+
+  SUBCASE("serial_within_key")
+  {
+    static constexpr int key_count{50};
+    static constexpr int task_count{200};
+
+    const std::size_t             keys{static_cast<std::size_t>(key_count)};
+    std::vector<std::vector<int>> results(keys);
+    std::vector<std::atomic<int>> in_flight(keys);
+    std::atomic<int>              violations{0};
+    {
+      pl::thd::keyed_executor<int> executor{pool, 4U};
+
+      for (int i{0}; i < task_count; ++i) {
+        for (int key{0}; key < key_count; ++key) {
+          (void)executor.add_task(key, [&, key, i] {
+            const std::size_t index{static_cast<std::size_t>(key)};
+
+            if (++in_flight[index] != 1) {
+              ++violations;
+            }
+
+            results[index].push_back(i);
+            --in_flight[index];
+          });
+        }
+      }
+    } // waits for the tasks.
+
+    CHECK(violations.load() == 0);
+
+    for (const std::vector<int>& result : results) {
+      REQUIRE(result.size() == static_cast<std::size_t>(task_count));
+
+      for (std::size_t i{0U}; i < result.size(); ++i) {
+        CHECK(result[i] == static_cast<int>(i));
+      }
+    }
+  }
+
+  SUBCASE("parallel_across_keys")
+  {
+    pl::thd::keyed_executor<int> executor{pool};
+    std::promise<void>           promise{};
+    std::shared_future<void>     gate{promise.get_future().share()};
+
+    // blocks key 1 until key 2 has run.
+    std::future<void> blocked{
+      executor.add_task(1, [gate] { gate.wait(); })};
+    std::future<void> other{
+      executor.add_task(2, [&promise] { promise.set_value(); })};
+
+    other.get();
+    blocked.get();
+    CHECK(executor.active_keys() <= 2U);
+  }
+
+  SUBCASE("move_only")
+  {
+    pl::thd::keyed_executor<std::string> executor{pool};
+
+    std::future<std::unique_ptr<int>> fut{executor.add_task(
+      "a",
+      [p = std::make_unique<int>(1)](std::unique_ptr<int> q) {
+        *q += *p;
+        return q;
+      },
+      std::make_unique<int>(2))};
+
+    CHECK(*fut.get() == 3);
+  }
+
+  SUBCASE("full_queue")
+  {
+    for (const pl::thd::overflow_policy policy :
+         {pl::thd::overflow_policy::block,
+          pl::thd::overflow_policy::reject,
+          pl::thd::overflow_policy::caller_runs,
+          pl::thd::overflow_policy::drop_lowest_priority}) {
+      pl::thd::thread_pool     small_pool{1U, 1U, policy};
+      std::promise<void>       promise{};
+      std::shared_future<void> gate{promise.get_future().share()};
+      std::future<void>        blocker{
+        small_pool.add_task([gate] { gate.wait(); })};
+
+      while (small_pool.tasks_waiting_for_execution() != 0U) {
+        std::this_thread::yield();
+      }
+
+      std::future<void> filler{small_pool.add_task([] {})}; // fills the queue
+      std::vector<int>  counts(10U, 0);
+      {
+        pl::thd::keyed_executor<int> executor{small_pool};
+
+        for (int i{0}; i < 100; ++i) {
+          for (int key{0}; key < 10; ++key) {
+            (void)executor.add_task(key, [&counts, key] {
+              ++counts[static_cast<std::size_t>(key)];
+            });
+          }
+        }
+
+        promise.set_value();
+      } // waits for the tasks.
+
+      for (const int count : counts) {
+        CHECK(count == 100);
+      }
+    }
+  }
+}
@@ -0,0 +1,87 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/latch.hpp" // pl::thd::latch
+#include <atomic>                            // std::atomic
+#include <thread>                            // std::thread
+#include <vector>                            // std::vector
+
+TEST_CASE("latch_test")
+{
+  SUBCASE("count_down")
+  {
+    pl::thd::latch l{3U};
+    CHECK_UNARY_FALSE(l.try_wait());
+    l.count_down(2U);
+    CHECK_UNARY_FALSE(l.try_wait());
+    l.count_down();
+    CHECK_UNARY(l.try_wait());
+    l.wait();
+  }
+
+  SUBCASE("zero")
+  {
+    pl::thd::latch l{0U};
+    CHECK_UNARY(l.try_wait());
+    l.wait();
+  }
+
+  SUBCASE("threads")
+  {
+    static constexpr std::uint32_t thread_count{4U};
+
+    pl::thd::latch           start{1U};
+    pl::thd::latch           done{thread_count};
+    std::atomic<int>         started{0};
+    std::vector<std::thread> threads{};
+
+    for (std::uint32_t i{0U}; i < thread_count; ++i) {
+      threads.emplace_back([&] {
+        start.wait();
+        ++started;
+        done.arrive_and_wait();
+      });
+    }
+
+    CHECK(started.load() == 0);
+    start.count_down();
+    done.wait();
+    CHECK(started.load() == static_cast<int>(thread_count));
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+}
@@ -0,0 +1,181 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/assert.hpp" // pl::precondition_violation_exception
+#include "../../../include/pl/thd/pipeline.hpp"    // pl::thd::make_pipeline
+#include "../../../include/pl/thd/thread_pool.hpp" // pl::thd::thread_pool
+#include <atomic>                                  // std::atomic
+#include <stdexcept>                               // std::runtime_error
+#include <string>                                  // std::string
+#include <vector>                                  // std::vector
+
+TEST_CASE("pipeline_test")
+{
+  static constexpr int item_count{1000};
+
+  pl::thd::thread_pool pool{4U};
+  int                  next{0};
+
+  auto source = [&next](pl::thd::flow_control& fc) {
+    if (next == item_count) {
+      fc.stop();
+    }
+
+    return next++;
+  };
+
+  SUBCASE("serial_in_order_restores_order")
+  {
+    std::vector<std::string> result{};
+
+    pl::thd::make_pipeline(source)
+      .add_stage(pl::thd::filter_mode::parallel, [](int i) { return i * 2; })
+      .add_stage(
+        pl::thd::filter_mode::parallel, [](int i) { return std::to_string(i); })
+      .add_stage(
+        pl::thd::filter_mode::serial_in_order,
+        [&result](const std::string& s) { result.push_back(s); })
+      .run(pool, 8U);
+
+    REQUIRE(result.size() == static_cast<std::size_t>(item_count));
+
+    for (int i{0}; i < item_count; ++i) {
+      CHECK(result[static_cast<std::size_t>(i)] == std::to_string(i * 2));
+    }
+  }
+
+  SUBCASE("serial_out_of_order")
+  {
+    long long sum{0};
+
+    pl::thd::make_pipeline(source)
+      .add_stage(pl::thd::filter_mode::parallel, [](int i) { return i + 1; })
+      .add_stage(
+        pl::thd::filter_mode::serial_out_of_order,
+        [&sum](int i) { sum += i; })
+      .run(pool, 4U);
+
+    CHECK(sum == (static_cast<long long>(item_count) * (item_count + 1)) / 2);
+  }
+
+  SUBCASE("token_limit")
+  {
+    static constexpr std::size_t max_tokens{3U};
+    std::atomic<std::size_t>     in_flight{0U};
+    std::atomic<std::size_t>     max_in_flight{0U};
+
+    pl::thd::make_pipeline([&](pl::thd::flow_control& fc) {
+      if (next == item_count) {
+        fc.stop();
+      }
+
+      const std::size_t current{++in_flight};
+      std::size_t       prev{max_in_flight.load()};
+
+      while ((prev < current)
+             && !max_in_flight.compare_exchange_weak(prev, current)) {
+      }
+
+      return next++;
+    })
+      .add_stage(pl::thd::filter_mode::parallel, [](int i) { return i; })
+      .add_stage(
+        pl::thd::filter_mode::serial_in_order,
+        [&in_flight](int) { --in_flight; })
+      .run(pool, max_tokens);
+
+    CHECK(max_in_flight.load() <= max_tokens + 1U);
+    CHECK(next == item_count + 1);
+  }
+
+  SUBCASE("exception")
+  {
+    std::atomic<int> count{0};
+
+    CHECK_THROWS_AS(
+      pl::thd::make_pipeline(source)
+        .add_stage(
+          pl::thd::filter_mode::parallel,
+          [](int i) {
+            if (i == 10) {
+              throw std::runtime_error{"error"};
+            }
+
+            return i;
+          })
+        .add_stage(
+          pl::thd::filter_mode::serial_in_order, [&count](int) { ++count; })
+        .run(pool, 4U),
+      std::runtime_error);
+
+    CHECK(count.load() < item_count);
+  }
+
+  SUBCASE("stateful_stages")
+  {
+    int calls{0};
+    int sum{0};
+
+    // a serial stage may keep state in its callable.
+    pl::thd::make_pipeline(source)
+      .add_stage(
+        pl::thd::filter_mode::serial_in_order,
+        [call = 0](int i) mutable { return i - call++; })
+      .add_stage(
+        pl::thd::filter_mode::serial_out_of_order,
+        [&calls, &sum](int i) {
+          ++calls;
+          sum += i;
+        })
+      .run(pool, 4U);
+
+    CHECK(calls == item_count);
+    CHECK(sum == 0);
+
+    // a parallel stage is invoked concurrently, it must be const callable.
+    CHECK_THROWS_AS(
+      (void)pl::thd::make_pipeline(source).add_stage(
+        pl::thd::filter_mode::parallel, [call = 0](int i) mutable {
+          return i + call++;
+        }),
+      pl::precondition_violation_exception);
+  }
+
+  SUBCASE("source_only")
+  {
+    pl::thd::make_pipeline(source).run(pool, 2U);
+    CHECK(next == item_count + 1);
+  }
+}
@@ -0,0 +1,240 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/monitor.hpp" // pl::thd::monitor
+#include "../../../include/pl/thd/profiled_mutex.hpp" // pl::thd::profiled_mutex
+#include "../../../include/pl/thd/thread_pool.hpp" // pl::thd::basic_thread_pool
+#include "../../../include/pl/thd/thread_safe_queue.hpp" // pl::thd::thread_safe_queue
+#include <algorithm> // std::find_if
+#include <array>     // std::array
+#include <atomic>    // std::atomic
+#include <chrono>    // std::chrono::milliseconds
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uint64_t
+#include <future>    // std::future
+#include <mutex>     // std::lock_guard
+#include <numeric>   // std::accumulate
+#include <sstream>   // std::ostringstream
+#include <string>    // std::string
+#include <thread>    // std::thread
+#include <vector>    // std::vector
+
+namespace {
+std::uint64_t sum(
+  const std::array<std::uint64_t, pl::thd::lock_histogram_buckets>& histogram)
+{
+  return std::accumulate(histogram.begin(), histogram.end(), std::uint64_t{0U});
+}
+
+const pl::thd::lock_profile* find_profile(
+  const std::vector<pl::thd::lock_profile>& profiles,
+  const std::string&                        name)
+{
+  const auto it = std::find_if(
+    profiles.begin(), profiles.end(), [&name](const pl::thd::lock_profile& p) {
+      return p.name == name;
+    });
+  return it == profiles.end() ? nullptr : &*it;
+}
+} // anonymous namespace
+
+TEST_CASE("profiled_mutex_test")
+{
+  pl::thd::clear_destroyed_lock_profiles();
+
+  SUBCASE("disabled")
+  {
+    pl::thd::enable_lock_profiling(false);
+    CHECK_UNARY_FALSE(pl::thd::is_lock_profiling_enabled());
+    pl::thd::profiled_mutex mutex{"disabled"};
+
+    for (int i{0}; i < 10; ++i) {
+      std::lock_guard<pl::thd::profiled_mutex> lock{mutex};
+      (void)lock;
+    }
+
+    CHECK(mutex.profile().acquisitions == 0U);
+    CHECK(mutex.profile().total_hold.count() == 0);
+  }
+
+  SUBCASE("enabled")
+  {
+    pl::thd::enable_lock_profiling();
+    CHECK_UNARY(pl::thd::is_lock_profiling_enabled());
+    pl::thd::profiled_mutex mutex{"enabled"};
+
+    for (int i{0}; i < 10; ++i) {
+      std::lock_guard<pl::thd::profiled_mutex> lock{mutex};
+      (void)lock;
+    }
+
+    REQUIRE_UNARY(mutex.try_lock());
+    mutex.unlock();
+
+    const pl::thd::lock_profile profile{mutex.profile()};
+    CHECK(profile.name == "enabled");
+    CHECK(profile.acquisitions == 11U);
+    CHECK(profile.contended_acquisitions == 0U);
+    CHECK(sum(profile.wait_histogram) == 11U);
+    CHECK(sum(profile.hold_histogram) == 11U);
+    CHECK(profile.wait_histogram[0] == 11U);
+    pl::thd::enable_lock_profiling(false);
+  }
+
+  SUBCASE("contended")
+  {
+    pl::thd::enable_lock_profiling();
+    pl::thd::profiled_mutex mutex{"contended"};
+    std::uint64_t           attempts{0U};
+
+    // the statistics are only recorded once the mutex has been acquired,
+    // so the other thread signals before it locks and the attempt is
+    // repeated until it actually had to wait.
+    while ((mutex.profile().contended_acquisitions == 0U)
+           && (attempts < 1000U)) {
+      ++attempts;
+      std::atomic<bool> is_locking{false};
+      mutex.lock();
+
+      std::thread thread{[&mutex, &is_locking] {
+        is_locking = true;
+        std::lock_guard<pl::thd::profiled_mutex> lock{mutex};
+        (void)lock;
+      }};
+
+      while (!is_locking.load()) {
+        std::this_thread::yield();
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      mutex.unlock();
+      thread.join();
+    }
+
+    pl::thd::enable_lock_profiling(false);
+
+    const pl::thd::lock_profile profile{mutex.profile()};
+    CHECK(profile.acquisitions == 2U * attempts);
+    CHECK(profile.contended_acquisitions == 1U);
+    CHECK(profile.total_wait.count() > 0);
+    CHECK(profile.total_hold.count() > 0);
+  }
+
+  SUBCASE("injected")
+  {
+    pl::thd::enable_lock_profiling();
+
+    {
+      pl::thd::basic_thread_pool<pl::thd::profiled_mutex> pool{2U};
+      pl::thd::thread_safe_queue<int, pl::thd::profiled_mutex> queue{};
+      pl::thd::monitor<int, pl::thd::profiled_mutex>           monitor{0};
+      monitor.name_mutex("counter");
+
+      std::vector<std::future<void>> futures{};
+
+      for (int i{0}; i < 100; ++i) {
+        futures.push_back(pool.add_task([&queue, &monitor, i] {
+          queue.push(i);
+          monitor([](int& value) { ++value; });
+        }));
+      }
+
+      for (std::future<void>& future : futures) {
+        future.get();
+      }
+
+      CHECK(queue.size() == 100U);
+      CHECK(monitor([](int value) { return value; }) == 100);
+    }
+
+    pl::thd::enable_lock_profiling(false);
+    const std::vector<pl::thd::lock_profile> profiles{
+      pl::thd::lock_profiles()};
+
+    const pl::thd::lock_profile* const pool{
+      find_profile(profiles, "pl::thd::thread_pool")};
+    const pl::thd::lock_profile* const queue{
+      find_profile(profiles, "pl::thd::thread_safe_queue")};
+    const pl::thd::lock_profile* const monitor{
+      find_profile(profiles, "counter")};
+    REQUIRE(pool != nullptr);
+    REQUIRE(queue != nullptr);
+    REQUIRE(monitor != nullptr);
+    CHECK(pool->acquisitions >= 100U);
+    CHECK(queue->acquisitions == 101U);
+    CHECK(monitor->acquisitions == 101U);
+
+    for (std::size_t i{1U}; i < profiles.size(); ++i) {
+      CHECK(profiles[i - 1U].total_wait >= profiles[i].total_wait);
+    }
+
+    std::ostringstream oss{};
+    pl::thd::write_lock_report(oss);
+    CHECK(oss.str().find("counter,101,") != std::string::npos);
+  }
+
+  SUBCASE("destroyed_merged_by_name")
+  {
+    pl::thd::enable_lock_profiling();
+    const auto lock_named = [](const char* name) {
+      pl::thd::profiled_mutex                  mutex{name};
+      std::lock_guard<pl::thd::profiled_mutex> lock{mutex};
+      (void)lock;
+    };
+
+    lock_named("short_lived");
+    lock_named("other");
+    const std::size_t size{pl::thd::lock_profiles().size()};
+
+    for (int i{0}; i < 1000; ++i) {
+      lock_named("short_lived");
+      lock_named("other");
+    }
+
+    pl::thd::enable_lock_profiling(false);
+    const std::vector<pl::thd::lock_profile> profiles{
+      pl::thd::lock_profiles()};
+    CHECK(profiles.size() == size);
+
+    const pl::thd::lock_profile* const profile{
+      find_profile(profiles, "short_lived")};
+    REQUIRE(profile != nullptr);
+    CHECK(profile->acquisitions == 1001U);
+    CHECK(sum(profile->wait_histogram) == 1001U);
+    CHECK(sum(profile->hold_histogram) == 1001U);
+  }
+
+  pl::thd::clear_destroyed_lock_profiles();
+}
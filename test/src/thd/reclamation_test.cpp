@@ -0,0 +1,248 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/reclamation.hpp" // pl::thd::epoch_guard, pl::thd::hazard_pointer
+#include <atomic>                                  // std::atomic
+#include <cstddef>                                 // std::size_t
+#include <thread>                                  // std::thread
+#include <vector>                                  // std::vector
+
+namespace pl {
+namespace test {
+namespace {
+class tracked {
+public:
+  static constexpr int alive_magic{0x5AFE};
+
+  explicit tracked(PL_INOUT std::atomic<int>& destroyed)
+    : m_magic{alive_magic}, m_destroyed{destroyed}
+  {
+  }
+
+  tracked(const tracked&) = delete;
+
+  tracked& operator=(const tracked&) = delete;
+
+  ~tracked()
+  {
+    m_magic = 0;
+    ++m_destroyed;
+  }
+
+  int magic() const noexcept
+  {
+    return m_magic;
+  }
+
+private:
+  int               m_magic;
+  std::atomic<int>& m_destroyed;
+};
+
+template<typename Callable>
+void run_on_thread(Callable callable)
+{
+  std::thread thread{callable};
+  thread.join();
+}
+} // anonymous namespace
+} // namespace test
+} // namespace pl
+
+TEST_CASE("reclamation_test")
+{
+  std::atomic<int> destroyed{0};
+
+  SUBCASE("epoch_collect")
+  {
+    for (int i{0}; i < 10; ++i) {
+      pl::thd::epoch_retire(new pl::test::tracked{destroyed});
+    }
+
+    for (int i{0}; i < 3; ++i) {
+      pl::thd::epoch_collect();
+    }
+
+    CHECK(destroyed.load() == 10);
+  }
+
+  SUBCASE("epoch_guard_delays_reclamation")
+  {
+    std::atomic<bool> pinned{false};
+    std::atomic<bool> done{false};
+    std::thread       reader{[&pinned, &done] {
+      pl::thd::epoch_guard guard{};
+      pinned = true;
+
+      while (!done) {
+        std::this_thread::yield();
+      }
+    }};
+
+    while (!pinned) {
+      std::this_thread::yield();
+    }
+
+    pl::thd::epoch_retire(new pl::test::tracked{destroyed});
+
+    for (int i{0}; i < 3; ++i) {
+      pl::thd::epoch_collect();
+    }
+
+    CHECK(destroyed.load() == 0);
+    done = true;
+    reader.join();
+
+    for (int i{0}; i < 3; ++i) {
+      pl::thd::epoch_collect();
+    }
+
+    CHECK(destroyed.load() == 1);
+  }
+
+  SUBCASE("epoch_nested_guards")
+  {
+    {
+      pl::thd::epoch_guard outer{};
+      {
+        pl::thd::epoch_guard inner{};
+      }
+
+      // still pinned by outer, another thread can't reclaim.
+      pl::test::run_on_thread([&destroyed] {
+        pl::thd::epoch_retire(new pl::test::tracked{destroyed});
+
+        for (int i{0}; i < 3; ++i) {
+          pl::thd::epoch_collect();
+        }
+      });
+
+      CHECK(destroyed.load() == 0);
+    }
+
+    // the retired object was handed over when the thread exited.
+    for (int i{0}; i < 3; ++i) {
+      pl::thd::epoch_collect();
+    }
+
+    CHECK(destroyed.load() == 1);
+  }
+
+  SUBCASE("hazard_pointer_protects")
+  {
+    std::atomic<pl::test::tracked*> shared{new pl::test::tracked{destroyed}};
+
+    {
+      pl::thd::hazard_pointer hp{};
+      pl::test::tracked*      p{hp.protect(shared)};
+      REQUIRE(p != nullptr);
+
+      pl::test::run_on_thread([&shared] {
+        pl::thd::hazard_retire(shared.exchange(nullptr));
+        pl::thd::hazard_collect();
+      });
+
+      CHECK(destroyed.load() == 0);
+      CHECK(p->magic() == pl::test::tracked::alive_magic);
+      hp.reset();
+    }
+
+    // the retired object was handed over when the thread exited.
+    pl::thd::hazard_collect();
+    CHECK(destroyed.load() == 1);
+  }
+
+  SUBCASE("concurrent")
+  {
+    static constexpr int iterations{20000};
+
+    std::atomic<pl::test::tracked*> epoch_shared{
+      new pl::test::tracked{destroyed}};
+    std::atomic<pl::test::tracked*> hazard_shared{
+      new pl::test::tracked{destroyed}};
+    std::atomic<bool>        done{false};
+    std::atomic<int>         corrupted{0};
+    std::vector<std::thread> readers{};
+
+    for (int t{0}; t < 2; ++t) {
+      readers.emplace_back([&] {
+        pl::thd::hazard_pointer hp{};
+
+        while (!done) {
+          {
+            pl::thd::epoch_guard     guard{};
+            const pl::test::tracked* p{epoch_shared.load()};
+
+            if (p->magic() != pl::test::tracked::alive_magic) {
+              ++corrupted;
+            }
+          }
+
+          const pl::test::tracked* p{hp.protect(hazard_shared)};
+
+          if (p->magic() != pl::test::tracked::alive_magic) {
+            ++corrupted;
+          }
+
+          hp.reset();
+        }
+      });
+    }
+
+    for (int i{0}; i < iterations; ++i) {
+      pl::thd::epoch_retire(
+        epoch_shared.exchange(new pl::test::tracked{destroyed}));
+      pl::thd::hazard_retire(
+        hazard_shared.exchange(new pl::test::tracked{destroyed}));
+    }
+
+    done = true;
+
+    for (std::thread& reader : readers) {
+      reader.join();
+    }
+
+    CHECK(corrupted.load() == 0);
+
+    for (int i{0}; i < 3; ++i) {
+      pl::thd::epoch_collect();
+    }
+
+    pl::thd::hazard_collect();
+    CHECK(destroyed.load() == 2 * iterations);
+    delete epoch_shared.load();
+    delete hazard_shared.load();
+  }
+}
@@ -0,0 +1,95 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/sharded_counter.hpp" // pl::thd::sharded_counter
+#include <cstddef>                                     // std::size_t
+#include <cstdint>                                     // std::uintptr_t
+#include <thread>                                      // std::thread
+#include <vector>                                      // std::vector
+
+TEST_CASE("sharded_counter_test")
+{
+  SUBCASE("shard_count")
+  {
+    CHECK(pl::thd::sharded_counter{3U}.shard_count() == 4U);
+    CHECK(pl::thd::sharded_counter{0U}.shard_count() == 1U);
+    CHECK(pl::thd::sharded_counter{}.shard_count() >= 1U);
+  }
+
+  SUBCASE("layout")
+  {
+    // every shard occupies cache lines of its own.
+    CHECK(
+      sizeof(pl::cache_aligned<std::atomic<std::int64_t>>)
+      == pl::hardware_destructive_interference_size);
+  }
+
+  SUBCASE("single_thread")
+  {
+    pl::thd::sharded_counter counter{4U};
+    CHECK(counter.load() == 0);
+    counter.increment();
+    counter.add(10);
+    counter.decrement();
+    CHECK(counter.load() == 10);
+    counter.add(-20);
+    CHECK(counter.load() == -10);
+    counter.reset();
+    CHECK(counter.load() == 0);
+  }
+
+  SUBCASE("multiple_threads")
+  {
+    static constexpr int thread_count{8};
+    static constexpr int iterations{100000};
+
+    pl::thd::sharded_counter counter{4U};
+    std::vector<std::thread> threads{};
+
+    for (int i{0}; i < thread_count; ++i) {
+      threads.emplace_back([&counter] {
+        for (int j{0}; j < iterations; ++j) {
+          counter.increment();
+        }
+      });
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    CHECK(counter.load() == thread_count * iterations);
+  }
+}
@@ -0,0 +1,145 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/spsc_queue.hpp" // pl::thd::spsc_queue
+#include <array>                                  // std::array
+#include <cstddef>                                // std::size_t
+#include <cstdint>                                // std::uintptr_t
+#include <future>   // std::future, std::async, std::launch::async
+#include <iterator> // std::back_inserter
+#include <memory>   // std::unique_ptr, std::make_unique
+#include <string>   // std::string
+#include <vector>   // std::vector
+
+TEST_CASE("spsc_queue_test")
+{
+  SUBCASE("capacity")
+  {
+    CHECK(pl::thd::spsc_queue<int>{1U}.capacity() == 1U);
+    CHECK(pl::thd::spsc_queue<int>{5U}.capacity() == 8U);
+    CHECK(pl::thd::spsc_queue<int>{16U}.capacity() == 16U);
+  }
+
+  SUBCASE("layout")
+  {
+    pl::thd::spsc_queue<int> q{4U};
+    CHECK(reinterpret_cast<std::uintptr_t>(&q) % 64U == 0U);
+    CHECK(sizeof(q) % 64U == 0U);
+    CHECK(sizeof(q) >= 3U * 64U);
+  }
+
+  SUBCASE("try_push_and_try_pop")
+  {
+    pl::thd::spsc_queue<std::string> q{2U};
+    CHECK_UNARY(q.empty());
+
+    CHECK_UNARY(q.try_push("one"));
+    CHECK_UNARY(q.try_emplace(3U, 'a'));
+    CHECK_UNARY_FALSE(q.try_push("three"));
+    CHECK(q.size() == 2U);
+
+    std::string s{};
+    CHECK_UNARY(q.try_pop(s));
+    CHECK(s == "one");
+    CHECK_UNARY(q.try_push("three"));
+    CHECK_UNARY(q.try_pop(s));
+    CHECK(s == "aaa");
+    CHECK_UNARY(q.try_pop(s));
+    CHECK(s == "three");
+    CHECK_UNARY_FALSE(q.try_pop(s));
+    CHECK_UNARY(q.empty());
+  }
+
+  SUBCASE("bulk")
+  {
+    pl::thd::spsc_queue<int>  q{4U};
+    const std::array<int, 6U> a{{1, 2, 3, 4, 5, 6}};
+
+    CHECK(q.try_push_bulk(a.data(), a.size()) == 4U);
+    CHECK(q.try_push_bulk(a.data(), a.size()) == 0U);
+
+    std::vector<int> v{};
+    CHECK(q.try_pop_bulk(std::back_inserter(v), 3U) == 3U);
+    CHECK(v == std::vector<int>{1, 2, 3});
+    CHECK(q.try_push_bulk(a.data() + 4, 2U) == 2U);
+    CHECK(q.try_pop_bulk(std::back_inserter(v), 10U) == 3U);
+    CHECK(v == std::vector<int>{1, 2, 3, 4, 5, 6});
+    CHECK_UNARY(q.empty());
+  }
+
+  SUBCASE("destroys_remaining_elements")
+  {
+    std::shared_ptr<int> p{std::make_shared<int>(1)};
+    {
+      pl::thd::spsc_queue<std::shared_ptr<int>> q{4U};
+      q.try_push(p);
+      q.try_push(p);
+      CHECK(p.use_count() == 3);
+    }
+    CHECK(p.use_count() == 1);
+  }
+
+  SUBCASE("blocking")
+  {
+    static constexpr int           count{100000};
+    pl::thd::spsc_queue<int, true> q{16U};
+
+    std::future<long long> consumer{std::async(std::launch::async, [&q] {
+      long long sum{0};
+
+      for (int i{0}; i < count; ++i) {
+        sum += q.pop();
+      }
+
+      return sum;
+    })};
+
+    for (int i{0}; i < count; ++i) {
+      q.push(i);
+    }
+
+    CHECK(consumer.get() == (static_cast<long long>(count) * (count - 1)) / 2);
+    CHECK_UNARY(q.empty());
+  }
+
+  SUBCASE("move_only")
+  {
+    pl::thd::spsc_queue<std::unique_ptr<int>, true> q{2U};
+    q.push(std::make_unique<int>(7));
+    const std::unique_ptr<int> p{q.pop()};
+    REQUIRE(p != nullptr);
+    CHECK(*p == 7);
+  }
+}
@@ -0,0 +1,155 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/strand.hpp"      // pl::thd::strand
+#include "../../../include/pl/thd/thread_pool.hpp" // pl::thd::thread_pool
+#include <atomic>                                  // std::atomic
+#include <cstddef>                                 // std::size_t
+#include <future>                                  // std::future, std::promise
+#include <memory> // std::unique_ptr, std::make_unique
+#include <stdexcept>                               // std::runtime_error
+#include <thread>                                  // std::this_thread::yield
+#include <vector>                                  // std::vector
+
+TEST_CASE("strand_test")
+{
+  pl::thd::thread_pool pool{4U};
+
+  SUBCASE("order")
+  {
+    std::vector<int> v{};
+    {
+      pl::thd::strand strand{pool};
+
+      for (int i{0}; i < 1000; ++i) {
+        strand.post([&v, i] { v.push_back(i); });
+      }
+    } // waits for the tasks.
+
+    REQUIRE(v.size() == 1000U);
+
+    for (std::size_t i{0U}; i < v.size(); ++i) {
+      CHECK(v[i] == static_cast<int>(i));
+    }
+  }
+
+  SUBCASE("serialized")
+  {
+    static constexpr std::size_t strand_count{100U};
+    std::atomic<int>             violations{0};
+    std::vector<int>             in_flight(strand_count, 0);
+    std::vector<int>             counters(strand_count, 0);
+    {
+      std::vector<std::unique_ptr<pl::thd::strand>> strands{};
+
+      for (std::size_t i{0U}; i < strand_count; ++i) {
+        strands.push_back(std::make_unique<pl::thd::strand>(pool));
+      }
+
+      for (int round{0}; round < 100; ++round) {
+        for (std::size_t i{0U}; i < strand_count; ++i) {
+          strands[i]->post([&, i] {
+            if (++in_flight[i] != 1) {
+              ++violations;
+            }
+
+            ++counters[i];
+            --in_flight[i];
+          });
+        }
+      }
+    }
+
+    CHECK(violations.load() == 0);
+
+    for (int counter : counters) {
+      CHECK(counter == 100);
+    }
+  }
+
+  SUBCASE("exceptions_are_discarded")
+  {
+    int i{0};
+    {
+      pl::thd::strand strand{pool};
+      strand.post([] { throw std::runtime_error{"error"}; });
+      strand.post([&i] { i = 1; });
+    }
+    CHECK(i == 1);
+  }
+
+  SUBCASE("move_only")
+  {
+    int i{0};
+    {
+      pl::thd::strand strand{pool};
+      strand.post([&i, p = std::make_unique<int>(5)] { i = *p; });
+    }
+    CHECK(i == 5);
+  }
+
+  SUBCASE("full_queue")
+  {
+    for (const pl::thd::overflow_policy policy :
+         {pl::thd::overflow_policy::block,
+          pl::thd::overflow_policy::reject,
+          pl::thd::overflow_policy::caller_runs,
+          pl::thd::overflow_policy::drop_lowest_priority}) {
+      pl::thd::thread_pool     small_pool{1U, 1U, policy};
+      std::promise<void>       promise{};
+      std::shared_future<void> gate{promise.get_future().share()};
+      std::future<void>        blocker{
+        small_pool.add_task([gate] { gate.wait(); })};
+
+      while (small_pool.tasks_waiting_for_execution() != 0U) {
+        std::this_thread::yield();
+      }
+
+      std::future<void> filler{small_pool.add_task([] {})}; // fills the queue
+      int               count{0};
+      {
+        pl::thd::strand strand{small_pool};
+
+        for (int i{0}; i < 100; ++i) {
+          strand.post([&count] { ++count; });
+        }
+
+        promise.set_value();
+      } // waits for the tasks.
+
+      CHECK(count == 100);
+    }
+  }
+}
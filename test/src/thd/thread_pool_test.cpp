@@ -34,10 +34,15 @@
 #pragma GCC diagnostic pop
 #endif // PL_COMPILER == PL_COMPILER_GCC
 #include "../../../include/pl/thd/thread_pool.hpp" // pl::thd::thread_pool
+#include <chrono>                                  // std::chrono::milliseconds
 #include <cstddef>                                 // std::size_t
+#include <cstdint> // std::uint8_t, std::uint64_t
 #include <future>                                  // std::future
+#include <limits>                                  // std::numeric_limits
+#include <memory> // std::unique_ptr, std::make_unique
 #include <string>                                  // std::string
 #include <thread> // std::thread::hardware_concurrency
+#include <vector> // std::vector
 
 namespace pl {
 namespace test {
@@ -59,6 +64,31 @@ public:
   {
   }
 };
+class copy_counter {
+public:
+  explicit copy_counter(int* copies) noexcept : m_copies{copies}
+  {
+  }
+  copy_counter(const copy_counter& other) noexcept : m_copies{other.m_copies}
+  {
+    ++*m_copies;
+  }
+  copy_counter(copy_counter&&) noexcept = default;
+  copy_counter& operator=(const copy_counter& other) noexcept
+  {
+    m_copies = other.m_copies;
+    ++*m_copies;
+    return *this;
+  }
+  copy_counter& operator=(copy_counter&&) noexcept = default;
+  int operator()(const copy_counter&) const noexcept
+  {
+    return 1;
+  }
+
+private:
+  int* m_copies;
+};
 } // anonymous namespace
 } // namespace test
 } // namespace pl
@@ -76,6 +106,17 @@ TEST_CASE("thread_pool_test")
   pl::thd::thread_pool two_threads_thread_pool{two_threads};
   pl::thd::thread_pool hw_concurrency_thread_pool{hw_concurrency};
 
+  SUBCASE("layout_test")
+  {
+    // the members guarded by the mutex begin on a cache line of their own.
+    CHECK(
+      alignof(pl::thd::thread_pool)
+      == pl::hardware_destructive_interference_size);
+    CHECK(
+      sizeof(pl::thd::thread_pool) % pl::hardware_destructive_interference_size
+      == 0U);
+  }
+
   SUBCASE("thread_count_test")
   {
     CHECK(empty_thread_pool.thread_count() == no_threads);
@@ -104,4 +145,310 @@ TEST_CASE("thread_pool_test")
     CHECK(fut5.get() == "text test");
     fut6.wait();
   }
+
+  SUBCASE("priority_test")
+  {
+    pl::thd::thread_pool     tp{1U};
+    std::promise<void>       promise{};
+    std::shared_future<void> gate{promise.get_future().share()};
+    std::vector<int>         order{};
+
+    std::future<void> blocker{tp.add_task([gate] { gate.wait(); })};
+    std::future<void> fut1{
+      tp.add_task([&order] { order.push_back(1); })};
+    std::future<void> fut2{tp.add_task(
+      static_cast<std::uint8_t>(1U), [&order] { order.push_back(2); })};
+    std::future<void> fut3{
+      tp.add_task([&order] { order.push_back(3); })};
+
+    promise.set_value();
+    fut3.wait();
+    CHECK(order == std::vector<int>{2, 1, 3});
+  }
+
+  SUBCASE("unbounded_test")
+  {
+    CHECK(
+      empty_thread_pool.max_queue_depth()
+      == std::numeric_limits<std::size_t>::max());
+    CHECK(empty_thread_pool.policy() == pl::thd::overflow_policy::block);
+  }
+
+  SUBCASE("reject_test")
+  {
+    pl::thd::thread_pool tp{no_threads, 2U, pl::thd::overflow_policy::reject};
+
+    std::future<int> fut1{tp.add_task([] { return 1; })};
+    std::future<int> fut2{tp.add_task([] { return 2; })};
+    CHECK_THROWS_AS(
+      (void)tp.add_task([] { return 3; }), pl::thd::task_rejected_exception);
+    std::future<int> fut3{
+      tp.try_add_task(static_cast<std::uint8_t>(0U), [] { return 3; })};
+    CHECK_UNARY_FALSE(fut3.valid());
+    CHECK(tp.tasks_waiting_for_execution() == 2U);
+  }
+
+  SUBCASE("block_test")
+  {
+    pl::thd::thread_pool     tp{1U, 1U, pl::thd::overflow_policy::block};
+    std::promise<void>       promise{};
+    std::shared_future<void> gate{promise.get_future().share()};
+
+    std::future<void> blocker{tp.add_task([gate] { gate.wait(); })};
+
+    while (tp.tasks_waiting_for_execution() != 0U) {
+      std::this_thread::yield();
+    }
+
+    std::future<int> fut1{tp.add_task([] { return 1; })};
+    std::future<int> fut2{
+      tp.try_add_task(static_cast<std::uint8_t>(0U), [] { return 2; })};
+    CHECK_UNARY_FALSE(fut2.valid());
+
+    std::thread thd{[&promise] {
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+      promise.set_value();
+    }};
+    std::future<int> fut3{tp.add_task([] { return 3; })}; // blocks.
+    CHECK(fut1.get() == 1);
+    CHECK(fut3.get() == 3);
+    thd.join();
+  }
+
+  SUBCASE("caller_runs_test")
+  {
+    pl::thd::thread_pool tp{
+      no_threads, 1U, pl::thd::overflow_policy::caller_runs};
+
+    std::future<std::thread::id> fut1{
+      tp.add_task([] { return std::this_thread::get_id(); })};
+    std::future<std::thread::id> fut2{
+      tp.add_task([] { return std::this_thread::get_id(); })};
+
+    CHECK(
+      fut1.wait_for(std::chrono::seconds{0}) == std::future_status::timeout);
+    CHECK(fut2.get() == std::this_thread::get_id());
+    CHECK(tp.tasks_waiting_for_execution() == 1U);
+
+    std::future<std::thread::id> fut3{
+      tp.try_add_task(static_cast<std::uint8_t>(0U), [] {
+        return std::this_thread::get_id();
+      })};
+    CHECK_UNARY_FALSE(fut3.valid());
+  }
+
+  SUBCASE("force_add_task_test")
+  {
+    pl::thd::thread_pool tp{
+      no_threads, 1U, pl::thd::overflow_policy::drop_lowest_priority};
+
+    std::future<int> fut1{
+      tp.force_add_task(static_cast<std::uint8_t>(0U), [] { return 1; })};
+    std::future<int> fut2{
+      tp.force_add_task(static_cast<std::uint8_t>(0U), [] { return 2; })};
+    CHECK(tp.tasks_waiting_for_execution() == 2U);
+
+    // only the task added is a candidate for being dropped.
+    std::future<int> fut3{
+      tp.add_task(static_cast<std::uint8_t>(1U), [] { return 3; })};
+    CHECK_THROWS_AS(fut3.get(), std::future_error);
+    CHECK(tp.tasks_waiting_for_execution() == 2U);
+    CHECK(
+      fut1.wait_for(std::chrono::seconds{0}) == std::future_status::timeout);
+    CHECK(
+      fut2.wait_for(std::chrono::seconds{0}) == std::future_status::timeout);
+  }
+
+  SUBCASE("drop_lowest_priority_test")
+  {
+    pl::thd::thread_pool tp{
+      no_threads, 2U, pl::thd::overflow_policy::drop_lowest_priority};
+
+    std::future<int> fut1{tp.add_task([] { return 1; })};
+    std::future<int> fut2{tp.add_task([] { return 2; })};
+    std::future<int> fut3{
+      tp.add_task(static_cast<std::uint8_t>(1U), [] { return 3; })};
+    std::future<int> fut4{tp.add_task([] { return 4; })};
+
+    // fut1 was the oldest of the lowest priority, then fut2.
+    CHECK_THROWS_AS(fut1.get(), std::future_error);
+    CHECK_THROWS_AS(fut2.get(), std::future_error);
+    CHECK(tp.tasks_waiting_for_execution() == 2U);
+
+    std::future<int> fut5{
+      tp.add_task(static_cast<std::uint8_t>(2U), [] { return 5; })};
+    // lower than anything queued, the new task itself is dropped.
+    std::future<int> fut6{tp.add_task([] { return 6; })};
+    CHECK_THROWS_AS(fut6.get(), std::future_error);
+    CHECK_THROWS_AS(fut4.get(), std::future_error);
+    CHECK(tp.tasks_waiting_for_execution() == 2U);
+  }
+
+  SUBCASE("elastic_test")
+  {
+    pl::thd::thread_pool tp{
+      1U, 4U, std::chrono::milliseconds{0}, std::chrono::milliseconds{20}};
+    std::promise<void>            promise{};
+    std::shared_future<void>      gate{promise.get_future().share()};
+    std::vector<std::future<int>> futures{};
+
+    CHECK(tp.thread_count() == 1U);
+    CHECK(tp.min_thread_count() == 1U);
+    CHECK(tp.max_thread_count() == 4U);
+
+    for (int i{0}; i < 6; ++i) {
+      futures.push_back(tp.add_task([gate, i] {
+        gate.wait();
+        return i;
+      }));
+    }
+
+    CHECK(tp.thread_count() == 4U);
+    promise.set_value();
+
+    for (int i{0}; i < 6; ++i) {
+      CHECK(futures[static_cast<std::size_t>(i)].get() == i);
+    }
+
+    // the threads beyond the minimum retire once idle.
+    while (tp.thread_count() != 1U) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+
+    CHECK(tp.thread_count() == 1U);
+    CHECK(tp.add_task([] { return 7; }).get() == 7);
+  }
+
+  SUBCASE("elastic_threshold_test")
+  {
+    pl::thd::thread_pool tp{
+      1U, 2U, std::chrono::milliseconds{20}, std::chrono::hours{1}};
+    std::promise<void>       promise{};
+    std::shared_future<void> gate{promise.get_future().share()};
+
+    std::future<void> blocked{tp.add_task([gate] { gate.wait(); })};
+
+    while (tp.tasks_waiting_for_execution() != 0U) {
+      std::this_thread::yield();
+    }
+
+    // the only thread is busy and no more tasks are added after these,
+    // a thread is added once the oldest of them waited for 20ms.
+    std::future<int> low{
+      tp.add_task(static_cast<std::uint8_t>(0U), [] { return 1; })};
+    std::future<int> high{
+      tp.add_task(static_cast<std::uint8_t>(1U), [] { return 2; })};
+
+    CHECK(high.get() == 2);
+    CHECK(low.get() == 1);
+    CHECK(tp.thread_count() == 2U);
+    promise.set_value();
+    blocked.get();
+  }
+
+  SUBCASE("elastic_queued_behind_test")
+  {
+    pl::thd::thread_pool tp{
+      1U, 2U, std::chrono::milliseconds{20}, std::chrono::hours{1}};
+    std::promise<void>       promise{};
+    std::shared_future<void> gate{promise.get_future().share()};
+
+    // the idle thread takes the first task and blocks, the second one was
+    // queued behind it and still gets a thread once it waited for 20ms.
+    std::future<void> blocked{tp.add_task([gate] { gate.wait(); })};
+    std::future<int>  queued{tp.add_task([] { return 1; })};
+
+    CHECK(queued.get() == 1);
+    CHECK(tp.thread_count() == 2U);
+    promise.set_value();
+    blocked.get();
+  }
+
+  SUBCASE("blocking_scope_test")
+  {
+    pl::thd::thread_pool tp{
+      1U, 2U, std::chrono::hours{1}, std::chrono::hours{1}};
+    std::promise<void>       promise{};
+    std::shared_future<void> gate{promise.get_future().share()};
+
+    std::future<void> blocked{tp.add_task([&tp, gate] {
+      pl::thd::thread_pool::blocking_scope scope{tp};
+      gate.wait();
+    })};
+
+    while (tp.tasks_waiting_for_execution() != 0U) {
+      std::this_thread::yield();
+    }
+
+    // the only thread is blocked, so another one is created for this.
+    CHECK(tp.add_task([] { return 1; }).get() == 1);
+    CHECK(tp.thread_count() == 2U);
+    promise.set_value();
+    blocked.get();
+  }
+
+  SUBCASE("metrics_test")
+  {
+    pl::thd::thread_pool tp{1U};
+    constexpr std::uint64_t one_millisecond_ns{1000000U};
+
+    CHECK(tp.metrics().run_time.total_count() == 0U);
+    tp.enable_metrics();
+
+    for (int i{0}; i < 10; ++i) {
+      tp.add_task([] {
+          std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        })
+        .get();
+    }
+
+    // the run time is recorded after the promise of the task is set.
+    while (tp.metrics().run_time.total_count() != 10U) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    const pl::thd::thread_pool_metrics metrics{tp.metrics()};
+    CHECK(metrics.queue_wait.total_count() == 10U);
+    CHECK(metrics.run_time.min() >= one_millisecond_ns);
+    CHECK(
+      metrics.run_time.value_at_percentile(99.9) <= metrics.run_time.max());
+
+    // with a single thread the second task runs after the first is done.
+    tp.enable_metrics(false);
+    tp.add_task([] {}).get();
+    tp.add_task([] {}).get();
+    CHECK(tp.metrics().run_time.total_count() == 10U);
+
+    tp.reset_metrics();
+    CHECK(tp.metrics().run_time.total_count() == 0U);
+    CHECK(tp.metrics().queue_wait.total_count() == 0U);
+  }
+
+  SUBCASE("move_only_test")
+  {
+    std::future<int> fut{two_threads_thread_pool.add_task(
+      [p = std::make_unique<int>(5)](std::unique_ptr<int> q) {
+        return *p + *q;
+      },
+      std::make_unique<int>(2))};
+    CHECK(fut.get() == 7);
+
+    std::future<std::unique_ptr<int>> fut2{
+      two_threads_thread_pool.try_add_task(
+        static_cast<std::uint8_t>(1U),
+        [](std::unique_ptr<int> q) { return q; },
+        std::make_unique<int>(3))};
+    CHECK(*fut2.get() == 3);
+  }
+
+  SUBCASE("copy_count_test")
+  {
+    int                    copies{0};
+    pl::test::copy_counter task{&copies};
+    pl::test::copy_counter arg{&copies};
+    std::future<int>       fut{
+      two_threads_thread_pool.add_task(std::move(task), std::move(arg))};
+    CHECK(fut.get() == 1);
+    CHECK(copies == 0);
+  }
 }
@@ -34,7 +34,10 @@
 #pragma GCC diagnostic pop
 #endif // PL_COMPILER == PL_COMPILER_GCC
 #include "../../../include/pl/thd/thread_safe_queue.hpp" // pl::thd::thread_safe_queue
-#include <future> // std::future, std::async, std::launch::async
+#include <cstddef> // std::size_t
+#include <future>  // std::future, std::async, std::launch::async
+#include <memory>  // std::unique_ptr, std::make_unique
+#include <string>  // std::string
 
 TEST_CASE("thread_safe_queue_test")
 {
@@ -91,4 +94,21 @@ TEST_CASE("thread_safe_queue_test")
     CHECK_UNARY(q.empty());
     CHECK(q.size() == 0U);
   }
+
+  SUBCASE("move_only")
+  {
+    pl::thd::thread_safe_queue<std::unique_ptr<int>> queue{};
+    queue.push(std::make_unique<int>(1)).emplace(std::make_unique<int>(2));
+
+    CHECK(*queue.pop() == 1);
+    CHECK(*queue.pop() == 2);
+    CHECK_UNARY(queue.empty());
+  }
+
+  SUBCASE("emplace")
+  {
+    pl::thd::thread_safe_queue<std::string> queue{};
+    queue.emplace(std::size_t{3U}, 'a');
+    CHECK(queue.pop() == "aaa");
+  }
 }
@@ -0,0 +1,209 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/thread_pool.hpp" // pl::thd::thread_pool
+#include "../../../include/pl/thd/timer_wheel.hpp" // pl::thd::timer_wheel
+#include "../../../include/pl/timer.hpp"           // pl::timer
+#include <atomic>                                  // std::atomic
+#include <chrono> // std::literals::chrono_literals::operator""ms
+#include <future> // std::promise, std::future
+#include <memory> // std::make_unique
+#include <thread> // std::this_thread::sleep_for
+
+TEST_CASE("timer_wheel_test")
+{
+  using namespace std::literals::chrono_literals;
+
+  pl::thd::thread_pool pool{2U};
+  pl::thd::timer_wheel wheel{pool};
+
+  CHECK(wheel.tick_duration() == std::chrono::milliseconds{1});
+  CHECK(wheel.timers_pending() == 0U);
+
+  SUBCASE("schedule_after")
+  {
+    std::promise<void> promise{};
+    std::future<void>  future{promise.get_future()};
+    const pl::timer    timer{};
+
+    wheel.schedule_after(50ms, [&promise] { promise.set_value(); });
+
+    CHECK(future.wait_for(5s) == std::future_status::ready);
+    CHECK(timer.elapsed_time() >= 50ms);
+    CHECK(wheel.timers_pending() == 0U);
+  }
+
+  SUBCASE("move_only")
+  {
+    std::promise<int> promise{};
+    std::future<int>  future{promise.get_future()};
+
+    wheel.schedule_after(
+      1ms, [p = std::move(promise), v = std::make_unique<int>(3)]() mutable {
+        p.set_value(*v);
+      });
+
+    REQUIRE(future.wait_for(5s) == std::future_status::ready);
+    CHECK(future.get() == 3);
+  }
+
+  SUBCASE("order")
+  {
+    std::atomic<int>  first{0};
+    std::promise<int> promise{};
+    std::future<int>  future{promise.get_future()};
+
+    wheel.schedule_after(
+      400ms, [&promise, &first] { promise.set_value(first.load()); });
+    wheel.schedule_after(10ms, [&first] { first = 1; });
+
+    REQUIRE(future.wait_for(5s) == std::future_status::ready);
+    CHECK(future.get() == 1);
+  }
+
+  SUBCASE("cancel")
+  {
+    std::atomic<bool> has_run{false};
+    const pl::thd::timer_wheel::timer_id id{
+      wheel.schedule_after(50ms, [&has_run] { has_run = true; })};
+
+    CHECK(id != pl::thd::timer_wheel::timer_id{});
+    CHECK(wheel.timers_pending() == 1U);
+    CHECK_UNARY(wheel.cancel(id));
+    CHECK_UNARY_FALSE(wheel.cancel(id));
+    CHECK(wheel.timers_pending() == 0U);
+
+    std::this_thread::sleep_for(100ms);
+    CHECK_UNARY_FALSE(has_run.load());
+  }
+
+  SUBCASE("schedule_after_max")
+  {
+    std::atomic<bool> has_run{false};
+    const pl::thd::timer_wheel::timer_id id{wheel.schedule_after(
+      pl::thd::timer_wheel::duration::max(),
+      [&has_run] { has_run = true; })};
+
+    // doesn't overflow into a timer that is due right away.
+    std::this_thread::sleep_for(50ms);
+    CHECK_UNARY_FALSE(has_run.load());
+    CHECK(wheel.timers_pending() == 1U);
+    CHECK_UNARY(wheel.cancel(id));
+    CHECK(wheel.timers_pending() == 0U);
+  }
+
+  SUBCASE("schedule_every")
+  {
+    std::atomic<int>   count{0};
+    std::promise<void> promise{};
+    std::future<void>  future{promise.get_future()};
+
+    const pl::thd::timer_wheel::timer_id id{
+      wheel.schedule_every(5ms, [&count, &promise] {
+        if (++count == 3) {
+          promise.set_value();
+        }
+      })};
+
+    REQUIRE(future.wait_for(5s) == std::future_status::ready);
+    CHECK_UNARY(wheel.cancel(id));
+    CHECK(wheel.timers_pending() == 0U);
+    const int final_count{count.load()};
+    std::this_thread::sleep_for(50ms);
+    CHECK(count.load() == final_count);
+  }
+
+  SUBCASE("schedule_every_slow_task")
+  {
+    std::atomic<int> runs{0};
+    std::atomic<int> running{0};
+    std::atomic<int> max_running{0};
+
+    // each run takes far longer than the period, so that the firings due
+    // while it runs are skipped rather than run on another thread.
+    const pl::thd::timer_wheel::timer_id id{
+      wheel.schedule_every(2ms, [&runs, &running, &max_running] {
+        const int current{++running};
+        int       prev{max_running.load()};
+
+        while ((prev < current)
+               && !max_running.compare_exchange_weak(prev, current)) {
+        }
+
+        std::this_thread::sleep_for(20ms);
+        --running;
+        ++runs;
+      })};
+
+    std::this_thread::sleep_for(150ms);
+    CHECK_UNARY(wheel.cancel(id));
+    std::this_thread::sleep_for(50ms); // let the last run finish.
+    CHECK(runs.load() >= 2);
+    CHECK(max_running.load() == 1);
+  }
+
+  SUBCASE("cascade")
+  {
+    // with a tick duration of 1us 100ms are beyond the two lowest levels.
+    pl::thd::timer_wheel fine_wheel{pool, 1us};
+    std::promise<void>   promise{};
+    std::future<void>    future{promise.get_future()};
+    const pl::timer      timer{};
+
+    fine_wheel.schedule_after(100ms, [&promise] { promise.set_value(); });
+
+    REQUIRE(future.wait_for(5s) == std::future_status::ready);
+    CHECK(timer.elapsed_time() >= 100ms);
+  }
+
+  SUBCASE("many_timers")
+  {
+    static constexpr int timer_count{10000};
+    std::atomic<int>     count{0};
+    std::promise<void>   promise{};
+    std::future<void>    future{promise.get_future()};
+
+    for (int i{0}; i < timer_count; ++i) {
+      wheel.schedule_after(std::chrono::milliseconds{i % 600}, [&] {
+        if (++count == timer_count) {
+          promise.set_value();
+        }
+      });
+    }
+
+    REQUIRE(future.wait_for(10s) == std::future_status::ready);
+    CHECK(wheel.timers_pending() == 0U);
+  }
+}
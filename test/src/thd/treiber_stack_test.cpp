@@ -0,0 +1,263 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../../include/pl/thd/treiber_stack.hpp" // pl::thd::treiber_stack
+#include <atomic>                                    // std::atomic
+#include <cstddef>                                   // std::size_t
+#include <iterator>                                  // std::back_inserter
+#include <memory>                                    // std::unique_ptr
+#include <numeric>                                   // std::accumulate
+#include <thread>                                    // std::thread
+#include <vector>                                    // std::vector
+
+namespace {
+struct pooled_buffer {
+  std::atomic<pooled_buffer*> next{nullptr};
+  int                         value{0};
+};
+
+using buffer_pool
+  = pl::thd::intrusive_treiber_stack<pooled_buffer, &pooled_buffer::next>;
+} // anonymous namespace
+
+TEST_CASE("treiber_stack_test")
+{
+  SUBCASE("push_and_pop")
+  {
+    pl::thd::treiber_stack<int> stack{};
+    int                         value{0};
+
+    CHECK_UNARY(stack.empty());
+    CHECK_UNARY_FALSE(stack.try_pop(value));
+
+    stack.push(1);
+    stack.push(2);
+    stack.emplace(3);
+    CHECK_UNARY_FALSE(stack.empty());
+
+    REQUIRE_UNARY(stack.try_pop(value));
+    CHECK(value == 3);
+    REQUIRE_UNARY(stack.try_pop(value));
+    CHECK(value == 2);
+    REQUIRE_UNARY(stack.try_pop(value));
+    CHECK(value == 1);
+    CHECK_UNARY_FALSE(stack.try_pop(value));
+    CHECK_UNARY(stack.empty());
+  }
+
+  SUBCASE("push_list_and_pop_all")
+  {
+    pl::thd::treiber_stack<int> stack{};
+    const std::vector<int>      values{1, 2, 3, 4};
+    std::vector<int>            popped{};
+
+    stack.push(0);
+    stack.push_list(values.begin(), values.end());
+    stack.push_list(values.end(), values.end());
+    stack.pop_all(std::back_inserter(popped));
+
+    CHECK(popped == std::vector<int>{4, 3, 2, 1, 0});
+    CHECK_UNARY(stack.empty());
+  }
+
+  SUBCASE("move_only")
+  {
+    pl::thd::treiber_stack<std::unique_ptr<int>> stack{};
+    stack.push(std::make_unique<int>(5));
+    stack.push(std::make_unique<int>(6));
+
+    std::unique_ptr<int> value{};
+    REQUIRE_UNARY(stack.try_pop(value));
+    CHECK(*value == 6);
+    // the remaining element is destroyed by the destructor of the stack.
+  }
+
+  SUBCASE("multiple_threads")
+  {
+    static constexpr int thread_count{4};
+    static constexpr int iterations{20000};
+
+    pl::thd::treiber_stack<int> stack{};
+    std::atomic<long>           popped_sum{0};
+    std::atomic<long>           popped_count{0};
+    std::vector<std::thread>    threads{};
+
+    for (int i{0}; i < thread_count; ++i) {
+      threads.emplace_back([&stack, &popped_sum, &popped_count] {
+        long sum{0};
+        long count{0};
+        int  value{0};
+
+        for (int j{1}; j <= iterations; ++j) {
+          stack.push(j);
+
+          if (stack.try_pop(value)) {
+            sum += value;
+            ++count;
+          }
+        }
+
+        popped_sum += sum;
+        popped_count += count;
+      });
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    std::vector<int> rest{};
+    stack.pop_all(std::back_inserter(rest));
+
+    CHECK(
+      popped_count.load() + static_cast<long>(rest.size())
+      == static_cast<long>(thread_count) * iterations);
+    CHECK(
+      popped_sum.load() + std::accumulate(rest.begin(), rest.end(), 0L)
+      == static_cast<long>(thread_count) * iterations * (iterations + 1) / 2);
+  }
+
+  SUBCASE("free_list")
+  {
+    static constexpr int         thread_count{4};
+    static constexpr std::size_t buffer_count{8U};
+
+    pl::thd::treiber_stack<std::unique_ptr<std::vector<char>>> free_list{};
+    std::vector<std::unique_ptr<std::vector<char>>>            buffers{};
+
+    for (std::size_t i{0U}; i < buffer_count; ++i) {
+      buffers.push_back(std::make_unique<std::vector<char>>(64U));
+    }
+
+    free_list.push_list(
+      std::make_move_iterator(buffers.begin()),
+      std::make_move_iterator(buffers.end()));
+    std::vector<std::thread> threads{};
+
+    for (int i{0}; i < thread_count; ++i) {
+      threads.emplace_back([&free_list] {
+        std::unique_ptr<std::vector<char>> buffer{};
+
+        for (int j{0}; j < 10000; ++j) {
+          if (free_list.try_pop(buffer)) {
+            (*buffer)[0] = 'x';
+            free_list.push(std::move(buffer));
+          }
+        }
+      });
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    buffers.clear();
+    free_list.pop_all(std::back_inserter(buffers));
+    CHECK(buffers.size() == buffer_count);
+  }
+
+  SUBCASE("intrusive")
+  {
+    buffer_pool                 pool{};
+    std::vector<pooled_buffer>  buffers(4U);
+    std::vector<pooled_buffer*> popped{};
+
+    CHECK_UNARY(pool.empty());
+    CHECK(pool.try_pop() == nullptr);
+
+    pool.push(buffers[0]);
+    pool.push(buffers[1]);
+    CHECK(pool.try_pop() == &buffers[1]);
+
+    const std::vector<pooled_buffer*> list{&buffers[2], &buffers[3]};
+    pool.push_list(list.begin(), list.end());
+    pool.pop_all(std::back_inserter(popped));
+
+    CHECK(
+      popped
+      == std::vector<pooled_buffer*>{&buffers[3], &buffers[2], &buffers[0]});
+    CHECK_UNARY(pool.empty());
+  }
+
+  SUBCASE("intrusive_multiple_threads")
+  {
+    static constexpr int         thread_count{4};
+    static constexpr int         iterations{20000};
+    static constexpr std::size_t buffer_count{8U};
+
+    buffer_pool                 pool{};
+    std::vector<pooled_buffer>  buffers(buffer_count);
+    std::vector<pooled_buffer*> popped{};
+    std::vector<std::thread>    threads{};
+    std::atomic<int>            pop_count{0};
+
+    for (pooled_buffer& buffer : buffers) {
+      pool.push(buffer);
+    }
+
+    for (int i{0}; i < thread_count; ++i) {
+      threads.emplace_back([&pool, &pop_count] {
+        int count{0};
+
+        for (int j{0}; j < iterations; ++j) {
+          pooled_buffer* const buffer{pool.try_pop()};
+
+          if (buffer != nullptr) {
+            // no other thread holds the buffer at the same time.
+            ++buffer->value;
+            ++count;
+            pool.push(*buffer);
+          }
+        }
+
+        pop_count += count;
+      });
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    pool.pop_all(std::back_inserter(popped));
+    CHECK(popped.size() == buffer_count);
+    CHECK(
+      std::accumulate(
+        buffers.begin(),
+        buffers.end(),
+        0,
+        [](int sum, const pooled_buffer& b) { return sum + b.value; })
+      == pop_count.load());
+  }
+}
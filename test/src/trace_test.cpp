@@ -0,0 +1,134 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#define PL_ENABLE_TRACING
+#include "../../include/pl/trace.hpp" // PL_TRACE_SCOPE, pl::write_chrome_trace
+#include <chrono>                     // std::chrono::milliseconds
+#include <cstdint>                    // std::uint64_t
+#include <sstream>                    // std::ostringstream
+#include <string>                     // std::string
+#include <thread>                     // std::thread
+
+namespace pl {
+namespace test {
+namespace {
+int traced_function(int i)
+{
+  PL_TRACE_FUNCTION();
+  PL_TRACE_SCOPE("inner zone");
+  return i + 1;
+}
+
+std::string write_trace()
+{
+  std::ostringstream oss{};
+  ::pl::write_chrome_trace(oss);
+  return oss.str();
+}
+} // anonymous namespace
+} // namespace test
+} // namespace pl
+
+TEST_CASE("trace_test")
+{
+  static const std::string empty_trace{
+    "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n]}\n"};
+
+  // discard whatever was recorded before.
+  (void)pl::test::write_trace();
+
+  SUBCASE("zones")
+  {
+    PL_TRACE_THREAD_NAME("test thread");
+    CHECK(pl::test::traced_function(1) == 2);
+
+    const std::string trace{pl::test::write_trace()};
+    CHECK(trace.find(R"({"displayTimeUnit":"ns","traceEvents":[)") == 0U);
+    CHECK(
+      trace.find(R"("name":"inner zone","cat":"pl","ph":"X")")
+      != std::string::npos);
+    CHECK(trace.find("traced_function") != std::string::npos);
+    CHECK(trace.find("trace_test.cpp:") != std::string::npos);
+    CHECK(trace.find(R"("args":{"name":"test thread"})") != std::string::npos);
+    CHECK(trace.find("\n]}\n") == trace.size() - 4U);
+
+    // the events were taken.
+    CHECK(pl::test::write_trace() == empty_trace);
+  }
+
+  SUBCASE("threads")
+  {
+    std::thread thread{[] {
+      PL_TRACE_THREAD_NAME("other thread");
+      (void)pl::test::traced_function(2);
+    }};
+    thread.join();
+
+    const std::string trace{pl::test::write_trace()};
+    CHECK(trace.find("other thread") != std::string::npos);
+    CHECK(trace.find("inner zone") != std::string::npos);
+    CHECK(pl::test::write_trace() == empty_trace);
+  }
+
+  SUBCASE("trace_flusher")
+  {
+    std::ostringstream oss{};
+
+    {
+      const pl::trace_flusher flusher{oss, std::chrono::milliseconds{1}};
+      (void)pl::test::traced_function(3);
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+      (void)pl::test::traced_function(4);
+    }
+
+    const std::string trace{oss.str()};
+    CHECK(trace.find(R"({"displayTimeUnit":"ns","traceEvents":[)") == 0U);
+    CHECK(trace.find("inner zone") != std::string::npos);
+    CHECK(trace.find("\n]}\n") == trace.size() - 4U);
+  }
+
+  SUBCASE("dropped")
+  {
+    const std::uint64_t dropped{pl::trace_events_dropped()};
+
+    for (int i{0}; i < PL_TRACE_BUFFER_CAPACITY; ++i) {
+      PL_TRACE_SCOPE("filler");
+    }
+
+    (void)pl::test::traced_function(5);
+    CHECK(pl::trace_events_dropped() == dropped + 2U);
+    (void)pl::test::write_trace();
+  }
+}
@@ -0,0 +1,101 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../../include/pl/cpu_features.hpp" // pl::cpu_features
+#include "../../include/pl/tsc_timer.hpp" // pl::tsc_timer, pl::scoped_tsc_timer
+#include <chrono> // std::literals::chrono_literals::operator""ms, std::chrono::nanoseconds
+#include <cstdint>                           // std::uint64_t
+#include <thread>                            // std::this_thread::sleep_for
+
+TEST_CASE("tsc_timer_test")
+{
+  using namespace std::literals::chrono_literals;
+
+  pl::tsc_timer::calibrate();
+  CHECK(pl::tsc_timer::nanoseconds_per_tick() > 0.0);
+
+#if PL_CPU_X86
+  CHECK(
+    pl::tsc_timer::uses_cycle_counter()
+    == pl::cpu_features::current().has(
+      pl::cpu_feature::rdtscp | pl::cpu_feature::invariant_tsc));
+#endif // PL_CPU_X86
+
+  SUBCASE("elapsed_time")
+  {
+    pl::tsc_timer timer{};
+    std::this_thread::sleep_for(50ms);
+    CHECK(timer.elapsed_time() >= 49ms);
+    CHECK(timer.elapsed_time() < 10s);
+    CHECK(timer.elapsed_ticks() > 0U);
+
+    timer.reset();
+    CHECK(timer.elapsed_time() < 49ms);
+    std::this_thread::sleep_for(20ms);
+    CHECK(timer.elapsed_time() >= 19ms);
+  }
+
+  SUBCASE("monotonic")
+  {
+    const pl::tsc_timer timer{};
+    std::uint64_t       previous{timer.elapsed_ticks()};
+
+    for (int i{0}; i < 1000; ++i) {
+      const std::uint64_t current{timer.elapsed_ticks()};
+      CHECK(current >= previous);
+      previous = current;
+    }
+  }
+
+  SUBCASE("scoped_tsc_timer")
+  {
+    std::chrono::nanoseconds total{0};
+
+    {
+      const pl::scoped_tsc_timer t{total};
+      std::this_thread::sleep_for(10ms);
+    }
+
+    CHECK(total >= 9ms);
+    const std::chrono::nanoseconds first{total};
+
+    {
+      const pl::scoped_tsc_timer t{total};
+      std::this_thread::sleep_for(10ms);
+    }
+
+    CHECK(total >= first + 9ms);
+  }
+}
@@ -34,6 +34,8 @@
 #pragma GCC diagnostic pop
 #endif // PL_COMPILER == PL_COMPILER_GCC
 #include "../../include/pl/unhexify.hpp"
+#include <system_error> // std::errc
+#include <vector>       // std::vector
 
 TEST_CASE("unhexify_no_delimiter")
 {
@@ -58,6 +60,23 @@ TEST_CASE("unhexify_long_delimiter")
   CHECK(expected == pl::unhexify(ary, 12));
 }
 
+TEST_CASE("try_unhexify")
+{
+  const std::vector<pl::byte> expected{0x7E, 0x00, 0xab, 0x1E};
+
+  const pl::expected<std::vector<pl::byte>, std::errc> result{
+    pl::try_unhexify("7E:00:aB:1E", 1)};
+  REQUIRE(result.has_value());
+  CHECK(*result == expected);
+  CHECK(*pl::try_unhexify("7E00AB1E", 0) == expected);
+
+  CHECK(pl::try_unhexify("7", 0).error() == std::errc::invalid_argument);
+  CHECK(pl::try_unhexify("7E0", 0).error() == std::errc::invalid_argument);
+  CHECK(pl::try_unhexify("7E:0", 1).error() == std::errc::invalid_argument);
+  CHECK(pl::try_unhexify("7G", 0).error() == std::errc::invalid_argument);
+  CHECK(pl::try_unhexify("7E:x0", 1).error() == std::errc::invalid_argument);
+}
+
 TEST_CASE("unhexify_one_byte")
 {
   const std::vector<pl::byte> expected{0xAB};
@@ -0,0 +1,158 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include "../../include/pl/compiler.hpp"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#endif // PL_COMPILER == PL_COMPILER_GCC
+#include "../doctest.h"
+#if PL_COMPILER == PL_COMPILER_GCC
+#pragma GCC diagnostic pop
+#endif                                          // PL_COMPILER == PL_COMPILER_GCC
+#include "../../include/pl/unique_function.hpp" // pl::unique_function
+#include <cstddef>                              // std::size_t
+#include <functional>                           // std::bad_function_call
+#include <memory> // std::unique_ptr, std::make_unique
+#include <string>                               // std::string
+#include <utility>                              // std::move
+
+namespace pl {
+namespace test {
+namespace {
+class copy_counter {
+public:
+  explicit copy_counter(int* copies) noexcept : m_copies{copies}
+  {
+  }
+  copy_counter(const copy_counter& other) noexcept : m_copies{other.m_copies}
+  {
+    ++*m_copies;
+  }
+  copy_counter(copy_counter&&) noexcept = default;
+  copy_counter& operator=(const copy_counter& other) noexcept
+  {
+    m_copies = other.m_copies;
+    ++*m_copies;
+    return *this;
+  }
+  copy_counter& operator=(copy_counter&&) noexcept = default;
+  int operator()(int i) const noexcept
+  {
+    return i + 1;
+  }
+
+private:
+  int* m_copies;
+};
+
+struct large_callable {
+  char                 buffer[128];
+  std::unique_ptr<int> value;
+
+  int operator()(int i) const
+  {
+    return i + *value;
+  }
+};
+} // anonymous namespace
+} // namespace test
+} // namespace pl
+
+TEST_CASE("unique_function_test")
+{
+  SUBCASE("empty")
+  {
+    pl::unique_function<int(int)> f1{};
+    pl::unique_function<int(int)> f2{nullptr};
+
+    CHECK_UNARY_FALSE(f1);
+    CHECK_UNARY(f2 == nullptr);
+    CHECK_THROWS_AS(f1(1), std::bad_function_call);
+  }
+
+  SUBCASE("move_only")
+  {
+    pl::unique_function<int(int)> f1{
+      [p = std::make_unique<int>(5)](int i) { return *p + i; }};
+    CHECK_UNARY(f1 != nullptr);
+    CHECK(f1(2) == 7);
+
+    pl::unique_function<int(int)> f2{std::move(f1)};
+    CHECK_UNARY_FALSE(f1);
+    CHECK(f2(3) == 8);
+
+    f1 = std::move(f2);
+    CHECK(f1(4) == 9);
+    f1 = nullptr;
+    CHECK_UNARY_FALSE(f1);
+  }
+
+  SUBCASE("large_callable")
+  {
+    pl::unique_function<int(int)> f1{
+      pl::test::large_callable{{}, std::make_unique<int>(10)}};
+    pl::unique_function<int(int)> f2{[](int i) { return i * 2; }};
+
+    f1.swap(f2);
+    CHECK(f1(3) == 6);
+    CHECK(f2(3) == 13);
+
+    pl::unique_function<int(int)> f3{std::move(f2)};
+    CHECK(f3(1) == 11);
+  }
+
+  SUBCASE("arguments")
+  {
+    pl::unique_function<std::string(std::unique_ptr<std::string>)> f{
+      [](std::unique_ptr<std::string> p) { return *p + "!"; }};
+    CHECK(f(std::make_unique<std::string>("text")) == "text!");
+
+    pl::unique_function<void(int)> discard{[](int i) { return i; }};
+    discard(1);
+
+    pl::unique_function<std::size_t(const std::string&)> member{
+      &std::string::size};
+    CHECK(member(std::string{"abc"}) == 3U);
+  }
+
+  SUBCASE("copies")
+  {
+    int copies{0};
+    {
+      pl::test::copy_counter        counter{&copies};
+      pl::unique_function<int(int)> f1{std::move(counter)};
+      pl::unique_function<int(int)> f2{std::move(f1)};
+      f1 = std::move(f2);
+      CHECK(f1(1) == 2);
+    }
+    CHECK(copies == 0);
+
+    pl::test::copy_counter        counter{&copies};
+    pl::unique_function<int(int)> f{counter};
+    CHECK(copies == 1);
+  }
+}